@@ -0,0 +1,199 @@
+/**
+ * @file cell-delta.h
+ * @brief Delta compression of the cell voltages for the CAN telemetry
+ *
+ * @details Most of the cell voltages barely change between two consecutive
+ * measurement cycles, instead of sending all the raw values every time only the
+ * cells that changed are sent, encoded as the difference from the last transmitted value
+ *
+ * Every frame is exactly CELL_DELTA_FRAME_SIZE bytes long (a classic CAN payload)
+ * and has the following layout:
+ *  - Byte 0: frame type (bits 7-6) and frame sequence number (bits 5-0)
+ *  - Byte 1: index of the first cell of the frame
+ *  - Absolute and keyframe frames: bytes 2-7 contain three consecutive raw voltages (little endian)
+ *  - Delta frames: byte 2 is a bitmask of the changed cells starting from the index in byte 1,
+ *    bytes 3-7 contain the signed 8-bit differences of the changed cells in order
+ *
+ * The voltages are expressed in the same unit of the LTC6811 registers (100uV)
+ *
+ * @date 18 Oct 2026
+ * @author Antonio Gelain [antonio.gelain2@gmail.com]
+ */
+
+#ifndef CELL_DELTA_H
+#define CELL_DELTA_H
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Size of a single encoded frame in bytes
+#define CELL_DELTA_FRAME_SIZE 8U
+// Maximum number of cells that can be addressed by a frame
+#define CELL_DELTA_MAX_CELLS 256U
+// Number of raw voltages inside an absolute or keyframe frame
+#define CELL_DELTA_ABSOLUTE_COUNT 3U
+// Number of cells covered by the bitmask of a delta frame
+#define CELL_DELTA_WINDOW_SIZE 8U
+// Maximum number of differences inside a delta frame
+#define CELL_DELTA_DELTA_COUNT 5U
+// Number of different sequence numbers
+#define CELL_DELTA_SEQ_COUNT 64U
+
+/**
+ * @brief Get the number of frames needed to send all the cells
+ *
+ * @param CELLS The number of cells
+ */
+#define CELL_DELTA_KEYFRAME_COUNT(CELLS) (((CELLS) + CELL_DELTA_ABSOLUTE_COUNT - 1U) / CELL_DELTA_ABSOLUTE_COUNT)
+
+/**
+ * @brief Get the size of the buffer needed for the encoding
+ *
+ * @details The encoder never produces more bytes than a full keyframe
+ *
+ * @param CELLS The number of cells
+ */
+#define CELL_DELTA_BUFFER_SIZE(CELLS) (CELL_DELTA_KEYFRAME_COUNT(CELLS) * CELL_DELTA_FRAME_SIZE)
+
+/** @brief Type of an encoded frame */
+typedef enum {
+    CELL_DELTA_FRAME_DELTA = 0, // Differences of the changed cells
+    CELL_DELTA_FRAME_ABSOLUTE,  // Raw voltages of cells whose difference does not fit in 8 bits
+    CELL_DELTA_FRAME_KEYFRAME,  // Raw voltages, part of a full keyframe
+    CELL_DELTA_FRAME_TYPE_COUNT
+} CellDeltaFrameType;
+
+/**
+ * @brief Encoder handler structure
+ *
+ * @param reference The last transmitted voltages, as seen by the decoder
+ * @param cell_count The number of cells
+ * @param deadband The maximum difference which is not considered a change
+ * @param keyframe_period The number of cycles between two keyframes (0 to disable)
+ * @param cycles The number of cycles since the last keyframe
+ * @param seq The sequence number of the next frame
+ * @param keyframe_requested True if the next cycle has to be a keyframe
+ */
+typedef struct {
+    uint16_t * reference;
+    size_t cell_count;
+    uint16_t deadband;
+    size_t keyframe_period;
+    size_t cycles;
+    uint8_t seq;
+    bool keyframe_requested;
+} CellDeltaEncoder;
+
+/**
+ * @brief Decoder handler structure
+ *
+ * @param voltages The decoded cell voltages
+ * @param cell_count The number of cells
+ * @param seq The expected sequence number of the next frame
+ * @param key_next The index of the next expected keyframe frame
+ * @param synced True if the voltages are consistent with the encoder ones
+ */
+typedef struct {
+    uint16_t * voltages;
+    size_t cell_count;
+    uint8_t seq;
+    size_t key_next;
+    bool synced;
+} CellDeltaDecoder;
+
+
+/**
+ * @brief Initialize the encoder
+ *
+ * @details The first encoded cycle is always a keyframe
+ *
+ * @details With a deadband of 0 the compression is lossless, otherwise the
+ * decoded voltages differ at most by 'deadband' from the encoded ones
+ *
+ * @attention The 'reference' array size has to be equal to 'cell_count'
+ *
+ * @param enc The encoder handler structure
+ * @param reference The array used to store the last transmitted voltages
+ * @param cell_count The number of cells (at most CELL_DELTA_MAX_CELLS)
+ * @param deadband The maximum difference which is not considered a change
+ * @param keyframe_period The number of cycles between two keyframes (0 to disable)
+ */
+void cell_delta_encoder_init(
+    CellDeltaEncoder * enc,
+    uint16_t * reference,
+    size_t cell_count,
+    uint16_t deadband,
+    size_t keyframe_period
+);
+
+/**
+ * @brief Force the next encoded cycle to be a keyframe
+ *
+ * @param enc The encoder handler structure
+ */
+void cell_delta_encoder_request_keyframe(CellDeltaEncoder * enc);
+
+/**
+ * @brief Encode the cell voltages of a single measurement cycle
+ *
+ * @details If the delta encoding would be larger than a keyframe a keyframe is sent instead
+ *
+ * @attention The 'out' array should be large enough to contain all the encoded bytes
+ * Use the CELL_DELTA_BUFFER_SIZE macro to get the right size for the buffer
+ *
+ * @param enc The encoder handler structure
+ * @param voltages The array of 'cell_count' voltages to encode
+ * @param out The array where the encoded frames are written
+ * @return size_t The number of encoded bytes (a multiple of CELL_DELTA_FRAME_SIZE, 0 if nothing changed)
+ */
+size_t cell_delta_encode(
+    CellDeltaEncoder * enc,
+    uint16_t * voltages,
+    uint8_t * out
+);
+
+/**
+ * @brief Initialize the decoder
+ *
+ * @attention The 'voltages' array size has to be equal to 'cell_count'
+ *
+ * @param dec The decoder handler structure
+ * @param voltages The array where the decoded voltages are stored
+ * @param cell_count The number of cells (at most CELL_DELTA_MAX_CELLS)
+ */
+void cell_delta_decoder_init(
+    CellDeltaDecoder * dec,
+    uint16_t * voltages,
+    size_t cell_count
+);
+
+/**
+ * @brief Decode one or more encoded frames
+ *
+ * @details A missing frame is detected from the sequence number, in that case
+ * the decoder is out of sync until the next complete keyframe is received
+ *
+ * @details The decoding stops at the first invalid frame, the return value can be
+ * compared with 'size' to check if all bytes were decoded correctly
+ *
+ * @param dec The decoder handler structure
+ * @param data The array of bytes to decode
+ * @param size The number of bytes to decode
+ * @return size_t The number of decoded bytes
+ */
+size_t cell_delta_decode(
+    CellDeltaDecoder * dec,
+    uint8_t * data,
+    size_t size
+);
+
+/**
+ * @brief Check if the decoded voltages are consistent with the encoded ones
+ *
+ * @param dec The decoder handler structure
+ * @return bool True if the decoder is in sync, false otherwise
+ */
+bool cell_delta_decoder_is_synced(CellDeltaDecoder * dec);
+
+#endif  // CELL_DELTA_H
@@ -0,0 +1,266 @@
+/**
+ * @file ltc6811-chain.h
+ * @brief Per-device state of the LTC6811 chains and scheduler for multiple chains
+ *
+ * @details Each chain (e.g. an isoSPI port) keeps the state of its devices inside the
+ * 'devices' array of the Ltc6811Chain structure, the store functions decode the data
+ * read from the chain directly into that state, counting the PEC errors and saving the
+ * time of the last valid read of each register group
+ *
+ * The scheduler measures the cell voltages of multiple chains, it returns one operation
+ * at a time which has to be executed on the SPI peripheral of the selected chain:
+ *  - In round-robin mode each chain completes its measurement before the next one is started
+ *  - In interleaved mode the conversions of all the chains are started together and the
+ *    reads of one chain are executed while the other chains are still converting
+ *
+ * @date 18 Oct 2026
+ * @author Antonio Gelain [antonio.gelain2@gmail.com]
+ */
+
+#ifndef LTC6811_CHAIN_H
+#define LTC6811_CHAIN_H
+
+#include "ltc6811.h"
+
+// Maximum number of chains handled by a single scheduler
+#ifndef LTC6811_SCHEDULER_MAX_CHAINS
+#define LTC6811_SCHEDULER_MAX_CHAINS 8U
+#endif  // LTC6811_SCHEDULER_MAX_CHAINS
+
+/** @brief Scheduling policy between the chains */
+typedef enum {
+    LTC6811_SCHEDULER_ROUND_ROBIN = 0,
+    LTC6811_SCHEDULER_INTERLEAVED
+} Ltc6811SchedulerMode;
+
+/** @brief Type of a scheduled operation */
+typedef enum {
+    LTC6811_OP_NONE = 0,   // Nothing to do, wait for the given time
+    LTC6811_OP_CONVERSION, // Send the command that starts the conversion
+    LTC6811_OP_READ        // Send the command and read the data
+} Ltc6811OpType;
+
+/** @brief Measurement state of a single chain */
+typedef enum {
+    LTC6811_CHAIN_IDLE = 0,
+    LTC6811_CHAIN_CONVERTING,
+    LTC6811_CHAIN_READING,
+    LTC6811_CHAIN_DONE
+} Ltc6811ChainState;
+
+/**
+ * @brief Single operation to execute on a chain
+ *
+ * @param type The type of the operation
+ * @param chain The index of the chain where the operation has to be executed
+ * @param reg The cell voltage register group read by the operation
+ * @param size The number of bytes to send
+ * @param read_size The number of bytes to read after the command is sent
+ * @param wait The time after which a new operation can be executed (only for LTC6811_OP_NONE)
+ * @param out The encoded bytes to send
+ */
+typedef struct {
+    Ltc6811OpType type;
+    size_t chain;
+    Ltc6811Cvxr reg;
+    size_t size;
+    size_t read_size;
+    uint32_t wait;
+    uint8_t out[LTC6811_READ_BUFFER_SIZE(1U)];
+} Ltc6811Op;
+
+/**
+ * @brief Scheduler handler structure
+ *
+ * @param chains The array of chains
+ * @param chain_count The number of chains
+ * @param policy The scheduling policy
+ * @param mode The ADC conversion mode
+ * @param dcp The discharge permitted option
+ * @param conversion_time The time needed to complete a conversion of all the cells
+ * @param current The index of the chain that is measured in round-robin mode
+ * @param state The measurement state of each chain
+ * @param start The time when the conversion of each chain was started
+ * @param reg The next register group to read for each chain
+ * @param cycles The number of completed measurement cycles of all the chains
+ */
+typedef struct {
+    Ltc6811Chain * chains;
+    size_t chain_count;
+    Ltc6811SchedulerMode policy;
+    Ltc6811Md mode;
+    Ltc6811Dcp dcp;
+    uint32_t conversion_time;
+    size_t current;
+    Ltc6811ChainState state[LTC6811_SCHEDULER_MAX_CHAINS];
+    uint32_t start[LTC6811_SCHEDULER_MAX_CHAINS];
+    Ltc6811Cvxr reg[LTC6811_SCHEDULER_MAX_CHAINS];
+    size_t cycles;
+} Ltc6811Scheduler;
+
+
+/**
+ * @brief Decode the cell voltages read from the chain and store them in the devices state
+ *
+ * @attention The chain has to be initialized with 'ltc6811_chain_init_devices'
+ *
+ * @param chain The LTC6811 chain handler
+ * @param reg The register group that was read
+ * @param data The array of bytes to decode
+ * @param timestamp The time when the data was read
+ * @return size_t The number of decoded bytes (PEC included)
+ */
+size_t ltc6811_chain_store_cv(
+    Ltc6811Chain * chain,
+    Ltc6811Cvxr reg,
+    uint8_t * data,
+    uint32_t timestamp
+);
+
+/**
+ * @brief Decode the auxiliary voltages read from the chain and store them in the devices state
+ *
+ * @attention The chain has to be initialized with 'ltc6811_chain_init_devices'
+ *
+ * @param chain The LTC6811 chain handler
+ * @param reg The register group that was read
+ * @param data The array of bytes to decode
+ * @param timestamp The time when the data was read
+ * @return size_t The number of decoded bytes (PEC included)
+ */
+size_t ltc6811_chain_store_aux(
+    Ltc6811Chain * chain,
+    Ltc6811Avxr reg,
+    uint8_t * data,
+    uint32_t timestamp
+);
+
+/**
+ * @brief Decode the status read from the chain and store it in the devices state
+ *
+ * @attention The chain has to be initialized with 'ltc6811_chain_init_devices'
+ *
+ * @param chain The LTC6811 chain handler
+ * @param reg The register group that was read
+ * @param data The array of bytes to decode
+ * @param timestamp The time when the data was read
+ * @return size_t The number of decoded bytes (PEC included)
+ */
+size_t ltc6811_chain_store_stat(
+    Ltc6811Chain * chain,
+    Ltc6811Stxr reg,
+    uint8_t * data,
+    uint32_t timestamp
+);
+
+/**
+ * @brief Encode the write configuration command with the configuration shadows of the devices
+ *
+ * @attention The 'out' array should be large enough to contain all the encoded bytes
+ * Use the LTC6811_WRITE_BUFFER_SIZE macro to get the right size for the buffer
+ *
+ * @param chain The LTC6811 chain handler
+ * @param out The array where the encoded bytes are written
+ * @return size_t The number of encoded bytes
+ */
+size_t ltc6811_chain_wrcfg_encode(
+    Ltc6811Chain * chain,
+    uint8_t * out
+);
+
+/**
+ * @brief Encode the write PWM command with the PWM shadows of the devices
+ *
+ * @attention The 'out' array should be large enough to contain all the encoded bytes
+ * Use the LTC6811_WRITE_BUFFER_SIZE macro to get the right size for the buffer
+ *
+ * @param chain The LTC6811 chain handler
+ * @param out The array where the encoded bytes are written
+ * @return size_t The number of encoded bytes
+ */
+size_t ltc6811_chain_wrpwm_encode(
+    Ltc6811Chain * chain,
+    uint8_t * out
+);
+
+/**
+ * @brief Encode the write S control command with the S control shadows of the devices
+ *
+ * @attention The 'out' array should be large enough to contain all the encoded bytes
+ * Use the LTC6811_WRITE_BUFFER_SIZE macro to get the right size for the buffer
+ *
+ * @param chain The LTC6811 chain handler
+ * @param out The array where the encoded bytes are written
+ * @return size_t The number of encoded bytes
+ */
+size_t ltc6811_chain_wrsctrl_encode(
+    Ltc6811Chain * chain,
+    uint8_t * out
+);
+
+/**
+ * @brief Get the time needed to convert all the cells with the ADCV command
+ *
+ * @param mode The ADC conversion mode
+ * @param adcopt The ADCOPT bit of the LTC configuration
+ * @return uint32_t The conversion time in microseconds
+ */
+uint32_t ltc6811_adcv_conversion_time_us(Ltc6811Md mode, uint8_t adcopt);
+
+/**
+ * @brief Initialize the scheduler
+ *
+ * @attention The chains have to be initialized with 'ltc6811_chain_init_devices'
+ *
+ * @param sched The scheduler handler structure
+ * @param chains The array of chains
+ * @param chain_count The number of chains (at most LTC6811_SCHEDULER_MAX_CHAINS)
+ * @param policy The scheduling policy
+ * @param mode The ADC conversion mode
+ * @param dcp The discharge permitted option
+ * @param conversion_time The conversion time in the same unit used for the time
+ */
+void ltc6811_scheduler_init(
+    Ltc6811Scheduler * sched,
+    Ltc6811Chain * chains,
+    size_t chain_count,
+    Ltc6811SchedulerMode policy,
+    Ltc6811Md mode,
+    Ltc6811Dcp dcp,
+    uint32_t conversion_time
+);
+
+/**
+ * @brief Get the next operation to execute
+ *
+ * @details If the operation type is LTC6811_OP_READ, 'read_size' bytes has to be
+ * read from the chain and given to the 'ltc6811_scheduler_decode' function
+ *
+ * @param sched The scheduler handler structure
+ * @param now The current time
+ * @param op The operation to execute
+ * @return Ltc6811OpType The type of the operation
+ */
+Ltc6811OpType ltc6811_scheduler_next(
+    Ltc6811Scheduler * sched,
+    uint32_t now,
+    Ltc6811Op * op
+);
+
+/**
+ * @brief Decode the data read after a read operation and store it in the chain state
+ *
+ * @param sched The scheduler handler structure
+ * @param op The executed read operation
+ * @param data The array of bytes to decode
+ * @param now The current time
+ * @return size_t The number of decoded bytes (PEC included)
+ */
+size_t ltc6811_scheduler_decode(
+    Ltc6811Scheduler * sched,
+    Ltc6811Op * op,
+    uint8_t * data,
+    uint32_t now
+);
+
+#endif  // LTC6811_CHAIN_H
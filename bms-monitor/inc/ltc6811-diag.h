@@ -0,0 +1,201 @@
+/**
+ * @file ltc6811-diag.h
+ * @brief Incremental diagnostics scheduler for the LTC6811 chain
+ *
+ * @details The open wire check and the self tests of the LTC6811 require multiple
+ * conversions and reads, running all of them at once stalls the measurement loop
+ * for a long time. The diagnostics are split into steps and only one step is
+ * executed for each measurement cycle, so that the full coverage is reached
+ * after LTC6811_DIAG_STEP_COUNT cycles without changing the sampling period
+ * of the cell voltages
+ *
+ * @attention Every step overwrites the content of the registers that it uses
+ * (cell voltage, auxiliary and status registers), all the transactions of a single
+ * step have to be executed before any other conversion is started
+ *
+ * @date 18 Oct 2026
+ * @author Antonio Gelain [antonio.gelain2@gmail.com]
+ */
+
+#ifndef LTC6811_DIAG_H
+#define LTC6811_DIAG_H
+
+#include "ltc6811.h"
+
+// Voltage difference between pull-up and pull-down conversions below which a wire is considered open (100uV)
+#define LTC6811_DIAG_OPEN_WIRE_THRESHOLD (-4000)
+// Total number of C pins that can be checked by the open wire detection (C0 ... C12)
+#define LTC6811_DIAG_WIRE_COUNT (LTC6811_CELL_COUNT + 1)
+// Maximum number of transactions executed in a single step
+#define LTC6811_DIAG_STEP_MAX_OPS 6U
+
+/** @brief List of the available diagnostic tests */
+typedef enum {
+    LTC6811_DIAG_OPEN_WIRE = 0, // Open wire detection (ADOW)
+    LTC6811_DIAG_CVST,          // Cell voltage conversion self test
+    LTC6811_DIAG_AXST,          // GPIOs conversion self test
+    LTC6811_DIAG_STATST,        // Status group conversion self test
+    LTC6811_DIAG_MUX,           // Multiplexer self test (DIAGN)
+    LTC6811_DIAG_TEST_COUNT
+} Ltc6811DiagTest;
+
+/** @brief List of the diagnostic steps executed one per measurement cycle */
+typedef enum {
+    LTC6811_DIAG_STEP_OW_PUP = 0, // Open wire conversion with the pull-up current
+    LTC6811_DIAG_STEP_OW_PDN,     // Open wire conversion with the pull-down current
+    LTC6811_DIAG_STEP_CVST,
+    LTC6811_DIAG_STEP_AXST,
+    LTC6811_DIAG_STEP_STATST,
+    LTC6811_DIAG_STEP_MUX,
+    LTC6811_DIAG_STEP_COUNT
+} Ltc6811DiagStep;
+
+// Bitset with all the diagnostic tests set
+#define LTC6811_DIAG_ALL_TESTS ((1U << LTC6811_DIAG_TEST_COUNT) - 1U)
+
+/**
+ * @brief Diagnostic results of a single LTC6811
+ *
+ * @details The 'done' and 'failed' fields are bitsets where each bit
+ * corresponds to a test of the Ltc6811DiagTest enum
+ *
+ * @param done The tests that were executed at least once
+ * @param failed The tests that failed the last time they were executed
+ * @param open_wire Bitset of the open C pins (C0 starts from the least significant bit)
+ * @param step_ok False if a PEC error occurred during the current step (used internally)
+ * @param pup_ok False if a PEC error occurred during the pull-up open wire step (used internally)
+ * @param pup Cell voltages measured with the pull-up current (used internally)
+ */
+typedef struct {
+    uint8_t done;
+    uint8_t failed;
+    uint16_t open_wire;
+    bool step_ok;
+    bool pup_ok;
+    uint16_t pup[LTC6811_CELL_COUNT];
+} Ltc6811DiagResult;
+
+/**
+ * @brief Diagnostics scheduler handler structure
+ *
+ * @param chain The LTC6811 chain handler
+ * @param results The array of results, one for each LTC6811 in the chain
+ * @param mode The ADC conversion mode used by the diagnostic conversions
+ * @param adcopt The ADCOPT bit of the LTC configuration
+ * @param test_mode The self test mode option
+ * @param step The current step
+ * @param op The index of the next transaction of the current step
+ * @param rounds The number of times all the steps have been executed
+ */
+typedef struct {
+    Ltc6811Chain * chain;
+    Ltc6811DiagResult * results;
+    Ltc6811Md mode;
+    uint8_t adcopt;
+    Ltc6811St test_mode;
+    Ltc6811DiagStep step;
+    size_t op;
+    size_t rounds;
+} Ltc6811Diag;
+
+
+/**
+ * @brief Initialize the diagnostics scheduler
+ *
+ * @attention The 'results' array size has to be equal to the number of LTC6811 in the chain
+ *
+ * @param diag The diagnostics handler structure
+ * @param chain The LTC6811 chain handler
+ * @param results The array where the diagnostic results are stored
+ * @param mode The ADC conversion mode used for the diagnostic conversions
+ * @param adcopt The ADCOPT bit of the LTC configuration
+ * @param test_mode The self test mode option
+ */
+void ltc6811_diag_init(
+    Ltc6811Diag * diag,
+    Ltc6811Chain * chain,
+    Ltc6811DiagResult * results,
+    Ltc6811Md mode,
+    uint8_t adcopt,
+    Ltc6811St test_mode
+);
+
+/**
+ * @brief Clear all the diagnostic results and restart from the first step
+ *
+ * @param diag The diagnostics handler structure
+ */
+void ltc6811_diag_reset(Ltc6811Diag * diag);
+
+/**
+ * @brief Encode the next transaction of the current diagnostic step
+ *
+ * @details When the function returns 0 the current step has ended and nothing
+ * else has to be sent in this measurement cycle, the next call starts the next step
+ *
+ * @details If 'read_size' is 0 after the call the encoded command starts a conversion
+ * and the end of the conversion has to be awaited (e.g. with 'ltc6811_pladc_encode_broadcast')
+ * before the next transaction, otherwise 'read_size' bytes have to be received
+ * and given to the 'ltc6811_diag_decode' function
+ *
+ * @attention The 'out' array should be large enough to contain all the encoded bytes
+ * Use the LTC6811_READ_BUFFER_SIZE macro to get the right size for the buffer
+ *
+ * @param diag The diagnostics handler structure
+ * @param out The array where the encoded bytes are written
+ * @param read_size The number of bytes to read after the command is sent
+ * @return size_t The number of encoded bytes
+ */
+size_t ltc6811_diag_encode(
+    Ltc6811Diag * diag,
+    uint8_t * out,
+    size_t * read_size
+);
+
+/**
+ * @brief Decode the data read after a diagnostic read transaction
+ *
+ * @details The return value can be compared with the LTC6811_DATA_BUFFER_SIZE macro
+ * to check if all bytes where decoded correctly, the results of the devices with
+ * an invalid PEC are not updated in the current step
+ *
+ * @param diag The diagnostics handler structure
+ * @param data The array of bytes to decode
+ * @return size_t The number of decoded bytes (PEC included)
+ */
+size_t ltc6811_diag_decode(
+    Ltc6811Diag * diag,
+    uint8_t * data
+);
+
+/**
+ * @brief Check if every diagnostic test has been executed on all the LTC6811 in the chain
+ *
+ * @param diag The diagnostics handler structure
+ * @return bool True if the diagnostic coverage is complete, false otherwise
+ */
+bool ltc6811_diag_is_complete(Ltc6811Diag * diag);
+
+/**
+ * @brief Check if at least one diagnostic test failed on any LTC6811 of the chain
+ *
+ * @param diag The diagnostics handler structure
+ * @return bool True if a failure was detected, false otherwise
+ */
+bool ltc6811_diag_has_failed(Ltc6811Diag * diag);
+
+/**
+ * @brief Get the expected result of a self test conversion
+ *
+ * @param mode The ADC conversion mode
+ * @param adcopt The ADCOPT bit of the LTC configuration
+ * @param test_mode The self test mode option
+ * @return uint16_t The expected self test value
+ */
+uint16_t ltc6811_diag_self_test_value(
+    Ltc6811Md mode,
+    uint8_t adcopt,
+    Ltc6811St test_mode
+);
+
+#endif  // LTC6811_DIAG_H
@@ -0,0 +1,197 @@
+/**
+ * @file ltc6811-shadow.h
+ * @brief Shadowed configuration, PWM and S control writes with dirty tracking
+ *
+ * @details The values that should be written to the LTC6811 are kept in the shadows
+ * of the 'devices' array of the chain, the set functions modify the shadows and mark
+ * the register groups that changed as dirty; only the dirty groups are written
+ * and the configuration is read back and verified periodically
+ *
+ * @attention In a daisy-chain every write command sends the data of all the devices,
+ * so a group is written if at least one device of the chain has changed
+ *
+ * @date 18 Oct 2026
+ * @author Antonio Gelain [antonio.gelain2@gmail.com]
+ */
+
+#ifndef LTC6811_SHADOW_H
+#define LTC6811_SHADOW_H
+
+#include "ltc6811.h"
+
+/** @brief Register groups handled by the shadows */
+typedef enum {
+    LTC6811_SHADOW_CFG = 0, // Configuration register group (WRCFG)
+    LTC6811_SHADOW_PWM,     // PWM register group (WRPWM)
+    LTC6811_SHADOW_SCTRL,   // S control register group (WRSCTRL)
+    LTC6811_SHADOW_GROUP_COUNT
+} Ltc6811ShadowGroup;
+
+// Bitmask with all the register groups set
+#define LTC6811_SHADOW_ALL_GROUPS ((1U << LTC6811_SHADOW_GROUP_COUNT) - 1U)
+
+/**
+ * @brief Shadow handler structure
+ *
+ * @param chain The LTC6811 chain handler
+ * @param verify_period The time between two configuration verifications (0 to disable)
+ * @param last_verify The time of the last configuration verification
+ * @param verify_pending True if the data of a configuration read is expected
+ * @param writes The number of write commands encoded
+ * @param skipped The number of times nothing had to be written
+ * @param verify_errors The number of devices whose configuration did not match the shadow
+ */
+typedef struct {
+    Ltc6811Chain * chain;
+    uint32_t verify_period;
+    uint32_t last_verify;
+    bool verify_pending;
+    uint32_t writes;
+    uint32_t skipped;
+    uint32_t verify_errors;
+} Ltc6811Shadow;
+
+
+/**
+ * @brief Initialize the shadow handler
+ *
+ * @details All the register groups are marked as dirty so that the first
+ * call to 'ltc6811_shadow_encode' writes the whole shadow
+ *
+ * @attention The chain has to be initialized with 'ltc6811_chain_init_devices'
+ *
+ * @param shadow The shadow handler structure
+ * @param chain The LTC6811 chain handler
+ * @param verify_period The time between two configuration verifications (0 to disable)
+ * @param now The current time
+ */
+void ltc6811_shadow_init(
+    Ltc6811Shadow * shadow,
+    Ltc6811Chain * chain,
+    uint32_t verify_period,
+    uint32_t now
+);
+
+/**
+ * @brief Mark some register groups of all the devices as dirty
+ *
+ * @details Useful when the LTC6811 has lost its registers content (e.g. after
+ * the watchdog timeout or a power cycle)
+ *
+ * @param shadow The shadow handler structure
+ * @param groups Bitmask of the register groups (see Ltc6811ShadowGroup)
+ */
+void ltc6811_shadow_invalidate(Ltc6811Shadow * shadow, uint8_t groups);
+
+/**
+ * @brief Check if a register group has to be written
+ *
+ * @param shadow The shadow handler structure
+ * @param group The register group
+ * @return bool True if at least one device has changed, false otherwise
+ */
+bool ltc6811_shadow_is_dirty(Ltc6811Shadow * shadow, Ltc6811ShadowGroup group);
+
+/**
+ * @brief Update the configuration shadow of a device
+ *
+ * @details The read only DTEN bit is ignored
+ *
+ * @param shadow The shadow handler structure
+ * @param device The index of the device in the chain
+ * @param config The new configuration
+ * @return bool True if the configuration has changed, false otherwise
+ */
+bool ltc6811_shadow_set_config(
+    Ltc6811Shadow * shadow,
+    size_t device,
+    Ltc6811Cfgr * config
+);
+
+/**
+ * @brief Update the discharge cells bits of the configuration shadow of a device
+ *
+ * @param shadow The shadow handler structure
+ * @param device The index of the device in the chain
+ * @param dcc The discharge cells bits (cell 1 starts from the least significant bit)
+ * @return bool True if the configuration has changed, false otherwise
+ */
+bool ltc6811_shadow_set_dcc(
+    Ltc6811Shadow * shadow,
+    size_t device,
+    uint16_t dcc
+);
+
+/**
+ * @brief Update the PWM shadow of a device
+ *
+ * @attention The 'pwm' array size has to be equal to LTC6811_PWM_COUNT
+ *
+ * @param shadow The shadow handler structure
+ * @param device The index of the device in the chain
+ * @param pwm The PWM duty cycles (only the lower 4 bits are used)
+ * @return bool True if the PWM shadow has changed, false otherwise
+ */
+bool ltc6811_shadow_set_pwm(
+    Ltc6811Shadow * shadow,
+    size_t device,
+    uint8_t * pwm
+);
+
+/**
+ * @brief Update the S control shadow of a device
+ *
+ * @attention The 'sctrl' array size has to be equal to LTC6811_SCTL_COUNT
+ *
+ * @param shadow The shadow handler structure
+ * @param device The index of the device in the chain
+ * @param sctrl The S pins control values (only the lower 4 bits are used)
+ * @return bool True if the S control shadow has changed, false otherwise
+ */
+bool ltc6811_shadow_set_sctrl(
+    Ltc6811Shadow * shadow,
+    size_t device,
+    uint8_t * sctrl
+);
+
+/**
+ * @brief Encode the next transaction needed to synchronize the LTC6811 with the shadows
+ *
+ * @details The dirty register groups are written one per call, when nothing has
+ * to be written and the verification period has elapsed a read configuration
+ * command is encoded and 'read_size' bytes have to be received and given to
+ * the 'ltc6811_shadow_decode' function
+ *
+ * @attention The 'out' array should be large enough to contain all the encoded bytes
+ * Use the LTC6811_WRITE_BUFFER_SIZE macro to get the right size for the buffer
+ *
+ * @param shadow The shadow handler structure
+ * @param now The current time
+ * @param out The array where the encoded bytes are written
+ * @param read_size The number of bytes to read after the command is sent
+ * @return size_t The number of encoded bytes, 0 if nothing has to be sent
+ */
+size_t ltc6811_shadow_encode(
+    Ltc6811Shadow * shadow,
+    uint32_t now,
+    uint8_t * out,
+    size_t * read_size
+);
+
+/**
+ * @brief Verify the configuration read from the chain against the shadows
+ *
+ * @details The GPIO and DCTO bits are not compared because their read value is
+ * the status of the pins and of the discharge timer, the configuration of
+ * the devices that do not match is marked as dirty
+ *
+ * @param shadow The shadow handler structure
+ * @param data The array of bytes to decode
+ * @return size_t The number of decoded bytes (PEC included)
+ */
+size_t ltc6811_shadow_decode(
+    Ltc6811Shadow * shadow,
+    uint8_t * data
+);
+
+#endif  // LTC6811_SHADOW_H
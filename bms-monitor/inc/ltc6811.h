@@ -373,9 +373,49 @@ typedef struct __attribute__((__packed__)) {
     uint8_t fcom2 : 4; // Final communication control bits of the third data byte
     uint8_t data[LTC6811_COMM_DATA_COUNT];   // Data transmited (received) to (from) I2C/SPI slave device
 } Ltc6811Comm;
-/** @brief LTC6811 handler structure */
+/**
+ * @brief State of a single LTC6811 of a chain
+ *
+ * @details The timestamps are in the same unit of the time given to the
+ * functions that update them (e.g. milliseconds or microseconds)
+ *
+ * @param config The configuration shadow, the data that should be written to the LTC
+ * @param pwm The PWM duty cycles shadow
+ * @param sctrl The S pins control shadow
+ * @param dirty Bitmask of the shadows modified since their last write (see ltc6811-shadow.h)
+ * @param cells The last cell voltages read
+ * @param aux The last auxiliary voltages read
+ * @param status The last status read
+ * @param pec_errors The number of register groups discarded because of a PEC error
+ * @param cells_timestamp The time of the last read of each cell voltage register group
+ * @param aux_timestamp The time of the last read of each auxiliary register group
+ * @param status_timestamp The time of the last read of each status register group
+ */
+typedef struct {
+    Ltc6811Cfgr config;
+    uint8_t pwm[LTC6811_PWM_COUNT];
+    uint8_t sctrl[LTC6811_SCTL_COUNT];
+    uint8_t dirty;
+    uint16_t cells[LTC6811_CELL_COUNT];
+    uint16_t aux[LTC6811_AUX_COUNT];
+    Ltc6811Str status;
+    uint32_t pec_errors;
+    uint32_t cells_timestamp[LTC6811_CVXR_COUNT];
+    uint32_t aux_timestamp[LTC6811_AVXR_COUNT];
+    uint32_t status_timestamp[LTC6811_STXR_COUNT];
+} Ltc6811Device;
+
+/**
+ * @brief LTC6811 handler structure
+ *
+ * @param count The number of LTC6811 in the chain
+ * @param devices The state of each LTC6811 of the chain (can be NULL if not used)
+ * @param pec_errors The total number of PEC errors of the chain
+ */
 typedef struct {
     size_t count;
+    Ltc6811Device * devices;
+    uint32_t pec_errors;
 } Ltc6811Chain;
 typedef struct {
     size_t count;
@@ -390,6 +430,21 @@ typedef struct {
  */
 void ltc6811_chain_init(Ltc6811Chain * chain, size_t ltc_count);
 
+/**
+ * @brief Initialize the LTC6811 chain structure with the state of each device
+ *
+ * @attention The 'devices' array size has to be equal to 'ltc_count'
+ *
+ * @param chain The chain structure
+ * @param ltc_count The total number of LTC6811 in the chain
+ * @param devices The array where the state of each LTC6811 is stored
+ */
+void ltc6811_chain_init_devices(
+    Ltc6811Chain * chain,
+    size_t ltc_count,
+    Ltc6811Device * devices
+);
+
 /**
  * @brief Check if the ADC conversion has ended or not
  *
@@ -0,0 +1,104 @@
+/**
+ * @file ntc.h
+ * @brief Fixed-point conversion of the LTC6811 auxiliary voltages to NTC temperatures
+ *
+ * @details The conversion uses a lookup table of the expected ADC codes, evenly spaced
+ * in temperature, which is generated at compile time from the Beta model of the NTC
+ * and is linearly interpolated, no floating point operation is done at runtime
+ *
+ * The NTC is expected to be connected between the GPIO and ground with a
+ * pull-up resistor connected to the reference voltage (VREF2)
+ *
+ * The model parameters can be changed by defining the macros below before
+ * compiling the library (e.g. with the -D compiler option)
+ *
+ * @date 18 Oct 2026
+ * @author Antonio Gelain [antonio.gelain2@gmail.com]
+ */
+
+#ifndef NTC_H
+#define NTC_H
+
+#include <inttypes.h>
+#include <stddef.h>
+
+// Beta value of the NTC in K
+#ifndef NTC_BETA
+#define NTC_BETA 3435.0
+#endif  // NTC_BETA
+
+// Resistance of the NTC at the nominal temperature in Ohm
+#ifndef NTC_R0
+#define NTC_R0 10000.0
+#endif  // NTC_R0
+
+// Nominal temperature of the NTC in °C
+#ifndef NTC_T0
+#define NTC_T0 25.0
+#endif  // NTC_T0
+
+// Resistance of the pull-up resistor in Ohm
+#ifndef NTC_R_PULLUP
+#define NTC_R_PULLUP 10000.0
+#endif  // NTC_R_PULLUP
+
+// ADC code of the pull-up reference voltage (VREF2 is 3V with a resolution of 100uV)
+#ifndef NTC_VREF_CODE
+#define NTC_VREF_CODE 30000.0
+#endif  // NTC_VREF_CODE
+
+// Temperature of the first element of the lookup table in hundredths of °C
+#ifndef NTC_LUT_TEMP_MIN
+#define NTC_LUT_TEMP_MIN (-4000)
+#endif  // NTC_LUT_TEMP_MIN
+
+// Temperature difference between two consecutive elements of the lookup table in hundredths of °C
+#ifndef NTC_LUT_TEMP_STEP
+#define NTC_LUT_TEMP_STEP 300
+#endif  // NTC_LUT_TEMP_STEP
+
+// Number of elements of the lookup table
+#define NTC_LUT_SIZE 64U
+// Temperature of the last element of the lookup table in hundredths of °C
+#define NTC_LUT_TEMP_MAX (NTC_LUT_TEMP_MIN + NTC_LUT_TEMP_STEP * ((int32_t)NTC_LUT_SIZE - 1))
+
+/**
+ * @brief Convert a single auxiliary voltage to temperature
+ *
+ * @details Codes outside the range of the lookup table are saturated to
+ * NTC_LUT_TEMP_MIN or NTC_LUT_TEMP_MAX, which also happens when the NTC is
+ * disconnected or shorted
+ *
+ * @param code The raw ADC code as returned by 'ltc6811_rdaux_decode_broadcast'
+ * @return int16_t The temperature in hundredths of °C
+ */
+int16_t ntc_code_to_temp(uint16_t code);
+
+/**
+ * @brief Convert multiple auxiliary voltages to temperatures
+ *
+ * @attention The 'out' array should be large enough to store 'count' temperatures
+ *
+ * @param codes The array of raw ADC codes
+ * @param count The number of codes to convert
+ * @param out The array where the temperatures in hundredths of °C are stored
+ * @return size_t The number of converted codes
+ */
+size_t ntc_code_to_temp_bulk(
+    uint16_t * codes,
+    size_t count,
+    int16_t * out
+);
+
+/**
+ * @brief Get the expected ADC code at a given temperature
+ *
+ * @details The value is read from the lookup table so the temperature
+ * is rounded down to the nearest table element
+ *
+ * @param temp The temperature in hundredths of °C
+ * @return uint16_t The ADC code
+ */
+uint16_t ntc_temp_to_code(int16_t temp);
+
+#endif  // NTC_H
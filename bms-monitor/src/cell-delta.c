@@ -0,0 +1,307 @@
+/**
+ * @file cell-delta.c
+ * @brief Delta compression of the cell voltages for the CAN telemetry
+ *
+ * @date 18 Oct 2026
+ * @author Antonio Gelain [antonio.gelain2@gmail.com]
+ */
+
+#include "cell-delta.h"
+
+#include <stdint.h>
+
+#define CELL_DELTA_SEQ_MASK (CELL_DELTA_SEQ_COUNT - 1U)
+#define CELL_DELTA_KEY_INVALID SIZE_MAX
+
+/**
+ * @brief Get the header byte of a frame
+ *
+ * @param type The frame type
+ * @param seq The sequence number
+ * @return uint8_t The header byte
+ */
+static inline uint8_t _cell_delta_header(CellDeltaFrameType type, uint8_t seq) {
+    return ((uint8_t)type << 6U) | (seq & CELL_DELTA_SEQ_MASK);
+}
+
+/**
+ * @brief Check if a difference is not considered a change
+ *
+ * @param diff The difference between the actual and the transmitted voltage
+ * @param deadband The maximum difference which is not considered a change
+ * @return bool True if the cell has not changed, false otherwise
+ */
+static inline bool _cell_delta_unchanged(int32_t diff, uint16_t deadband) {
+    return diff >= -(int32_t)deadband && diff <= (int32_t)deadband;
+}
+
+/**
+ * @brief Encode a frame with raw voltages
+ *
+ * @param type The frame type (absolute or keyframe)
+ * @param seq The sequence number
+ * @param index The index of the first cell
+ * @param voltages The voltages to encode
+ * @param cell_count The number of cells
+ * @param out The frame where the bytes are written
+ */
+static void _cell_delta_encode_absolute(
+    CellDeltaFrameType type,
+    uint8_t seq,
+    size_t index,
+    uint16_t * voltages,
+    size_t cell_count,
+    uint8_t * out)
+{
+    out[0] = _cell_delta_header(type, seq);
+    out[1] = (uint8_t)index;
+    for (size_t i = 0; i < CELL_DELTA_ABSOLUTE_COUNT; ++i) {
+        uint16_t volt = (index + i < cell_count) ? voltages[index + i] : 0U;
+        out[2 + i * 2] = volt & 0xFF;
+        out[3 + i * 2] = volt >> 8;
+    }
+}
+
+/**
+ * @brief Update the voltages with the content of a single frame
+ *
+ * @details The frame is validated before any voltage is modified
+ *
+ * @param voltages The voltages to update
+ * @param cell_count The number of cells
+ * @param frame The frame to apply
+ * @return bool True if the frame is valid, false otherwise
+ */
+static bool _cell_delta_apply(uint16_t * voltages, size_t cell_count, uint8_t * frame) {
+    CellDeltaFrameType type = frame[0] >> 6U;
+    size_t index = frame[1];
+    if (index >= cell_count)
+        return false;
+
+    switch (type) {
+        case CELL_DELTA_FRAME_ABSOLUTE:
+        case CELL_DELTA_FRAME_KEYFRAME:
+            for (size_t i = 0; i < CELL_DELTA_ABSOLUTE_COUNT && index + i < cell_count; ++i)
+                voltages[index + i] = frame[2 + i * 2] | ((uint16_t)frame[3 + i * 2] << 8);
+            return true;
+        case CELL_DELTA_FRAME_DELTA:
+        {
+            uint8_t mask = frame[2];
+            size_t n = 0;
+            for (size_t i = 0; i < CELL_DELTA_WINDOW_SIZE; ++i) {
+                if ((mask >> i) & 1U) {
+                    if (index + i >= cell_count || n >= CELL_DELTA_DELTA_COUNT)
+                        return false;
+                    ++n;
+                }
+            }
+            n = 0;
+            for (size_t i = 0; i < CELL_DELTA_WINDOW_SIZE; ++i) {
+                if ((mask >> i) & 1U)
+                    voltages[index + i] += (int8_t)frame[3 + n++];
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Encode all the voltages as a keyframe
+ *
+ * @param enc The encoder handler structure
+ * @param voltages The voltages to encode
+ * @param out The array where the encoded frames are written
+ * @return size_t The number of encoded bytes
+ */
+static size_t _cell_delta_encode_keyframe(CellDeltaEncoder * enc, uint16_t * voltages, uint8_t * out) {
+    size_t byte_count = 0U;
+    for (size_t i = 0; i < enc->cell_count; i += CELL_DELTA_ABSOLUTE_COUNT) {
+        _cell_delta_encode_absolute(
+            CELL_DELTA_FRAME_KEYFRAME,
+            enc->seq++,
+            i,
+            voltages,
+            enc->cell_count,
+            out + byte_count
+        );
+        byte_count += CELL_DELTA_FRAME_SIZE;
+    }
+    for (size_t i = 0; i < enc->cell_count; ++i)
+        enc->reference[i] = voltages[i];
+    enc->seq &= CELL_DELTA_SEQ_MASK;
+    enc->cycles = 0U;
+    enc->keyframe_requested = false;
+    return byte_count;
+}
+
+/**
+ * @brief Encode only the changed voltages
+ *
+ * @param enc The encoder handler structure
+ * @param voltages The voltages to encode
+ * @param out The array where the encoded frames are written
+ * @return size_t The number of encoded bytes or SIZE_MAX if a keyframe is smaller
+ */
+static size_t _cell_delta_encode_delta(CellDeltaEncoder * enc, uint16_t * voltages, uint8_t * out) {
+    const size_t max_size = CELL_DELTA_BUFFER_SIZE(enc->cell_count);
+    size_t byte_count = 0U;
+    uint8_t seq = enc->seq;
+
+    size_t i = 0;
+    while (i < enc->cell_count) {
+        int32_t diff = (int32_t)voltages[i] - enc->reference[i];
+        if (_cell_delta_unchanged(diff, enc->deadband)) {
+            ++i;
+            continue;
+        }
+        if (byte_count + CELL_DELTA_FRAME_SIZE > max_size)
+            return SIZE_MAX;
+
+        uint8_t * frame = out + byte_count;
+        byte_count += CELL_DELTA_FRAME_SIZE;
+
+        // The difference does not fit in a delta frame
+        if (diff < INT8_MIN || diff > INT8_MAX) {
+            _cell_delta_encode_absolute(CELL_DELTA_FRAME_ABSOLUTE, seq++, i, voltages, enc->cell_count, frame);
+            i += CELL_DELTA_ABSOLUTE_COUNT;
+            continue;
+        }
+
+        frame[0] = _cell_delta_header(CELL_DELTA_FRAME_DELTA, seq++);
+        frame[1] = (uint8_t)i;
+        frame[2] = 0U;
+        for (size_t j = 3; j < CELL_DELTA_FRAME_SIZE; ++j)
+            frame[j] = 0U;
+
+        size_t n = 0, off = 0;
+        for (; off < CELL_DELTA_WINDOW_SIZE && i + off < enc->cell_count && n < CELL_DELTA_DELTA_COUNT; ++off) {
+            diff = (int32_t)voltages[i + off] - enc->reference[i + off];
+            if (_cell_delta_unchanged(diff, enc->deadband))
+                continue;
+            if (diff < INT8_MIN || diff > INT8_MAX)
+                break;
+            frame[2] |= 1U << off;
+            frame[3 + n++] = (uint8_t)(int8_t)diff;
+        }
+        i += off;
+    }
+
+    // Update the reference with the values seen by the decoder
+    for (size_t k = 0; k < byte_count; k += CELL_DELTA_FRAME_SIZE)
+        _cell_delta_apply(enc->reference, enc->cell_count, out + k);
+    enc->seq = seq & CELL_DELTA_SEQ_MASK;
+    return byte_count;
+}
+
+void cell_delta_encoder_init(
+    CellDeltaEncoder * enc,
+    uint16_t * reference,
+    size_t cell_count,
+    uint16_t deadband,
+    size_t keyframe_period)
+{
+    if (enc == NULL || reference == NULL)
+        return;
+    enc->reference = reference;
+    enc->cell_count = cell_count > CELL_DELTA_MAX_CELLS ? CELL_DELTA_MAX_CELLS : cell_count;
+    enc->deadband = deadband;
+    enc->keyframe_period = keyframe_period;
+    enc->cycles = 0U;
+    enc->seq = 0U;
+    enc->keyframe_requested = true;
+    for (size_t i = 0; i < enc->cell_count; ++i)
+        enc->reference[i] = 0U;
+}
+
+void cell_delta_encoder_request_keyframe(CellDeltaEncoder * enc) {
+    if (enc == NULL)
+        return;
+    enc->keyframe_requested = true;
+}
+
+size_t cell_delta_encode(
+    CellDeltaEncoder * enc,
+    uint16_t * voltages,
+    uint8_t * out)
+{
+    if (enc == NULL || voltages == NULL || out == NULL)
+        return 0U;
+
+    ++enc->cycles;
+    if (enc->keyframe_period > 0U && enc->cycles >= enc->keyframe_period)
+        enc->keyframe_requested = true;
+    if (enc->keyframe_requested)
+        return _cell_delta_encode_keyframe(enc, voltages, out);
+
+    size_t byte_count = _cell_delta_encode_delta(enc, voltages, out);
+    if (byte_count == SIZE_MAX)
+        return _cell_delta_encode_keyframe(enc, voltages, out);
+    return byte_count;
+}
+
+void cell_delta_decoder_init(
+    CellDeltaDecoder * dec,
+    uint16_t * voltages,
+    size_t cell_count)
+{
+    if (dec == NULL || voltages == NULL)
+        return;
+    dec->voltages = voltages;
+    dec->cell_count = cell_count > CELL_DELTA_MAX_CELLS ? CELL_DELTA_MAX_CELLS : cell_count;
+    dec->seq = 0U;
+    dec->key_next = CELL_DELTA_KEY_INVALID;
+    dec->synced = false;
+    for (size_t i = 0; i < dec->cell_count; ++i)
+        dec->voltages[i] = 0U;
+}
+
+size_t cell_delta_decode(
+    CellDeltaDecoder * dec,
+    uint8_t * data,
+    size_t size)
+{
+    if (dec == NULL || data == NULL)
+        return 0U;
+
+    size_t byte_count = 0U;
+    for (; byte_count + CELL_DELTA_FRAME_SIZE <= size; byte_count += CELL_DELTA_FRAME_SIZE) {
+        uint8_t * frame = data + byte_count;
+        CellDeltaFrameType type = frame[0] >> 6U;
+        uint8_t seq = frame[0] & CELL_DELTA_SEQ_MASK;
+        size_t index = frame[1];
+
+        // A frame was lost
+        bool in_order = (seq == dec->seq);
+        if (!in_order) {
+            dec->synced = false;
+            dec->key_next = CELL_DELTA_KEY_INVALID;
+        }
+        dec->seq = (seq + 1U) & CELL_DELTA_SEQ_MASK;
+
+        if (!_cell_delta_apply(dec->voltages, dec->cell_count, frame))
+            break;
+
+        if (type == CELL_DELTA_FRAME_KEYFRAME) {
+            if (index == 0U)
+                dec->key_next = 0U;
+            if (index == dec->key_next) {
+                dec->key_next += CELL_DELTA_ABSOLUTE_COUNT;
+                if (dec->key_next >= dec->cell_count) {
+                    dec->synced = true;
+                    dec->key_next = CELL_DELTA_KEY_INVALID;
+                }
+            }
+            else
+                dec->key_next = CELL_DELTA_KEY_INVALID;
+        }
+    }
+    return byte_count;
+}
+
+bool cell_delta_decoder_is_synced(CellDeltaDecoder * dec) {
+    if (dec == NULL)
+        return false;
+    return dec->synced;
+}
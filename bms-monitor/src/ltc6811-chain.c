@@ -0,0 +1,411 @@
+/**
+ * @file ltc6811-chain.c
+ * @brief Per-device state of the LTC6811 chains and scheduler for multiple chains
+ *
+ * @date 18 Oct 2026
+ * @author Antonio Gelain [antonio.gelain2@gmail.com]
+ */
+
+#include "ltc6811-chain.h"
+
+#include <string.h>
+
+// Size in bytes of the data of a single LTC6811 (PEC included)
+#define LTC6811_CHAIN_DEVICE_BYTE_COUNT (LTC6811_REG_BYTE_COUNT + LTC6811_PEC_BYTE_COUNT)
+
+/**
+ * @brief Conversion time of all the cells in microseconds
+ * @details The first index is the ADCOPT bit, the second is the conversion mode
+ */
+static const uint32_t adcv_conversion_time[2U][4U] = {
+    [0U] = {
+        [LTC6811_MD_422HZ_1KHZ] = 12807U,
+        [LTC6811_MD_27KHZ_14KHZ] = 1113U,
+        [LTC6811_MD_7KHZ_3KHZ] = 2335U,
+        [LTC6811_MD_26HZ_2KHZ] = 201317U
+    },
+    [1U] = {
+        [LTC6811_MD_422HZ_1KHZ] = 7212U,
+        [LTC6811_MD_27KHZ_14KHZ] = 1288U,
+        [LTC6811_MD_7KHZ_3KHZ] = 3033U,
+        [LTC6811_MD_26HZ_2KHZ] = 4430U
+    }
+};
+
+/**
+ * @brief Update the PEC error counters of a device
+ *
+ * @param chain The LTC6811 chain handler
+ * @param device The device state
+ * @param decoded The number of decoded bytes of the device
+ * @return bool True if the data was valid, false otherwise
+ */
+static inline bool _ltc6811_chain_check(Ltc6811Chain * chain, Ltc6811Device * device, size_t decoded) {
+    if (decoded > 0U)
+        return true;
+    ++device->pec_errors;
+    ++chain->pec_errors;
+    return false;
+}
+
+size_t ltc6811_chain_store_cv(
+    Ltc6811Chain * chain,
+    Ltc6811Cvxr reg,
+    uint8_t * data,
+    uint32_t timestamp)
+{
+    if (chain == NULL || chain->devices == NULL || data == NULL || reg >= LTC6811_CVXR_COUNT)
+        return 0U;
+
+    // Every device is decoded on its own to know which one has a PEC error
+    Ltc6811Chain single = { .count = 1U };
+    size_t decoded = 0U;
+    for (size_t i = 0; i < chain->count; ++i) {
+        Ltc6811Device * device = &chain->devices[i];
+        size_t byte_count = ltc6811_rdcv_decode_broadcast(
+            &single,
+            data + i * LTC6811_CHAIN_DEVICE_BYTE_COUNT,
+            device->cells + reg * LTC6811_REG_CELL_COUNT
+        );
+        if (_ltc6811_chain_check(chain, device, byte_count))
+            device->cells_timestamp[reg] = timestamp;
+        decoded += byte_count;
+    }
+    return decoded;
+}
+
+size_t ltc6811_chain_store_aux(
+    Ltc6811Chain * chain,
+    Ltc6811Avxr reg,
+    uint8_t * data,
+    uint32_t timestamp)
+{
+    if (chain == NULL || chain->devices == NULL || data == NULL || reg >= LTC6811_AVXR_COUNT)
+        return 0U;
+
+    Ltc6811Chain single = { .count = 1U };
+    size_t decoded = 0U;
+    for (size_t i = 0; i < chain->count; ++i) {
+        Ltc6811Device * device = &chain->devices[i];
+        size_t byte_count = ltc6811_rdaux_decode_broadcast(
+            &single,
+            data + i * LTC6811_CHAIN_DEVICE_BYTE_COUNT,
+            device->aux + reg * LTC6811_REG_AUX_COUNT
+        );
+        if (_ltc6811_chain_check(chain, device, byte_count))
+            device->aux_timestamp[reg] = timestamp;
+        decoded += byte_count;
+    }
+    return decoded;
+}
+
+size_t ltc6811_chain_store_stat(
+    Ltc6811Chain * chain,
+    Ltc6811Stxr reg,
+    uint8_t * data,
+    uint32_t timestamp)
+{
+    if (chain == NULL || chain->devices == NULL || data == NULL || reg >= LTC6811_STXR_COUNT)
+        return 0U;
+
+    Ltc6811Chain single = { .count = 1U };
+    size_t decoded = 0U;
+    for (size_t i = 0; i < chain->count; ++i) {
+        Ltc6811Device * device = &chain->devices[i];
+
+        // The under and over voltage flags are accumulated by the decode function
+        Ltc6811Str status = device->status;
+        if (reg == LTC6811_STBR) {
+            status.CUV = 0U;
+            status.COV = 0U;
+        }
+        size_t byte_count = ltc6811_rdstat_decode_broadcast(
+            &single,
+            reg,
+            data + i * LTC6811_CHAIN_DEVICE_BYTE_COUNT,
+            &status
+        );
+        if (_ltc6811_chain_check(chain, device, byte_count)) {
+            device->status = status;
+            device->status_timestamp[reg] = timestamp;
+        }
+        decoded += byte_count;
+    }
+    return decoded;
+}
+
+/**
+ * @brief Encode a write command using the shadow of each device
+ *
+ * @details Each device is encoded on its own as a single element chain
+ * and its data is then copied in place
+ *
+ * @param chain The LTC6811 chain handler
+ * @param encode The function used to encode the data of a single device
+ * @param reversed True if the data of the last device of the chain is sent first
+ * @param out The array where the encoded bytes are written
+ * @return size_t The number of encoded bytes
+ */
+static size_t _ltc6811_chain_write_encode(
+    Ltc6811Chain * chain,
+    size_t (* encode)(Ltc6811Chain *, Ltc6811Device *, uint8_t *),
+    bool reversed,
+    uint8_t * out)
+{
+    Ltc6811Chain single = { .count = 1U };
+    uint8_t buf[LTC6811_WRITE_BUFFER_SIZE(1U)];
+    const size_t cmd_size = LTC6811_CMD_BYTE_COUNT + LTC6811_PEC_BYTE_COUNT;
+    size_t encoded = cmd_size;
+    for (size_t i = 0; i < chain->count; ++i) {
+        size_t index = reversed ? chain->count - i - 1U : i;
+        encode(&single, &chain->devices[index], buf);
+        memcpy(out + encoded, buf + cmd_size, LTC6811_CHAIN_DEVICE_BYTE_COUNT);
+        encoded += LTC6811_CHAIN_DEVICE_BYTE_COUNT;
+    }
+
+    // Encode only the command
+    Ltc6811Chain empty = { .count = 0U };
+    encode(&empty, chain->devices, out);
+    return encoded;
+}
+
+static size_t _ltc6811_chain_wrcfg_device(Ltc6811Chain * single, Ltc6811Device * device, uint8_t * out) {
+    return ltc6811_wrcfg_encode_broadcast(single, &device->config, out);
+}
+
+static size_t _ltc6811_chain_wrpwm_device(Ltc6811Chain * single, Ltc6811Device * device, uint8_t * out) {
+    return ltc6811_wrpwm_encode_broadcast(single, device->pwm, out);
+}
+
+static size_t _ltc6811_chain_wrsctrl_device(Ltc6811Chain * single, Ltc6811Device * device, uint8_t * out) {
+    return ltc6811_wrsctrl_encode_broadcast(single, device->sctrl, out);
+}
+
+size_t ltc6811_chain_wrcfg_encode(
+    Ltc6811Chain * chain,
+    uint8_t * out)
+{
+    if (chain == NULL || chain->devices == NULL || out == NULL)
+        return 0U;
+    // Same order of 'ltc6811_wrcfg_encode_broadcast'
+    return _ltc6811_chain_write_encode(chain, _ltc6811_chain_wrcfg_device, true, out);
+}
+
+size_t ltc6811_chain_wrpwm_encode(
+    Ltc6811Chain * chain,
+    uint8_t * out)
+{
+    if (chain == NULL || chain->devices == NULL || out == NULL)
+        return 0U;
+    // Same order of 'ltc6811_wrpwm_encode_broadcast'
+    return _ltc6811_chain_write_encode(chain, _ltc6811_chain_wrpwm_device, false, out);
+}
+
+size_t ltc6811_chain_wrsctrl_encode(
+    Ltc6811Chain * chain,
+    uint8_t * out)
+{
+    if (chain == NULL || chain->devices == NULL || out == NULL)
+        return 0U;
+    // Same order of 'ltc6811_wrsctrl_encode_broadcast'
+    return _ltc6811_chain_write_encode(chain, _ltc6811_chain_wrsctrl_device, false, out);
+}
+
+uint32_t ltc6811_adcv_conversion_time_us(Ltc6811Md mode, uint8_t adcopt) {
+    return adcv_conversion_time[adcopt ? 1U : 0U][mode & 0x03];
+}
+
+void ltc6811_scheduler_init(
+    Ltc6811Scheduler * sched,
+    Ltc6811Chain * chains,
+    size_t chain_count,
+    Ltc6811SchedulerMode policy,
+    Ltc6811Md mode,
+    Ltc6811Dcp dcp,
+    uint32_t conversion_time)
+{
+    if (sched == NULL || chains == NULL)
+        return;
+    sched->chains = chains;
+    sched->chain_count = chain_count > LTC6811_SCHEDULER_MAX_CHAINS ? LTC6811_SCHEDULER_MAX_CHAINS : chain_count;
+    sched->policy = policy;
+    sched->mode = mode;
+    sched->dcp = dcp;
+    sched->conversion_time = conversion_time;
+    sched->current = 0U;
+    sched->cycles = 0U;
+    for (size_t i = 0; i < LTC6811_SCHEDULER_MAX_CHAINS; ++i) {
+        sched->state[i] = LTC6811_CHAIN_IDLE;
+        sched->start[i] = 0U;
+        sched->reg[i] = LTC6811_CVAR;
+    }
+}
+
+/**
+ * @brief Get the remaining conversion time of a chain
+ *
+ * @param sched The scheduler handler structure
+ * @param chain The index of the chain
+ * @param now The current time
+ * @return uint32_t The remaining time, 0 if the conversion has ended
+ */
+static inline uint32_t _ltc6811_scheduler_remaining(Ltc6811Scheduler * sched, size_t chain, uint32_t now) {
+    uint32_t elapsed = now - sched->start[chain];
+    return elapsed >= sched->conversion_time ? 0U : sched->conversion_time - elapsed;
+}
+
+/**
+ * @brief Start the conversion of the cell voltages of a chain
+ *
+ * @param sched The scheduler handler structure
+ * @param chain The index of the chain
+ * @param now The current time
+ * @param op The operation to execute
+ * @return Ltc6811OpType The type of the operation
+ */
+static Ltc6811OpType _ltc6811_scheduler_convert(Ltc6811Scheduler * sched, size_t chain, uint32_t now, Ltc6811Op * op) {
+    op->type = LTC6811_OP_CONVERSION;
+    op->chain = chain;
+    op->read_size = 0U;
+    op->size = ltc6811_adcv_encode_broadcast(
+        &sched->chains[chain],
+        sched->mode,
+        sched->dcp,
+        LTC6811_CH_ALL,
+        op->out
+    );
+    sched->state[chain] = LTC6811_CHAIN_CONVERTING;
+    sched->start[chain] = now;
+    sched->reg[chain] = LTC6811_CVAR;
+    return op->type;
+}
+
+/**
+ * @brief Read the next cell voltage register group of a chain
+ *
+ * @param sched The scheduler handler structure
+ * @param chain The index of the chain
+ * @param op The operation to execute
+ * @return Ltc6811OpType The type of the operation
+ */
+static Ltc6811OpType _ltc6811_scheduler_read(Ltc6811Scheduler * sched, size_t chain, Ltc6811Op * op) {
+    Ltc6811Chain * ltc = &sched->chains[chain];
+    op->type = LTC6811_OP_READ;
+    op->chain = chain;
+    op->reg = sched->reg[chain];
+    op->size = ltc6811_rdcv_encode_broadcast(ltc, op->reg, op->out);
+    op->read_size = LTC6811_DATA_BUFFER_SIZE(ltc->count);
+
+    if (++sched->reg[chain] >= LTC6811_CVXR_COUNT)
+        sched->state[chain] = LTC6811_CHAIN_DONE;
+    else
+        sched->state[chain] = LTC6811_CHAIN_READING;
+    return op->type;
+}
+
+/**
+ * @brief Wait for some time before the next operation
+ *
+ * @param op The operation to execute
+ * @param wait The time to wait
+ * @return Ltc6811OpType The type of the operation
+ */
+static inline Ltc6811OpType _ltc6811_scheduler_wait(Ltc6811Op * op, uint32_t wait) {
+    op->type = LTC6811_OP_NONE;
+    op->size = 0U;
+    op->read_size = 0U;
+    op->wait = wait;
+    return op->type;
+}
+
+/**
+ * @brief Start a new measurement cycle if all the chains are done
+ *
+ * @param sched The scheduler handler structure
+ */
+static void _ltc6811_scheduler_check_cycle(Ltc6811Scheduler * sched) {
+    for (size_t i = 0; i < sched->chain_count; ++i)
+        if (sched->state[i] != LTC6811_CHAIN_DONE)
+            return;
+    for (size_t i = 0; i < sched->chain_count; ++i)
+        sched->state[i] = LTC6811_CHAIN_IDLE;
+    sched->current = 0U;
+    ++sched->cycles;
+}
+
+static Ltc6811OpType _ltc6811_scheduler_next_round_robin(Ltc6811Scheduler * sched, uint32_t now, Ltc6811Op * op) {
+    size_t chain = sched->current;
+    switch (sched->state[chain]) {
+        case LTC6811_CHAIN_IDLE:
+            return _ltc6811_scheduler_convert(sched, chain, now, op);
+        case LTC6811_CHAIN_CONVERTING:
+        {
+            uint32_t remaining = _ltc6811_scheduler_remaining(sched, chain, now);
+            if (remaining > 0U)
+                return _ltc6811_scheduler_wait(op, remaining);
+            // fall through
+        }
+        case LTC6811_CHAIN_READING:
+            _ltc6811_scheduler_read(sched, chain, op);
+            if (sched->state[chain] == LTC6811_CHAIN_DONE) {
+                ++sched->current;
+                _ltc6811_scheduler_check_cycle(sched);
+            }
+            return op->type;
+        default:
+            return _ltc6811_scheduler_wait(op, 0U);
+    }
+}
+
+static Ltc6811OpType _ltc6811_scheduler_next_interleaved(Ltc6811Scheduler * sched, uint32_t now, Ltc6811Op * op) {
+    // Start all the conversions first so that they overlap with the reads
+    for (size_t i = 0; i < sched->chain_count; ++i)
+        if (sched->state[i] == LTC6811_CHAIN_IDLE)
+            return _ltc6811_scheduler_convert(sched, i, now, op);
+
+    // Read the first chain that has completed its conversion
+    uint32_t wait = UINT32_MAX;
+    for (size_t i = 0; i < sched->chain_count; ++i) {
+        if (sched->state[i] == LTC6811_CHAIN_READING) {
+            _ltc6811_scheduler_read(sched, i, op);
+            _ltc6811_scheduler_check_cycle(sched);
+            return op->type;
+        }
+        if (sched->state[i] == LTC6811_CHAIN_CONVERTING) {
+            uint32_t remaining = _ltc6811_scheduler_remaining(sched, i, now);
+            if (remaining == 0U) {
+                _ltc6811_scheduler_read(sched, i, op);
+                _ltc6811_scheduler_check_cycle(sched);
+                return op->type;
+            }
+            if (remaining < wait)
+                wait = remaining;
+        }
+    }
+    return _ltc6811_scheduler_wait(op, wait == UINT32_MAX ? 0U : wait);
+}
+
+Ltc6811OpType ltc6811_scheduler_next(
+    Ltc6811Scheduler * sched,
+    uint32_t now,
+    Ltc6811Op * op)
+{
+    if (sched == NULL || op == NULL || sched->chain_count == 0U)
+        return LTC6811_OP_NONE;
+    if (sched->policy == LTC6811_SCHEDULER_INTERLEAVED)
+        return _ltc6811_scheduler_next_interleaved(sched, now, op);
+    return _ltc6811_scheduler_next_round_robin(sched, now, op);
+}
+
+size_t ltc6811_scheduler_decode(
+    Ltc6811Scheduler * sched,
+    Ltc6811Op * op,
+    uint8_t * data,
+    uint32_t now)
+{
+    if (sched == NULL || op == NULL || data == NULL)
+        return 0U;
+    if (op->type != LTC6811_OP_READ || op->chain >= sched->chain_count)
+        return 0U;
+    return ltc6811_chain_store_cv(&sched->chains[op->chain], op->reg, data, now);
+}
@@ -0,0 +1,411 @@
+/**
+ * @file ltc6811-diag.c
+ * @brief Incremental diagnostics scheduler for the LTC6811 chain
+ *
+ * @date 18 Oct 2026
+ * @author Antonio Gelain [antonio.gelain2@gmail.com]
+ */
+
+#include "ltc6811-diag.h"
+
+#include <string.h>
+
+/** @brief Single transaction that can be executed inside a diagnostic step */
+typedef enum {
+    LTC6811_DIAG_OP_ADOW_PUP,
+    LTC6811_DIAG_OP_ADOW_PDN,
+    LTC6811_DIAG_OP_CVST,
+    LTC6811_DIAG_OP_AXST,
+    LTC6811_DIAG_OP_STATST,
+    LTC6811_DIAG_OP_DIAGN,
+    LTC6811_DIAG_OP_RDCVA,
+    LTC6811_DIAG_OP_RDCVB,
+    LTC6811_DIAG_OP_RDCVC,
+    LTC6811_DIAG_OP_RDCVD,
+    LTC6811_DIAG_OP_RDAUXA,
+    LTC6811_DIAG_OP_RDAUXB,
+    LTC6811_DIAG_OP_RDSTATA,
+    LTC6811_DIAG_OP_RDSTATB
+} Ltc6811DiagOp;
+
+/** @brief List of transactions of a single diagnostic step */
+typedef struct {
+    Ltc6811DiagTest test;
+    size_t count;
+    Ltc6811DiagOp ops[LTC6811_DIAG_STEP_MAX_OPS];
+} Ltc6811DiagStepOps;
+
+/**
+ * @brief Transactions executed for each step
+ * @details Open wire conversions are repeated twice as suggested by the datasheet
+ */
+static const Ltc6811DiagStepOps steps[LTC6811_DIAG_STEP_COUNT] = {
+    [LTC6811_DIAG_STEP_OW_PUP] = {
+        LTC6811_DIAG_OPEN_WIRE, 6U,
+        {
+            LTC6811_DIAG_OP_ADOW_PUP,
+            LTC6811_DIAG_OP_ADOW_PUP,
+            LTC6811_DIAG_OP_RDCVA,
+            LTC6811_DIAG_OP_RDCVB,
+            LTC6811_DIAG_OP_RDCVC,
+            LTC6811_DIAG_OP_RDCVD
+        }
+    },
+    [LTC6811_DIAG_STEP_OW_PDN] = {
+        LTC6811_DIAG_OPEN_WIRE, 6U,
+        {
+            LTC6811_DIAG_OP_ADOW_PDN,
+            LTC6811_DIAG_OP_ADOW_PDN,
+            LTC6811_DIAG_OP_RDCVA,
+            LTC6811_DIAG_OP_RDCVB,
+            LTC6811_DIAG_OP_RDCVC,
+            LTC6811_DIAG_OP_RDCVD
+        }
+    },
+    [LTC6811_DIAG_STEP_CVST] = {
+        LTC6811_DIAG_CVST, 5U,
+        {
+            LTC6811_DIAG_OP_CVST,
+            LTC6811_DIAG_OP_RDCVA,
+            LTC6811_DIAG_OP_RDCVB,
+            LTC6811_DIAG_OP_RDCVC,
+            LTC6811_DIAG_OP_RDCVD
+        }
+    },
+    [LTC6811_DIAG_STEP_AXST] = {
+        LTC6811_DIAG_AXST, 3U,
+        {
+            LTC6811_DIAG_OP_AXST,
+            LTC6811_DIAG_OP_RDAUXA,
+            LTC6811_DIAG_OP_RDAUXB
+        }
+    },
+    [LTC6811_DIAG_STEP_STATST] = {
+        LTC6811_DIAG_STATST, 3U,
+        {
+            LTC6811_DIAG_OP_STATST,
+            LTC6811_DIAG_OP_RDSTATA,
+            LTC6811_DIAG_OP_RDSTATB
+        }
+    },
+    [LTC6811_DIAG_STEP_MUX] = {
+        LTC6811_DIAG_MUX, 2U,
+        {
+            LTC6811_DIAG_OP_DIAGN,
+            LTC6811_DIAG_OP_RDSTATB
+        }
+    }
+};
+
+/**
+ * @brief Check if a transaction reads data from the LTCs
+ *
+ * @param op The transaction
+ * @return bool True if data has to be read, false otherwise
+ */
+static inline bool _ltc6811_diag_op_is_read(Ltc6811DiagOp op) {
+    return op >= LTC6811_DIAG_OP_RDCVA;
+}
+
+/**
+ * @brief Prepare the results before the execution of a new step
+ *
+ * @param diag The diagnostics handler structure
+ */
+static void _ltc6811_diag_step_begin(Ltc6811Diag * diag) {
+    for (size_t i = 0; i < diag->chain->count; ++i)
+        diag->results[i].step_ok = true;
+}
+
+/**
+ * @brief Update the results at the end of a step and move to the next one
+ *
+ * @param diag The diagnostics handler structure
+ */
+static void _ltc6811_diag_step_end(Ltc6811Diag * diag) {
+    const Ltc6811DiagTest test = steps[diag->step].test;
+
+    for (size_t i = 0; i < diag->chain->count; ++i) {
+        Ltc6811DiagResult * res = &diag->results[i];
+
+        // The pull-up step only collects data for the pull-down one
+        if (diag->step == LTC6811_DIAG_STEP_OW_PUP)
+            res->pup_ok = res->step_ok;
+        else if (res->step_ok && (diag->step != LTC6811_DIAG_STEP_OW_PDN || res->pup_ok))
+            res->done |= (1U << test);
+    }
+
+    diag->op = 0U;
+    if (++diag->step >= LTC6811_DIAG_STEP_COUNT) {
+        diag->step = LTC6811_DIAG_STEP_OW_PUP;
+        ++diag->rounds;
+    }
+}
+
+/**
+ * @brief Set or clear the failed bit of a test for a single LTC
+ *
+ * @param res The results of the LTC
+ * @param test The diagnostic test
+ * @param failed True if the test has failed, false otherwise
+ */
+static inline void _ltc6811_diag_set_failed(Ltc6811DiagResult * res, Ltc6811DiagTest test, bool failed) {
+    if (failed)
+        res->failed |= (1U << test);
+    else
+        res->failed &= ~(1U << test);
+}
+
+/**
+ * @brief Evaluate the cell voltages of a single register group of a single LTC
+ *
+ * @param diag The diagnostics handler structure
+ * @param res The results of the LTC
+ * @param reg The cell voltage register group
+ * @param volts The cell voltages of the register group
+ */
+static void _ltc6811_diag_eval_cells(
+    Ltc6811Diag * diag,
+    Ltc6811DiagResult * res,
+    Ltc6811Cvxr reg,
+    uint16_t * volts)
+{
+    const size_t base = reg * LTC6811_REG_CELL_COUNT;
+    switch (diag->step) {
+        case LTC6811_DIAG_STEP_OW_PUP:
+            memcpy(res->pup + base, volts, LTC6811_REG_CELL_COUNT * sizeof(uint16_t));
+            break;
+        case LTC6811_DIAG_STEP_OW_PDN:
+            if (reg == LTC6811_CVAR)
+                res->open_wire = (res->pup[0] == 0U) ? 1U : 0U;
+            for (size_t j = 0; j < LTC6811_REG_CELL_COUNT; ++j) {
+                // Cell N is connected between the C(N-1) and C(N) pins
+                const size_t cell = base + j;
+                const int32_t delta = (int32_t)res->pup[cell] - (int32_t)volts[j];
+                if (cell > 0 && delta < LTC6811_DIAG_OPEN_WIRE_THRESHOLD)
+                    res->open_wire |= (1U << cell);
+                if (cell == LTC6811_CELL_COUNT - 1 && volts[j] == 0U)
+                    res->open_wire |= (1U << (LTC6811_DIAG_WIRE_COUNT - 1));
+            }
+            if (reg == LTC6811_CVDR)
+                _ltc6811_diag_set_failed(res, LTC6811_DIAG_OPEN_WIRE, res->open_wire != 0U);
+            break;
+        case LTC6811_DIAG_STEP_CVST:
+        {
+            const uint16_t expected = ltc6811_diag_self_test_value(diag->mode, diag->adcopt, diag->test_mode);
+            bool failed = (reg != LTC6811_CVAR) && (res->failed & (1U << LTC6811_DIAG_CVST));
+            for (size_t j = 0; j < LTC6811_REG_CELL_COUNT; ++j)
+                failed |= volts[j] != expected;
+            _ltc6811_diag_set_failed(res, LTC6811_DIAG_CVST, failed);
+        }
+            break;
+        default:
+            break;
+    }
+}
+
+void ltc6811_diag_init(
+    Ltc6811Diag * diag,
+    Ltc6811Chain * chain,
+    Ltc6811DiagResult * results,
+    Ltc6811Md mode,
+    uint8_t adcopt,
+    Ltc6811St test_mode)
+{
+    if (diag == NULL || chain == NULL || results == NULL)
+        return;
+    diag->chain = chain;
+    diag->results = results;
+    diag->mode = mode;
+    diag->adcopt = adcopt;
+    diag->test_mode = test_mode;
+    ltc6811_diag_reset(diag);
+}
+
+void ltc6811_diag_reset(Ltc6811Diag * diag) {
+    if (diag == NULL)
+        return;
+    diag->step = LTC6811_DIAG_STEP_OW_PUP;
+    diag->op = 0U;
+    diag->rounds = 0U;
+    memset(diag->results, 0U, diag->chain->count * sizeof(Ltc6811DiagResult));
+}
+
+size_t ltc6811_diag_encode(
+    Ltc6811Diag * diag,
+    uint8_t * out,
+    size_t * read_size)
+{
+    if (diag == NULL || out == NULL || read_size == NULL)
+        return 0U;
+
+    *read_size = 0U;
+    if (diag->op >= steps[diag->step].count) {
+        _ltc6811_diag_step_end(diag);
+        return 0U;
+    }
+    if (diag->op == 0U)
+        _ltc6811_diag_step_begin(diag);
+
+    const Ltc6811DiagOp op = steps[diag->step].ops[diag->op];
+    Ltc6811Chain * chain = diag->chain;
+    size_t encoded = 0U;
+    switch (op) {
+        case LTC6811_DIAG_OP_ADOW_PUP:
+        case LTC6811_DIAG_OP_ADOW_PDN:
+            encoded = ltc6811_adow_encode_broadcast(
+                chain,
+                diag->mode,
+                op == LTC6811_DIAG_OP_ADOW_PUP ? LTC6811_PUP_ACTIVE : LTC6811_PUP_INACTIVE,
+                LTC6811_DCP_DISABLED,
+                LTC6811_CH_ALL,
+                out
+            );
+            break;
+        case LTC6811_DIAG_OP_CVST:
+            encoded = ltc6811_cvst_encode_broadcast(chain, diag->mode, diag->test_mode, out);
+            break;
+        case LTC6811_DIAG_OP_AXST:
+            encoded = ltc6811_axst_encode_broadcast(chain, diag->mode, diag->test_mode, out);
+            break;
+        case LTC6811_DIAG_OP_STATST:
+            encoded = ltc6811_statst_encode_broadcast(chain, diag->mode, diag->test_mode, out);
+            break;
+        case LTC6811_DIAG_OP_DIAGN:
+            encoded = ltc6811_diagn_encode_broadcast(chain, out);
+            break;
+        case LTC6811_DIAG_OP_RDCVA:
+        case LTC6811_DIAG_OP_RDCVB:
+        case LTC6811_DIAG_OP_RDCVC:
+        case LTC6811_DIAG_OP_RDCVD:
+            encoded = ltc6811_rdcv_encode_broadcast(chain, LTC6811_CVAR + (op - LTC6811_DIAG_OP_RDCVA), out);
+            break;
+        case LTC6811_DIAG_OP_RDAUXA:
+        case LTC6811_DIAG_OP_RDAUXB:
+            encoded = ltc6811_rdaux_encode_broadcast(chain, LTC6811_AVAR + (op - LTC6811_DIAG_OP_RDAUXA), out);
+            break;
+        case LTC6811_DIAG_OP_RDSTATA:
+        case LTC6811_DIAG_OP_RDSTATB:
+            encoded = ltc6811_rdstat_encode_broadcast(chain, LTC6811_STAR + (op - LTC6811_DIAG_OP_RDSTATA), out);
+            break;
+        default:
+            return 0U;
+    }
+
+    // Conversion commands do not need any data to be decoded
+    if (_ltc6811_diag_op_is_read(op))
+        *read_size = LTC6811_DATA_BUFFER_SIZE(chain->count);
+    else
+        ++diag->op;
+    return encoded;
+}
+
+size_t ltc6811_diag_decode(Ltc6811Diag * diag, uint8_t * data) {
+    if (diag == NULL || data == NULL)
+        return 0U;
+    if (diag->op >= steps[diag->step].count)
+        return 0U;
+    const Ltc6811DiagOp op = steps[diag->step].ops[diag->op];
+    if (!_ltc6811_diag_op_is_read(op))
+        return 0U;
+
+    const uint16_t expected = ltc6811_diag_self_test_value(diag->mode, diag->adcopt, diag->test_mode);
+    const size_t byte_count = LTC6811_REG_BYTE_COUNT + LTC6811_PEC_BYTE_COUNT;
+
+    // Decode the register of each LTC separately using a single element chain
+    Ltc6811Chain single = { .count = 1U };
+    size_t decoded = 0U;
+    for (size_t i = 0; i < diag->chain->count; ++i) {
+        Ltc6811DiagResult * res = &diag->results[i];
+        uint8_t * reg_data = data + i * byte_count;
+        uint16_t volts[LTC6811_REG_CELL_COUNT] = { 0 };
+        Ltc6811Str status = { 0 };
+        size_t dev_decoded = 0U;
+
+        switch (op) {
+            case LTC6811_DIAG_OP_RDCVA:
+            case LTC6811_DIAG_OP_RDCVB:
+            case LTC6811_DIAG_OP_RDCVC:
+            case LTC6811_DIAG_OP_RDCVD:
+                dev_decoded = ltc6811_rdcv_decode_broadcast(&single, reg_data, volts);
+                if (dev_decoded > 0U)
+                    _ltc6811_diag_eval_cells(diag, res, LTC6811_CVAR + (op - LTC6811_DIAG_OP_RDCVA), volts);
+                break;
+            case LTC6811_DIAG_OP_RDAUXA:
+            case LTC6811_DIAG_OP_RDAUXB:
+                dev_decoded = ltc6811_rdaux_decode_broadcast(&single, reg_data, volts);
+                if (dev_decoded > 0U) {
+                    bool failed = (op != LTC6811_DIAG_OP_RDAUXA) && (res->failed & (1U << LTC6811_DIAG_AXST));
+                    for (size_t j = 0; j < LTC6811_REG_AUX_COUNT; ++j)
+                        failed |= volts[j] != expected;
+                    _ltc6811_diag_set_failed(res, LTC6811_DIAG_AXST, failed);
+                }
+                break;
+            case LTC6811_DIAG_OP_RDSTATA:
+                dev_decoded = ltc6811_rdstat_decode_broadcast(&single, LTC6811_STAR, reg_data, &status);
+                if (dev_decoded > 0U) {
+                    bool failed = status.SC != expected || status.ITMP != expected || status.VA != expected;
+                    _ltc6811_diag_set_failed(res, LTC6811_DIAG_STATST, failed);
+                }
+                break;
+            case LTC6811_DIAG_OP_RDSTATB:
+                dev_decoded = ltc6811_rdstat_decode_broadcast(&single, LTC6811_STBR, reg_data, &status);
+                if (dev_decoded > 0U) {
+                    if (diag->step == LTC6811_DIAG_STEP_MUX) {
+                        _ltc6811_diag_set_failed(res, LTC6811_DIAG_MUX, status.MUXFAIL != 0U);
+                    }
+                    else {
+                        bool failed = (res->failed & (1U << LTC6811_DIAG_STATST)) || status.VD != expected;
+                        _ltc6811_diag_set_failed(res, LTC6811_DIAG_STATST, failed);
+                    }
+                }
+                break;
+            default:
+                break;
+        }
+
+        if (dev_decoded == 0U)
+            res->step_ok = false;
+        decoded += dev_decoded;
+    }
+
+    ++diag->op;
+    return decoded;
+}
+
+bool ltc6811_diag_is_complete(Ltc6811Diag * diag) {
+    if (diag == NULL)
+        return false;
+    for (size_t i = 0; i < diag->chain->count; ++i) {
+        if (diag->results[i].done != LTC6811_DIAG_ALL_TESTS)
+            return false;
+    }
+    return true;
+}
+
+bool ltc6811_diag_has_failed(Ltc6811Diag * diag) {
+    if (diag == NULL)
+        return false;
+    for (size_t i = 0; i < diag->chain->count; ++i) {
+        if (diag->results[i].failed != 0U)
+            return true;
+    }
+    return false;
+}
+
+uint16_t ltc6811_diag_self_test_value(
+    Ltc6811Md mode,
+    uint8_t adcopt,
+    Ltc6811St test_mode)
+{
+    // Self test results taken from the datasheet (Table 21)
+    const bool fast = (mode == LTC6811_MD_27KHZ_14KHZ);
+    if (test_mode == LTC6811_ST_TWO) {
+        if (fast)
+            return adcopt ? 0x6AAC : 0x6A9A;
+        return 0x6AAA;
+    }
+    if (fast)
+        return adcopt ? 0x9553 : 0x9565;
+    return 0x9555;
+}
@@ -0,0 +1,238 @@
+/**
+ * @file ltc6811-shadow.c
+ * @brief Shadowed configuration, PWM and S control writes with dirty tracking
+ *
+ * @date 18 Oct 2026
+ * @author Antonio Gelain [antonio.gelain2@gmail.com]
+ */
+
+#include "ltc6811-shadow.h"
+#include "ltc6811-chain.h"
+
+/**
+ * @brief Compare the writable fields of two configurations
+ *
+ * @param a The first configuration
+ * @param b The second configuration
+ * @param verify True to compare only the fields whose read value equals the written one
+ * @return bool True if the configurations are equal, false otherwise
+ */
+static bool _ltc6811_shadow_cfgr_equal(Ltc6811Cfgr * a, Ltc6811Cfgr * b, bool verify) {
+    if (a->ADCOPT != b->ADCOPT || a->REFON != b->REFON ||
+        a->VUV != b->VUV || a->VOV != b->VOV || a->DCC != b->DCC)
+        return false;
+    if (verify)
+        return true;
+    return a->GPIO == b->GPIO && a->DCTO == b->DCTO;
+}
+
+/**
+ * @brief Copy an array of 4-bit values and check if it has changed
+ *
+ * @param dst The array to update
+ * @param src The new values
+ * @param count The number of values
+ * @return bool True if at least one value has changed, false otherwise
+ */
+static bool _ltc6811_shadow_update_nibbles(uint8_t * dst, uint8_t * src, size_t count) {
+    bool changed = false;
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t val = src[i] & 0x0F;
+        if (dst[i] != val) {
+            dst[i] = val;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+/**
+ * @brief Get the device state if the index is valid
+ *
+ * @param shadow The shadow handler structure
+ * @param device The index of the device
+ * @return Ltc6811Device * The device state or NULL
+ */
+static inline Ltc6811Device * _ltc6811_shadow_device(Ltc6811Shadow * shadow, size_t device) {
+    if (shadow == NULL || shadow->chain == NULL || shadow->chain->devices == NULL)
+        return NULL;
+    if (device >= shadow->chain->count)
+        return NULL;
+    return &shadow->chain->devices[device];
+}
+
+void ltc6811_shadow_init(
+    Ltc6811Shadow * shadow,
+    Ltc6811Chain * chain,
+    uint32_t verify_period,
+    uint32_t now)
+{
+    if (shadow == NULL || chain == NULL)
+        return;
+    shadow->chain = chain;
+    shadow->verify_period = verify_period;
+    shadow->last_verify = now;
+    shadow->verify_pending = false;
+    shadow->writes = 0U;
+    shadow->skipped = 0U;
+    shadow->verify_errors = 0U;
+    ltc6811_shadow_invalidate(shadow, LTC6811_SHADOW_ALL_GROUPS);
+}
+
+void ltc6811_shadow_invalidate(Ltc6811Shadow * shadow, uint8_t groups) {
+    if (shadow == NULL || shadow->chain == NULL || shadow->chain->devices == NULL)
+        return;
+    for (size_t i = 0; i < shadow->chain->count; ++i)
+        shadow->chain->devices[i].dirty |= groups & LTC6811_SHADOW_ALL_GROUPS;
+}
+
+bool ltc6811_shadow_is_dirty(Ltc6811Shadow * shadow, Ltc6811ShadowGroup group) {
+    if (shadow == NULL || shadow->chain == NULL || shadow->chain->devices == NULL)
+        return false;
+    for (size_t i = 0; i < shadow->chain->count; ++i)
+        if (shadow->chain->devices[i].dirty & (1U << group))
+            return true;
+    return false;
+}
+
+bool ltc6811_shadow_set_config(
+    Ltc6811Shadow * shadow,
+    size_t device,
+    Ltc6811Cfgr * config)
+{
+    Ltc6811Device * dev = _ltc6811_shadow_device(shadow, device);
+    if (dev == NULL || config == NULL)
+        return false;
+    if (_ltc6811_shadow_cfgr_equal(&dev->config, config, false))
+        return false;
+    dev->config = *config;
+    dev->config.DTEN = 0U;
+    dev->dirty |= 1U << LTC6811_SHADOW_CFG;
+    return true;
+}
+
+bool ltc6811_shadow_set_dcc(
+    Ltc6811Shadow * shadow,
+    size_t device,
+    uint16_t dcc)
+{
+    Ltc6811Device * dev = _ltc6811_shadow_device(shadow, device);
+    if (dev == NULL)
+        return false;
+    dcc &= 0x0FFF;
+    if (dev->config.DCC == dcc)
+        return false;
+    dev->config.DCC = dcc;
+    dev->dirty |= 1U << LTC6811_SHADOW_CFG;
+    return true;
+}
+
+bool ltc6811_shadow_set_pwm(
+    Ltc6811Shadow * shadow,
+    size_t device,
+    uint8_t * pwm)
+{
+    Ltc6811Device * dev = _ltc6811_shadow_device(shadow, device);
+    if (dev == NULL || pwm == NULL)
+        return false;
+    if (!_ltc6811_shadow_update_nibbles(dev->pwm, pwm, LTC6811_PWM_COUNT))
+        return false;
+    dev->dirty |= 1U << LTC6811_SHADOW_PWM;
+    return true;
+}
+
+bool ltc6811_shadow_set_sctrl(
+    Ltc6811Shadow * shadow,
+    size_t device,
+    uint8_t * sctrl)
+{
+    Ltc6811Device * dev = _ltc6811_shadow_device(shadow, device);
+    if (dev == NULL || sctrl == NULL)
+        return false;
+    if (!_ltc6811_shadow_update_nibbles(dev->sctrl, sctrl, LTC6811_SCTL_COUNT))
+        return false;
+    dev->dirty |= 1U << LTC6811_SHADOW_SCTRL;
+    return true;
+}
+
+size_t ltc6811_shadow_encode(
+    Ltc6811Shadow * shadow,
+    uint32_t now,
+    uint8_t * out,
+    size_t * read_size)
+{
+    if (shadow == NULL || shadow->chain == NULL || shadow->chain->devices == NULL || out == NULL || read_size == NULL)
+        return 0U;
+    *read_size = 0U;
+
+    Ltc6811Chain * chain = shadow->chain;
+    for (Ltc6811ShadowGroup group = 0; group < LTC6811_SHADOW_GROUP_COUNT; ++group) {
+        if (!ltc6811_shadow_is_dirty(shadow, group))
+            continue;
+
+        size_t byte_count = 0U;
+        switch (group) {
+            case LTC6811_SHADOW_CFG:
+                byte_count = ltc6811_chain_wrcfg_encode(chain, out);
+                break;
+            case LTC6811_SHADOW_PWM:
+                byte_count = ltc6811_chain_wrpwm_encode(chain, out);
+                break;
+            case LTC6811_SHADOW_SCTRL:
+                byte_count = ltc6811_chain_wrsctrl_encode(chain, out);
+                break;
+            default:
+                break;
+        }
+        for (size_t i = 0; i < chain->count; ++i)
+            chain->devices[i].dirty &= ~(1U << group);
+        ++shadow->writes;
+        return byte_count;
+    }
+
+    // Verify the configuration only when there is nothing else to write
+    if (shadow->verify_period > 0U && now - shadow->last_verify >= shadow->verify_period) {
+        shadow->last_verify = now;
+        shadow->verify_pending = true;
+        *read_size = LTC6811_DATA_BUFFER_SIZE(chain->count);
+        return ltc6811_rdcfg_encode_broadcast(chain, out);
+    }
+
+    ++shadow->skipped;
+    return 0U;
+}
+
+size_t ltc6811_shadow_decode(
+    Ltc6811Shadow * shadow,
+    uint8_t * data)
+{
+    if (shadow == NULL || shadow->chain == NULL || shadow->chain->devices == NULL || data == NULL)
+        return 0U;
+    if (!shadow->verify_pending)
+        return 0U;
+    shadow->verify_pending = false;
+
+    Ltc6811Chain * chain = shadow->chain;
+    Ltc6811Chain single = { .count = 1U };
+    size_t decoded = 0U;
+    for (size_t i = 0; i < chain->count; ++i) {
+        Ltc6811Device * dev = &chain->devices[i];
+        Ltc6811Cfgr config;
+        size_t byte_count = ltc6811_rdcfg_decode_broadcast(
+            &single,
+            data + i * (LTC6811_REG_BYTE_COUNT + LTC6811_PEC_BYTE_COUNT),
+            &config
+        );
+        if (byte_count == 0U) {
+            ++dev->pec_errors;
+            ++chain->pec_errors;
+            continue;
+        }
+        if (!_ltc6811_shadow_cfgr_equal(&dev->config, &config, true)) {
+            dev->dirty |= 1U << LTC6811_SHADOW_CFG;
+            ++shadow->verify_errors;
+        }
+        decoded += byte_count;
+    }
+    return decoded;
+}
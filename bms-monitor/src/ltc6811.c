@@ -199,6 +199,20 @@ void ltc6811_chain_init(Ltc6811Chain * chain, size_t ltc_count) {
     if (chain == NULL)
         return;
     chain->count = ltc_count;
+    chain->devices = NULL;
+    chain->pec_errors = 0U;
+}
+
+void ltc6811_chain_init_devices(
+    Ltc6811Chain * chain,
+    size_t ltc_count,
+    Ltc6811Device * devices)
+{
+    if (chain == NULL || devices == NULL)
+        return;
+    ltc6811_chain_init(chain, ltc_count);
+    memset(devices, 0U, sizeof(*devices) * ltc_count);
+    chain->devices = devices;
 }
 
 bool ltc6811_pladc_check(uint8_t byte) {
@@ -668,7 +682,7 @@ size_t ltc6811_adow_encode_broadcast(
     // Get command
     Ltc6811Command cmd = ADOW;
     cmd = _ltc6811_cmd_set_md(cmd, mode);
-    cmd = _ltc6811_cmd_set_pup(cmd, mode);
+    cmd = _ltc6811_cmd_set_pup(cmd, pup);
     cmd = _ltc6811_cmd_set_dcp(cmd, dcp);
     cmd = _ltc6811_cmd_set_ch(cmd, cells);
 
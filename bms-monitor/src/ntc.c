@@ -0,0 +1,77 @@
+/**
+ * @file ntc.c
+ * @brief Fixed-point conversion of the LTC6811 auxiliary voltages to NTC temperatures
+ *
+ * @date 18 Oct 2026
+ * @author Antonio Gelain [antonio.gelain2@gmail.com]
+ */
+
+#include "ntc.h"
+
+/*
+ * The exponential cannot be used inside a constant expression, it is approximated
+ * with a Taylor series of exp(x / 8) raised to the power of 8, the error is
+ * negligible compared to the ADC resolution for |x| < 4 (from -50°C to 200°C)
+ */
+#define _NTC_EXP_SERIES(X) (1.0 + (X) * (1.0 + (X) / 2.0 * (1.0 + (X) / 3.0 * (1.0 + (X) / 4.0 * \
+    (1.0 + (X) / 5.0 * (1.0 + (X) / 6.0 * (1.0 + (X) / 7.0 * (1.0 + (X) / 8.0))))))))
+#define _NTC_SQ(X) ((X) * (X))
+#define _NTC_EXP(X) _NTC_SQ(_NTC_SQ(_NTC_SQ(_NTC_EXP_SERIES((X) / 8.0))))
+
+#define _NTC_KELVIN(T) ((T) + 273.15)
+// Exponent of the Beta model, R(T) = R0 * exp(-x)
+#define _NTC_BETA_EXP(T) (NTC_BETA * (1.0 / _NTC_KELVIN(NTC_T0) - 1.0 / _NTC_KELVIN(T)))
+// Voltage divider with the NTC on the low side, code = VREF * R / (R + RPU)
+#define _NTC_CODE(T) (NTC_VREF_CODE / (1.0 + NTC_R_PULLUP / NTC_R0 * _NTC_EXP(_NTC_BETA_EXP(T))))
+
+// Temperature in °C of the I-th element of the table
+#define _NTC_LUT_TEMP(I) ((NTC_LUT_TEMP_MIN + NTC_LUT_TEMP_STEP * (I)) / 100.0)
+#define _NTC_LUT_ENTRY(I) ((uint16_t)(_NTC_CODE(_NTC_LUT_TEMP(I)) + 0.5))
+#define _NTC_LUT_ENTRY_4(I) _NTC_LUT_ENTRY(I), _NTC_LUT_ENTRY((I) + 1), _NTC_LUT_ENTRY((I) + 2), _NTC_LUT_ENTRY((I) + 3)
+#define _NTC_LUT_ENTRY_16(I) _NTC_LUT_ENTRY_4(I), _NTC_LUT_ENTRY_4((I) + 4), _NTC_LUT_ENTRY_4((I) + 8), _NTC_LUT_ENTRY_4((I) + 12)
+#define _NTC_LUT_ENTRY_64(I) _NTC_LUT_ENTRY_16(I), _NTC_LUT_ENTRY_16((I) + 16), _NTC_LUT_ENTRY_16((I) + 32), _NTC_LUT_ENTRY_16((I) + 48)
+
+/** @brief Expected ADC codes for each temperature step, in decreasing order */
+static const uint16_t ntc_lut[NTC_LUT_SIZE] = { _NTC_LUT_ENTRY_64(0) };
+
+int16_t ntc_code_to_temp(uint16_t code) {
+    if (code >= ntc_lut[0])
+        return NTC_LUT_TEMP_MIN;
+    if (code <= ntc_lut[NTC_LUT_SIZE - 1U])
+        return NTC_LUT_TEMP_MAX;
+
+    /*
+     * Binary search of the segment where ntc_lut[lo] > code >= ntc_lut[lo + 1]
+     * The table size is a power of two so the search has a fixed number of
+     * iterations and the comparison can be compiled without branches
+     */
+    size_t lo = 0U;
+    for (size_t half = NTC_LUT_SIZE / 2U; half > 0U; half /= 2U)
+        lo = (ntc_lut[lo + half] > code) ? lo + half : lo;
+
+    // Linear interpolation with rounding
+    int32_t span = ntc_lut[lo] - ntc_lut[lo + 1U];
+    int32_t diff = ntc_lut[lo] - code;
+    int32_t temp = NTC_LUT_TEMP_MIN + NTC_LUT_TEMP_STEP * (int32_t)lo;
+    return temp + (diff * NTC_LUT_TEMP_STEP + span / 2) / span;
+}
+
+size_t ntc_code_to_temp_bulk(
+    uint16_t * codes,
+    size_t count,
+    int16_t * out)
+{
+    if (codes == NULL || out == NULL)
+        return 0U;
+    for (size_t i = 0; i < count; ++i)
+        out[i] = ntc_code_to_temp(codes[i]);
+    return count;
+}
+
+uint16_t ntc_temp_to_code(int16_t temp) {
+    if (temp <= NTC_LUT_TEMP_MIN)
+        return ntc_lut[0];
+    if (temp >= NTC_LUT_TEMP_MAX)
+        return ntc_lut[NTC_LUT_SIZE - 1U];
+    return ntc_lut[(temp - NTC_LUT_TEMP_MIN) / NTC_LUT_TEMP_STEP];
+}
@@ -0,0 +1,336 @@
+/**
+ * @file test-cell-delta.c
+ * @brief Unit test for the cell voltages delta compression
+ *
+ * @date 18 Oct 2026
+ * @author Antonio Gelain [antonio.gelain2@gmail.com]
+ */
+
+#include "unity.h"
+#include "cell-delta.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LTC_COUNT 2
+#define CELL_COUNT (LTC_COUNT * 12)
+
+// Trace parameters used for the bandwidth benchmark
+#define TRACE_LTC_COUNT 12
+#define TRACE_CELL_COUNT (TRACE_LTC_COUNT * 12)
+#define TRACE_CYCLES 2000
+
+CellDeltaEncoder enc;
+CellDeltaDecoder dec;
+uint16_t reference[CELL_COUNT];
+uint16_t decoded[CELL_COUNT];
+uint16_t volts[CELL_COUNT];
+uint8_t out[CELL_DELTA_BUFFER_SIZE(CELL_COUNT)];
+
+/**
+ * @brief Generate the cell voltages of a pack under a realistic load profile
+ *
+ * @details The trace contains ADC noise, a slow discharge, a few load steps
+ * with a different internal resistance for each cell and the relaxation after the steps
+ */
+typedef struct {
+    uint32_t seed;
+    size_t cycle;
+    size_t cell_count;
+    uint16_t ocv[TRACE_CELL_COUNT];
+} Trace;
+
+static uint32_t trace_rand(Trace * trace) {
+    trace->seed = trace->seed * 1664525U + 1013904223U;
+    return trace->seed >> 16;
+}
+
+static void trace_init(Trace * trace, size_t cell_count, uint32_t seed) {
+    trace->seed = seed;
+    trace->cycle = 0;
+    trace->cell_count = cell_count;
+    for (size_t i = 0; i < cell_count; ++i)
+        trace->ocv[i] = 40500 + (trace_rand(trace) % 80);
+}
+
+static void trace_next(Trace * trace, uint16_t * out) {
+    size_t t = trace->cycle++;
+    // Load current profile in arbitrary units (idle, acceleration and regen)
+    int32_t load = 0;
+    if (t % 500 >= 200 && t % 500 < 260)
+        load = 600;
+    else if (t % 500 >= 300 && t % 500 < 320)
+        load = -250;
+    for (size_t i = 0; i < trace->cell_count; ++i) {
+        if (load > 0 && t % 4 == 0)
+            trace->ocv[i] -= 1;
+        int32_t ir = 8 + (int32_t)(i % 7);
+        int32_t noise = (int32_t)(trace_rand(trace) % 5) - 2;
+        out[i] = (uint16_t)(trace->ocv[i] - (load * ir) / 10 + noise);
+    }
+}
+
+void setUp(void) {
+    cell_delta_encoder_init(&enc, reference, CELL_COUNT, 0, 0);
+    cell_delta_decoder_init(&dec, decoded, CELL_COUNT);
+    for (size_t i = 0; i < CELL_COUNT; ++i)
+        volts[i] = 36000 + i * 7;
+}
+
+void tearDown(void) {
+
+}
+
+void check_encode_with_null(void) {
+    TEST_ASSERT_EQUAL_size_t(0U, cell_delta_encode(NULL, volts, out));
+    TEST_ASSERT_EQUAL_size_t(0U, cell_delta_encode(&enc, NULL, out));
+    TEST_ASSERT_EQUAL_size_t(0U, cell_delta_encode(&enc, volts, NULL));
+}
+
+void check_decode_with_null(void) {
+    TEST_ASSERT_EQUAL_size_t(0U, cell_delta_decode(NULL, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_size_t(0U, cell_delta_decode(&dec, NULL, sizeof(out)));
+}
+
+void check_first_cycle_is_keyframe(void) {
+    size_t byte_count = cell_delta_encode(&enc, volts, out);
+    TEST_ASSERT_EQUAL_size_t(CELL_DELTA_BUFFER_SIZE(CELL_COUNT), byte_count);
+    for (size_t i = 0; i < byte_count; i += CELL_DELTA_FRAME_SIZE)
+        TEST_ASSERT_EQUAL_UINT8(CELL_DELTA_FRAME_KEYFRAME, out[i] >> 6);
+}
+
+void check_keyframe_syncs_decoder(void) {
+    size_t byte_count = cell_delta_encode(&enc, volts, out);
+    TEST_ASSERT_FALSE(cell_delta_decoder_is_synced(&dec));
+    TEST_ASSERT_EQUAL_size_t(byte_count, cell_delta_decode(&dec, out, byte_count));
+    TEST_ASSERT_TRUE(cell_delta_decoder_is_synced(&dec));
+    TEST_ASSERT_EQUAL_UINT16_ARRAY(volts, decoded, CELL_COUNT);
+}
+
+void check_keyframe_bytes(void) {
+    cell_delta_encode(&enc, volts, out);
+    uint8_t expected[] = { 0x80, 0x00, 0xA0, 0x8C, 0xA7, 0x8C, 0xAE, 0x8C };
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, out, CELL_DELTA_FRAME_SIZE);
+}
+
+void check_unchanged_cycle_is_empty(void) {
+    cell_delta_encode(&enc, volts, out);
+    TEST_ASSERT_EQUAL_size_t(0U, cell_delta_encode(&enc, volts, out));
+}
+
+void check_small_change_is_delta(void) {
+    cell_delta_encode(&enc, volts, out);
+    volts[10] -= 3;
+    volts[12] += 100;
+    size_t byte_count = cell_delta_encode(&enc, volts, out);
+    TEST_ASSERT_EQUAL_size_t(CELL_DELTA_FRAME_SIZE, byte_count);
+
+    uint8_t expected[] = {
+        (CELL_DELTA_FRAME_DELTA << 6) | CELL_DELTA_KEYFRAME_COUNT(CELL_COUNT),
+        10,
+        0x05,
+        (uint8_t)-3,
+        100,
+        0, 0, 0
+    };
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, out, CELL_DELTA_FRAME_SIZE);
+}
+
+void check_large_change_is_absolute(void) {
+    cell_delta_encode(&enc, volts, out);
+    volts[5] -= 1000;
+    size_t byte_count = cell_delta_encode(&enc, volts, out);
+    TEST_ASSERT_EQUAL_size_t(CELL_DELTA_FRAME_SIZE, byte_count);
+    TEST_ASSERT_EQUAL_UINT8(CELL_DELTA_FRAME_ABSOLUTE, out[0] >> 6);
+    TEST_ASSERT_EQUAL_UINT8(5, out[1]);
+    TEST_ASSERT_EQUAL_UINT16(volts[5], out[2] | (out[3] << 8));
+}
+
+void check_delta_window_limit(void) {
+    cell_delta_encode(&enc, volts, out);
+    for (size_t i = 0; i < CELL_COUNT; ++i)
+        volts[i] += 1;
+    size_t byte_count = cell_delta_encode(&enc, volts, out);
+    size_t frames = (CELL_COUNT + CELL_DELTA_DELTA_COUNT - 1) / CELL_DELTA_DELTA_COUNT;
+    TEST_ASSERT_EQUAL_size_t(frames * CELL_DELTA_FRAME_SIZE, byte_count);
+}
+
+void check_fallback_to_keyframe(void) {
+    cell_delta_encode(&enc, volts, out);
+    // Alternate small and large changes which is the worst case for the delta encoding
+    for (size_t i = 0; i < CELL_COUNT; ++i)
+        volts[i] += (i % 4 == 0) ? 1 : 500;
+    size_t byte_count = cell_delta_encode(&enc, volts, out);
+    TEST_ASSERT_LESS_OR_EQUAL_size_t(CELL_DELTA_BUFFER_SIZE(CELL_COUNT), byte_count);
+}
+
+void check_periodic_keyframe(void) {
+    cell_delta_encoder_init(&enc, reference, CELL_COUNT, 0, 4);
+    cell_delta_encode(&enc, volts, out);
+    for (size_t i = 0; i < 3; ++i)
+        TEST_ASSERT_EQUAL_size_t(0U, cell_delta_encode(&enc, volts, out));
+    TEST_ASSERT_EQUAL_size_t(CELL_DELTA_BUFFER_SIZE(CELL_COUNT), cell_delta_encode(&enc, volts, out));
+    TEST_ASSERT_EQUAL_UINT8(CELL_DELTA_FRAME_KEYFRAME, out[0] >> 6);
+}
+
+void check_requested_keyframe(void) {
+    cell_delta_encode(&enc, volts, out);
+    cell_delta_encoder_request_keyframe(&enc);
+    TEST_ASSERT_EQUAL_size_t(CELL_DELTA_BUFFER_SIZE(CELL_COUNT), cell_delta_encode(&enc, volts, out));
+    TEST_ASSERT_EQUAL_size_t(0U, cell_delta_encode(&enc, volts, out));
+}
+
+void check_lost_frame_desyncs_decoder(void) {
+    size_t byte_count = cell_delta_encode(&enc, volts, out);
+    cell_delta_decode(&dec, out, byte_count);
+
+    // Lose the first frame
+    volts[0] += 1;
+    volts[20] += 1;
+    volts[21] += 400;
+    byte_count = cell_delta_encode(&enc, volts, out);
+    TEST_ASSERT_GREATER_THAN_size_t(CELL_DELTA_FRAME_SIZE, byte_count);
+    cell_delta_decode(&dec, out + CELL_DELTA_FRAME_SIZE, byte_count - CELL_DELTA_FRAME_SIZE);
+    TEST_ASSERT_FALSE(cell_delta_decoder_is_synced(&dec));
+
+    // Deltas do not resync the decoder
+    volts[3] += 2;
+    byte_count = cell_delta_encode(&enc, volts, out);
+    cell_delta_decode(&dec, out, byte_count);
+    TEST_ASSERT_FALSE(cell_delta_decoder_is_synced(&dec));
+
+    cell_delta_encoder_request_keyframe(&enc);
+    byte_count = cell_delta_encode(&enc, volts, out);
+    cell_delta_decode(&dec, out, byte_count);
+    TEST_ASSERT_TRUE(cell_delta_decoder_is_synced(&dec));
+    TEST_ASSERT_EQUAL_UINT16_ARRAY(volts, decoded, CELL_COUNT);
+}
+
+void check_partial_keyframe_does_not_sync(void) {
+    size_t byte_count = cell_delta_encode(&enc, volts, out);
+    cell_delta_decode(&dec, out, byte_count - CELL_DELTA_FRAME_SIZE);
+    TEST_ASSERT_FALSE(cell_delta_decoder_is_synced(&dec));
+}
+
+void check_decode_invalid_index(void) {
+    size_t byte_count = cell_delta_encode(&enc, volts, out);
+    out[CELL_DELTA_FRAME_SIZE + 1] = CELL_COUNT;
+    TEST_ASSERT_EQUAL_size_t(CELL_DELTA_FRAME_SIZE, cell_delta_decode(&dec, out, byte_count));
+}
+
+void check_decode_invalid_type(void) {
+    cell_delta_encode(&enc, volts, out);
+    out[0] |= 0xC0;
+    TEST_ASSERT_EQUAL_size_t(0U, cell_delta_decode(&dec, out, CELL_DELTA_FRAME_SIZE));
+}
+
+void check_deadband_error_is_bounded(void) {
+    const uint16_t deadband = 2;
+    cell_delta_encoder_init(&enc, reference, CELL_COUNT, deadband, 0);
+    Trace trace;
+    trace_init(&trace, CELL_COUNT, 42);
+    for (size_t t = 0; t < 600; ++t) {
+        trace_next(&trace, volts);
+        size_t byte_count = cell_delta_encode(&enc, volts, out);
+        TEST_ASSERT_EQUAL_size_t(byte_count, cell_delta_decode(&dec, out, byte_count));
+        for (size_t i = 0; i < CELL_COUNT; ++i)
+            TEST_ASSERT_INT_WITHIN(deadband, volts[i], decoded[i]);
+    }
+}
+
+void check_round_trip_trace(void) {
+    cell_delta_encoder_init(&enc, reference, CELL_COUNT, 0, 50);
+    Trace trace;
+    trace_init(&trace, CELL_COUNT, 7);
+    for (size_t t = 0; t < 1000; ++t) {
+        trace_next(&trace, volts);
+        size_t byte_count = cell_delta_encode(&enc, volts, out);
+        TEST_ASSERT_EQUAL_size_t(byte_count, cell_delta_decode(&dec, out, byte_count));
+        TEST_ASSERT_TRUE(cell_delta_decoder_is_synced(&dec));
+        TEST_ASSERT_EQUAL_UINT16_ARRAY(volts, decoded, CELL_COUNT);
+    }
+}
+
+/**
+ * @brief Compare the number of CAN frames needed to send the trace with
+ * the raw encoding (four voltages per frame)
+ */
+static void benchmark_bandwidth(uint16_t deadband, size_t keyframe_period) {
+    static uint16_t trace_ref[TRACE_CELL_COUNT];
+    static uint16_t trace_dec[TRACE_CELL_COUNT];
+    static uint16_t trace_volts[TRACE_CELL_COUNT];
+    static uint8_t trace_out[CELL_DELTA_BUFFER_SIZE(TRACE_CELL_COUNT)];
+    CellDeltaEncoder trace_enc;
+    CellDeltaDecoder trace_dec_handler;
+    Trace trace;
+
+    cell_delta_encoder_init(&trace_enc, trace_ref, TRACE_CELL_COUNT, deadband, keyframe_period);
+    cell_delta_decoder_init(&trace_dec_handler, trace_dec, TRACE_CELL_COUNT);
+    trace_init(&trace, TRACE_CELL_COUNT, 1234);
+
+    const size_t raw_frames = (TRACE_CELL_COUNT * 2U + CELL_DELTA_FRAME_SIZE - 1U) / CELL_DELTA_FRAME_SIZE;
+    size_t frames = 0, max_frames = 0;
+    for (size_t t = 0; t < TRACE_CYCLES; ++t) {
+        trace_next(&trace, trace_volts);
+        size_t byte_count = cell_delta_encode(&trace_enc, trace_volts, trace_out);
+        cell_delta_decode(&trace_dec_handler, trace_out, byte_count);
+        for (size_t i = 0; i < TRACE_CELL_COUNT; ++i)
+            TEST_ASSERT_INT_WITHIN(deadband, trace_volts[i], trace_dec[i]);
+
+        size_t cycle_frames = byte_count / CELL_DELTA_FRAME_SIZE;
+        frames += cycle_frames;
+        if (cycle_frames > max_frames)
+            max_frames = cycle_frames;
+    }
+    TEST_ASSERT_LESS_THAN_size_t(raw_frames * TRACE_CYCLES, frames);
+
+    printf(
+        "[BENCH] cells %d, deadband %u, keyframe period %zu: %.2f frames/cycle (max %zu), raw %zu frames/cycle, %.1f%% of raw\n",
+        TRACE_CELL_COUNT,
+        deadband,
+        keyframe_period,
+        (double)frames / TRACE_CYCLES,
+        max_frames,
+        raw_frames,
+        100.0 * frames / (raw_frames * TRACE_CYCLES)
+    );
+}
+
+void benchmark_bandwidth_lossless(void) {
+    benchmark_bandwidth(0, 0);
+    benchmark_bandwidth(0, 100);
+}
+
+void benchmark_bandwidth_deadband(void) {
+    benchmark_bandwidth(1, 100);
+    benchmark_bandwidth(2, 100);
+    benchmark_bandwidth(5, 100);
+}
+
+int main() {
+    UNITY_BEGIN();
+
+    RUN_TEST(check_encode_with_null);
+    RUN_TEST(check_decode_with_null);
+    RUN_TEST(check_first_cycle_is_keyframe);
+    RUN_TEST(check_keyframe_syncs_decoder);
+    RUN_TEST(check_keyframe_bytes);
+    RUN_TEST(check_unchanged_cycle_is_empty);
+    RUN_TEST(check_small_change_is_delta);
+    RUN_TEST(check_large_change_is_absolute);
+    RUN_TEST(check_delta_window_limit);
+    RUN_TEST(check_fallback_to_keyframe);
+    RUN_TEST(check_periodic_keyframe);
+    RUN_TEST(check_requested_keyframe);
+    RUN_TEST(check_lost_frame_desyncs_decoder);
+    RUN_TEST(check_partial_keyframe_does_not_sync);
+    RUN_TEST(check_decode_invalid_index);
+    RUN_TEST(check_decode_invalid_type);
+    RUN_TEST(check_deadband_error_is_bounded);
+    RUN_TEST(check_round_trip_trace);
+    RUN_TEST(benchmark_bandwidth_lossless);
+    RUN_TEST(benchmark_bandwidth_deadband);
+
+    UNITY_END();
+}
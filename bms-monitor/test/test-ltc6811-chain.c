@@ -0,0 +1,305 @@
+/**
+ * @file test-ltc6811-chain.c
+ * @brief Unit test for the LTC6811 chain state and the multiple chains scheduler
+ *
+ * @date 18 Oct 2026
+ * @author Antonio Gelain [antonio.gelain2@gmail.com]
+ */
+
+#include "unity.h"
+#include "ltc6811-chain.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define LTC_COUNT 2
+#define CHAIN_COUNT 4
+#define DEVICE_BYTE_COUNT (LTC6811_REG_BYTE_COUNT + LTC6811_PEC_BYTE_COUNT)
+
+// Simulated SPI speed of 1MHz (8 microseconds per byte)
+#define SPI_BYTE_TIME 8U
+#define CONVERSION_TIME 2335U
+
+Ltc6811Chain chains[CHAIN_COUNT];
+Ltc6811Device devices[CHAIN_COUNT][LTC_COUNT];
+Ltc6811Scheduler sched;
+
+static uint16_t pec15(uint8_t * data, size_t len) {
+    uint16_t rem = 16;
+    for (size_t i = 0; i < len; ++i) {
+        rem ^= (uint16_t)data[i] << 7;
+        for (size_t b = 0; b < 8; ++b) {
+            if (rem & 0x4000)
+                rem = (rem << 1) ^ 0x4599;
+            else
+                rem <<= 1;
+        }
+    }
+    return (rem << 1) & 0xFFFF;
+}
+
+static void fill_reg(uint8_t * out, uint16_t a, uint16_t b, uint16_t c) {
+    uint16_t vals[] = { a, b, c };
+    for (size_t i = 0; i < 3; ++i) {
+        out[i * 2] = vals[i] & 0xFF;
+        out[i * 2 + 1] = vals[i] >> 8;
+    }
+    uint16_t pec = pec15(out, LTC6811_REG_BYTE_COUNT);
+    out[6] = pec >> 8;
+    out[7] = pec & 0xFF;
+}
+
+void setUp(void) {
+    for (size_t i = 0; i < CHAIN_COUNT; ++i)
+        ltc6811_chain_init_devices(&chains[i], LTC_COUNT, devices[i]);
+}
+
+void tearDown(void) {
+
+}
+
+void check_chain_init_without_devices(void) {
+    Ltc6811Chain chain;
+    ltc6811_chain_init(&chain, LTC_COUNT);
+    TEST_ASSERT_EQUAL_size_t(LTC_COUNT, chain.count);
+    TEST_ASSERT_NULL(chain.devices);
+}
+
+void check_chain_init_devices(void) {
+    TEST_ASSERT_EQUAL_size_t(LTC_COUNT, chains[0].count);
+    TEST_ASSERT_EQUAL_PTR(devices[0], chains[0].devices);
+    TEST_ASSERT_EQUAL_UINT32(0U, chains[0].pec_errors);
+    TEST_ASSERT_EQUAL_UINT32(0U, devices[0][1].pec_errors);
+}
+
+void check_store_without_devices(void) {
+    Ltc6811Chain chain;
+    uint8_t data[LTC6811_DATA_BUFFER_SIZE(LTC_COUNT)] = { 0 };
+    ltc6811_chain_init(&chain, LTC_COUNT);
+    TEST_ASSERT_EQUAL_size_t(0U, ltc6811_chain_store_cv(&chain, LTC6811_CVAR, data, 0U));
+}
+
+void check_store_cv(void) {
+    uint8_t data[LTC6811_DATA_BUFFER_SIZE(LTC_COUNT)];
+    fill_reg(data, 100, 200, 300);
+    fill_reg(data + DEVICE_BYTE_COUNT, 400, 500, 600);
+
+    size_t byte_count = ltc6811_chain_store_cv(&chains[0], LTC6811_CVBR, data, 42U);
+    TEST_ASSERT_EQUAL_size_t(LTC6811_DATA_BUFFER_SIZE(LTC_COUNT), byte_count);
+
+    uint16_t expected0[] = { 100, 200, 300 };
+    uint16_t expected1[] = { 400, 500, 600 };
+    TEST_ASSERT_EQUAL_UINT16_ARRAY(expected0, devices[0][0].cells + 3, 3);
+    TEST_ASSERT_EQUAL_UINT16_ARRAY(expected1, devices[0][1].cells + 3, 3);
+    TEST_ASSERT_EQUAL_UINT32(42U, devices[0][0].cells_timestamp[LTC6811_CVBR]);
+    TEST_ASSERT_EQUAL_UINT32(42U, devices[0][1].cells_timestamp[LTC6811_CVBR]);
+    TEST_ASSERT_EQUAL_UINT32(0U, devices[0][0].cells_timestamp[LTC6811_CVAR]);
+}
+
+void check_store_cv_pec_error(void) {
+    uint8_t data[LTC6811_DATA_BUFFER_SIZE(LTC_COUNT)];
+    fill_reg(data, 100, 200, 300);
+    fill_reg(data + DEVICE_BYTE_COUNT, 400, 500, 600);
+    ltc6811_chain_store_cv(&chains[0], LTC6811_CVAR, data, 10U);
+
+    fill_reg(data, 101, 201, 301);
+    fill_reg(data + DEVICE_BYTE_COUNT, 401, 501, 601);
+    data[DEVICE_BYTE_COUNT + 7] ^= 0x01;
+    size_t byte_count = ltc6811_chain_store_cv(&chains[0], LTC6811_CVAR, data, 20U);
+    TEST_ASSERT_EQUAL_size_t(DEVICE_BYTE_COUNT, byte_count);
+
+    uint16_t expected1[] = { 400, 500, 600 };
+    TEST_ASSERT_EQUAL_UINT16_ARRAY(expected1, devices[0][1].cells, 3);
+    TEST_ASSERT_EQUAL_UINT16(101, devices[0][0].cells[0]);
+    TEST_ASSERT_EQUAL_UINT32(20U, devices[0][0].cells_timestamp[LTC6811_CVAR]);
+    TEST_ASSERT_EQUAL_UINT32(10U, devices[0][1].cells_timestamp[LTC6811_CVAR]);
+    TEST_ASSERT_EQUAL_UINT32(0U, devices[0][0].pec_errors);
+    TEST_ASSERT_EQUAL_UINT32(1U, devices[0][1].pec_errors);
+    TEST_ASSERT_EQUAL_UINT32(1U, chains[0].pec_errors);
+}
+
+void check_store_aux(void) {
+    uint8_t data[LTC6811_DATA_BUFFER_SIZE(LTC_COUNT)];
+    fill_reg(data, 1, 2, 3);
+    fill_reg(data + DEVICE_BYTE_COUNT, 4, 5, 6);
+    ltc6811_chain_store_aux(&chains[1], LTC6811_AVBR, data, 7U);
+    uint16_t expected[] = { 4, 5, 6 };
+    TEST_ASSERT_EQUAL_UINT16_ARRAY(expected, devices[1][1].aux + 3, 3);
+    TEST_ASSERT_EQUAL_UINT32(7U, devices[1][1].aux_timestamp[LTC6811_AVBR]);
+}
+
+void check_store_stat_clears_flags(void) {
+    uint8_t data[LTC6811_DATA_BUFFER_SIZE(LTC_COUNT)];
+    // Cell 1 under voltage and cell 2 over voltage
+    fill_reg(data, 0, 0x0009, 0);
+    fill_reg(data + DEVICE_BYTE_COUNT, 0, 0, 0);
+    ltc6811_chain_store_stat(&chains[0], LTC6811_STBR, data, 1U);
+    TEST_ASSERT_EQUAL_HEX16(0x001, devices[0][0].status.CUV);
+    TEST_ASSERT_EQUAL_HEX16(0x002, devices[0][0].status.COV);
+
+    fill_reg(data, 0, 0, 0);
+    ltc6811_chain_store_stat(&chains[0], LTC6811_STBR, data, 2U);
+    TEST_ASSERT_EQUAL_HEX16(0U, devices[0][0].status.CUV);
+    TEST_ASSERT_EQUAL_HEX16(0U, devices[0][0].status.COV);
+    TEST_ASSERT_EQUAL_UINT32(2U, devices[0][0].status_timestamp[LTC6811_STBR]);
+}
+
+void check_wrcfg_encode_matches_broadcast(void) {
+    Ltc6811Cfgr config[LTC_COUNT] = { 0 };
+    for (size_t i = 0; i < LTC_COUNT; ++i) {
+        config[i].REFON = 1;
+        config[i].GPIO = 0x1F;
+        config[i].VUV = 0x123 + i;
+        config[i].VOV = 0x456 + i;
+        config[i].DCC = 0x800 >> i;
+        config[i].DCTO = i;
+        devices[0][i].config = config[i];
+    }
+
+    uint8_t expected[LTC6811_WRITE_BUFFER_SIZE(LTC_COUNT)];
+    uint8_t out[LTC6811_WRITE_BUFFER_SIZE(LTC_COUNT)];
+    size_t expected_count = ltc6811_wrcfg_encode_broadcast(&chains[0], config, expected);
+    TEST_ASSERT_EQUAL_size_t(expected_count, ltc6811_chain_wrcfg_encode(&chains[0], out));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, out, expected_count);
+}
+
+void check_adcv_conversion_time(void) {
+    TEST_ASSERT_EQUAL_UINT32(2335U, ltc6811_adcv_conversion_time_us(LTC6811_MD_7KHZ_3KHZ, 0));
+    TEST_ASSERT_EQUAL_UINT32(3033U, ltc6811_adcv_conversion_time_us(LTC6811_MD_7KHZ_3KHZ, 1));
+    TEST_ASSERT_EQUAL_UINT32(1113U, ltc6811_adcv_conversion_time_us(LTC6811_MD_27KHZ_14KHZ, 0));
+}
+
+void check_scheduler_round_robin_sequence(void) {
+    Ltc6811Op op;
+    ltc6811_scheduler_init(&sched, chains, 2, LTC6811_SCHEDULER_ROUND_ROBIN, LTC6811_MD_7KHZ_3KHZ, LTC6811_DCP_DISABLED, 100U);
+
+    TEST_ASSERT_EQUAL_INT(LTC6811_OP_CONVERSION, ltc6811_scheduler_next(&sched, 0U, &op));
+    TEST_ASSERT_EQUAL_size_t(0U, op.chain);
+    TEST_ASSERT_EQUAL_INT(LTC6811_OP_NONE, ltc6811_scheduler_next(&sched, 40U, &op));
+    TEST_ASSERT_EQUAL_UINT32(60U, op.wait);
+    for (size_t reg = 0; reg < LTC6811_CVXR_COUNT; ++reg) {
+        TEST_ASSERT_EQUAL_INT(LTC6811_OP_READ, ltc6811_scheduler_next(&sched, 100U, &op));
+        TEST_ASSERT_EQUAL_size_t(0U, op.chain);
+        TEST_ASSERT_EQUAL_INT(reg, op.reg);
+        TEST_ASSERT_EQUAL_size_t(LTC6811_DATA_BUFFER_SIZE(LTC_COUNT), op.read_size);
+    }
+    TEST_ASSERT_EQUAL_INT(LTC6811_OP_CONVERSION, ltc6811_scheduler_next(&sched, 100U, &op));
+    TEST_ASSERT_EQUAL_size_t(1U, op.chain);
+}
+
+void check_scheduler_interleaved_sequence(void) {
+    Ltc6811Op op;
+    ltc6811_scheduler_init(&sched, chains, 2, LTC6811_SCHEDULER_INTERLEAVED, LTC6811_MD_7KHZ_3KHZ, LTC6811_DCP_DISABLED, 100U);
+
+    TEST_ASSERT_EQUAL_INT(LTC6811_OP_CONVERSION, ltc6811_scheduler_next(&sched, 0U, &op));
+    TEST_ASSERT_EQUAL_size_t(0U, op.chain);
+    TEST_ASSERT_EQUAL_INT(LTC6811_OP_CONVERSION, ltc6811_scheduler_next(&sched, 10U, &op));
+    TEST_ASSERT_EQUAL_size_t(1U, op.chain);
+    TEST_ASSERT_EQUAL_INT(LTC6811_OP_NONE, ltc6811_scheduler_next(&sched, 20U, &op));
+    TEST_ASSERT_EQUAL_UINT32(80U, op.wait);
+    TEST_ASSERT_EQUAL_INT(LTC6811_OP_READ, ltc6811_scheduler_next(&sched, 100U, &op));
+    TEST_ASSERT_EQUAL_size_t(0U, op.chain);
+}
+
+void check_scheduler_adcv_command(void) {
+    Ltc6811Op op;
+    uint8_t expected[LTC6811_POLL_BUFFER_SIZE(LTC_COUNT)];
+    ltc6811_scheduler_init(&sched, chains, 1, LTC6811_SCHEDULER_ROUND_ROBIN, LTC6811_MD_27KHZ_14KHZ, LTC6811_DCP_ENABLED, 100U);
+    ltc6811_scheduler_next(&sched, 0U, &op);
+    size_t size = ltc6811_adcv_encode_broadcast(&chains[0], LTC6811_MD_27KHZ_14KHZ, LTC6811_DCP_ENABLED, LTC6811_CH_ALL, expected);
+    TEST_ASSERT_EQUAL_size_t(size, op.size);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, op.out, size);
+}
+
+void check_scheduler_decode_stores_data(void) {
+    Ltc6811Op op;
+    uint8_t data[LTC6811_DATA_BUFFER_SIZE(LTC_COUNT)];
+    fill_reg(data, 1000, 2000, 3000);
+    fill_reg(data + DEVICE_BYTE_COUNT, 4000, 5000, 6000);
+
+    ltc6811_scheduler_init(&sched, chains, 2, LTC6811_SCHEDULER_ROUND_ROBIN, LTC6811_MD_7KHZ_3KHZ, LTC6811_DCP_DISABLED, 0U);
+    ltc6811_scheduler_next(&sched, 0U, &op);
+    TEST_ASSERT_EQUAL_size_t(0U, ltc6811_scheduler_decode(&sched, &op, data, 0U));
+    ltc6811_scheduler_next(&sched, 0U, &op);
+    TEST_ASSERT_EQUAL_size_t(sizeof(data), ltc6811_scheduler_decode(&sched, &op, data, 5U));
+    TEST_ASSERT_EQUAL_UINT16(4000, devices[0][1].cells[0]);
+    TEST_ASSERT_EQUAL_UINT32(5U, devices[0][1].cells_timestamp[LTC6811_CVAR]);
+}
+
+/**
+ * @brief Simulate the execution of the scheduled operations with an ideal clock
+ *
+ * @details Every operation takes the time needed to transfer its bytes on the SPI,
+ * the chains share the same SPI peripheral
+ *
+ * @return uint32_t The time needed to complete the given number of cycles
+ */
+static uint32_t simulate(Ltc6811SchedulerMode policy, size_t cycles) {
+    Ltc6811Op op;
+    uint8_t data[LTC6811_DATA_BUFFER_SIZE(LTC_COUNT)];
+    uint32_t start[CHAIN_COUNT] = { 0 };
+    uint32_t now = 0U;
+
+    for (size_t i = 0; i < LTC_COUNT; ++i)
+        fill_reg(data + i * DEVICE_BYTE_COUNT, 36000, 36001, 36002);
+    ltc6811_scheduler_init(&sched, chains, CHAIN_COUNT, policy, LTC6811_MD_7KHZ_3KHZ, LTC6811_DCP_DISABLED, CONVERSION_TIME);
+
+    while (sched.cycles < cycles) {
+        switch (ltc6811_scheduler_next(&sched, now, &op)) {
+            case LTC6811_OP_NONE:
+                TEST_ASSERT_GREATER_THAN_UINT32(0U, op.wait);
+                now += op.wait;
+                break;
+            case LTC6811_OP_CONVERSION:
+                start[op.chain] = now;
+                now += op.size * SPI_BYTE_TIME;
+                break;
+            case LTC6811_OP_READ:
+                // The data must not be read before the end of the conversion
+                TEST_ASSERT_GREATER_OR_EQUAL_UINT32(CONVERSION_TIME, now - start[op.chain]);
+                now += (op.size + op.read_size) * SPI_BYTE_TIME;
+                TEST_ASSERT_EQUAL_size_t(op.read_size, ltc6811_scheduler_decode(&sched, &op, data, now));
+                break;
+        }
+    }
+    for (size_t i = 0; i < CHAIN_COUNT; ++i)
+        for (size_t reg = 0; reg < LTC6811_CVXR_COUNT; ++reg)
+            TEST_ASSERT_NOT_EQUAL(0U, devices[i][LTC_COUNT - 1].cells_timestamp[reg]);
+    return now;
+}
+
+void check_scheduler_interleaved_is_faster(void) {
+    const size_t cycles = 10;
+    uint32_t round_robin = simulate(LTC6811_SCHEDULER_ROUND_ROBIN, cycles);
+    uint32_t interleaved = simulate(LTC6811_SCHEDULER_INTERLEAVED, cycles);
+    TEST_ASSERT_LESS_THAN_UINT32(round_robin, interleaved);
+
+    printf(
+        "[BENCH] %d chains of %d LTC6811: round-robin %u us/cycle, interleaved %u us/cycle\n",
+        CHAIN_COUNT,
+        LTC_COUNT,
+        (unsigned)(round_robin / cycles),
+        (unsigned)(interleaved / cycles)
+    );
+}
+
+int main() {
+    UNITY_BEGIN();
+
+    RUN_TEST(check_chain_init_without_devices);
+    RUN_TEST(check_chain_init_devices);
+    RUN_TEST(check_store_without_devices);
+    RUN_TEST(check_store_cv);
+    RUN_TEST(check_store_cv_pec_error);
+    RUN_TEST(check_store_aux);
+    RUN_TEST(check_store_stat_clears_flags);
+    RUN_TEST(check_wrcfg_encode_matches_broadcast);
+    RUN_TEST(check_adcv_conversion_time);
+    RUN_TEST(check_scheduler_round_robin_sequence);
+    RUN_TEST(check_scheduler_interleaved_sequence);
+    RUN_TEST(check_scheduler_adcv_command);
+    RUN_TEST(check_scheduler_decode_stores_data);
+    RUN_TEST(check_scheduler_interleaved_is_faster);
+
+    UNITY_END();
+}
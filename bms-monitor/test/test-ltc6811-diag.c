@@ -0,0 +1,286 @@
+/**
+ * @file test-ltc6811-diag.c
+ * @brief Unit test for the LTC6811 diagnostics scheduler
+ *
+ * @date 18 Oct 2026
+ * @author Antonio Gelain [antonio.gelain2@gmail.com]
+ */
+
+#include "unity.h"
+#include "ltc6811-diag.h"
+
+#include <string.h>
+
+#define LTC_COUNT 2
+#define CONVERSION_MASK ((3U << 7) | (1U << 6) | (3U << 5) | (1U << 4) | 0x07U)
+
+/** @brief Simulated state of a single LTC6811 */
+typedef struct {
+    uint16_t cells[LTC6811_CELL_COUNT];
+    int open_pin; // Open C pin or -1 if none
+    bool wrong_cvst;
+    bool mux_fail;
+    bool pec_error;
+} SimLtc;
+
+Ltc6811Chain chain;
+Ltc6811Diag diag;
+Ltc6811DiagResult results[LTC_COUNT];
+SimLtc sim[LTC_COUNT];
+
+// Last conversion started by the scheduler
+uint16_t last_conv;
+
+static uint16_t pec15(uint8_t * data, size_t len) {
+    uint16_t rem = 16;
+    for (size_t i = 0; i < len; ++i) {
+        rem ^= (uint16_t)data[i] << 7;
+        for (size_t b = 0; b < 8; ++b) {
+            if (rem & 0x4000)
+                rem = (rem << 1) ^ 0x4599;
+            else
+                rem <<= 1;
+        }
+    }
+    return (rem << 1) & 0xFFFF;
+}
+
+static void fill_reg(uint8_t * out, uint16_t a, uint16_t b, uint16_t c, bool pec_error) {
+    uint16_t vals[] = { a, b, c };
+    for (size_t i = 0; i < 3; ++i) {
+        out[i * 2] = vals[i] & 0xFF;
+        out[i * 2 + 1] = vals[i] >> 8;
+    }
+    uint16_t pec = pec15(out, LTC6811_REG_BYTE_COUNT);
+    if (pec_error)
+        pec ^= 0x0F;
+    out[6] = pec >> 8;
+    out[7] = pec & 0xFF;
+}
+
+static uint16_t sim_cell(SimLtc * ltc, size_t cell) {
+    uint16_t conv = last_conv & ~CONVERSION_MASK;
+    uint16_t st = ltc6811_diag_self_test_value(LTC6811_MD_7KHZ_3KHZ, 0, LTC6811_ST_ONE);
+    if (conv == (CVST & ~CONVERSION_MASK))
+        return (ltc->wrong_cvst && cell == 7) ? st + 1 : st;
+    // Pull-down conversion on an open wire makes the cell above read higher
+    bool pup = (last_conv >> 6) & 1U;
+    if (!pup && ltc->open_pin >= 0 && (size_t)ltc->open_pin == cell)
+        return ltc->cells[cell] + 5000;
+    return ltc->cells[cell];
+}
+
+static void sim_respond(uint16_t cmd, uint8_t * data) {
+    uint16_t st = ltc6811_diag_self_test_value(LTC6811_MD_7KHZ_3KHZ, 0, LTC6811_ST_ONE);
+    for (size_t i = 0; i < LTC_COUNT; ++i) {
+        SimLtc * ltc = &sim[i];
+        uint8_t * out = data + i * (LTC6811_REG_BYTE_COUNT + LTC6811_PEC_BYTE_COUNT);
+        size_t reg = 0;
+        switch (cmd) {
+            case RDCVA: reg = 0; break;
+            case RDCVB: reg = 1; break;
+            case RDCVC: reg = 2; break;
+            case RDCVD: reg = 3; break;
+            default: reg = 4; break;
+        }
+        if (reg < 4) {
+            size_t c = reg * 3;
+            fill_reg(out, sim_cell(ltc, c), sim_cell(ltc, c + 1), sim_cell(ltc, c + 2), ltc->pec_error);
+        }
+        else if (cmd == RDAUXA || cmd == RDAUXB || cmd == RDSTATA) {
+            fill_reg(out, st, st, st, ltc->pec_error);
+        }
+        else if (cmd == RDSTATB) {
+            fill_reg(out, st, 0, ltc->mux_fail ? 0x0200 : 0x0000, ltc->pec_error);
+        }
+    }
+}
+
+/**
+ * @brief Run a single diagnostic step as it would be done inside a measurement cycle
+ *
+ * @return size_t The number of executed transactions
+ */
+static size_t run_step(void) {
+    uint8_t out[LTC6811_READ_BUFFER_SIZE(LTC_COUNT)];
+    uint8_t data[LTC6811_DATA_BUFFER_SIZE(LTC_COUNT)];
+    size_t read_size = 0, ops = 0;
+    while (ltc6811_diag_encode(&diag, out, &read_size) > 0) {
+        uint16_t cmd = ((uint16_t)(out[0] & 0x07) << 8) | out[1];
+        if (read_size > 0) {
+            TEST_ASSERT_EQUAL_size_t(LTC6811_DATA_BUFFER_SIZE(LTC_COUNT), read_size);
+            sim_respond(cmd, data);
+            ltc6811_diag_decode(&diag, data);
+        }
+        else {
+            last_conv = cmd;
+        }
+        ++ops;
+    }
+    return ops;
+}
+
+static void run_round(void) {
+    for (size_t i = 0; i < LTC6811_DIAG_STEP_COUNT; ++i)
+        run_step();
+}
+
+void setUp(void) {
+    ltc6811_chain_init(&chain, LTC_COUNT);
+    ltc6811_diag_init(&diag, &chain, results, LTC6811_MD_7KHZ_3KHZ, 0, LTC6811_ST_ONE);
+    for (size_t i = 0; i < LTC_COUNT; ++i) {
+        for (size_t j = 0; j < LTC6811_CELL_COUNT; ++j)
+            sim[i].cells[j] = 36000 + j * 10;
+        sim[i].open_pin = -1;
+        sim[i].wrong_cvst = false;
+        sim[i].mux_fail = false;
+        sim[i].pec_error = false;
+    }
+    last_conv = 0;
+}
+
+void tearDown(void) {
+
+}
+
+void check_diag_self_test_value(void) {
+    TEST_ASSERT_EQUAL_HEX16(0x9565, ltc6811_diag_self_test_value(LTC6811_MD_27KHZ_14KHZ, 0, LTC6811_ST_ONE));
+    TEST_ASSERT_EQUAL_HEX16(0x9553, ltc6811_diag_self_test_value(LTC6811_MD_27KHZ_14KHZ, 1, LTC6811_ST_ONE));
+    TEST_ASSERT_EQUAL_HEX16(0x9555, ltc6811_diag_self_test_value(LTC6811_MD_7KHZ_3KHZ, 0, LTC6811_ST_ONE));
+    TEST_ASSERT_EQUAL_HEX16(0x6A9A, ltc6811_diag_self_test_value(LTC6811_MD_27KHZ_14KHZ, 0, LTC6811_ST_TWO));
+    TEST_ASSERT_EQUAL_HEX16(0x6AAC, ltc6811_diag_self_test_value(LTC6811_MD_27KHZ_14KHZ, 1, LTC6811_ST_TWO));
+    TEST_ASSERT_EQUAL_HEX16(0x6AAA, ltc6811_diag_self_test_value(LTC6811_MD_422HZ_1KHZ, 1, LTC6811_ST_TWO));
+}
+
+void check_diag_encode_with_null(void) {
+    uint8_t out[LTC6811_READ_BUFFER_SIZE(LTC_COUNT)];
+    size_t read_size = 0;
+    TEST_ASSERT_EQUAL_size_t(0U, ltc6811_diag_encode(NULL, out, &read_size));
+    TEST_ASSERT_EQUAL_size_t(0U, ltc6811_diag_encode(&diag, NULL, &read_size));
+    TEST_ASSERT_EQUAL_size_t(0U, ltc6811_diag_encode(&diag, out, NULL));
+}
+
+void check_diag_step_transactions(void) {
+    const size_t expected[LTC6811_DIAG_STEP_COUNT] = { 6, 6, 5, 3, 3, 2 };
+    for (size_t i = 0; i < LTC6811_DIAG_STEP_COUNT; ++i) {
+        TEST_ASSERT_EQUAL_INT(i, diag.step);
+        TEST_ASSERT_EQUAL_size_t(expected[i], run_step());
+    }
+    TEST_ASSERT_EQUAL_INT(LTC6811_DIAG_STEP_OW_PUP, diag.step);
+    TEST_ASSERT_EQUAL_size_t(1U, diag.rounds);
+}
+
+void check_diag_first_transaction_is_open_wire_pull_up(void) {
+    uint8_t out[LTC6811_READ_BUFFER_SIZE(LTC_COUNT)];
+    uint8_t expected[LTC6811_POLL_BUFFER_SIZE(LTC_COUNT)];
+    size_t read_size = 1;
+    size_t len = ltc6811_diag_encode(&diag, out, &read_size);
+    ltc6811_adow_encode_broadcast(&chain, LTC6811_MD_7KHZ_3KHZ, LTC6811_PUP_ACTIVE, LTC6811_DCP_DISABLED, LTC6811_CH_ALL, expected);
+
+    TEST_ASSERT_EQUAL_size_t(LTC6811_POLL_BUFFER_SIZE(LTC_COUNT), len);
+    TEST_ASSERT_EQUAL_size_t(0U, read_size);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, out, len);
+}
+
+void check_diag_not_complete_before_full_round(void) {
+    for (size_t i = 0; i < LTC6811_DIAG_STEP_COUNT - 1; ++i) {
+        run_step();
+        TEST_ASSERT_FALSE(ltc6811_diag_is_complete(&diag));
+    }
+    run_step();
+    TEST_ASSERT_TRUE(ltc6811_diag_is_complete(&diag));
+}
+
+void check_diag_healthy_chain(void) {
+    run_round();
+    TEST_ASSERT_TRUE(ltc6811_diag_is_complete(&diag));
+    TEST_ASSERT_FALSE(ltc6811_diag_has_failed(&diag));
+    for (size_t i = 0; i < LTC_COUNT; ++i) {
+        TEST_ASSERT_EQUAL_HEX8(LTC6811_DIAG_ALL_TESTS, results[i].done);
+        TEST_ASSERT_EQUAL_HEX16(0U, results[i].open_wire);
+    }
+}
+
+void check_diag_open_wire(void) {
+    sim[1].open_pin = 5;
+    run_round();
+    TEST_ASSERT_TRUE(ltc6811_diag_has_failed(&diag));
+    TEST_ASSERT_EQUAL_HEX8(0U, results[0].failed);
+    TEST_ASSERT_EQUAL_HEX8(1U << LTC6811_DIAG_OPEN_WIRE, results[1].failed);
+    TEST_ASSERT_EQUAL_HEX16(1U << 5, results[1].open_wire);
+}
+
+void check_diag_open_wire_first_pin(void) {
+    sim[0].cells[0] = 0;
+    run_round();
+    TEST_ASSERT_EQUAL_HEX16(1U, results[0].open_wire);
+}
+
+void check_diag_open_wire_last_pin(void) {
+    sim[0].cells[LTC6811_CELL_COUNT - 1] = 0;
+    run_round();
+    TEST_ASSERT_EQUAL_HEX16(1U << LTC6811_CELL_COUNT, results[0].open_wire);
+}
+
+void check_diag_cvst_failure(void) {
+    sim[0].wrong_cvst = true;
+    run_round();
+    TEST_ASSERT_EQUAL_HEX8(1U << LTC6811_DIAG_CVST, results[0].failed);
+    TEST_ASSERT_EQUAL_HEX8(0U, results[1].failed);
+}
+
+void check_diag_mux_failure(void) {
+    sim[1].mux_fail = true;
+    run_round();
+    TEST_ASSERT_EQUAL_HEX8(0U, results[0].failed);
+    TEST_ASSERT_EQUAL_HEX8(1U << LTC6811_DIAG_MUX, results[1].failed);
+}
+
+void check_diag_failure_is_cleared(void) {
+    sim[1].mux_fail = true;
+    run_round();
+    sim[1].mux_fail = false;
+    run_round();
+    TEST_ASSERT_FALSE(ltc6811_diag_has_failed(&diag));
+}
+
+void check_diag_pec_error_not_done(void) {
+    sim[0].pec_error = true;
+    run_round();
+    TEST_ASSERT_FALSE(ltc6811_diag_is_complete(&diag));
+    TEST_ASSERT_EQUAL_HEX8(0U, results[0].done);
+    TEST_ASSERT_EQUAL_HEX8(LTC6811_DIAG_ALL_TESTS, results[1].done);
+
+    sim[0].pec_error = false;
+    run_round();
+    TEST_ASSERT_TRUE(ltc6811_diag_is_complete(&diag));
+}
+
+void check_diag_reset(void) {
+    run_round();
+    ltc6811_diag_reset(&diag);
+    TEST_ASSERT_FALSE(ltc6811_diag_is_complete(&diag));
+    TEST_ASSERT_EQUAL_size_t(0U, diag.rounds);
+    TEST_ASSERT_EQUAL_INT(LTC6811_DIAG_STEP_OW_PUP, diag.step);
+}
+
+int main() {
+    UNITY_BEGIN();
+
+    RUN_TEST(check_diag_self_test_value);
+    RUN_TEST(check_diag_encode_with_null);
+    RUN_TEST(check_diag_step_transactions);
+    RUN_TEST(check_diag_first_transaction_is_open_wire_pull_up);
+    RUN_TEST(check_diag_not_complete_before_full_round);
+    RUN_TEST(check_diag_healthy_chain);
+    RUN_TEST(check_diag_open_wire);
+    RUN_TEST(check_diag_open_wire_first_pin);
+    RUN_TEST(check_diag_open_wire_last_pin);
+    RUN_TEST(check_diag_cvst_failure);
+    RUN_TEST(check_diag_mux_failure);
+    RUN_TEST(check_diag_failure_is_cleared);
+    RUN_TEST(check_diag_pec_error_not_done);
+    RUN_TEST(check_diag_reset);
+
+    UNITY_END();
+}
@@ -0,0 +1,346 @@
+/**
+ * @file test-ltc6811-shadow.c
+ * @brief Unit test for the shadowed LTC6811 register writes
+ *
+ * @date 18 Oct 2026
+ * @author Antonio Gelain [antonio.gelain2@gmail.com]
+ */
+
+#include "unity.h"
+#include "ltc6811-shadow.h"
+#include "ltc6811-chain.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define LTC_COUNT 4
+#define DEVICE_BYTE_COUNT (LTC6811_REG_BYTE_COUNT + LTC6811_PEC_BYTE_COUNT)
+#define VERIFY_PERIOD 1000U
+
+Ltc6811Chain chain;
+Ltc6811Device devices[LTC_COUNT];
+Ltc6811Shadow shadow;
+uint8_t out[LTC6811_WRITE_BUFFER_SIZE(LTC_COUNT)];
+uint8_t expected[LTC6811_WRITE_BUFFER_SIZE(LTC_COUNT)];
+size_t read_size;
+
+static uint16_t pec15(uint8_t * data, size_t len) {
+    uint16_t rem = 16;
+    for (size_t i = 0; i < len; ++i) {
+        rem ^= (uint16_t)data[i] << 7;
+        for (size_t b = 0; b < 8; ++b) {
+            if (rem & 0x4000)
+                rem = (rem << 1) ^ 0x4599;
+            else
+                rem <<= 1;
+        }
+    }
+    return (rem << 1) & 0xFFFF;
+}
+
+// Build the data read from the chain with the configuration of each device
+static void fill_rdcfg(uint8_t * data) {
+    for (size_t i = 0; i < LTC_COUNT; ++i) {
+        uint8_t * reg = data + i * DEVICE_BYTE_COUNT;
+        Ltc6811Cfgr * cfg = &devices[i].config;
+        reg[0] = cfg->ADCOPT | (cfg->REFON << 2) | (cfg->GPIO << 3);
+        reg[1] = cfg->VUV & 0xFF;
+        reg[2] = ((cfg->VUV >> 8) & 0x0F) | ((cfg->VOV & 0x0F) << 4);
+        reg[3] = cfg->VOV >> 4;
+        reg[4] = cfg->DCC & 0xFF;
+        reg[5] = ((cfg->DCC >> 8) & 0x0F) | (cfg->DCTO << 4);
+        uint16_t pec = pec15(reg, LTC6811_REG_BYTE_COUNT);
+        reg[6] = pec >> 8;
+        reg[7] = pec & 0xFF;
+    }
+}
+
+// Write every dirty group until nothing is left
+static size_t flush(uint32_t now) {
+    size_t count = 0U;
+    while (ltc6811_shadow_encode(&shadow, now, out, &read_size) > 0U)
+        ++count;
+    return count;
+}
+
+void setUp(void) {
+    ltc6811_chain_init_devices(&chain, LTC_COUNT, devices);
+    ltc6811_shadow_init(&shadow, &chain, VERIFY_PERIOD, 0U);
+}
+
+void tearDown(void) {
+
+}
+
+void check_shadow_init_all_dirty(void) {
+    TEST_ASSERT_TRUE(ltc6811_shadow_is_dirty(&shadow, LTC6811_SHADOW_CFG));
+    TEST_ASSERT_TRUE(ltc6811_shadow_is_dirty(&shadow, LTC6811_SHADOW_PWM));
+    TEST_ASSERT_TRUE(ltc6811_shadow_is_dirty(&shadow, LTC6811_SHADOW_SCTRL));
+}
+
+void check_shadow_encode_order(void) {
+    size_t size = ltc6811_shadow_encode(&shadow, 0U, out, &read_size);
+    TEST_ASSERT_EQUAL_size_t(LTC6811_WRITE_BUFFER_SIZE(LTC_COUNT), size);
+    TEST_ASSERT_FALSE(ltc6811_shadow_is_dirty(&shadow, LTC6811_SHADOW_CFG));
+    TEST_ASSERT_TRUE(ltc6811_shadow_is_dirty(&shadow, LTC6811_SHADOW_PWM));
+
+    size = ltc6811_shadow_encode(&shadow, 0U, out, &read_size);
+    TEST_ASSERT_EQUAL_size_t(LTC6811_WRITE_BUFFER_SIZE(LTC_COUNT), size);
+    TEST_ASSERT_FALSE(ltc6811_shadow_is_dirty(&shadow, LTC6811_SHADOW_PWM));
+    TEST_ASSERT_TRUE(ltc6811_shadow_is_dirty(&shadow, LTC6811_SHADOW_SCTRL));
+
+    size = ltc6811_shadow_encode(&shadow, 0U, out, &read_size);
+    TEST_ASSERT_EQUAL_size_t(LTC6811_WRITE_BUFFER_SIZE(LTC_COUNT), size);
+    TEST_ASSERT_FALSE(ltc6811_shadow_is_dirty(&shadow, LTC6811_SHADOW_SCTRL));
+
+    TEST_ASSERT_EQUAL_size_t(0U, ltc6811_shadow_encode(&shadow, 0U, out, &read_size));
+    TEST_ASSERT_EQUAL_UINT32(3U, shadow.writes);
+    TEST_ASSERT_EQUAL_UINT32(1U, shadow.skipped);
+}
+
+void check_shadow_set_unchanged_not_dirty(void) {
+    flush(0U);
+    Ltc6811Cfgr cfg = devices[1].config;
+    TEST_ASSERT_FALSE(ltc6811_shadow_set_config(&shadow, 1U, &cfg));
+    TEST_ASSERT_FALSE(ltc6811_shadow_set_dcc(&shadow, 1U, devices[1].config.DCC));
+    uint8_t pwm[LTC6811_PWM_COUNT] = { 0 };
+    TEST_ASSERT_FALSE(ltc6811_shadow_set_pwm(&shadow, 1U, pwm));
+    TEST_ASSERT_FALSE(ltc6811_shadow_is_dirty(&shadow, LTC6811_SHADOW_CFG));
+    TEST_ASSERT_FALSE(ltc6811_shadow_is_dirty(&shadow, LTC6811_SHADOW_PWM));
+}
+
+void check_shadow_set_dcc_dirty(void) {
+    flush(0U);
+    TEST_ASSERT_TRUE(ltc6811_shadow_set_dcc(&shadow, 2U, 0x0421));
+    TEST_ASSERT_TRUE(ltc6811_shadow_is_dirty(&shadow, LTC6811_SHADOW_CFG));
+    TEST_ASSERT_FALSE(ltc6811_shadow_is_dirty(&shadow, LTC6811_SHADOW_PWM));
+    TEST_ASSERT_EQUAL_UINT16(0x0421, devices[2].config.DCC);
+    TEST_ASSERT_EQUAL_size_t(1U, flush(0U));
+}
+
+void check_shadow_set_config_ignore_dten(void) {
+    flush(0U);
+    Ltc6811Cfgr cfg = devices[0].config;
+    cfg.DTEN = 1U;
+    TEST_ASSERT_FALSE(ltc6811_shadow_set_config(&shadow, 0U, &cfg));
+    cfg.VUV = 0x123;
+    TEST_ASSERT_TRUE(ltc6811_shadow_set_config(&shadow, 0U, &cfg));
+    TEST_ASSERT_EQUAL_UINT8(0U, devices[0].config.DTEN);
+}
+
+void check_shadow_set_invalid_device(void) {
+    TEST_ASSERT_FALSE(ltc6811_shadow_set_dcc(&shadow, LTC_COUNT, 0x0001));
+    TEST_ASSERT_FALSE(ltc6811_shadow_set_dcc(NULL, 0U, 0x0001));
+}
+
+void check_shadow_set_pwm_mask(void) {
+    flush(0U);
+    uint8_t pwm[LTC6811_PWM_COUNT] = { 0 };
+    pwm[3] = 0xF7;
+    TEST_ASSERT_TRUE(ltc6811_shadow_set_pwm(&shadow, 3U, pwm));
+    TEST_ASSERT_EQUAL_UINT8(0x07, devices[3].pwm[3]);
+    TEST_ASSERT_TRUE(ltc6811_shadow_is_dirty(&shadow, LTC6811_SHADOW_PWM));
+    TEST_ASSERT_FALSE(ltc6811_shadow_is_dirty(&shadow, LTC6811_SHADOW_SCTRL));
+}
+
+void check_shadow_encode_wrcfg_bytes(void) {
+    flush(0U);
+    ltc6811_shadow_set_dcc(&shadow, 0U, 0x0003);
+    ltc6811_shadow_set_dcc(&shadow, 3U, 0x0800);
+
+    size_t size = ltc6811_shadow_encode(&shadow, 0U, out, &read_size);
+    size_t expected_size = ltc6811_chain_wrcfg_encode(&chain, expected);
+    TEST_ASSERT_EQUAL_size_t(expected_size, size);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, out, size);
+    TEST_ASSERT_EQUAL_size_t(0U, read_size);
+}
+
+void check_shadow_encode_wrpwm_bytes(void) {
+    flush(0U);
+    uint8_t pwm[LTC6811_PWM_COUNT] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 };
+    ltc6811_shadow_set_pwm(&shadow, 1U, pwm);
+
+    size_t size = ltc6811_shadow_encode(&shadow, 0U, out, &read_size);
+    size_t expected_size = ltc6811_chain_wrpwm_encode(&chain, expected);
+    TEST_ASSERT_EQUAL_size_t(expected_size, size);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, out, size);
+}
+
+void check_shadow_verify_after_period(void) {
+    flush(0U);
+    TEST_ASSERT_EQUAL_size_t(0U, ltc6811_shadow_encode(&shadow, VERIFY_PERIOD - 1U, out, &read_size));
+    TEST_ASSERT_FALSE(shadow.verify_pending);
+
+    size_t size = ltc6811_shadow_encode(&shadow, VERIFY_PERIOD, out, &read_size);
+    TEST_ASSERT_EQUAL_size_t(LTC6811_CMD_BYTE_COUNT + LTC6811_PEC_BYTE_COUNT, size);
+    TEST_ASSERT_EQUAL_size_t(LTC6811_DATA_BUFFER_SIZE(LTC_COUNT), read_size);
+    TEST_ASSERT_TRUE(shadow.verify_pending);
+
+    // The next verification waits for another period
+    TEST_ASSERT_EQUAL_size_t(0U, ltc6811_shadow_encode(&shadow, VERIFY_PERIOD + 1U, out, &read_size));
+}
+
+void check_shadow_verify_disabled(void) {
+    ltc6811_shadow_init(&shadow, &chain, 0U, 0U);
+    flush(0U);
+    TEST_ASSERT_EQUAL_size_t(0U, ltc6811_shadow_encode(&shadow, 10U * VERIFY_PERIOD, out, &read_size));
+    TEST_ASSERT_FALSE(shadow.verify_pending);
+}
+
+void check_shadow_verify_match(void) {
+    ltc6811_shadow_set_dcc(&shadow, 1U, 0x0055);
+    flush(0U);
+    ltc6811_shadow_encode(&shadow, VERIFY_PERIOD, out, &read_size);
+
+    uint8_t data[LTC6811_DATA_BUFFER_SIZE(LTC_COUNT)];
+    fill_rdcfg(data);
+    TEST_ASSERT_EQUAL_size_t(sizeof(data), ltc6811_shadow_decode(&shadow, data));
+    TEST_ASSERT_FALSE(shadow.verify_pending);
+    TEST_ASSERT_EQUAL_UINT32(0U, shadow.verify_errors);
+    TEST_ASSERT_FALSE(ltc6811_shadow_is_dirty(&shadow, LTC6811_SHADOW_CFG));
+}
+
+void check_shadow_verify_mismatch_dirty(void) {
+    flush(0U);
+    ltc6811_shadow_encode(&shadow, VERIFY_PERIOD, out, &read_size);
+
+    // Simulate a device that has been reset with a different configuration
+    uint8_t data[LTC6811_DATA_BUFFER_SIZE(LTC_COUNT)];
+    devices[2].config.DCC = 0x0001;
+    fill_rdcfg(data);
+    devices[2].config.DCC = 0x0000;
+
+    ltc6811_shadow_decode(&shadow, data);
+    TEST_ASSERT_EQUAL_UINT32(1U, shadow.verify_errors);
+    TEST_ASSERT_EQUAL_UINT8(1U << LTC6811_SHADOW_CFG, devices[2].dirty);
+    TEST_ASSERT_EQUAL_UINT8(0U, devices[1].dirty);
+    TEST_ASSERT_EQUAL_size_t(1U, flush(VERIFY_PERIOD));
+}
+
+void check_shadow_verify_ignore_read_only(void) {
+    flush(0U);
+    ltc6811_shadow_encode(&shadow, VERIFY_PERIOD, out, &read_size);
+
+    // GPIO and DCTO are read back as the pins and timer status
+    uint8_t data[LTC6811_DATA_BUFFER_SIZE(LTC_COUNT)];
+    devices[0].config.GPIO = 0x0A;
+    devices[0].config.DCTO = 0x03;
+    fill_rdcfg(data);
+    devices[0].config.GPIO = 0x00;
+    devices[0].config.DCTO = 0x00;
+
+    ltc6811_shadow_decode(&shadow, data);
+    TEST_ASSERT_EQUAL_UINT32(0U, shadow.verify_errors);
+}
+
+void check_shadow_verify_pec_error(void) {
+    flush(0U);
+    ltc6811_shadow_encode(&shadow, VERIFY_PERIOD, out, &read_size);
+
+    uint8_t data[LTC6811_DATA_BUFFER_SIZE(LTC_COUNT)];
+    fill_rdcfg(data);
+    data[DEVICE_BYTE_COUNT + 4] ^= 0x01;
+
+    TEST_ASSERT_EQUAL_size_t(sizeof(data) - DEVICE_BYTE_COUNT, ltc6811_shadow_decode(&shadow, data));
+    TEST_ASSERT_EQUAL_UINT32(0U, shadow.verify_errors);
+    TEST_ASSERT_EQUAL_UINT32(1U, devices[1].pec_errors);
+    TEST_ASSERT_EQUAL_UINT32(1U, chain.pec_errors);
+    TEST_ASSERT_FALSE(ltc6811_shadow_is_dirty(&shadow, LTC6811_SHADOW_CFG));
+}
+
+void check_shadow_decode_without_verify(void) {
+    uint8_t data[LTC6811_DATA_BUFFER_SIZE(LTC_COUNT)];
+    fill_rdcfg(data);
+    TEST_ASSERT_EQUAL_size_t(0U, ltc6811_shadow_decode(&shadow, data));
+}
+
+void check_shadow_invalidate(void) {
+    flush(0U);
+    ltc6811_shadow_invalidate(&shadow, 1U << LTC6811_SHADOW_SCTRL);
+    TEST_ASSERT_FALSE(ltc6811_shadow_is_dirty(&shadow, LTC6811_SHADOW_CFG));
+    TEST_ASSERT_TRUE(ltc6811_shadow_is_dirty(&shadow, LTC6811_SHADOW_SCTRL));
+    TEST_ASSERT_EQUAL_size_t(1U, flush(0U));
+}
+
+/**
+ * @brief Simulate a balancing loop that updates the discharge bits every 100ms
+ * while the balancing of a cell is toggled only every 5 seconds, comparing the
+ * bytes sent on the SPI bus writing everything every time with the shadow writes
+ */
+void check_shadow_bench_balancing(void) {
+    const uint32_t duration = 60000U;
+    const uint32_t period = 100U;
+    size_t naive_bytes = 0U, shadow_bytes = 0U;
+    size_t naive_writes = 0U;
+    Ltc6811Chain naive;
+    Ltc6811Device naive_devices[LTC_COUNT];
+    ltc6811_chain_init_devices(&naive, LTC_COUNT, naive_devices);
+
+    for (uint32_t now = 0U; now < duration; now += period) {
+        uint16_t dcc = (uint16_t)(1U << ((now / 5000U) % 12U));
+        uint8_t pwm[LTC6811_PWM_COUNT];
+        memset(pwm, 0x0F, sizeof(pwm));
+
+        // Write every register group every time
+        for (size_t i = 0; i < LTC_COUNT; ++i) {
+            naive_devices[i].config.DCC = dcc;
+            memcpy(naive_devices[i].pwm, pwm, sizeof(pwm));
+        }
+        naive_bytes += ltc6811_chain_wrcfg_encode(&naive, out);
+        naive_bytes += ltc6811_chain_wrpwm_encode(&naive, out);
+        naive_writes += 2U;
+
+        // Write only what has changed
+        for (size_t i = 0; i < LTC_COUNT; ++i) {
+            ltc6811_shadow_set_dcc(&shadow, i, dcc);
+            ltc6811_shadow_set_pwm(&shadow, i, pwm);
+        }
+        size_t size;
+        while ((size = ltc6811_shadow_encode(&shadow, now, out, &read_size)) > 0U) {
+            shadow_bytes += size + read_size;
+            if (read_size > 0U) {
+                uint8_t data[LTC6811_DATA_BUFFER_SIZE(LTC_COUNT)];
+                fill_rdcfg(data);
+                ltc6811_shadow_decode(&shadow, data);
+                break;
+            }
+        }
+    }
+
+    printf("[BENCH] balancing %lus with %d LTCs: naive %lu writes %lu bytes, shadow %lu writes %lu bytes (%lu verifications)\n",
+        (unsigned long)(duration / 1000U),
+        LTC_COUNT,
+        (unsigned long)naive_writes,
+        (unsigned long)naive_bytes,
+        (unsigned long)shadow.writes,
+        (unsigned long)shadow_bytes,
+        (unsigned long)(duration / VERIFY_PERIOD)
+    );
+    TEST_ASSERT_EQUAL_UINT32(0U, shadow.verify_errors);
+    TEST_ASSERT_LESS_THAN_size_t(naive_bytes, shadow_bytes);
+}
+
+int main() {
+    UNITY_BEGIN();
+
+    RUN_TEST(check_shadow_init_all_dirty);
+    RUN_TEST(check_shadow_encode_order);
+    RUN_TEST(check_shadow_set_unchanged_not_dirty);
+    RUN_TEST(check_shadow_set_dcc_dirty);
+    RUN_TEST(check_shadow_set_config_ignore_dten);
+    RUN_TEST(check_shadow_set_invalid_device);
+    RUN_TEST(check_shadow_set_pwm_mask);
+    RUN_TEST(check_shadow_encode_wrcfg_bytes);
+    RUN_TEST(check_shadow_encode_wrpwm_bytes);
+    RUN_TEST(check_shadow_verify_after_period);
+    RUN_TEST(check_shadow_verify_disabled);
+    RUN_TEST(check_shadow_verify_match);
+    RUN_TEST(check_shadow_verify_mismatch_dirty);
+    RUN_TEST(check_shadow_verify_ignore_read_only);
+    RUN_TEST(check_shadow_verify_pec_error);
+    RUN_TEST(check_shadow_decode_without_verify);
+    RUN_TEST(check_shadow_invalidate);
+    RUN_TEST(check_shadow_bench_balancing);
+
+    return UNITY_END();
+}
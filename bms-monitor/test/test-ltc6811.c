@@ -853,6 +853,20 @@ void check_adow_encode_broadcast_cmd_pec_bytes() {
     );
     TEST_ASSERT_EQUAL_HEX8_ARRAY(pec, out + LTC6811_CMD_BYTE_COUNT, LTC6811_PEC_BYTE_COUNT);
 }
+void check_adow_encode_broadcast_pup_inactive_cmd_bytes() {
+    Ltc6811Command command = ADOW | (LTC6811_MD_26HZ_2KHZ << 7) | (LTC6811_PUP_INACTIVE << 6) | (LTC6811_DCP_ENABLED << 4) | (LTC6811_CH_12);
+    uint8_t cmd[] = { command >> 8, command & 0xFF };
+    uint8_t out[LTC6811_POLL_BUFFER_SIZE(LTC_COUNT)];
+    ltc6811_adow_encode_broadcast(
+        &chain,
+        LTC6811_MD_26HZ_2KHZ,
+        LTC6811_PUP_INACTIVE,
+        LTC6811_DCP_ENABLED,
+        LTC6811_CH_12,
+        out
+    );
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(cmd, out, LTC6811_CMD_BYTE_COUNT);
+}
 
 void check_cvst_encode_broadcast_length() {
     uint8_t out[LTC6811_POLL_BUFFER_SIZE(LTC_COUNT)];
@@ -1586,6 +1600,7 @@ int main() {
     RUN_TEST(check_adow_encode_broadcast_length);
     RUN_TEST(check_adow_encode_broadcast_cmd_bytes);
     RUN_TEST(check_adow_encode_broadcast_cmd_pec_bytes);
+    RUN_TEST(check_adow_encode_broadcast_pup_inactive_cmd_bytes);
 
     // Start cell voltage ADC conversion self test and poll status broadcast encode
     RUN_TEST(check_cvst_encode_broadcast_length);
@@ -0,0 +1,149 @@
+/**
+ * @file test-ntc.c
+ * @brief Unit test for the NTC temperature conversion
+ *
+ * @date 18 Oct 2026
+ * @author Antonio Gelain [antonio.gelain2@gmail.com]
+ */
+
+#include "unity.h"
+#include "ntc.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+// Number of sensors used for the benchmark (five GPIOs for each LTC6811)
+#define BENCH_SENSOR_COUNT 600
+#define BENCH_ITERATIONS 2000
+
+// Maximum error allowed between the lookup table and the floating point model in hundredths of °C
+#define MAX_ERROR 10
+
+/** @brief Floating point conversion with the Beta model, as done by the projects before */
+static float ntc_code_to_temp_float(uint16_t code) {
+    float r = NTC_R_PULLUP * code / (NTC_VREF_CODE - code);
+    float inv_t = 1.0f / (NTC_T0 + 273.15f) + logf(r / NTC_R0) / NTC_BETA;
+    return 1.0f / inv_t - 273.15f;
+}
+
+static double elapsed_ns(struct timespec * start, struct timespec * end) {
+    return (end->tv_sec - start->tv_sec) * 1e9 + (end->tv_nsec - start->tv_nsec);
+}
+
+void setUp(void) {
+
+}
+
+void tearDown(void) {
+
+}
+
+void check_lut_nominal_temperature(void) {
+    // At 25°C the NTC resistance equals the pull-up resistance
+    uint16_t code = NTC_VREF_CODE / 2;
+    TEST_ASSERT_INT_WITHIN(5, 2500, ntc_code_to_temp(code));
+}
+
+void check_lut_accuracy(void) {
+    uint16_t min_code = ntc_temp_to_code(NTC_LUT_TEMP_MAX);
+    uint16_t max_code = ntc_temp_to_code(NTC_LUT_TEMP_MIN);
+    for (uint16_t code = min_code + 1; code < max_code; ++code) {
+        int32_t expected = (int32_t)lroundf(ntc_code_to_temp_float(code) * 100.0f);
+        TEST_ASSERT_INT_WITHIN(MAX_ERROR, expected, ntc_code_to_temp(code));
+    }
+}
+
+void check_lut_monotonic(void) {
+    int16_t prev = ntc_code_to_temp(0);
+    for (uint32_t code = 1; code <= UINT16_MAX; ++code) {
+        int16_t temp = ntc_code_to_temp(code);
+        TEST_ASSERT_LESS_OR_EQUAL_INT(prev, temp);
+        prev = temp;
+    }
+}
+
+void check_lut_saturation(void) {
+    TEST_ASSERT_EQUAL_INT16(NTC_LUT_TEMP_MAX, ntc_code_to_temp(0));
+    TEST_ASSERT_EQUAL_INT16(NTC_LUT_TEMP_MIN, ntc_code_to_temp(UINT16_MAX));
+    TEST_ASSERT_EQUAL_INT16(NTC_LUT_TEMP_MIN, ntc_code_to_temp(NTC_VREF_CODE));
+}
+
+void check_temp_to_code(void) {
+    for (int16_t temp = NTC_LUT_TEMP_MIN; temp <= NTC_LUT_TEMP_MAX; temp += NTC_LUT_TEMP_STEP)
+        TEST_ASSERT_INT_WITHIN(1, temp, ntc_code_to_temp(ntc_temp_to_code(temp)));
+}
+
+void check_bulk_with_null(void) {
+    uint16_t codes[1] = { 0 };
+    int16_t temps[1];
+    TEST_ASSERT_EQUAL_size_t(0U, ntc_code_to_temp_bulk(NULL, 1, temps));
+    TEST_ASSERT_EQUAL_size_t(0U, ntc_code_to_temp_bulk(codes, 1, NULL));
+}
+
+void check_bulk(void) {
+    uint16_t codes[] = { 25000, 20000, 15000, 10000, 5000 };
+    int16_t temps[5];
+    TEST_ASSERT_EQUAL_size_t(5U, ntc_code_to_temp_bulk(codes, 5, temps));
+    for (size_t i = 0; i < 5; ++i)
+        TEST_ASSERT_EQUAL_INT16(ntc_code_to_temp(codes[i]), temps[i]);
+}
+
+void benchmark_throughput(void) {
+    static uint16_t codes[BENCH_SENSOR_COUNT];
+    static int16_t temps[BENCH_SENSOR_COUNT];
+    static float temps_float[BENCH_SENSOR_COUNT];
+    uint32_t seed = 1;
+    for (size_t i = 0; i < BENCH_SENSOR_COUNT; ++i) {
+        seed = seed * 1664525U + 1013904223U;
+        // Temperatures between about 10°C and 70°C
+        codes[i] = 6000 + (seed >> 16) % 16000;
+    }
+
+    struct timespec start, end;
+    volatile int32_t sink = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t it = 0; it < BENCH_ITERATIONS; ++it) {
+        ntc_code_to_temp_bulk(codes, BENCH_SENSOR_COUNT, temps);
+        sink += temps[it % BENCH_SENSOR_COUNT];
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double lut_ns = elapsed_ns(&start, &end) / ((double)BENCH_ITERATIONS * BENCH_SENSOR_COUNT);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t it = 0; it < BENCH_ITERATIONS; ++it) {
+        for (size_t i = 0; i < BENCH_SENSOR_COUNT; ++i)
+            temps_float[i] = ntc_code_to_temp_float(codes[i]);
+        sink += (int32_t)temps_float[it % BENCH_SENSOR_COUNT];
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double float_ns = elapsed_ns(&start, &end) / ((double)BENCH_ITERATIONS * BENCH_SENSOR_COUNT);
+
+    for (size_t i = 0; i < BENCH_SENSOR_COUNT; ++i)
+        TEST_ASSERT_INT_WITHIN(MAX_ERROR, lroundf(temps_float[i] * 100.0f), temps[i]);
+
+    printf(
+        "[BENCH] %d sensors: lookup table %.1f ns/sensor, float %.1f ns/sensor (x%.2f)\n",
+        BENCH_SENSOR_COUNT,
+        lut_ns,
+        float_ns,
+        float_ns / lut_ns
+    );
+    (void)sink;
+}
+
+int main() {
+    UNITY_BEGIN();
+
+    RUN_TEST(check_lut_nominal_temperature);
+    RUN_TEST(check_lut_accuracy);
+    RUN_TEST(check_lut_monotonic);
+    RUN_TEST(check_lut_saturation);
+    RUN_TEST(check_temp_to_code);
+    RUN_TEST(check_bulk_with_null);
+    RUN_TEST(check_bulk);
+    RUN_TEST(benchmark_throughput);
+
+    UNITY_END();
+}
@@ -1,19 +1,33 @@
-#include "stdlib.h"
+#include "stddef.h"
 #include "can_fifo_queue.h"
+#include "can_fifo_queue_static.h"
 
 
 typedef struct _CANFQ_QueueTypeDef {
-	uint8_t head, tail;
-	CAN_MessageTypeDef queue[CANFQ_SIZE];
+	bool used;
+	CANFQS_QueueTypeDef fifo;
+	CANFQS_MessageTypeDef storage[CANFQ_SIZE];
 } _CANFQ_QueueTypeDef;
 
+static _CANFQ_QueueTypeDef _CANFQ_pool[CANFQ_MAX_QUEUES];
+
 /**
- * @brief Initialize a new FIFO queue
- * @param fifo The queue to initialize
+ * @brief Initialize a new FIFO queue of CANFQ_SIZE - 1 messages
+ * @param fifo The queue to initialize, NULL if all the CANFQ_MAX_QUEUES queues are used
  * */
 void CANFQ_init(_CANFQ_QueueTypeDef ** fifo) {
-    (*fifo) = malloc(sizeof(_CANFQ_QueueTypeDef));
-	(*fifo)->head = (*fifo)->tail = 0;
+	(*fifo) = NULL;
+	for (int i = 0; i < CANFQ_MAX_QUEUES; i++) {
+		if (!_CANFQ_pool[i].used) {
+			(*fifo) = &_CANFQ_pool[i];
+			break;
+		}
+	}
+	if ((*fifo) == NULL)
+		return;
+
+	(*fifo)->used = true;
+	CANFQS_init(&(*fifo)->fifo, (*fifo)->storage, CANFQ_SIZE);
 }
 
 /**
@@ -21,7 +35,10 @@ void CANFQ_init(_CANFQ_QueueTypeDef ** fifo) {
  * @param fifo The queue to destroy
  * */
 void CANFQ_destroy(_CANFQ_QueueTypeDef ** fifo) {
-    free(*fifo);
+	if ((*fifo) == NULL)
+		return;
+	(*fifo)->used = false;
+	(*fifo) = NULL;
 }
 
 /**
@@ -30,7 +47,7 @@ void CANFQ_destroy(_CANFQ_QueueTypeDef ** fifo) {
  * @retval True if empty, false otherwise
  * */
 bool CANFQ_is_empty(_CANFQ_QueueTypeDef * fifo) {
-	return fifo->head == fifo->tail;
+	return CANFQS_is_empty(&fifo->fifo);
 }
 
 /**
@@ -39,7 +56,7 @@ bool CANFQ_is_empty(_CANFQ_QueueTypeDef * fifo) {
  * @retval True if full, false otherwise
  * */
 bool CANFQ_is_full(_CANFQ_QueueTypeDef * fifo) {
-	return (fifo->head + 1) % CANFQ_SIZE == fifo->tail;
+	return CANFQS_is_full(&fifo->fifo);
 }
 
 /**
@@ -49,41 +66,33 @@ bool CANFQ_is_full(_CANFQ_QueueTypeDef * fifo) {
  * @return True on success, false on error (empty queue)
  * */
 bool CANFQ_pop(_CANFQ_QueueTypeDef * fifo, CAN_MessageTypeDef * msg) {
-	if (CANFQ_is_empty(fifo))
+	CANFQS_MessageTypeDef curr;
+	if (!CANFQS_pop(&fifo->fifo, &curr))
 		return false;
 
 	/* Copy node contents to output parameter */
-	CAN_MessageTypeDef * curr = &fifo->queue[fifo->tail];
-	msg->id = curr->id;
-	msg->size = curr->size;
-	msg->hcan  = curr->hcan;
-	for (int i = 0; i < curr->size; i++)
-		msg->data[i] = curr->data[i];
-	
-	/* Increment tail */
-	fifo->tail = (fifo->tail + 1) % CANFQ_SIZE;
+	msg->id = curr.id;
+	msg->size = curr.size;
+	msg->hcan  = curr.hcan;
+	for (int i = 0; i < curr.size; i++)
+		msg->data[i] = curr.data[i];
 	return true;
 }
 
 /**
  * @brief Push a new CAN message into the FIFO queue
  * @param fifo The FIFO queue in which to push
- * @param msg The message to be pushed
+ * @param msg The message to be pushed, its data values are truncated to 8 bits
  * @return True on success, false on error (full queue)
  * */
 bool CANFQ_push(_CANFQ_QueueTypeDef * fifo, CAN_MessageTypeDef * msg) {
-	if (CANFQ_is_full(fifo))
-		return false;
-	
-	/* Copy the message contents into the queue node */
-	CAN_MessageTypeDef * curr = &fifo->queue[fifo->head];
-	curr->id = msg->id;
-	curr->size = msg->size;
-	curr->hcan = msg->hcan;
-	for (int i = 0; i < msg->size; i++)
-		curr->data[i] = msg->data[i];
-	
-	/* Increment head */
-	fifo->head = (fifo->head + 1) % CANFQ_SIZE;
-	return true;
+	/* Copy the message contents into the compact message */
+	CANFQS_MessageTypeDef curr;
+	curr.id = msg->id;
+	curr.size = msg->size > 8 ? 8 : msg->size;
+	curr.hcan = msg->hcan;
+	for (int i = 0; i < curr.size; i++)
+		curr.data[i] = msg->data[i];
+
+	return CANFQS_push(&fifo->fifo, &curr);
 }
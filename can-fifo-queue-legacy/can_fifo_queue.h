@@ -7,6 +7,12 @@
  * struct containing three uint16 fields: id, size, and a vector of data values.
  * The queue guarantees First-In-First-Out priority to messages, meaning the first
  * item to be pushed, will be the first to be returned when invoking a pop.
+ *
+ * This API is kept for the existing code: the queues are taken from a static
+ * pool of CANFQ_MAX_QUEUES can_fifo_queue_static.h queues, without malloc.
+ * CANFQ_init sets the handle to NULL when all of them are used, so the
+ * handle must be checked before pushing or popping (CANFQ_destroy accepts a
+ * NULL handle). New code should use can_fifo_queue_static.h directly.
  * */
 
 #ifndef _CAN_FIFO_H
@@ -32,6 +38,11 @@
 
 #define CANFQ_SIZE 100
 
+/* Number of queues that can be initialized at the same time */
+#ifndef CANFQ_MAX_QUEUES
+#define CANFQ_MAX_QUEUES 4
+#endif
+
 typedef struct _CANFQ_QueueTypeDef * CANFQ_QueueTypeDef;
 
 void CANFQ_init(CANFQ_QueueTypeDef *);
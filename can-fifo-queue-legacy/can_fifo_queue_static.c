@@ -0,0 +1,77 @@
+#include "string.h"
+#include "can_fifo_queue_static.h"
+
+
+/* The index written by the other context is read with acquire, the own one is published with release */
+#define _CANFQS_LOAD(x) __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define _CANFQS_STORE(x, v) __atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+
+/**
+ * @brief Next slot after i, without a division
+ * */
+static inline uint16_t _CANFQS_next(CANFQS_QueueTypeDef * fifo, uint16_t i) {
+	return i + 1 == fifo->slots ? 0 : i + 1;
+}
+
+/**
+ * @brief Initialize a FIFO queue, not needed for the queues declared with CANFQS_DEFINE
+ * @param fifo The queue to initialize
+ * @param storage The array of messages, used for capacity + 1 messages
+ * @param slots The length of the storage array (CANFQS_SLOTS(capacity))
+ * */
+void CANFQS_init(CANFQS_QueueTypeDef * fifo, CANFQS_MessageTypeDef * storage, uint16_t slots) {
+	fifo->head = fifo->tail = 0;
+	fifo->slots = slots;
+	fifo->queue = storage;
+}
+
+/**
+ * @brief Checks if the queue is empty
+ * @param fifo The queue to inspect
+ * @retval True if empty, false otherwise
+ * */
+bool CANFQS_is_empty(CANFQS_QueueTypeDef * fifo) {
+	return _CANFQS_LOAD(fifo->head) == _CANFQS_LOAD(fifo->tail);
+}
+
+/**
+ * @brief Checks if the queue is full
+ * @param fifo The queue to inspect
+ * @retval True if full, false otherwise
+ * */
+bool CANFQS_is_full(CANFQS_QueueTypeDef * fifo) {
+	return _CANFQS_next(fifo, _CANFQS_LOAD(fifo->head)) == _CANFQS_LOAD(fifo->tail);
+}
+
+/**
+ * @brief Pop the oldest CAN message from the FIFO queue, only one context may pop
+ * @param fifo The FIFO queue from which to pop
+ * @param msg Where to store the popped message
+ * @return True on success, false on error (empty queue)
+ * */
+bool CANFQS_pop(CANFQS_QueueTypeDef * fifo, CANFQS_MessageTypeDef * msg) {
+	uint16_t tail = fifo->tail;
+	if (tail == _CANFQS_LOAD(fifo->head))
+		return false;
+
+	memcpy(msg, &fifo->queue[tail], sizeof(CANFQS_MessageTypeDef));
+	_CANFQS_STORE(fifo->tail, _CANFQS_next(fifo, tail));
+	return true;
+}
+
+/**
+ * @brief Push a new CAN message into the FIFO queue, only one context may push
+ * @param fifo The FIFO queue in which to push
+ * @param msg The message to be pushed
+ * @return True on success, false on error (full queue)
+ * */
+bool CANFQS_push(CANFQS_QueueTypeDef * fifo, const CANFQS_MessageTypeDef * msg) {
+	uint16_t head = fifo->head;
+	uint16_t next = _CANFQS_next(fifo, head);
+	if (next == _CANFQS_LOAD(fifo->tail))
+		return false;
+
+	memcpy(&fifo->queue[head], msg, sizeof(CANFQS_MessageTypeDef));
+	_CANFQS_STORE(fifo->head, next);
+	return true;
+}
@@ -0,0 +1,66 @@
+/**
+ * @file can_fifo_queue_static.h
+ * @author Alessandro Sartori
+ * @brief A FIFO queue of CAN messages in memory provided by the caller.
+ *
+ * Same push/pop API of can_fifo_queue.h without malloc: the messages are
+ * stored in a static array of compact CANFQS_MessageTypeDef (8-bit payload,
+ * 12 bytes each). One context (e.g. the CAN RX interrupt) can push while
+ * another one (e.g. the main loop) pops, without locks: push writes only the
+ * head index, pop only the tail index, and an index is published after the
+ * message is copied. One slot of the array is always left empty.
+ *
+ * Declare a queue of 64 messages with static storage:
+ *
+ *     CANFQS_DEFINE(can_rx_queue, 64);
+ *
+ *     // CAN RX interrupt
+ *     CANFQS_push(&can_rx_queue, &msg);
+ *
+ *     // Main loop
+ *     while (CANFQS_pop(&can_rx_queue, &msg))
+ *         handle(&msg);
+ * */
+
+#ifndef _CAN_FIFO_STATIC_H
+#define _CAN_FIFO_STATIC_H
+
+#include "inttypes.h"
+#include "stdbool.h"
+
+
+typedef struct {
+    uint16_t id;
+    uint8_t hcan;       /* CAN bus index */
+    uint8_t size;       /* Number of bytes of data, up to 8 */
+    uint8_t data[8];
+} CANFQS_MessageTypeDef;
+
+typedef struct {
+    uint16_t head;      /* Next slot to push, written only by push */
+    uint16_t tail;      /* Next slot to pop, written only by pop */
+    uint16_t slots;     /* Length of the storage array, capacity + 1 */
+    CANFQS_MessageTypeDef * queue;
+} CANFQS_QueueTypeDef;
+
+/**
+ * @brief Length of the storage array of a queue of capacity messages
+ * */
+#define CANFQS_SLOTS(capacity) ((capacity) + 1)
+
+/**
+ * @brief Declare a queue of capacity messages and its storage, already initialized
+ * @param name The name of the CANFQS_QueueTypeDef variable
+ * @param capacity The maximum number of messages (less than 65535)
+ * */
+#define CANFQS_DEFINE(name, capacity) \
+    static CANFQS_MessageTypeDef name##_storage[CANFQS_SLOTS(capacity)]; \
+    static CANFQS_QueueTypeDef name = {0, 0, CANFQS_SLOTS(capacity), name##_storage}
+
+void CANFQS_init(CANFQS_QueueTypeDef *, CANFQS_MessageTypeDef * storage, uint16_t slots);
+bool CANFQS_is_empty(CANFQS_QueueTypeDef *);
+bool CANFQS_is_full(CANFQS_QueueTypeDef *);
+bool CANFQS_pop(CANFQS_QueueTypeDef *, CANFQS_MessageTypeDef *);
+bool CANFQS_push(CANFQS_QueueTypeDef *, const CANFQS_MessageTypeDef *);
+
+#endif
@@ -22,6 +22,23 @@ MunitTest tests[] = {
         test_fifo_order,
         NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL
     }, 
+    {
+        "/test-static-capacity",
+        test_static_capacity,
+        NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL
+    }, {
+        "/test-static-fifo-wrap",
+        test_static_fifo_wrap,
+        NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL
+    }, {
+        "/test-static-spsc",
+        test_static_spsc,
+        NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL
+    }, {
+        "/test-legacy-pool",
+        test_legacy_pool,
+        NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL
+    },
 
     /* Mark the end of the array with a NULL test function */
     { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
@@ -8,4 +8,9 @@ MunitResult test_is_empty(const MunitParameter *, void *);
 MunitResult test_is_full(const MunitParameter *, void *);
 MunitResult test_fifo_order(const MunitParameter *, void *);
 
+MunitResult test_static_capacity(const MunitParameter *, void *);
+MunitResult test_static_fifo_wrap(const MunitParameter *, void *);
+MunitResult test_static_spsc(const MunitParameter *, void *);
+MunitResult test_legacy_pool(const MunitParameter *, void *);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,132 @@
+#define _POSIX_C_SOURCE 200112L
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define MUNIT_ENABLE_ASSERT_ALIASES
+#include "../../munit/munit.h"
+#include "tests.h"
+
+#include "../can_fifo_queue.h"
+#include "../can_fifo_queue_static.h"
+
+
+CANFQS_DEFINE(test_queue, 16);
+
+MunitResult test_static_capacity(const MunitParameter * params, void * data) {
+    CANFQS_init(&test_queue, test_queue_storage, CANFQS_SLOTS(16));
+    CANFQS_MessageTypeDef m = {1, 0, 2, {1, 2}};
+
+    assert_true(CANFQS_is_empty(&test_queue));
+    for (int i = 0; i < 16; i++) {
+        assert_false(CANFQS_is_full(&test_queue));
+        assert_true(CANFQS_push(&test_queue, &m));
+    }
+    assert_true(CANFQS_is_full(&test_queue));
+    assert_false(CANFQS_push(&test_queue, &m));
+
+    for (int i = 0; i < 16; i++)
+        assert_true(CANFQS_pop(&test_queue, &m));
+    assert_true(CANFQS_is_empty(&test_queue));
+    assert_false(CANFQS_pop(&test_queue, &m));
+
+    return MUNIT_OK;
+}
+
+MunitResult test_static_fifo_wrap(const MunitParameter * params, void * data) {
+    CANFQS_init(&test_queue, test_queue_storage, CANFQS_SLOTS(16));
+    int pushed = 0, popped = 0;
+
+    /* Push and pop bursts of different lengths, many times across the end of the array */
+    for (int round = 0; round < 50; round++) {
+        for (int i = 0; i < round % 11 + 1; i++) {
+            CANFQS_MessageTypeDef m = {pushed, pushed % 2, pushed % 9, {0}};
+            for (int j = 0; j < m.size; j++)
+                m.data[j] = pushed + j;
+            if (!CANFQS_push(&test_queue, &m))
+                break;
+            pushed++;
+        }
+        assert_int(pushed - popped, <=, 16);
+
+        CANFQS_MessageTypeDef m;
+        for (int i = 0; i < round % 7 + 1 && CANFQS_pop(&test_queue, &m); i++) {
+            assert_int(m.id, ==, popped);
+            assert_int(m.hcan, ==, popped % 2);
+            assert_int(m.size, ==, popped % 9);
+            for (int j = 0; j < m.size; j++)
+                assert_int(m.data[j], ==, (uint8_t)(popped + j));
+            popped++;
+        }
+    }
+
+    return MUNIT_OK;
+}
+
+#define SPSC_MESSAGES 100000
+
+static void * _spsc_producer(void * arg) {
+    for (int i = 0; i < SPSC_MESSAGES; i++) {
+        CANFQS_MessageTypeDef m = {i, 0, 8, {i, i >> 8, i >> 16}};
+        while (!CANFQS_push(&test_queue, &m))
+            sched_yield();
+    }
+    return NULL;
+}
+
+MunitResult test_static_spsc(const MunitParameter * params, void * data) {
+    CANFQS_init(&test_queue, test_queue_storage, CANFQS_SLOTS(16));
+
+    /* One thread pushes as the CAN interrupt would, this one pops as the main loop */
+    pthread_t producer;
+    pthread_create(&producer, NULL, _spsc_producer, NULL);
+    int errors = 0;
+    for (int i = 0; i < SPSC_MESSAGES; i++) {
+        CANFQS_MessageTypeDef m;
+        while (!CANFQS_pop(&test_queue, &m))
+            sched_yield();
+        if (m.id != (uint16_t)i || m.data[0] != (uint8_t)i || m.data[1] != (uint8_t)(i >> 8) || m.data[2] != (uint8_t)(i >> 16))
+            errors++;
+    }
+    pthread_join(producer, NULL);
+
+    assert_int(errors, ==, 0);
+    assert_true(CANFQS_is_empty(&test_queue));
+    return MUNIT_OK;
+}
+
+MunitResult test_legacy_pool(const MunitParameter * params, void * data) {
+    CANFQ_QueueTypeDef q[CANFQ_MAX_QUEUES + 1];
+
+    for (int i = 0; i < CANFQ_MAX_QUEUES; i++) {
+        CANFQ_init(&q[i]);
+        assert_not_null(q[i]);
+    }
+    CANFQ_init(&q[CANFQ_MAX_QUEUES]);
+    assert_null(q[CANFQ_MAX_QUEUES]);
+    CANFQ_destroy(&q[CANFQ_MAX_QUEUES]);
+
+    /* A destroyed queue can be taken again, empty */
+    CAN_MessageTypeDef m = {0x123, 1, 2, {0x1AB, 0xCD}};
+    assert_true(CANFQ_push(q[0], &m));
+    CANFQ_destroy(&q[0]);
+    assert_null(q[0]);
+    CANFQ_init(&q[0]);
+    assert_not_null(q[0]);
+    assert_true(CANFQ_is_empty(q[0]));
+
+    /* The data values are stored on 8 bits */
+    assert_true(CANFQ_push(q[0], &m));
+    CAN_MessageTypeDef out;
+    assert_true(CANFQ_pop(q[0], &out));
+    assert_int(out.id, ==, 0x123);
+    assert_int(out.hcan, ==, 1);
+    assert_int(out.size, ==, 2);
+    assert_int(out.data[0], ==, 0xAB);
+    assert_int(out.data[1], ==, 0xCD);
+
+    for (int i = 0; i < CANFQ_MAX_QUEUES; i++)
+        CANFQ_destroy(&q[i]);
+    return MUNIT_OK;
+}
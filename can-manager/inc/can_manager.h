@@ -13,6 +13,13 @@
 #include "can_manager_can_types.h"
 #include "can_manager_config.h"
 
+#if defined(CAN_MGR_RX_QUEUE_SIZE) && CAN_MGR_RX_QUEUE_SIZE > 0
+#include "ring-buffer.h"
+#endif
+#if defined(CAN_MGR_TX_QUEUE_SIZE) && CAN_MGR_TX_QUEUE_SIZE > 0
+#include "min-heap.h"
+#endif
+
 #ifndef CAN_MGR_STM32_APPLICATION
 #include "can_manager_type_mocking.h"
 #else
@@ -25,6 +32,321 @@ extern HAL_StatusTypeDef can_mgr_hal_code;
 
 int can_mgr_init(CAN_HandleTypeDef *hcan);
 int can_mgr_config(int can_id, CAN_FilterTypeDef *hfilter, uint32_t its, uint32_t rx_fifo_assignment, can_mgr_msg_t *message_states, uint8_t *message_is_new, size_t message_states_size);
+/**
+ * @brief Enable the consistent reads of the message states with can_mgr_read
+ * @details Each message state gets a sequence counter that the interrupt
+ * callback increments before and after writing the state, so that the reader
+ * can detect a write that happened during the copy without disabling the
+ * interrupts
+ * @attention Must be called after can_mgr_config, the message_seq array must
+ * have the same size of the message states
+ * @param message_seq The sequence counters or NULL to disable them
+ */
+int can_mgr_config_seq(int can_id, uint32_t *message_seq);
+/**
+ * @brief Copy a consistent snapshot of a message state and clear its new flag
+ * @details The copy is retried at most CAN_MGR_READ_MAX_RETRIES times if the
+ * state is written by the interrupt callback in the meantime
+ * @return 1 if the message was new, 0 if it was already read, -1 on error
+ */
+int can_mgr_read(int can_id, int index, can_mgr_msg_t *out);
+/**
+ * @brief Get the index of the message state of a received message
+ * @details If CAN_MGR_ID_TABLE_SIZE is greater than 0 the lookup table filled
+ * by can_mgr_config is used, otherwise the user-defined
+ * can_mgr_from_id_to_index is called
+ * @return The index of the message state or -1 if the message is ignored
+ */
+int can_mgr_id_to_index(int can_id, int msg_id);
 void can_mgr_it_callback(CAN_HandleTypeDef *hcan, uint32_t rx_fifo_assignment, can_mgr_msg_t *mock_msg);
 
+#if defined(CAN_MGR_FD_ENABLED) && CAN_MGR_FD_ENABLED > 0
+/**
+ * @brief Use variable length message states (extended IDs and CAN FD payloads)
+ * instead of the ones given to can_mgr_config
+ * @details The payload of a received message is copied by the HAL straight into
+ * the data buffer of its state; the extended IDs are given to
+ * can_mgr_from_id_to_index with CAN_MGR_EXT_ID_FLAG set. Messages larger than
+ * the capacity of their state are discarded
+ * @attention Must be called after can_mgr_config, each state needs a buffer of
+ * at least 8 bytes (the bxCAN HAL always writes 8 bytes)
+ */
+int can_mgr_config_fd(int can_id, can_mgr_fd_msg_t *message_states, uint8_t *message_is_new, size_t message_states_size);
+/**
+ * @brief Copy a consistent snapshot of a variable length message state into
+ * the buffer of out and clear its new flag, see can_mgr_read; on error (e.g.
+ * a buffer too small) the message stays new
+ * @return 1 if the message was new, 0 if it was already read, -1 on error
+ */
+int can_mgr_read_fd(int can_id, int index, can_mgr_fd_msg_t *out);
+#endif
+
+/** @brief Result of the filter optimization */
+typedef struct {
+  size_t banks;             // Filter banks used
+  size_t list_entries;      // IDs accepted by list mode entries
+  size_t mask_entries;      // Mask mode entries
+  size_t accepted;          // Standard IDs accepted by the filters
+  size_t false_accepts;     // Accepted IDs that are not wanted
+  float false_accept_ratio; // false_accepts / accepted
+} can_mgr_filter_report_t;
+
+#ifndef CAN_MGR_FILTER_MAX_IDS
+#define CAN_MGR_FILTER_MAX_IDS 128
+#endif
+
+/**
+ * IDs accepted by a single filter entry: the bits set in the mask must be
+ * equal to the ones of id, a full mask is a single ID (list mode entry)
+ */
+typedef struct {
+  uint16_t id;
+  uint16_t mask;
+} _can_mgr_filter_group_t;
+
+/**
+ * @brief Working memory of can_mgr_filter_optimize, needed only during the
+ * call (e.g. a local variable of the configuration code)
+ */
+typedef struct {
+  // Used internally by the optimizer
+  uint8_t wanted[0x800 / 8];
+  uint16_t ids[CAN_MGR_FILTER_MAX_IDS];
+  _can_mgr_filter_group_t groups[CAN_MGR_FILTER_MAX_IDS];
+} can_mgr_filter_scratch_t;
+
+/**
+ * @brief Compute the filter banks (16-bit scale) that accept the given
+ * standard IDs with the least number of unwanted IDs
+ * @details If the IDs do not fit in list mode entries (4 for each bank) the
+ * closest ones are merged into mask mode entries (2 for each bank) until they
+ * fit in max_banks banks; at most CAN_MGR_FILTER_MAX_IDS distinct IDs
+ * @param filters Array of at least max_banks filters, to be given to
+ * can_mgr_config_filters
+ * @param first_bank Number of the first bank (e.g. SlaveStartFilterBank for
+ * the second peripheral)
+ * @param fifo The receive FIFO of the filters
+ * @param report The false accepts of the filters (can be NULL)
+ * @param scratch Working memory, the function holds no static state and can be
+ * called from different contexts with different buffers
+ * @return The number of banks used or -1 on error
+ */
+int can_mgr_filter_optimize(const uint16_t *ids, size_t ids_size, CAN_FilterTypeDef *filters, size_t max_banks, uint32_t first_bank, uint32_t fifo, can_mgr_filter_report_t *report, can_mgr_filter_scratch_t *scratch);
+/**
+ * @brief Configure multiple filter banks of a peripheral
+ */
+int can_mgr_config_filters(int can_id, CAN_FilterTypeDef *filters, size_t count);
+
+#if defined(CAN_MGR_TX_QUEUE_SIZE) && CAN_MGR_TX_QUEUE_SIZE > 0
+/**
+ * @brief Move the queued messages into the free transmit mailboxes
+ * @details With CAN_MGR_TX_QUEUE_SIZE greater than 0 can_mgr_send never waits
+ * for a free mailbox, the message is queued and sent in order of priority
+ * (lowest ID first) as soon as a mailbox is free; this function must be
+ * called from HAL_CAN_TxMailbox0/1/2CompleteCallback (and the abort callbacks)
+ */
+void can_mgr_tx_it_callback(CAN_HandleTypeDef *hcan);
+/**
+ * @brief Get the number of messages waiting for a free transmit mailbox
+ * @return The number of queued messages or -1 on error
+ */
+int can_mgr_tx_queue_size(int can_id);
+#endif
+
+#if defined(CAN_MGR_SCHEDULE_WHEEL_SIZE) && CAN_MGR_SCHEDULE_WHEEL_SIZE > 0
+/**
+ * @brief Periodic message of a schedule table
+ * @details The period and the offset are expressed in ticks of
+ * can_mgr_schedule_tick; fill is called when the message is due to write its
+ * payload (ID and size are already set) and can return a value different from
+ * 0 to skip that transmission, if NULL the message is sent with zeroed data
+ */
+typedef struct {
+  uint16_t id;
+  uint8_t size;
+  uint32_t period;
+  uint32_t offset;
+  int (*fill)(can_mgr_msg_t *msg);
+  // Used internally by the scheduler
+  uint32_t _due;
+  int16_t _next;
+} can_mgr_schedule_entry_t;
+
+typedef struct {
+  uint32_t window;            // Number of ticks analyzed (the hyperperiod)
+  uint32_t max_burst;         // Maximum number of messages due in the same tick
+  uint32_t max_burst_time_us; // Bus time needed by the largest burst
+  float utilization;          // Fraction of the bus bandwidth used
+} can_mgr_schedule_stats_t;
+
+/**
+ * @brief Set the schedule table of the periodic messages of a peripheral
+ * @attention The table is used (and modified) by the scheduler until it is
+ * replaced, it must not be a local variable
+ * @param now The current tick, the messages are first sent at now + offset
+ */
+int can_mgr_schedule_config(int can_id, can_mgr_schedule_entry_t *table, size_t size, uint32_t now);
+/**
+ * @brief Send all the periodic messages that are due
+ * @details Only the messages in the timer wheel slots of the elapsed ticks are
+ * visited, the due messages are sent in batches with can_mgr_send_n; a message
+ * that is late because some ticks were missed is sent only once
+ * @param now The current tick (e.g. HAL_GetTick())
+ * @return The number of messages sent or queued or -1 on error
+ */
+int can_mgr_schedule_tick(int can_id, uint32_t now);
+/**
+ * @brief Compute the offsets of a schedule table to spread the bus load
+ * @details The offsets are chosen to minimize the number of bits sent in the
+ * same tick, the result is exact when the periods divide
+ * CAN_MGR_SCHEDULE_WHEEL_SIZE; uses CAN_MGR_SCHEDULE_WHEEL_SIZE * 4 bytes of
+ * stack and can be called from different contexts
+ * @attention Must be called before can_mgr_schedule_config, a table currently
+ * given to can_mgr_schedule_config is rejected
+ */
+int can_mgr_schedule_balance(can_mgr_schedule_entry_t *table, size_t size);
+/**
+ * @brief Compute the worst case burst and the bus utilization of a schedule
+ * table (e.g. in a host test to check a new table)
+ * @param tick_us Duration of a tick in microseconds
+ * @param bitrate Bit rate of the bus in bit/s
+ */
+int can_mgr_schedule_stats(const can_mgr_schedule_entry_t *table, size_t size, uint32_t tick_us, uint32_t bitrate, can_mgr_schedule_stats_t *stats);
+#endif
+
+#if defined(CAN_MGR_STATS_ENABLED) && CAN_MGR_STATS_ENABLED > 0
+/** @brief Counters of a peripheral */
+typedef struct {
+  uint32_t rx_frames;
+  uint32_t tx_frames;
+  uint32_t unknown_ids;   // Received messages ignored (index < 0)
+  uint32_t out_of_bound;  // Received messages with an index out of the message states
+  uint32_t overwritten;   // Message states written again before being read
+  uint32_t fifo_overruns; // Messages lost by the hardware receive FIFOs
+  uint16_t bus_load;      // Estimated bus load of the last window (per mille)
+  uint16_t max_bus_load;  // Highest bus load since the last reset (per mille)
+} can_mgr_stats_t;
+
+/** @brief Reception statistics of a single message state */
+typedef struct {
+  uint32_t id;
+  uint32_t count;
+  uint32_t last_us;
+  uint32_t min_period_us;
+  uint32_t max_period_us;
+  uint64_t sum_period_us; // Average period is sum_period_us / (count - 1)
+} can_mgr_id_stats_t;
+
+/**
+ * @brief Get the current time in microseconds for the statistics
+ * @details Weakly defined (HAL_GetTick based on STM32), should be re-defined
+ * with a microsecond timer to get meaningful inter-arrival times
+ */
+uint32_t can_mgr_stats_get_time_us(void);
+/**
+ * @brief Reset the statistics of a peripheral and set where the per message
+ * statistics are stored
+ * @attention Must be called after can_mgr_config, the id_stats array must
+ * have the same size of the message states
+ * @param id_stats The per message statistics or NULL to disable them
+ * @param bitrate Bit rate of the bus in bit/s, used to estimate the bus load
+ */
+int can_mgr_config_stats(int can_id, can_mgr_id_stats_t *id_stats, uint32_t bitrate);
+/**
+ * @brief Copy the counters of a peripheral
+ * @details The bus load is estimated from the received and sent messages
+ * (with the worst case number of stuff bits) in windows of
+ * CAN_MGR_STATS_WINDOW_US microseconds; with the transmit queue a message is
+ * counted when it is moved into a transmit mailbox
+ */
+int can_mgr_stats_get(int can_id, can_mgr_stats_t *out);
+/**
+ * @brief Count the receive FIFO overruns, must be called from
+ * HAL_CAN_ErrorCallback with the value of HAL_CAN_GetError
+ */
+void can_mgr_stats_error_callback(CAN_HandleTypeDef *hcan, uint32_t hal_error);
+/**
+ * @brief Write a line with the counters of a peripheral (e.g. for ucli)
+ * @return The number of characters of the line (as snprintf) or -1 on error
+ */
+int can_mgr_stats_format(int can_id, char *buf, size_t size);
+/**
+ * @brief Write a line with the statistics of a message state
+ * @return The number of characters of the line (as snprintf), 0 if the
+ * message was never received or -1 on error
+ */
+int can_mgr_stats_format_id(int can_id, int index, char *buf, size_t size);
+#endif
+
+#if defined(CAN_MGR_TIMEOUT_HEAP_SIZE) && CAN_MGR_TIMEOUT_HEAP_SIZE > 0
+/**
+ * @brief Timeout of a message state
+ * @details A message state is stale if it is not received for
+ * CAN_MGR_TIMEOUT_PERIODS times its expected period
+ */
+typedef struct {
+  uint32_t period;  // Expected period in ticks (0 to not monitor the message)
+  uint32_t last_rx; // Tick of the last reception, updated by the interrupt
+  uint8_t stale;
+} can_mgr_timeout_t;
+
+/**
+ * @brief Called when a message state becomes stale (stale = 1) and when it is
+ * received again (stale = 0), e.g. to set and reset an errorlib error
+ */
+typedef void (*can_mgr_timeout_callback_t)(int can_id, int index, uint8_t stale);
+
+/**
+ * @brief Get the current tick for the reception timestamps
+ * @details Weakly defined (HAL_GetTick on STM32), the periods and the ticks
+ * given to can_mgr_check_timeouts must use the same time base
+ */
+uint32_t can_mgr_get_tick(void);
+/**
+ * @brief Set the timeouts of the message states of a peripheral
+ * @attention Must be called after can_mgr_config, the timeouts array must
+ * have the same size of the message states and at most
+ * CAN_MGR_TIMEOUT_HEAP_SIZE messages can be monitored
+ * @param timeouts The timeouts with the expected periods or NULL to disable them
+ * @param callback Called when a message becomes stale or fresh again (can be NULL)
+ * @param now The current tick, every message is considered received at now
+ */
+int can_mgr_config_timeouts(int can_id, can_mgr_timeout_t *timeouts, can_mgr_timeout_callback_t callback, uint32_t now);
+/**
+ * @brief Find the message states whose deadline has passed
+ * @details The deadlines are kept in a heap, only the expired deadlines (and
+ * the ones of the messages received since they were last moved) are visited
+ * @attention Must be called only from one context (e.g. the main loop)
+ * @return The number of messages that became stale or -1 on error
+ */
+int can_mgr_check_timeouts(int can_id, uint32_t now);
+/**
+ * @brief Check if a message state is stale
+ * @return 1 if stale, 0 if fresh, -1 on error
+ */
+int can_mgr_is_stale(int can_id, int index);
+#endif
+
+#if defined(CAN_MGR_RX_QUEUE_SIZE) && CAN_MGR_RX_QUEUE_SIZE > 0
+/**
+ * @brief Select how the received messages of a peripheral are stored
+ * @details In queue mode every received message is pushed into a queue of
+ * CAN_MGR_RX_QUEUE_SIZE messages that must be emptied with can_mgr_rx_drain,
+ * otherwise only the last message of each ID is kept in the message states
+ * @param enable 1 to enable the queue mode, 0 to use the message states
+ */
+int can_mgr_rx_queue_enable(int can_id, uint8_t enable);
+/**
+ * @brief Remove at most count received messages from the queue of a peripheral
+ * @attention Must be called only from one context (e.g. the main loop)
+ * @return The number of messages copied into out or -1 on error
+ */
+int can_mgr_rx_drain(int can_id, can_mgr_msg_t *out, size_t count);
+/**
+ * @brief Get the number of messages lost because the queue was full
+ * @return The number of lost messages or -1 on error
+ */
+int can_mgr_rx_dropped(int can_id);
+#endif
+
 #endif // CAN_MANAGER_H
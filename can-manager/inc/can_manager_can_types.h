@@ -19,7 +19,63 @@ typedef struct {
   uint8_t data[8];
 } can_mgr_msg_t;
 
+// Largest payload of a CAN FD frame
+#define CAN_MGR_FD_MAX_SIZE (64U)
+// Flags of a variable length message
+#define CAN_MGR_MSG_EXT_ID (0x01U) // 29-bit extended ID
+#define CAN_MGR_MSG_FD (0x02U)     // CAN FD frame
+// Set in the msg_id given to can_mgr_from_id_to_index for the extended IDs
+#define CAN_MGR_EXT_ID_FLAG (0x20000000)
+
+/**
+ * Variable length message (extended IDs and CAN FD payloads), the payload is
+ * stored in a buffer owned by the application of capacity bytes
+ */
+typedef struct {
+  uint32_t id;
+  uint8_t flags;
+  uint8_t size;
+  uint8_t capacity;
+  uint8_t *data;
+} can_mgr_fd_msg_t;
+
+/** @brief Payload size of a data length code (CAN FD lengths above 8) */
+static inline uint8_t can_mgr_dlc_to_size(uint8_t dlc) {
+  if (dlc <= 8U)
+    return dlc;
+  if (dlc <= 12U)
+    return 8U + 4U * (dlc - 8U);
+  return dlc == 13U ? 32U : dlc == 14U ? 48U : 64U;
+}
+
+/** @brief Smallest data length code that holds size bytes */
+static inline uint8_t can_mgr_size_to_dlc(uint8_t size) {
+  if (size <= 8U)
+    return size;
+  if (size <= 24U)
+    return 8U + (size - 8U + 3U) / 4U;
+  return size <= 32U ? 13U : size <= 48U ? 14U : 15U;
+}
+
 int can_mgr_send(int can_id, can_mgr_msg_t *msg);
+/**
+ * @brief Send (or queue) multiple messages at once
+ * @details With the transmit queue enabled the messages are queued with a
+ * single critical section and then sent in order of priority
+ * @return The number of messages sent or queued (less than count if the queue
+ * is full) or -1 on error
+ */
+int can_mgr_send_n(int can_id, can_mgr_msg_t *msgs, size_t count);
+/**
+ * @brief Send (or queue) a variable length message, the payload is given to
+ * the peripheral directly from the buffer of the message
+ * @details With the transmit queue enabled the payload is copied into the
+ * queue if other messages are waiting or no mailbox is free, extended IDs are
+ * ordered as in the bus arbitration; size must be a valid length (0 to 8 for
+ * classic frames, see can_mgr_dlc_to_size for CAN FD)
+ * @return 0 on success or -1 on error
+ */
+int can_mgr_send_fd(int can_id, const can_mgr_fd_msg_t *msg);
 can_mgr_msg_t **get_can_mgr_states(void);
 int can_mgr_start(int can_id);
 
@@ -14,9 +14,22 @@ typedef enum {
   HAL_TIMEOUT = 0x03U
 } HAL_StatusTypeDef;
 
-typedef struct {
-  uint8_t dummy;
-} CAN_HandleTypeDef;
+#define CAN_ID_STD (0x00000000U)   /*!< Standard Id */
+#define CAN_ID_EXT (0x00000004U)   /*!< Extended Id */
+#define CAN_RTR_DATA (0x00000000U) /*!< Data frame */
+#define DISABLE (0)
+#define ENABLE (1)
+#define CAN_FILTERMODE_IDMASK (0x00000000U)  /*!< Identifier mask mode */
+#define CAN_FILTERMODE_IDLIST (0x00000001U)  /*!< Identifier list mode */
+#define CAN_FILTERSCALE_16BIT (0x00000000U)  /*!< Two 16-bit filters */
+#define CAN_FILTERSCALE_32BIT (0x00000001U)  /*!< One 32-bit filter */
+#define HAL_CAN_ERROR_RX_FOV0 (0x00000200U) /*!< Rx FIFO0 overrun error */
+#define HAL_CAN_ERROR_RX_FOV1 (0x00000800U) /*!< Rx FIFO1 overrun error */
+
+// Number of transmit mailboxes of the simulated peripheral
+#define CAN_MOCK_TX_MAILBOXES (3U)
+
+typedef struct CAN_HandleTypeDef CAN_HandleTypeDef;
 
 typedef struct {
   uint32_t FilterIdHigh; /*!< Specifies the filter identification number (MSBs
@@ -109,6 +122,8 @@ typedef struct {
                           filter element. This parameter must be a number
                           between Min_Data = 0 and Max_Data = 0xFF. */
 
+  uint32_t FDFormat; /*!< Simulation only: CAN FD frame (DLC up to 15) */
+
 } CAN_RxHeaderTypeDef;
 
 typedef int FunctionalState;
@@ -142,6 +157,46 @@ typedef struct {
               @note: DLC must be programmed as 8 bytes, in order these 2 bytes
               are sent. This parameter can be set to ENABLE or DISABLE. */
 
+  uint32_t FDFormat; /*!< Simulation only: CAN FD frame (DLC up to 15) */
+
 } CAN_TxHeaderTypeDef;
 
+/**
+ * Simulated peripheral, the transmitted messages are given to tx_callback
+ * and the mailboxes stay occupied until tx_free_level is incremented by the
+ * simulation; rx_header and rx_data are the message at the head of the
+ * receive FIFO
+ */
+struct CAN_HandleTypeDef {
+  uint8_t dummy;
+  uint32_t tx_free_level;
+  void (*tx_callback)(CAN_HandleTypeDef *hcan, CAN_TxHeaderTypeDef *header, uint8_t *data);
+  CAN_RxHeaderTypeDef rx_header;
+  uint8_t rx_data[CAN_MGR_FD_MAX_SIZE];
+  uint32_t rx_reads;
+};
+
+static inline HAL_StatusTypeDef HAL_CAN_GetRxMessage(CAN_HandleTypeDef *hcan, uint32_t fifo, CAN_RxHeaderTypeDef *header, uint8_t *data) {
+  *header = hcan->rx_header;
+  // Classic frames carry at most 8 bytes whatever the DLC
+  uint8_t size = can_mgr_dlc_to_size(header->DLC);
+  memcpy(data, hcan->rx_data, header->FDFormat || size < 8U ? size : 8U);
+  ++hcan->rx_reads;
+  return HAL_OK;
+}
+
+static inline uint32_t HAL_CAN_GetTxMailboxesFreeLevel(CAN_HandleTypeDef *hcan) {
+  return hcan->tx_free_level;
+}
+
+static inline HAL_StatusTypeDef HAL_CAN_AddTxMessage(CAN_HandleTypeDef *hcan, CAN_TxHeaderTypeDef *header, uint8_t *data, uint32_t *mailbox) {
+  if (hcan->tx_free_level == 0)
+    return HAL_ERROR;
+  --hcan->tx_free_level;
+  *mailbox = hcan->tx_free_level;
+  if (hcan->tx_callback != NULL)
+    hcan->tx_callback(hcan, header, data);
+  return HAL_OK;
+}
+
 #endif // CAN_MANAGER_TYPE_MOCKING_H
@@ -5,5 +5,27 @@
 #define CAN_MGR_N_CAN 2
 #define CAN_MGR_TOTAL_CAN_RX_FIFOS 2
 #define CAN_MGR_CAN_WAIT_ENABLED 0
+// Size of the ID to index lookup table of each peripheral (power of two, 0 to disable)
+#define CAN_MGR_ID_TABLE_SIZE 0
+// Size of the receive queue of each peripheral (power of two, 0 to disable)
+// The ring-buffer library is needed if enabled
+#define CAN_MGR_RX_QUEUE_SIZE 0
+// Size of the transmit queue of each peripheral (0 to disable)
+// The min-heap library is needed if enabled
+#define CAN_MGR_TX_QUEUE_SIZE 0
+// Number of slots of the timer wheel of the periodic message scheduler (power of two, 0 to disable)
+#define CAN_MGR_SCHEDULE_WHEEL_SIZE 0
+// Reception and transmission statistics (1 to enable), compiled out if disabled
+#define CAN_MGR_STATS_ENABLED 0
+// Duration of the window used to estimate the bus load
+#define CAN_MGR_STATS_WINDOW_US (100000U)
+// Maximum number of message states monitored for timeouts on each peripheral (0 to disable)
+#define CAN_MGR_TIMEOUT_HEAP_SIZE 0
+// Number of missed periods after which a message state is stale
+#define CAN_MGR_TIMEOUT_PERIODS 3
+// Maximum number of distinct IDs given to can_mgr_filter_optimize (size of can_mgr_filter_scratch_t)
+#define CAN_MGR_FILTER_MAX_IDS 128
+// Variable length message states with extended IDs and CAN FD payloads (1 to enable)
+#define CAN_MGR_FD_ENABLED 0
 
 #endif // CAN_MANAGER_CONFIG_H
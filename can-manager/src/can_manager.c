@@ -18,6 +18,17 @@ enum can_mgr_errors {
   can_mgr_invalid_msg_index_error,
   can_mgr_index_out_of_bound_error,
   can_mgr_invalid_can_id_error,
+  can_mgr_id_table_full_error,
+  can_mgr_rx_queue_full_error,
+  can_mgr_seq_not_configured_error,
+  can_mgr_torn_read_error,
+  can_mgr_tx_queue_full_error,
+  can_mgr_schedule_invalid_entry_error,
+  can_mgr_timeout_heap_full_error,
+  can_mgr_filter_invalid_error,
+  can_mgr_filter_too_many_ids_error,
+  can_mgr_fd_invalid_msg_error,
+  can_mgr_fd_buffer_too_small_error,
   can_mgr_n_errors
 };
 
@@ -26,9 +37,197 @@ int _can_mgr_fifo_assignment[CAN_MGR_TOTAL_CAN_RX_FIFOS];
 can_mgr_msg_t *_can_mgr_msg_states[CAN_MGR_N_CAN];
 uint8_t *_can_mgr_is_new_message[CAN_MGR_N_CAN];
 int _can_mgr_msg_states_sizes[CAN_MGR_N_CAN];
+// Sequence counter of each message state, odd while the state is being written
+uint32_t *_can_mgr_msg_seq[CAN_MGR_N_CAN];
 
 int _can_mgr_current_can_counter = 0;
 
+#define CAN_MGR_STD_ID_COUNT (0x800)
+
+#ifndef CAN_MGR_ID_TABLE_SIZE
+#define CAN_MGR_ID_TABLE_SIZE 0
+#endif
+
+#if CAN_MGR_ID_TABLE_SIZE > 0
+#if (CAN_MGR_ID_TABLE_SIZE & (CAN_MGR_ID_TABLE_SIZE - 1)) != 0
+#error "CAN_MGR_ID_TABLE_SIZE must be a power of two"
+#endif
+
+#define CAN_MGR_ID_TABLE_EMPTY (0xFFFFU)
+
+/**
+ * Open addressing (linear probing) table that maps the message ID to the
+ * index of the message state, it is filled once in can_mgr_config with the
+ * result of the user-defined can_mgr_from_id_to_index so that the interrupt
+ * callback does not depend on the cost of the user lookup
+ */
+typedef struct {
+  uint16_t id;
+  int16_t index;
+} _can_mgr_id_entry_t;
+
+_can_mgr_id_entry_t _can_mgr_id_table[CAN_MGR_N_CAN][CAN_MGR_ID_TABLE_SIZE];
+// Longest probe sequence of each table, bounds the lookup of unknown IDs
+uint16_t _can_mgr_id_table_max_probe[CAN_MGR_N_CAN];
+#endif
+
+#ifndef CAN_MGR_RX_QUEUE_SIZE
+#define CAN_MGR_RX_QUEUE_SIZE 0
+#endif
+
+#if CAN_MGR_RX_QUEUE_SIZE > 0
+#if (CAN_MGR_RX_QUEUE_SIZE & (CAN_MGR_RX_QUEUE_SIZE - 1)) != 0
+#error "CAN_MGR_RX_QUEUE_SIZE must be a power of two"
+#endif
+
+/**
+ * Received messages of the peripherals in queue mode, the interrupt callback is
+ * the only producer and the main loop the only consumer so no critical section
+ * is needed
+ */
+SpscRingBuffer(can_mgr_msg_t, CAN_MGR_RX_QUEUE_SIZE) _can_mgr_rx_queues[CAN_MGR_N_CAN];
+uint8_t _can_mgr_rx_queue_enabled[CAN_MGR_N_CAN];
+uint32_t _can_mgr_rx_dropped[CAN_MGR_N_CAN];
+#endif
+
+#ifndef CAN_MGR_TX_QUEUE_SIZE
+#define CAN_MGR_TX_QUEUE_SIZE 0
+#endif
+
+#if CAN_MGR_TX_QUEUE_SIZE > 0
+// Payload of a queued frame, the bxCAN peripheral sends only classic frames
+#ifdef CAN_MGR_STM32_APPLICATION
+#define CAN_MGR_TX_MAX_SIZE (8U)
+#else
+#define CAN_MGR_TX_MAX_SIZE CAN_MGR_FD_MAX_SIZE
+#endif
+
+/**
+ * Frames waiting for a free transmit mailbox, ordered as in the bus
+ * arbitration (see _can_mgr_tx_arbitration_id) and by insertion order for
+ * equal IDs
+ */
+typedef struct {
+  uint32_t id;
+  uint32_t seq;
+  uint8_t flags;
+  uint8_t size;
+  uint8_t data[CAN_MGR_TX_MAX_SIZE];
+} _can_mgr_tx_entry_t;
+
+MinHeap(_can_mgr_tx_entry_t, CAN_MGR_TX_QUEUE_SIZE) _can_mgr_tx_queues[CAN_MGR_N_CAN];
+uint32_t _can_mgr_tx_seq[CAN_MGR_N_CAN];
+
+#ifdef CAN_MGR_STM32_APPLICATION
+// The queue is shared with the transmit mailbox empty interrupt
+#define CAN_MGR_CS_ENTER()                                                     \
+  uint32_t _can_mgr_primask = __get_PRIMASK();                                 \
+  __disable_irq()
+#define CAN_MGR_CS_EXIT()                                                      \
+  if (!_can_mgr_primask)                                                       \
+  __enable_irq()
+#else
+#define CAN_MGR_CS_ENTER()
+#define CAN_MGR_CS_EXIT()
+#endif
+#endif
+
+#ifndef CAN_MGR_SCHEDULE_WHEEL_SIZE
+#define CAN_MGR_SCHEDULE_WHEEL_SIZE 0
+#endif
+
+#if CAN_MGR_SCHEDULE_WHEEL_SIZE > 0
+#if (CAN_MGR_SCHEDULE_WHEEL_SIZE & (CAN_MGR_SCHEDULE_WHEEL_SIZE - 1)) != 0
+#error "CAN_MGR_SCHEDULE_WHEEL_SIZE must be a power of two"
+#endif
+
+#define CAN_MGR_SCHEDULE_NONE (-1)
+// Maximum number of due messages sent with a single call of can_mgr_send_n
+#define CAN_MGR_SCHEDULE_BATCH_SIZE (8U)
+// Maximum number of ticks analyzed by can_mgr_schedule_stats
+#define CAN_MGR_SCHEDULE_STATS_MAX_WINDOW (1UL << 20)
+
+/**
+ * Timer wheel of the schedule table of each peripheral, every slot is the head
+ * of a list of the entries whose deadline modulo the wheel size is equal to
+ * the slot index, so each tick only visits the messages that could be due
+ */
+can_mgr_schedule_entry_t *_can_mgr_schedule_tables[CAN_MGR_N_CAN];
+size_t _can_mgr_schedule_sizes[CAN_MGR_N_CAN];
+int16_t _can_mgr_schedule_wheel[CAN_MGR_N_CAN][CAN_MGR_SCHEDULE_WHEEL_SIZE];
+uint32_t _can_mgr_schedule_last_tick[CAN_MGR_N_CAN];
+#endif
+
+#ifndef CAN_MGR_STATS_ENABLED
+#define CAN_MGR_STATS_ENABLED 0
+#endif
+
+#if CAN_MGR_STATS_ENABLED > 0
+#include <stdio.h>
+
+#ifndef CAN_MGR_STATS_WINDOW_US
+#define CAN_MGR_STATS_WINDOW_US (100000U)
+#endif
+
+can_mgr_stats_t _can_mgr_stats[CAN_MGR_N_CAN];
+can_mgr_id_stats_t *_can_mgr_id_stats[CAN_MGR_N_CAN];
+uint32_t _can_mgr_stats_bitrate[CAN_MGR_N_CAN];
+// Bits seen on the bus since the start of the current bus load window
+uint32_t _can_mgr_stats_window_bits[CAN_MGR_N_CAN];
+uint32_t _can_mgr_stats_window_start[CAN_MGR_N_CAN];
+#endif
+
+#ifndef CAN_MGR_TIMEOUT_HEAP_SIZE
+#define CAN_MGR_TIMEOUT_HEAP_SIZE 0
+#endif
+
+#if CAN_MGR_TIMEOUT_HEAP_SIZE > 0
+#ifndef CAN_MGR_TIMEOUT_PERIODS
+#define CAN_MGR_TIMEOUT_PERIODS 3
+#endif
+
+/**
+ * Binary heap of the deadlines of the monitored message states, the interrupt
+ * callback only updates the reception tick and the deadline is moved lazily
+ * when it is reached, so that the check only visits the expired (or refreshed)
+ * states; the top is replaced in place so the generic min-heap is not used
+ */
+typedef struct {
+  uint32_t deadline;
+  uint16_t index;
+} _can_mgr_deadline_t;
+
+_can_mgr_deadline_t _can_mgr_deadlines[CAN_MGR_N_CAN][CAN_MGR_TIMEOUT_HEAP_SIZE];
+uint16_t _can_mgr_deadlines_size[CAN_MGR_N_CAN];
+can_mgr_timeout_t *_can_mgr_timeouts[CAN_MGR_N_CAN];
+can_mgr_timeout_callback_t _can_mgr_timeout_callbacks[CAN_MGR_N_CAN];
+#endif
+
+#define CAN_MGR_FILTER_STD_MASK (0x7FFU)
+// Filter banks in 16-bit scale hold 4 IDs in list mode or 2 masks in mask mode
+#define CAN_MGR_FILTER_LIST_PER_BANK (4U)
+#define CAN_MGR_FILTER_MASKS_PER_BANK (2U)
+// Standard data frames only (RTR and IDE bits must be 0)
+#define CAN_MGR_FILTER_16BIT_FLAGS_MASK (0x18U)
+
+#ifndef CAN_MGR_FD_ENABLED
+#define CAN_MGR_FD_ENABLED 0
+#endif
+
+// Payload size of a classic frame, the bxCAN HAL always copies 8 bytes
+#define CAN_MGR_CLASSIC_MAX_SIZE (8U)
+#define CAN_MGR_STD_ID_MAX (0x7FFU)
+#define CAN_MGR_EXT_ID_MAX (0x1FFFFFFFU)
+
+#if CAN_MGR_FD_ENABLED > 0
+// Variable length message states, used instead of _can_mgr_msg_states
+can_mgr_fd_msg_t *_can_mgr_fd_states[CAN_MGR_N_CAN];
+#endif
+
+#ifndef CAN_MGR_READ_MAX_RETRIES
+#define CAN_MGR_READ_MAX_RETRIES 8
+#endif
+
 int can_mgr_error_code = can_mgr_no_error;
 HAL_StatusTypeDef can_mgr_hal_code;
 
@@ -38,28 +237,288 @@ HAL_StatusTypeDef can_mgr_hal_code;
     return -1;                                                                 \
   }
 
+/**
+ * Transmission time of a standard data frame in bits, with the worst case
+ * number of stuff bits
+ */
+static inline uint32_t _can_mgr_frame_bits(uint8_t size) {
+  return 47U + 8U * size + (34U + 8U * size - 1U) / 4U;
+}
+
+#ifndef __weak
+#define __weak __attribute__((weak))
+#endif
+
+#if CAN_MGR_TIMEOUT_HEAP_SIZE > 0
+// Weakly defined, can be re-defined by the user to use another time base
+__weak uint32_t can_mgr_get_tick(void) {
+#ifdef CAN_MGR_STM32_APPLICATION
+  return HAL_GetTick();
+#else
+  return 0;
+#endif
+}
+
+// Wrap-around safe comparison of the ticks
+static inline int _can_mgr_deadline_before(uint32_t a, uint32_t b) { return (int32_t)(a - b) < 0; }
+
+static void _can_mgr_deadline_push(int can_id, _can_mgr_deadline_t item) {
+  _can_mgr_deadline_t *heap = _can_mgr_deadlines[can_id];
+  size_t hole = _can_mgr_deadlines_size[can_id]++;
+  while (hole > 0) {
+    size_t parent = (hole - 1) / 2;
+    if (!_can_mgr_deadline_before(item.deadline, heap[parent].deadline))
+      break;
+    heap[hole] = heap[parent];
+    hole = parent;
+  }
+  heap[hole] = item;
+}
+
+// Replace the top of the heap with a new item
+static void _can_mgr_deadline_replace_top(int can_id, _can_mgr_deadline_t item) {
+  _can_mgr_deadline_t *heap = _can_mgr_deadlines[can_id];
+  size_t size = _can_mgr_deadlines_size[can_id];
+  size_t hole = 0, child;
+  while ((child = 2 * hole + 1) < size) {
+    if (child + 1 < size && _can_mgr_deadline_before(heap[child + 1].deadline, heap[child].deadline))
+      ++child;
+    if (!_can_mgr_deadline_before(heap[child].deadline, item.deadline))
+      break;
+    heap[hole] = heap[child];
+    hole = child;
+  }
+  heap[hole] = item;
+}
+
+static inline void _can_mgr_timeout_rx(int can_id, int index) {
+  can_mgr_timeout_t *timeouts = _can_mgr_timeouts[can_id];
+  if (timeouts != NULL && index >= 0 && index < _can_mgr_msg_states_sizes[can_id])
+    __atomic_store_n(&timeouts[index].last_rx, can_mgr_get_tick(), __ATOMIC_RELAXED);
+}
+#endif
+
+#if CAN_MGR_STATS_ENABLED > 0
+// Weakly defined, should be re-defined by the user with a microsecond timer
+__weak uint32_t can_mgr_stats_get_time_us(void) {
+#ifdef CAN_MGR_STM32_APPLICATION
+  return HAL_GetTick() * 1000U;
+#else
+  return 0;
+#endif
+}
+
+static void _can_mgr_stats_update_load(int can_id, uint32_t now) {
+  uint32_t elapsed = now - _can_mgr_stats_window_start[can_id];
+  if (elapsed < CAN_MGR_STATS_WINDOW_US || _can_mgr_stats_bitrate[can_id] == 0)
+    return;
+  // Per mille of the bits that could be sent in the window
+  uint64_t load = (uint64_t)_can_mgr_stats_window_bits[can_id] * 1000000000ULL /
+                  ((uint64_t)_can_mgr_stats_bitrate[can_id] * elapsed);
+  can_mgr_stats_t *stats = &_can_mgr_stats[can_id];
+  stats->bus_load = load > UINT16_MAX ? UINT16_MAX : load;
+  if (stats->bus_load > stats->max_bus_load)
+    stats->max_bus_load = stats->bus_load;
+  _can_mgr_stats_window_bits[can_id] = 0;
+  _can_mgr_stats_window_start[can_id] = now;
+}
+
+static void _can_mgr_stats_rx(int can_id, uint32_t msg_id, uint8_t size, int index) {
+  can_mgr_stats_t *stats = &_can_mgr_stats[can_id];
+  uint32_t now = can_mgr_stats_get_time_us();
+  ++stats->rx_frames;
+  _can_mgr_stats_window_bits[can_id] += _can_mgr_frame_bits(size);
+  _can_mgr_stats_update_load(can_id, now);
+
+  if (index < 0) {
+    ++stats->unknown_ids;
+    return;
+  }
+  if (index >= _can_mgr_msg_states_sizes[can_id]) {
+    ++stats->out_of_bound;
+    return;
+  }
+  if (_can_mgr_id_stats[can_id] == NULL)
+    return;
+  can_mgr_id_stats_t *id_stats = &_can_mgr_id_stats[can_id][index];
+  if (id_stats->count > 0) {
+    uint32_t period = now - id_stats->last_us;
+    if (id_stats->count == 1 || period < id_stats->min_period_us)
+      id_stats->min_period_us = period;
+    if (period > id_stats->max_period_us)
+      id_stats->max_period_us = period;
+    id_stats->sum_period_us += period;
+  }
+  id_stats->id = msg_id;
+  id_stats->last_us = now;
+  ++id_stats->count;
+}
+
+/**
+ * Count a frame given to a transmit mailbox (not when it is queued, the
+ * queued frames are not on the bus yet)
+ */
+static void _can_mgr_stats_tx(int can_id, uint8_t size) {
+  ++_can_mgr_stats[can_id].tx_frames;
+  _can_mgr_stats_window_bits[can_id] += _can_mgr_frame_bits(size);
+  _can_mgr_stats_update_load(can_id, can_mgr_stats_get_time_us());
+}
+#endif
+
+#if CAN_MGR_TX_QUEUE_SIZE > 0
+/**
+ * Bits of the arbitration field in the order they are sent, the lowest value
+ * wins: the 11-bit base ID, then RTR/SRR and IDE (recessive for extended IDs,
+ * so a standard frame wins over an extended one with the same base ID) and
+ * the 18-bit ID extension
+ */
+static inline uint32_t _can_mgr_tx_arbitration_id(const _can_mgr_tx_entry_t *entry) {
+  if (entry->flags & CAN_MGR_MSG_EXT_ID)
+    return ((entry->id >> 18) << 20) | (3U << 18) | (entry->id & 0x3FFFFU);
+  return entry->id << 20;
+}
+
+static int8_t _can_mgr_tx_compare(void *a, void *b) {
+  _can_mgr_tx_entry_t *ea = (_can_mgr_tx_entry_t *)a;
+  _can_mgr_tx_entry_t *eb = (_can_mgr_tx_entry_t *)b;
+  uint32_t ida = _can_mgr_tx_arbitration_id(ea);
+  uint32_t idb = _can_mgr_tx_arbitration_id(eb);
+  if (ida != idb)
+    return ida < idb ? -1 : 1;
+  // Wrap-around safe comparison of the insertion order
+  int32_t diff = (int32_t)(ea->seq - eb->seq);
+  return diff < 0 ? -1 : (diff > 0);
+}
+#endif
+
 int can_mgr_init(CAN_HandleTypeDef *hcan) {
   if (_can_mgr_current_can_counter == CAN_MGR_N_CAN) {
     can_mgr_error_code = can_mgr_too_many_peripherals_error;
     return -1;
   }
   _can_mgr_peripherals[_can_mgr_current_can_counter] = hcan;
+#if CAN_MGR_TX_QUEUE_SIZE > 0
+  min_heap_init(&_can_mgr_tx_queues[_can_mgr_current_can_counter], _can_mgr_tx_entry_t, CAN_MGR_TX_QUEUE_SIZE, _can_mgr_tx_compare);
+  _can_mgr_tx_seq[_can_mgr_current_can_counter] = 0;
+#endif
+#if CAN_MGR_RX_QUEUE_SIZE > 0
+  ring_buffer_spsc_init(&_can_mgr_rx_queues[_can_mgr_current_can_counter], can_mgr_msg_t, CAN_MGR_RX_QUEUE_SIZE);
+  _can_mgr_rx_queue_enabled[_can_mgr_current_can_counter] = 0;
+  _can_mgr_rx_dropped[_can_mgr_current_can_counter] = 0;
+#endif
   int assigned_id = _can_mgr_current_can_counter;
   _can_mgr_current_can_counter++;
   return assigned_id;
 }
 
+// User-defined function
+int can_mgr_from_id_to_index(int can_id, int msg_id);
+
+static inline int _can_mgr_has_states(int can_id) {
+#if CAN_MGR_FD_ENABLED > 0
+  if (_can_mgr_fd_states[can_id] != NULL)
+    return 1;
+#endif
+  return _can_mgr_msg_states[can_id] != NULL;
+}
+
+#if CAN_MGR_ID_TABLE_SIZE > 0
+static inline uint32_t _can_mgr_id_hash(uint16_t msg_id) {
+  // Fibonacci hashing, the upper bits are the most mixed
+  return ((uint32_t)msg_id * 0x9E3779B1U) >> 16;
+}
+
+static int _can_mgr_id_table_build(int can_id) {
+  _can_mgr_id_entry_t *table = _can_mgr_id_table[can_id];
+  for (size_t i = 0; i < CAN_MGR_ID_TABLE_SIZE; ++i) {
+    table[i].id = CAN_MGR_ID_TABLE_EMPTY;
+    table[i].index = -1;
+  }
+  _can_mgr_id_table_max_probe[can_id] = 0;
+  if (!_can_mgr_has_states(can_id))
+    return 0;
+
+  size_t used = 0;
+  for (int msg_id = 0; msg_id < CAN_MGR_STD_ID_COUNT; ++msg_id) {
+    int index = can_mgr_from_id_to_index(can_id, msg_id);
+    if (index < 0)
+      continue;
+    if (used == CAN_MGR_ID_TABLE_SIZE) {
+      can_mgr_error_code = can_mgr_id_table_full_error;
+      return -1;
+    }
+    uint32_t slot = _can_mgr_id_hash(msg_id) & (CAN_MGR_ID_TABLE_SIZE - 1);
+    uint16_t probe = 0;
+    while (table[slot].id != CAN_MGR_ID_TABLE_EMPTY) {
+      slot = (slot + 1) & (CAN_MGR_ID_TABLE_SIZE - 1);
+      ++probe;
+    }
+    table[slot].id = msg_id;
+    table[slot].index = index;
+    if (probe > _can_mgr_id_table_max_probe[can_id])
+      _can_mgr_id_table_max_probe[can_id] = probe;
+    ++used;
+  }
+  return 0;
+}
+#endif
+
+int can_mgr_id_to_index(int can_id, int msg_id) {
+  CAN_MGR_ID_CHECK(can_id);
+#if CAN_MGR_ID_TABLE_SIZE > 0
+  // The table holds only the standard IDs
+  if (msg_id >= 0 && (msg_id & CAN_MGR_EXT_ID_FLAG))
+    return can_mgr_from_id_to_index(can_id, msg_id);
+  if (msg_id < 0 || msg_id >= CAN_MGR_STD_ID_COUNT)
+    return -1;
+  _can_mgr_id_entry_t *table = _can_mgr_id_table[can_id];
+  uint32_t slot = _can_mgr_id_hash(msg_id) & (CAN_MGR_ID_TABLE_SIZE - 1);
+  for (uint16_t probe = 0; probe <= _can_mgr_id_table_max_probe[can_id]; ++probe) {
+    if (table[slot].id == msg_id)
+      return table[slot].index;
+    if (table[slot].id == CAN_MGR_ID_TABLE_EMPTY)
+      return -1;
+    slot = (slot + 1) & (CAN_MGR_ID_TABLE_SIZE - 1);
+  }
+  return -1;
+#else
+  return can_mgr_from_id_to_index(can_id, msg_id);
+#endif
+}
+
 /**
  * Se message_states == NULL ignorare tutti i messaggi ricevuti (consigliato e'
  * farlo anche a livello hardware con i filtri)
  * Con NULL ci si aspetta state_size == 0
  */
+// Set the message states of a peripheral and reset what depends on them
+static int _can_mgr_set_states(int can_id, uint8_t *message_is_new, size_t message_states_size) {
+  _can_mgr_is_new_message[can_id] = message_is_new;
+  _can_mgr_msg_states_sizes[can_id] = message_states_size;
+  _can_mgr_msg_seq[can_id] = NULL;
+#if CAN_MGR_STATS_ENABLED > 0
+  _can_mgr_id_stats[can_id] = NULL;
+#endif
+#if CAN_MGR_TIMEOUT_HEAP_SIZE > 0
+  _can_mgr_timeouts[can_id] = NULL;
+  _can_mgr_deadlines_size[can_id] = 0;
+#endif
+#if CAN_MGR_ID_TABLE_SIZE > 0
+  if (_can_mgr_id_table_build(can_id) < 0)
+    return -1;
+#endif
+  return 0;
+}
+
 int can_mgr_config(int can_id, CAN_FilterTypeDef *hfilter, uint32_t its, uint32_t rx_fifo_assignment, can_mgr_msg_t *message_states, uint8_t *message_is_new, size_t message_states_size) {
   CAN_MGR_ID_CHECK(can_id);
   _can_mgr_fifo_assignment[rx_fifo_assignment] = can_id;
   _can_mgr_msg_states[can_id] = message_states;
-  _can_mgr_is_new_message[can_id] = message_is_new;
-  _can_mgr_msg_states_sizes[can_id] = message_states_size;
+#if CAN_MGR_FD_ENABLED > 0
+  _can_mgr_fd_states[can_id] = NULL;
+#endif
+  if (_can_mgr_set_states(can_id, message_is_new, message_states_size) < 0)
+    return -1;
 #ifdef CAN_MGR_STM32_APPLICATION
   if (hfilter != NULL) {
     can_mgr_hal_code =
@@ -79,6 +538,103 @@ int can_mgr_config(int can_id, CAN_FilterTypeDef *hfilter, uint32_t its, uint32_
   return 0;
 }
 
+int can_mgr_config_seq(int can_id, uint32_t *message_seq) {
+  CAN_MGR_ID_CHECK(can_id);
+  if (message_seq != NULL)
+    memset(message_seq, 0, _can_mgr_msg_states_sizes[can_id] * sizeof(*message_seq));
+  _can_mgr_msg_seq[can_id] = message_seq;
+  return 0;
+}
+
+int can_mgr_read(int can_id, int index, can_mgr_msg_t *out) {
+  CAN_MGR_ID_CHECK(can_id);
+  // No fixed size states after can_mgr_config_fd
+  if (_can_mgr_msg_states[can_id] == NULL || index < 0 || index >= _can_mgr_msg_states_sizes[can_id]) {
+    can_mgr_error_code = can_mgr_index_out_of_bound_error;
+    return -1;
+  }
+  uint32_t *seq = _can_mgr_msg_seq[can_id];
+  if (seq == NULL) {
+    can_mgr_error_code = can_mgr_seq_not_configured_error;
+    return -1;
+  }
+
+  /**
+   * The flag is cleared before the copy, if the state is written in the
+   * meantime the copy is retried and the flag is set again by the interrupt
+   */
+  uint8_t is_new = __atomic_exchange_n(&_can_mgr_is_new_message[can_id][index], 0, __ATOMIC_ACQ_REL);
+  for (int retry = 0; retry < CAN_MGR_READ_MAX_RETRIES; ++retry) {
+    uint32_t start = __atomic_load_n(&seq[index], __ATOMIC_ACQUIRE);
+    if (start & 1U)
+      continue;
+    memcpy(out, &_can_mgr_msg_states[can_id][index], sizeof(*out));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&seq[index], __ATOMIC_RELAXED) == start)
+      return is_new;
+  }
+  can_mgr_error_code = can_mgr_torn_read_error;
+  return -1;
+}
+
+#if CAN_MGR_FD_ENABLED > 0
+int can_mgr_config_fd(int can_id, can_mgr_fd_msg_t *message_states, uint8_t *message_is_new, size_t message_states_size) {
+  CAN_MGR_ID_CHECK(can_id);
+  for (size_t i = 0; i < message_states_size; ++i) {
+    if (message_states[i].data == NULL || message_states[i].capacity < CAN_MGR_CLASSIC_MAX_SIZE) {
+      can_mgr_error_code = can_mgr_fd_invalid_msg_error;
+      return -1;
+    }
+  }
+  _can_mgr_msg_states[can_id] = NULL;
+  _can_mgr_fd_states[can_id] = message_states;
+  return _can_mgr_set_states(can_id, message_is_new, message_states_size);
+}
+
+int can_mgr_read_fd(int can_id, int index, can_mgr_fd_msg_t *out) {
+  CAN_MGR_ID_CHECK(can_id);
+  if (_can_mgr_fd_states[can_id] == NULL || index < 0 || index >= _can_mgr_msg_states_sizes[can_id]) {
+    can_mgr_error_code = can_mgr_index_out_of_bound_error;
+    return -1;
+  }
+  uint32_t *seq = _can_mgr_msg_seq[can_id];
+  if (seq == NULL) {
+    can_mgr_error_code = can_mgr_seq_not_configured_error;
+    return -1;
+  }
+
+  can_mgr_fd_msg_t *state = &_can_mgr_fd_states[can_id][index];
+  uint8_t *flag = &_can_mgr_is_new_message[can_id][index];
+  uint8_t is_new = __atomic_exchange_n(flag, 0, __ATOMIC_ACQ_REL);
+  int error = can_mgr_torn_read_error;
+  for (int retry = 0; retry < CAN_MGR_READ_MAX_RETRIES; ++retry) {
+    uint32_t start = __atomic_load_n(&seq[index], __ATOMIC_ACQUIRE);
+    if (start & 1U)
+      continue;
+    out->id = state->id;
+    out->flags = state->flags;
+    out->size = state->size;
+    if (out->size > out->capacity) {
+      // The size may be torn by a write, only a stable one is an error
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      if (__atomic_load_n(&seq[index], __ATOMIC_RELAXED) != start)
+        continue;
+      error = can_mgr_fd_buffer_too_small_error;
+      break;
+    }
+    memcpy(out->data, state->data, out->size);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&seq[index], __ATOMIC_RELAXED) == start)
+      return is_new;
+  }
+  can_mgr_error_code = error;
+  // The message was not read, it is still new for the next call
+  if (is_new)
+    __atomic_store_n(flag, 1, __ATOMIC_RELEASE);
+  return -1;
+}
+#endif
+
 int can_mgr_start(int can_id) {
   CAN_MGR_ID_CHECK(can_id);
 #ifdef CAN_MGR_STM32_APPLICATION
@@ -100,62 +656,951 @@ void _can_mgr_wait(CAN_HandleTypeDef *hcan) {
 #endif
 }
 
+static HAL_StatusTypeDef _can_mgr_add_tx_frame(CAN_HandleTypeDef *hcan, uint32_t id, uint8_t flags, uint8_t size, uint8_t *data) {
+  uint8_t ext = (flags & CAN_MGR_MSG_EXT_ID) != 0;
+  CAN_TxHeaderTypeDef header = {.StdId = ext ? 0 : id,
+                                .ExtId = ext ? id : 0,
+                                .IDE = ext ? CAN_ID_EXT : CAN_ID_STD,
+                                .RTR = CAN_RTR_DATA,
+                                .DLC = can_mgr_size_to_dlc(size),
+                                .TransmitGlobalTime = DISABLE};
+#ifndef CAN_MGR_STM32_APPLICATION
+  header.FDFormat = (flags & CAN_MGR_MSG_FD) != 0;
+#endif
+  uint32_t mlb;
+  return HAL_CAN_AddTxMessage(hcan, &header, data, &mlb);
+}
+
+#ifdef CAN_MGR_STM32_APPLICATION
+static inline HAL_StatusTypeDef _can_mgr_add_tx_message(CAN_HandleTypeDef *hcan, can_mgr_msg_t *msg) {
+  return _can_mgr_add_tx_frame(hcan, msg->id, 0, msg->size, msg->data);
+}
+#endif
+
+#if CAN_MGR_TX_QUEUE_SIZE > 0
+/**
+ * Move the queued messages with the highest priority into the free mailboxes
+ * @attention Must be called inside a critical section
+ */
+static int _can_mgr_tx_refill(int can_id) {
+  CAN_HandleTypeDef *hcan = _can_mgr_peripherals[can_id];
+  _can_mgr_tx_entry_t *top;
+  while (HAL_CAN_GetTxMailboxesFreeLevel(hcan) > 0 &&
+         (top = min_heap_peek(&_can_mgr_tx_queues[can_id])) != NULL) {
+    can_mgr_hal_code = _can_mgr_add_tx_frame(hcan, top->id, top->flags, top->size, top->data);
+    if (can_mgr_hal_code != HAL_OK) {
+      can_mgr_error_code = can_mgr_hal_can_send_error;
+      return -1;
+    }
+#if CAN_MGR_STATS_ENABLED > 0
+    _can_mgr_stats_tx(can_id, top->size);
+#endif
+    min_heap_remove(&_can_mgr_tx_queues[can_id], 0, NULL);
+  }
+  return 0;
+}
+#endif
+
 int can_mgr_send(int can_id, can_mgr_msg_t *msg) {
   CAN_MGR_ID_CHECK(can_id);
+#if CAN_MGR_TX_QUEUE_SIZE > 0
+  _can_mgr_tx_entry_t entry = {.id = msg->id, .size = msg->size};
+  memcpy(entry.data, msg->data, sizeof(msg->data));
+  CAN_MGR_CS_ENTER();
+  entry.seq = _can_mgr_tx_seq[can_id]++;
+  MinHeapReturnCode code = min_heap_insert(&_can_mgr_tx_queues[can_id], &entry);
+  int ret = _can_mgr_tx_refill(can_id);
+  CAN_MGR_CS_EXIT();
+  if (code != MIN_HEAP_OK) {
+    can_mgr_error_code = can_mgr_tx_queue_full_error;
+    return -1;
+  }
+  return ret;
+#else
   // TODO: make this less hardware dependent (pass the header in the function call(?))
 #ifdef CAN_MGR_STM32_APPLICATION
   CAN_HandleTypeDef *hcan = _can_mgr_peripherals[can_id];
-  CAN_TxHeaderTypeDef header = {.StdId = msg->id,
-                                .IDE = CAN_ID_STD,
-                                .RTR = CAN_RTR_DATA,
-                                .DLC = msg->size,
-                                .TransmitGlobalTime = DISABLE};
 #if CAN_MGR_CAN_WAIT_ENABLED == 1
   _can_mgr_wait(hcan);
 #endif
-  uint32_t mlb;
-  can_mgr_hal_code = HAL_CAN_AddTxMessage(hcan, &header, msg->data, &mlb);
+  can_mgr_hal_code = _can_mgr_add_tx_message(hcan, msg);
   if (can_mgr_hal_code != HAL_OK) {
     can_mgr_error_code = can_mgr_hal_can_send_error;
     return -1;
   }
+#endif
+#if CAN_MGR_STATS_ENABLED > 0
+  _can_mgr_stats_tx(can_id, msg->size);
 #endif
   return 0;
+#endif
 }
 
-// User-defined function
-int can_mgr_from_id_to_index(int can_id, int msg_id);
+int can_mgr_send_n(int can_id, can_mgr_msg_t *msgs, size_t count) {
+  CAN_MGR_ID_CHECK(can_id);
+#if CAN_MGR_TX_QUEUE_SIZE > 0
+  // All the messages are queued before refilling the mailboxes so that they
+  // are sent in order of priority
+  size_t queued = 0;
+  CAN_MGR_CS_ENTER();
+  for (; queued < count; ++queued) {
+    _can_mgr_tx_entry_t entry = {.id = msgs[queued].id, .seq = _can_mgr_tx_seq[can_id], .size = msgs[queued].size};
+    memcpy(entry.data, msgs[queued].data, sizeof(msgs[queued].data));
+    if (min_heap_insert(&_can_mgr_tx_queues[can_id], &entry) != MIN_HEAP_OK)
+      break;
+    ++_can_mgr_tx_seq[can_id];
+  }
+  int ret = _can_mgr_tx_refill(can_id);
+  CAN_MGR_CS_EXIT();
+  if (ret < 0)
+    return -1;
+  if (queued < count)
+    can_mgr_error_code = can_mgr_tx_queue_full_error;
+  return queued;
+#else
+  for (size_t i = 0; i < count; ++i)
+    if (can_mgr_send(can_id, &msgs[i]) < 0)
+      return i;
+  return count;
+#endif
+}
 
-void can_mgr_it_callback(CAN_HandleTypeDef *hcan, uint32_t rx_fifo_assignment, can_mgr_msg_t *mock_msg) {
-  /**
-   * TODO: integrate a priority queue to avoid O(n) search of incoming messages
-  */ 
-  int can_id = _can_mgr_fifo_assignment[rx_fifo_assignment];
-  if (_can_mgr_msg_states[can_id] == NULL) {
-    return;
+int can_mgr_send_fd(int can_id, const can_mgr_fd_msg_t *msg) {
+  CAN_MGR_ID_CHECK(can_id);
+  uint8_t fd = (msg->flags & CAN_MGR_MSG_FD) != 0;
+  uint32_t max_id = (msg->flags & CAN_MGR_MSG_EXT_ID) ? CAN_MGR_EXT_ID_MAX : CAN_MGR_STD_ID_MAX;
+  uint8_t max_size = fd ? CAN_MGR_FD_MAX_SIZE : CAN_MGR_CLASSIC_MAX_SIZE;
+  // The sizes between the FD lengths would send bytes past the payload
+  if (msg->id > max_id || msg->size > max_size || msg->size > msg->capacity ||
+      can_mgr_dlc_to_size(can_mgr_size_to_dlc(msg->size)) != msg->size) {
+    can_mgr_error_code = can_mgr_fd_invalid_msg_error;
+    return -1;
   }
-  int msg_id, msg_dlc;
-  uint8_t msg_data[8] = {0};
+  CAN_HandleTypeDef *hcan = _can_mgr_peripherals[can_id];
 #ifdef CAN_MGR_STM32_APPLICATION
-  CAN_RxHeaderTypeDef header;
-  HAL_CAN_GetRxMessage(hcan, rx_fifo_assignment, &header, msg_data);
-  msg_id = header.StdId;
-  msg_dlc = header.DLC;
+  // The bxCAN peripheral sends only classic frames
+  if (fd) {
+    can_mgr_error_code = can_mgr_fd_invalid_msg_error;
+    return -1;
+  }
+#endif
+#if CAN_MGR_TX_QUEUE_SIZE > 0
+  int ret = 0;
+  MinHeapReturnCode code = MIN_HEAP_OK;
+  CAN_MGR_CS_ENTER();
+  if (min_heap_is_empty(&_can_mgr_tx_queues[can_id]) && HAL_CAN_GetTxMailboxesFreeLevel(hcan) > 0) {
+    // Nothing is waiting, the payload is given to the peripheral directly
+    can_mgr_hal_code = _can_mgr_add_tx_frame(hcan, msg->id, msg->flags, msg->size, msg->data);
+    if (can_mgr_hal_code != HAL_OK) {
+      can_mgr_error_code = can_mgr_hal_can_send_error;
+      ret = -1;
+    }
+#if CAN_MGR_STATS_ENABLED > 0
+    else
+      _can_mgr_stats_tx(can_id, msg->size);
+#endif
+  } else {
+    _can_mgr_tx_entry_t entry = {.id = msg->id, .seq = _can_mgr_tx_seq[can_id]++, .flags = msg->flags, .size = msg->size};
+    memcpy(entry.data, msg->data, msg->size);
+    code = min_heap_insert(&_can_mgr_tx_queues[can_id], &entry);
+    ret = _can_mgr_tx_refill(can_id);
+  }
+  CAN_MGR_CS_EXIT();
+  if (code != MIN_HEAP_OK) {
+    can_mgr_error_code = can_mgr_tx_queue_full_error;
+    return -1;
+  }
+  return ret;
 #else
-  msg_id = mock_msg->id;
-  msg_dlc = mock_msg->size;
-  memcpy(msg_data, mock_msg->data, msg_dlc);
+#if defined(CAN_MGR_STM32_APPLICATION) && CAN_MGR_CAN_WAIT_ENABLED == 1
+  _can_mgr_wait(hcan);
 #endif
-  int index = can_mgr_from_id_to_index(can_id, msg_id);
-  if (index < 0) {
-    // ignore the message
-  } else if (index >= _can_mgr_msg_states_sizes[can_id]) {
+  can_mgr_hal_code = _can_mgr_add_tx_frame(hcan, msg->id, msg->flags, msg->size, msg->data);
+  if (can_mgr_hal_code != HAL_OK) {
+    can_mgr_error_code = can_mgr_hal_can_send_error;
+    return -1;
+  }
+#if CAN_MGR_STATS_ENABLED > 0
+  _can_mgr_stats_tx(can_id, msg->size);
+#endif
+  return 0;
+#endif
+}
+
+#if CAN_MGR_TX_QUEUE_SIZE > 0
+int can_mgr_tx_queue_size(int can_id) {
+  CAN_MGR_ID_CHECK(can_id);
+  return min_heap_size(&_can_mgr_tx_queues[can_id]);
+}
+
+void can_mgr_tx_it_callback(CAN_HandleTypeDef *hcan) {
+  for (int can_id = 0; can_id < _can_mgr_current_can_counter; ++can_id) {
+    if (_can_mgr_peripherals[can_id] == hcan) {
+      CAN_MGR_CS_ENTER();
+      _can_mgr_tx_refill(can_id);
+      CAN_MGR_CS_EXIT();
+      return;
+    }
+  }
+}
+#endif
+
+#if CAN_MGR_SCHEDULE_WHEEL_SIZE > 0
+static inline void _can_mgr_schedule_insert(int can_id, int16_t index) {
+  can_mgr_schedule_entry_t *entry = &_can_mgr_schedule_tables[can_id][index];
+  int16_t *slot = &_can_mgr_schedule_wheel[can_id][entry->_due & (CAN_MGR_SCHEDULE_WHEEL_SIZE - 1)];
+  entry->_next = *slot;
+  *slot = index;
+}
+
+int can_mgr_schedule_config(int can_id, can_mgr_schedule_entry_t *table, size_t size, uint32_t now) {
+  CAN_MGR_ID_CHECK(can_id);
+  if (size > INT16_MAX || (table == NULL && size > 0)) {
+    can_mgr_error_code = can_mgr_schedule_invalid_entry_error;
+    return -1;
+  }
+  for (size_t i = 0; i < size; ++i) {
+    if (table[i].period == 0 || table[i].size > 8) {
+      can_mgr_error_code = can_mgr_schedule_invalid_entry_error;
+      return -1;
+    }
+  }
+
+  _can_mgr_schedule_tables[can_id] = table;
+  _can_mgr_schedule_sizes[can_id] = size;
+  for (size_t i = 0; i < CAN_MGR_SCHEDULE_WHEEL_SIZE; ++i)
+    _can_mgr_schedule_wheel[can_id][i] = CAN_MGR_SCHEDULE_NONE;
+  // The messages with offset 0 are due at the first tick
+  _can_mgr_schedule_last_tick[can_id] = now - 1;
+  for (size_t i = 0; i < size; ++i) {
+    table[i]._due = now + table[i].offset % table[i].period;
+    _can_mgr_schedule_insert(can_id, i);
+  }
+  return 0;
+}
+
+int can_mgr_schedule_tick(int can_id, uint32_t now) {
+  CAN_MGR_ID_CHECK(can_id);
+  can_mgr_schedule_entry_t *table = _can_mgr_schedule_tables[can_id];
+  uint32_t elapsed = now - _can_mgr_schedule_last_tick[can_id];
+  if (table == NULL || elapsed == 0 || elapsed > INT32_MAX)
+    return 0;
+  _can_mgr_schedule_last_tick[can_id] = now;
+
+  // If some ticks were missed all the slots in between are visited
+  uint32_t steps = elapsed < CAN_MGR_SCHEDULE_WHEEL_SIZE ? elapsed : CAN_MGR_SCHEDULE_WHEEL_SIZE;
+  can_mgr_msg_t batch[CAN_MGR_SCHEDULE_BATCH_SIZE];
+  size_t batch_size = 0;
+  int sent = 0;
+  for (uint32_t tick = now - steps + 1; steps > 0; ++tick, --steps) {
+    int16_t *slot = &_can_mgr_schedule_wheel[can_id][tick & (CAN_MGR_SCHEDULE_WHEEL_SIZE - 1)];
+    int16_t index = *slot;
+    *slot = CAN_MGR_SCHEDULE_NONE;
+    while (index != CAN_MGR_SCHEDULE_NONE) {
+      can_mgr_schedule_entry_t *entry = &table[index];
+      int16_t next = entry->_next;
+      // Entries more than one turn of the wheel away are left in their slot
+      if ((int32_t)(entry->_due - now) <= 0) {
+        can_mgr_msg_t *msg = &batch[batch_size];
+        msg->id = entry->id;
+        msg->size = entry->size;
+        if (entry->fill == NULL || entry->fill(msg) == 0)
+          ++batch_size;
+        // A late message is sent once and not once for every missed period
+        do
+          entry->_due += entry->period;
+        while ((int32_t)(entry->_due - now) <= 0);
+
+        if (batch_size == CAN_MGR_SCHEDULE_BATCH_SIZE) {
+          int ret = can_mgr_send_n(can_id, batch, batch_size);
+          sent += ret > 0 ? ret : 0;
+          batch_size = 0;
+        }
+      }
+      _can_mgr_schedule_insert(can_id, index);
+      index = next;
+    }
+  }
+  if (batch_size > 0) {
+    int ret = can_mgr_send_n(can_id, batch, batch_size);
+    sent += ret > 0 ? ret : 0;
+  }
+  return sent;
+}
+
+int can_mgr_schedule_balance(can_mgr_schedule_entry_t *table, size_t size) {
+  if (size > INT16_MAX || (table == NULL && size > 0)) {
+    can_mgr_error_code = can_mgr_schedule_invalid_entry_error;
+    return -1;
+  }
+  // The wheel of a configured table would keep the old offsets
+  for (int can_id = 0; can_id < _can_mgr_current_can_counter; ++can_id) {
+    if (table != NULL && _can_mgr_schedule_tables[can_id] == table) {
+      can_mgr_error_code = can_mgr_schedule_invalid_entry_error;
+      return -1;
+    }
+  }
+  for (size_t i = 0; i < size; ++i) {
+    if (table[i].period == 0) {
+      can_mgr_error_code = can_mgr_schedule_invalid_entry_error;
+      return -1;
+    }
+  }
+
+  // Bus time (in bits) allocated to each slot of one turn of the wheel
+  uint32_t load[CAN_MGR_SCHEDULE_WHEEL_SIZE] = {0};
+
+  /**
+   * Greedy placement, the entries with the shortest period are the most
+   * constrained and are placed first in the offset that minimizes the
+   * highest load of the slots where they are sent. The entries are visited
+   * in order of (period, index), so no mark is written in the table
+   */
+  can_mgr_schedule_entry_t *prev = NULL;
+  for (size_t placed = 0; placed < size; ++placed) {
+    can_mgr_schedule_entry_t *entry = NULL;
+    for (size_t i = 0; i < size; ++i) {
+      can_mgr_schedule_entry_t *e = &table[i];
+      if (prev != NULL && (e->period < prev->period || (e->period == prev->period && e <= prev)))
+        continue;
+      if (entry == NULL || e->period < entry->period)
+        entry = e;
+    }
+    prev = entry;
+
+    uint32_t candidates = entry->period < CAN_MGR_SCHEDULE_WHEEL_SIZE ? entry->period : CAN_MGR_SCHEDULE_WHEEL_SIZE;
+    uint32_t best_offset = 0, best_max = UINT32_MAX, best_sum = UINT32_MAX;
+    for (uint32_t offset = 0; offset < candidates; ++offset) {
+      uint32_t max = 0, sum = 0;
+      for (uint32_t slot = offset; slot < CAN_MGR_SCHEDULE_WHEEL_SIZE; slot += entry->period) {
+        if (load[slot] > max)
+          max = load[slot];
+        sum += load[slot];
+      }
+      if (max < best_max || (max == best_max && sum < best_sum)) {
+        best_offset = offset;
+        best_max = max;
+        best_sum = sum;
+      }
+    }
+    entry->offset = best_offset;
+    for (uint32_t slot = best_offset; slot < CAN_MGR_SCHEDULE_WHEEL_SIZE; slot += entry->period)
+      load[slot] += _can_mgr_frame_bits(entry->size);
+  }
+  return 0;
+}
+
+static uint32_t _can_mgr_gcd(uint32_t a, uint32_t b) {
+  while (b != 0) {
+    uint32_t r = a % b;
+    a = b;
+    b = r;
+  }
+  return a;
+}
+
+int can_mgr_schedule_stats(const can_mgr_schedule_entry_t *table, size_t size, uint32_t tick_us, uint32_t bitrate, can_mgr_schedule_stats_t *stats) {
+  if (stats == NULL || tick_us == 0 || bitrate == 0 || (table == NULL && size > 0)) {
+    can_mgr_error_code = can_mgr_schedule_invalid_entry_error;
+    return -1;
+  }
+
+  // The schedule repeats after the least common multiple of the periods
+  uint64_t window = 1;
+  float utilization = 0.0f;
+  for (size_t i = 0; i < size; ++i) {
+    if (table[i].period == 0) {
+      can_mgr_error_code = can_mgr_schedule_invalid_entry_error;
+      return -1;
+    }
+    if (window < CAN_MGR_SCHEDULE_STATS_MAX_WINDOW)
+      window = window / _can_mgr_gcd(window, table[i].period) * table[i].period;
+    utilization += (float)_can_mgr_frame_bits(table[i].size) * 1e6f / ((float)table[i].period * tick_us * bitrate);
+  }
+  if (window > CAN_MGR_SCHEDULE_STATS_MAX_WINDOW)
+    window = CAN_MGR_SCHEDULE_STATS_MAX_WINDOW;
+
+  uint32_t max_burst = 0, max_burst_bits = 0;
+  for (uint32_t tick = 0; tick < window; ++tick) {
+    uint32_t burst = 0, burst_bits = 0;
+    for (size_t i = 0; i < size; ++i) {
+      if (tick % table[i].period == table[i].offset % table[i].period) {
+        ++burst;
+        burst_bits += _can_mgr_frame_bits(table[i].size);
+      }
+    }
+    if (burst > max_burst)
+      max_burst = burst;
+    if (burst_bits > max_burst_bits)
+      max_burst_bits = burst_bits;
+  }
+
+  stats->window = window;
+  stats->max_burst = max_burst;
+  stats->max_burst_time_us = (uint32_t)((uint64_t)max_burst_bits * 1000000U / bitrate);
+  stats->utilization = utilization;
+  return 0;
+}
+#endif
+
+#if CAN_MGR_STATS_ENABLED > 0
+int can_mgr_config_stats(int can_id, can_mgr_id_stats_t *id_stats, uint32_t bitrate) {
+  CAN_MGR_ID_CHECK(can_id);
+  if (id_stats != NULL)
+    memset(id_stats, 0, _can_mgr_msg_states_sizes[can_id] * sizeof(*id_stats));
+  _can_mgr_id_stats[can_id] = id_stats;
+  _can_mgr_stats_bitrate[can_id] = bitrate;
+  memset(&_can_mgr_stats[can_id], 0, sizeof(_can_mgr_stats[can_id]));
+  _can_mgr_stats_window_bits[can_id] = 0;
+  _can_mgr_stats_window_start[can_id] = can_mgr_stats_get_time_us();
+  return 0;
+}
+
+int can_mgr_stats_get(int can_id, can_mgr_stats_t *out) {
+  CAN_MGR_ID_CHECK(can_id);
+  // The load decreases even if no message is received
+  _can_mgr_stats_update_load(can_id, can_mgr_stats_get_time_us());
+  memcpy(out, &_can_mgr_stats[can_id], sizeof(*out));
+  return 0;
+}
+
+void can_mgr_stats_error_callback(CAN_HandleTypeDef *hcan, uint32_t hal_error) {
+  for (int can_id = 0; can_id < _can_mgr_current_can_counter; ++can_id) {
+    if (_can_mgr_peripherals[can_id] == hcan) {
+      if (hal_error & HAL_CAN_ERROR_RX_FOV0)
+        ++_can_mgr_stats[can_id].fifo_overruns;
+      if (hal_error & HAL_CAN_ERROR_RX_FOV1)
+        ++_can_mgr_stats[can_id].fifo_overruns;
+      return;
+    }
+  }
+}
+
+int can_mgr_stats_format(int can_id, char *buf, size_t size) {
+  CAN_MGR_ID_CHECK(can_id);
+  can_mgr_stats_t stats;
+  can_mgr_stats_get(can_id, &stats);
+  return snprintf(buf, size,
+                  "can%d rx %lu tx %lu unknown %lu oob %lu overwritten %lu overrun %lu load %u.%u%% max %u.%u%%\r\n",
+                  can_id, (unsigned long)stats.rx_frames, (unsigned long)stats.tx_frames,
+                  (unsigned long)stats.unknown_ids, (unsigned long)stats.out_of_bound,
+                  (unsigned long)stats.overwritten, (unsigned long)stats.fifo_overruns,
+                  stats.bus_load / 10U, stats.bus_load % 10U, stats.max_bus_load / 10U, stats.max_bus_load % 10U);
+}
+
+int can_mgr_stats_format_id(int can_id, int index, char *buf, size_t size) {
+  CAN_MGR_ID_CHECK(can_id);
+  if (_can_mgr_id_stats[can_id] == NULL || index < 0 || index >= _can_mgr_msg_states_sizes[can_id]) {
     can_mgr_error_code = can_mgr_index_out_of_bound_error;
+    return -1;
+  }
+  can_mgr_id_stats_t *id_stats = &_can_mgr_id_stats[can_id][index];
+  if (id_stats->count == 0)
+    return 0;
+  uint32_t avg = id_stats->count > 1 ? id_stats->sum_period_us / (id_stats->count - 1) : 0;
+  return snprintf(buf, size, "0x%03lX n %lu period us min %lu avg %lu max %lu jitter %lu\r\n",
+                  (unsigned long)id_stats->id, (unsigned long)id_stats->count, (unsigned long)id_stats->min_period_us,
+                  (unsigned long)avg, (unsigned long)id_stats->max_period_us,
+                  (unsigned long)(id_stats->max_period_us - id_stats->min_period_us));
+}
+#endif
+
+#if CAN_MGR_TIMEOUT_HEAP_SIZE > 0
+int can_mgr_config_timeouts(int can_id, can_mgr_timeout_t *timeouts, can_mgr_timeout_callback_t callback, uint32_t now) {
+  CAN_MGR_ID_CHECK(can_id);
+  _can_mgr_timeouts[can_id] = NULL;
+  _can_mgr_deadlines_size[can_id] = 0;
+  if (timeouts == NULL)
+    return 0;
+
+  for (int i = 0; i < _can_mgr_msg_states_sizes[can_id]; ++i) {
+    timeouts[i].last_rx = now;
+    timeouts[i].stale = 0;
+    if (timeouts[i].period == 0)
+      continue;
+    if (_can_mgr_deadlines_size[can_id] == CAN_MGR_TIMEOUT_HEAP_SIZE) {
+      _can_mgr_deadlines_size[can_id] = 0;
+      can_mgr_error_code = can_mgr_timeout_heap_full_error;
+      return -1;
+    }
+    _can_mgr_deadline_t deadline = {.deadline = now + timeouts[i].period * CAN_MGR_TIMEOUT_PERIODS, .index = i};
+    _can_mgr_deadline_push(can_id, deadline);
+  }
+  _can_mgr_timeout_callbacks[can_id] = callback;
+  _can_mgr_timeouts[can_id] = timeouts;
+  return 0;
+}
+
+int can_mgr_check_timeouts(int can_id, uint32_t now) {
+  CAN_MGR_ID_CHECK(can_id);
+  can_mgr_timeout_t *timeouts = _can_mgr_timeouts[can_id];
+  if (timeouts == NULL)
+    return 0;
+
+  int expired = 0;
+  _can_mgr_deadline_t *heap = _can_mgr_deadlines[can_id];
+  while (_can_mgr_deadlines_size[can_id] > 0 && !_can_mgr_deadline_before(now, heap[0].deadline)) {
+    _can_mgr_deadline_t deadline = heap[0];
+    can_mgr_timeout_t *timeout = &timeouts[deadline.index];
+
+    uint32_t last_rx = __atomic_load_n(&timeout->last_rx, __ATOMIC_RELAXED);
+    deadline.deadline = last_rx + timeout->period * CAN_MGR_TIMEOUT_PERIODS;
+    if ((int32_t)(deadline.deadline - now) > 0) {
+      // Received in the meantime, the deadline is only moved forward
+      if (timeout->stale) {
+        timeout->stale = 0;
+        if (_can_mgr_timeout_callbacks[can_id] != NULL)
+          _can_mgr_timeout_callbacks[can_id](can_id, deadline.index, 0);
+      }
+    } else {
+      if (!timeout->stale) {
+        timeout->stale = 1;
+        ++expired;
+        if (_can_mgr_timeout_callbacks[can_id] != NULL)
+          _can_mgr_timeout_callbacks[can_id](can_id, deadline.index, 1);
+      }
+      // Checked again after a period to detect when the sender comes back
+      deadline.deadline = now + timeout->period;
+    }
+    _can_mgr_deadline_replace_top(can_id, deadline);
+  }
+  return expired;
+}
+
+int can_mgr_is_stale(int can_id, int index) {
+  CAN_MGR_ID_CHECK(can_id);
+  if (_can_mgr_timeouts[can_id] == NULL || index < 0 || index >= _can_mgr_msg_states_sizes[can_id]) {
+    can_mgr_error_code = can_mgr_index_out_of_bound_error;
+    return -1;
+  }
+  return _can_mgr_timeouts[can_id][index].stale;
+}
+#endif
+
+static inline uint32_t _can_mgr_filter_group_size(_can_mgr_filter_group_t *group) {
+  return 1U << (11 - __builtin_popcount(group->mask));
+}
+
+static inline int _can_mgr_filter_group_is_list(_can_mgr_filter_group_t *group) {
+  return group->mask == CAN_MGR_FILTER_STD_MASK;
+}
+
+static size_t _can_mgr_filter_banks(_can_mgr_filter_group_t *groups, size_t size) {
+  size_t masks = 0;
+  for (size_t i = 0; i < size; ++i)
+    masks += !_can_mgr_filter_group_is_list(&groups[i]);
+  size_t lists = size - masks;
+  // A single ID can use the free entry of a mask bank
+  size_t free_mask_entries = masks % CAN_MGR_FILTER_MASKS_PER_BANK;
+  lists = lists > free_mask_entries ? lists - free_mask_entries : 0;
+  return (masks + CAN_MGR_FILTER_MASKS_PER_BANK - 1) / CAN_MGR_FILTER_MASKS_PER_BANK +
+         (lists + CAN_MGR_FILTER_LIST_PER_BANK - 1) / CAN_MGR_FILTER_LIST_PER_BANK;
+}
+
+static int32_t _can_mgr_filter_false_accepts(_can_mgr_filter_group_t *group, uint16_t *ids, size_t size) {
+  int32_t accepted = _can_mgr_filter_group_size(group);
+  for (size_t i = 0; i < size; ++i)
+    accepted -= (ids[i] & group->mask) == group->id;
+  return accepted;
+}
+
+static inline _can_mgr_filter_group_t _can_mgr_filter_merge(_can_mgr_filter_group_t *a, _can_mgr_filter_group_t *b) {
+  uint16_t mask = a->mask & b->mask & ~(a->id ^ b->id) & CAN_MGR_FILTER_STD_MASK;
+  return (_can_mgr_filter_group_t){.id = a->id & mask, .mask = mask};
+}
+
+static inline uint16_t _can_mgr_filter_16bit(uint16_t value) {
+  return (uint16_t)(value << 5);
+}
+
+static void _can_mgr_filter_fill(CAN_FilterTypeDef *filter, uint32_t bank, uint32_t fifo, uint32_t mode) {
+  memset(filter, 0, sizeof(*filter));
+  filter->FilterBank = bank;
+  filter->FilterFIFOAssignment = fifo;
+  filter->FilterMode = mode;
+  filter->FilterScale = CAN_FILTERSCALE_16BIT;
+  filter->FilterActivation = ENABLE;
+}
+
+// Index of the first list entry from the given one, size if there is none
+static inline size_t _can_mgr_filter_next_list(_can_mgr_filter_group_t *groups, size_t size, size_t from) {
+  while (from < size && !_can_mgr_filter_group_is_list(&groups[from]))
+    ++from;
+  return from;
+}
+
+int can_mgr_filter_optimize(const uint16_t *ids, size_t ids_size, CAN_FilterTypeDef *filters, size_t max_banks, uint32_t first_bank, uint32_t fifo, can_mgr_filter_report_t *report, can_mgr_filter_scratch_t *scratch) {
+  if ((ids == NULL && ids_size > 0) || filters == NULL || max_banks == 0 || scratch == NULL) {
+    can_mgr_error_code = can_mgr_filter_invalid_error;
+    return -1;
+  }
+  uint8_t *wanted = scratch->wanted;
+  uint16_t *wanted_ids = scratch->ids;
+  _can_mgr_filter_group_t *groups = scratch->groups;
+  memset(wanted, 0, sizeof(scratch->wanted));
+  size_t wanted_count = 0;
+  for (size_t i = 0; i < ids_size; ++i) {
+    if (ids[i] >= CAN_MGR_STD_ID_COUNT) {
+      can_mgr_error_code = can_mgr_filter_invalid_error;
+      return -1;
+    }
+    if (!(wanted[ids[i] / 8] & (1U << (ids[i] % 8)))) {
+      wanted[ids[i] / 8] |= 1U << (ids[i] % 8);
+      ++wanted_count;
+    }
+  }
+  if (wanted_count > CAN_MGR_FILTER_MAX_IDS) {
+    can_mgr_error_code = can_mgr_filter_too_many_ids_error;
+    return -1;
+  }
+
+  // Start from one list entry for each ID
+  size_t size = 0;
+  for (uint16_t id = 0; id < CAN_MGR_STD_ID_COUNT; ++id)
+    if (wanted[id / 8] & (1U << (id % 8))) {
+      wanted_ids[size] = id;
+      groups[size++] = (_can_mgr_filter_group_t){.id = id, .mask = CAN_MGR_FILTER_STD_MASK};
+    }
+
+  /**
+   * Greedy merge of the filter entries until they fit in the banks, each step
+   * merges the pair of entries that adds the least unwanted IDs (preferring
+   * the merges that free more space, a mask entry takes two list entries)
+   */
+  while (_can_mgr_filter_banks(groups, size) > max_banks) {
+    size_t best_a = 0, best_b = 1;
+    int32_t best_cost = INT32_MAX, best_gain = 0;
+    for (size_t a = 0; a < size; ++a) {
+      for (size_t b = a + 1; b < size; ++b) {
+        _can_mgr_filter_group_t merged = _can_mgr_filter_merge(&groups[a], &groups[b]);
+        int32_t cost = _can_mgr_filter_false_accepts(&merged, wanted_ids, wanted_count) -
+                       _can_mgr_filter_false_accepts(&groups[a], wanted_ids, wanted_count) -
+                       _can_mgr_filter_false_accepts(&groups[b], wanted_ids, wanted_count);
+        int32_t gain = (_can_mgr_filter_group_is_list(&groups[a]) ? 1 : 2) +
+                       (_can_mgr_filter_group_is_list(&groups[b]) ? 1 : 2) - 2;
+        if (cost < best_cost || (cost == best_cost && gain > best_gain)) {
+          best_a = a;
+          best_b = b;
+          best_cost = cost;
+          best_gain = gain;
+        }
+      }
+    }
+
+    // best_a < best_b so the merged entry is not moved by the removal
+    groups[best_a] = _can_mgr_filter_merge(&groups[best_a], &groups[best_b]);
+    groups[best_b] = groups[--size];
+    // Remove the entries already accepted by the new one
+    size_t merged = best_a;
+    for (size_t i = 0; i < size;) {
+      if (i != merged && (groups[i].mask & groups[merged].mask) == groups[merged].mask &&
+          (groups[i].id & groups[merged].mask) == groups[merged].id) {
+        groups[i] = groups[--size];
+        if (merged == size)
+          merged = i;
+      } else {
+        ++i;
+      }
+    }
+  }
+
+  // Mask banks first, then the list banks
+  size_t banks = 0, list_count = 0, mask_count = 0;
+  for (size_t i = 0; i < size; ++i)
+    list_count += _can_mgr_filter_group_is_list(&groups[i]);
+  size_t next_list = _can_mgr_filter_next_list(groups, size, 0);
+  for (size_t i = 0; i < size; ++i) {
+    if (_can_mgr_filter_group_is_list(&groups[i]))
+      continue;
+    uint16_t id = _can_mgr_filter_16bit(groups[i].id);
+    uint16_t mask = _can_mgr_filter_16bit(groups[i].mask) | CAN_MGR_FILTER_16BIT_FLAGS_MASK;
+    if (mask_count % CAN_MGR_FILTER_MASKS_PER_BANK == 0) {
+      _can_mgr_filter_fill(&filters[banks], first_bank + banks, fifo, CAN_FILTERMODE_IDMASK);
+      filters[banks].FilterIdLow = id;
+      filters[banks].FilterMaskIdLow = mask;
+      // The second entry is a copy until it is used
+      filters[banks].FilterIdHigh = id;
+      filters[banks].FilterMaskIdHigh = mask;
+      ++banks;
+    } else {
+      filters[banks - 1].FilterIdHigh = id;
+      filters[banks - 1].FilterMaskIdHigh = mask;
+    }
+    ++mask_count;
+  }
+  if (mask_count % CAN_MGR_FILTER_MASKS_PER_BANK != 0 && next_list < size) {
+    filters[banks - 1].FilterIdHigh = _can_mgr_filter_16bit(groups[next_list].id);
+    next_list = _can_mgr_filter_next_list(groups, size, next_list + 1);
+    filters[banks - 1].FilterMaskIdHigh = _can_mgr_filter_16bit(CAN_MGR_FILTER_STD_MASK) | CAN_MGR_FILTER_16BIT_FLAGS_MASK;
+  }
+  while (next_list < size) {
+    CAN_FilterTypeDef *filter = &filters[banks];
+    _can_mgr_filter_fill(filter, first_bank + banks, fifo, CAN_FILTERMODE_IDLIST);
+    uint32_t *entries[CAN_MGR_FILTER_LIST_PER_BANK] = {&filter->FilterIdLow, &filter->FilterMaskIdLow, &filter->FilterIdHigh, &filter->FilterMaskIdHigh};
+    // The unused entries repeat the first ID
+    uint16_t first = _can_mgr_filter_16bit(groups[next_list].id);
+    for (size_t e = 0; e < CAN_MGR_FILTER_LIST_PER_BANK; ++e) {
+      *entries[e] = next_list < size ? _can_mgr_filter_16bit(groups[next_list].id) : first;
+      next_list = _can_mgr_filter_next_list(groups, size, next_list + 1);
+    }
+    ++banks;
+  }
+
+  if (report != NULL) {
+    size_t accepted = 0;
+    for (uint16_t id = 0; id < CAN_MGR_STD_ID_COUNT; ++id) {
+      for (size_t i = 0; i < size; ++i) {
+        if ((id & groups[i].mask) == groups[i].id) {
+          ++accepted;
+          break;
+        }
+      }
+    }
+    report->banks = banks;
+    report->list_entries = list_count;
+    report->mask_entries = mask_count;
+    report->accepted = accepted;
+    report->false_accepts = accepted - wanted_count;
+    report->false_accept_ratio = accepted > 0 ? (float)report->false_accepts / accepted : 0.0f;
+  }
+  return banks;
+}
+
+int can_mgr_config_filters(int can_id, CAN_FilterTypeDef *filters, size_t count) {
+  CAN_MGR_ID_CHECK(can_id);
+#ifdef CAN_MGR_STM32_APPLICATION
+  for (size_t i = 0; i < count; ++i) {
+    can_mgr_hal_code = HAL_CAN_ConfigFilter(_can_mgr_peripherals[can_id], &filters[i]);
+    if (can_mgr_hal_code != HAL_OK) {
+      can_mgr_error_code = can_mgr_hal_config_filter_error;
+      return -1;
+    }
+  }
+#endif
+  return 0;
+}
+
+/**
+ * Read the ID and the data length code of the message at the head of the
+ * receive FIFO without releasing it, so that the payload can be copied
+ * directly into its message state
+ */
+static void _can_mgr_rx_peek(CAN_HandleTypeDef *hcan, uint32_t rx_fifo_assignment, uint32_t *msg_id, uint8_t *flags, uint8_t *dlc) {
+#ifdef CAN_MGR_STM32_APPLICATION
+  CAN_FIFOMailBox_TypeDef *mailbox = &hcan->Instance->sFIFOMailBox[rx_fifo_assignment];
+  uint32_t rir = mailbox->RIR;
+  if (rir & CAN_RI0R_IDE) {
+    *msg_id = ((CAN_RI0R_EXID | CAN_RI0R_STID) & rir) >> CAN_RI0R_EXID_Pos;
+    *flags = CAN_MGR_MSG_EXT_ID;
   } else {
-    _can_mgr_is_new_message[can_id][index] = 1;
-    _can_mgr_msg_states[can_id][index].id = msg_id;
-    _can_mgr_msg_states[can_id][index].size = msg_dlc;
-    memcpy(_can_mgr_msg_states[can_id][index].data, msg_data, msg_dlc);
+    *msg_id = (CAN_RI0R_STID & rir) >> CAN_TI0R_STID_Pos;
+    *flags = 0;
+  }
+  *dlc = (CAN_RDT0R_DLC & mailbox->RDTR) >> CAN_RDT0R_DLC_Pos;
+#else
+  CAN_RxHeaderTypeDef *header = &hcan->rx_header;
+  *msg_id = header->IDE == CAN_ID_EXT ? header->ExtId : header->StdId;
+  *flags = (header->IDE == CAN_ID_EXT ? CAN_MGR_MSG_EXT_ID : 0) | (header->FDFormat ? CAN_MGR_MSG_FD : 0);
+  *dlc = header->DLC;
+#endif
+}
+
+/**
+ * Get the ID and the size of a classic message, from mock_msg in the
+ * simulation or from the receive FIFO (on STM32 or if mock_msg is NULL)
+ * @return The standard ID or -1 for extended IDs and CAN FD frames
+ */
+static int _can_mgr_rx_classic_peek(CAN_HandleTypeDef *hcan, uint32_t rx_fifo_assignment, can_mgr_msg_t *mock_msg, uint8_t *size) {
+#ifndef CAN_MGR_STM32_APPLICATION
+  if (mock_msg != NULL) {
+    *size = mock_msg->size;
+    return mock_msg->id;
+  }
+#endif
+  uint32_t msg_id;
+  uint8_t flags;
+  _can_mgr_rx_peek(hcan, rx_fifo_assignment, &msg_id, &flags, size);
+  if (flags & (CAN_MGR_MSG_EXT_ID | CAN_MGR_MSG_FD))
+    return -1;
+  // A classic frame with a DLC from 9 to 15 carries 8 bytes (ISO 11898-1)
+  if (*size > CAN_MGR_CLASSIC_MAX_SIZE)
+    *size = CAN_MGR_CLASSIC_MAX_SIZE;
+  return msg_id;
+}
+
+/**
+ * Copy the payload of a classic message into data (at least 8 bytes, or
+ * CAN_MGR_FD_MAX_SIZE if the message is discarded) and release the FIFO
+ */
+static inline void _can_mgr_rx_classic_read(CAN_HandleTypeDef *hcan, uint32_t rx_fifo_assignment, can_mgr_msg_t *mock_msg, uint8_t *data) {
+#ifndef CAN_MGR_STM32_APPLICATION
+  if (mock_msg != NULL) {
+    memcpy(data, mock_msg->data, mock_msg->size);
+    return;
+  }
+#endif
+  CAN_RxHeaderTypeDef header;
+  HAL_CAN_GetRxMessage(hcan, rx_fifo_assignment, &header, data);
+}
+
+#if CAN_MGR_RX_QUEUE_SIZE > 0
+int can_mgr_rx_queue_enable(int can_id, uint8_t enable) {
+  CAN_MGR_ID_CHECK(can_id);
+  _can_mgr_rx_queue_enabled[can_id] = enable;
+  return 0;
+}
+
+int can_mgr_rx_drain(int can_id, can_mgr_msg_t *out, size_t count) {
+  CAN_MGR_ID_CHECK(can_id);
+  return ring_buffer_spsc_pop_n(&_can_mgr_rx_queues[can_id], out, count);
+}
+
+int can_mgr_rx_dropped(int can_id) {
+  CAN_MGR_ID_CHECK(can_id);
+  return _can_mgr_rx_dropped[can_id];
+}
+
+static void _can_mgr_rx_queue_push(CAN_HandleTypeDef *hcan, int can_id, uint32_t rx_fifo_assignment, can_mgr_msg_t *mock_msg) {
+  uint8_t size;
+  int msg_id = _can_mgr_rx_classic_peek(hcan, rx_fifo_assignment, mock_msg, &size);
+  // The message is written directly inside the queue
+  can_mgr_msg_t *slot = msg_id < 0 ? NULL : ring_buffer_spsc_reserve(&_can_mgr_rx_queues[can_id]);
+  if (slot == NULL) {
+    // The message has to be read anyway to release the FIFO
+    uint8_t discard[CAN_MGR_FD_MAX_SIZE];
+    _can_mgr_rx_classic_read(hcan, rx_fifo_assignment, mock_msg, discard);
+#if CAN_MGR_STATS_ENABLED > 0
+    // The frame has used the bus even if it is not kept (size is the DLC of
+    // the frames that are not classic)
+    ++_can_mgr_stats[can_id].rx_frames;
+    _can_mgr_stats_window_bits[can_id] += _can_mgr_frame_bits(can_mgr_dlc_to_size(size));
+    _can_mgr_stats_update_load(can_id, can_mgr_stats_get_time_us());
+#endif
+    // Extended IDs and CAN FD frames are not kept by the queue
+    if (msg_id >= 0) {
+      ++_can_mgr_rx_dropped[can_id];
+      can_mgr_error_code = can_mgr_rx_queue_full_error;
+    }
+    return;
+  }
+  _can_mgr_rx_classic_read(hcan, rx_fifo_assignment, mock_msg, slot->data);
+  slot->id = msg_id;
+  slot->size = size;
+#if CAN_MGR_STATS_ENABLED > 0 || CAN_MGR_TIMEOUT_HEAP_SIZE > 0
+  int index = can_mgr_id_to_index(can_id, slot->id);
+#endif
+#if CAN_MGR_STATS_ENABLED > 0
+  _can_mgr_stats_rx(can_id, slot->id, slot->size, index);
+#endif
+#if CAN_MGR_TIMEOUT_HEAP_SIZE > 0
+  _can_mgr_timeout_rx(can_id, index);
+#endif
+  ring_buffer_spsc_commit(&_can_mgr_rx_queues[can_id]);
+}
+#endif
+
+
+#if CAN_MGR_FD_ENABLED > 0
+static void _can_mgr_fd_it_callback(CAN_HandleTypeDef *hcan, int can_id, uint32_t rx_fifo_assignment) {
+  uint32_t msg_id;
+  uint8_t flags, dlc;
+  _can_mgr_rx_peek(hcan, rx_fifo_assignment, &msg_id, &flags, &dlc);
+  uint8_t size = can_mgr_dlc_to_size(dlc);
+  int index = can_mgr_id_to_index(can_id, (flags & CAN_MGR_MSG_EXT_ID) ? (int)(msg_id | CAN_MGR_EXT_ID_FLAG) : (int)msg_id);
+#if CAN_MGR_STATS_ENABLED > 0
+  _can_mgr_stats_rx(can_id, msg_id, size, index);
+#endif
+  CAN_RxHeaderTypeDef header;
+  can_mgr_fd_msg_t *state = NULL;
+  if (index >= _can_mgr_msg_states_sizes[can_id]) {
+    can_mgr_error_code = can_mgr_index_out_of_bound_error;
+  } else if (index >= 0) {
+    state = &_can_mgr_fd_states[can_id][index];
+    if (size > state->capacity) {
+      can_mgr_error_code = can_mgr_fd_buffer_too_small_error;
+      state = NULL;
+    }
+  }
+  if (state == NULL) {
+    // The message has to be read anyway to release the FIFO
+    uint8_t discard[CAN_MGR_FD_MAX_SIZE];
+    HAL_CAN_GetRxMessage(hcan, rx_fifo_assignment, &header, discard);
+    return;
   }
+
+#if CAN_MGR_STATS_ENABLED > 0
+  if (_can_mgr_is_new_message[can_id][index])
+    ++_can_mgr_stats[can_id].overwritten;
+#endif
+  uint32_t *seq = _can_mgr_msg_seq[can_id];
+  if (seq != NULL) {
+    __atomic_store_n(&seq[index], seq[index] + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+  }
+  // The payload is copied by the HAL straight into the buffer of the state
+  HAL_CAN_GetRxMessage(hcan, rx_fifo_assignment, &header, state->data);
+  state->id = msg_id;
+  state->flags = flags;
+  state->size = size;
+  if (seq != NULL)
+    __atomic_store_n(&seq[index], seq[index] + 1, __ATOMIC_RELEASE);
+  __atomic_store_n(&_can_mgr_is_new_message[can_id][index], 1, __ATOMIC_RELEASE);
+#if CAN_MGR_TIMEOUT_HEAP_SIZE > 0
+  _can_mgr_timeout_rx(can_id, index);
+#endif
 }
+#endif
 
+void can_mgr_it_callback(CAN_HandleTypeDef *hcan, uint32_t rx_fifo_assignment, can_mgr_msg_t *mock_msg) {
+  int can_id = _can_mgr_fifo_assignment[rx_fifo_assignment];
+#if CAN_MGR_RX_QUEUE_SIZE > 0
+  if (_can_mgr_rx_queue_enabled[can_id]) {
+    _can_mgr_rx_queue_push(hcan, can_id, rx_fifo_assignment, mock_msg);
+    return;
+  }
+#endif
+#if CAN_MGR_FD_ENABLED > 0
+  if (_can_mgr_fd_states[can_id] != NULL) {
+    _can_mgr_fd_it_callback(hcan, can_id, rx_fifo_assignment);
+    return;
+  }
+#endif
+  if (_can_mgr_msg_states[can_id] == NULL) {
+    return;
+  }
+  uint8_t msg_dlc;
+  int msg_id = _can_mgr_rx_classic_peek(hcan, rx_fifo_assignment, mock_msg, &msg_dlc);
+  int index = msg_id < 0 ? -1 : can_mgr_id_to_index(can_id, msg_id);
+#if CAN_MGR_STATS_ENABLED > 0
+  _can_mgr_stats_rx(can_id, msg_id, msg_dlc, index);
+#endif
+  if (index < 0 || index >= _can_mgr_msg_states_sizes[can_id]) {
+    if (index >= 0)
+      can_mgr_error_code = can_mgr_index_out_of_bound_error;
+    // The message has to be read anyway to release the FIFO
+    uint8_t discard[CAN_MGR_FD_MAX_SIZE];
+    _can_mgr_rx_classic_read(hcan, rx_fifo_assignment, mock_msg, discard);
+  } else {
+#if CAN_MGR_STATS_ENABLED > 0
+    if (_can_mgr_is_new_message[can_id][index])
+      ++_can_mgr_stats[can_id].overwritten;
+#endif
+    uint32_t *seq = _can_mgr_msg_seq[can_id];
+    if (seq != NULL) {
+      // Odd sequence number while the state is inconsistent
+      __atomic_store_n(&seq[index], seq[index] + 1, __ATOMIC_RELAXED);
+      __atomic_thread_fence(__ATOMIC_RELEASE);
+    }
+    can_mgr_msg_t *state = &_can_mgr_msg_states[can_id][index];
+    // The payload is copied straight into the state
+    _can_mgr_rx_classic_read(hcan, rx_fifo_assignment, mock_msg, state->data);
+    state->id = msg_id;
+    state->size = msg_dlc;
+    if (seq != NULL)
+      __atomic_store_n(&seq[index], seq[index] + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&_can_mgr_is_new_message[can_id][index], 1, __ATOMIC_RELEASE);
+#if CAN_MGR_TIMEOUT_HEAP_SIZE > 0
+    _can_mgr_timeout_rx(can_id, index);
+#endif
+  }
+}
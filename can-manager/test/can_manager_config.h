@@ -0,0 +1,18 @@
+#ifndef CAN_MANAGER_CONFIG_H
+#define CAN_MANAGER_CONFIG_H
+
+#define CAN_MGR_N_CAN 2
+#define CAN_MGR_TOTAL_CAN_RX_FIFOS 2
+#define CAN_MGR_CAN_WAIT_ENABLED 0
+#define CAN_MGR_ID_TABLE_SIZE 1024
+#define CAN_MGR_RX_QUEUE_SIZE 16
+#define CAN_MGR_TX_QUEUE_SIZE 32
+#define CAN_MGR_SCHEDULE_WHEEL_SIZE 64
+#define CAN_MGR_STATS_ENABLED 1
+#define CAN_MGR_STATS_WINDOW_US (100000U)
+#define CAN_MGR_TIMEOUT_HEAP_SIZE 512
+#define CAN_MGR_TIMEOUT_PERIODS 3
+#define CAN_MGR_FILTER_MAX_IDS 512
+#define CAN_MGR_FD_ENABLED 1
+
+#endif // CAN_MANAGER_CONFIG_H
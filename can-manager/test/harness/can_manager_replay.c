@@ -0,0 +1,295 @@
+/**
+ * @file can_manager_replay.c
+ * @brief Host side harness that replays CAN traffic through the receive
+ * interrupt path of the CAN manager
+ *
+ * @date 18 Oct 2026
+ * @author Giacomo Mazzucchi [giacomo.mazzucchi@protonmail.com]
+ */
+
+#include "can_manager_replay.h"
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CAN_MGR_REPLAY_LINE_SIZE 512
+// Waits longer than this are done with a sleep, shorter ones by spinning
+#define CAN_MGR_REPLAY_SPIN_NS (200000ULL)
+
+// State shared between the interrupt thread and the main loop
+typedef struct {
+  const can_mgr_replay_config_t *config;
+  const can_mgr_replay_frame_t *frames;
+  size_t count;
+  uint64_t start_ns;
+  // Interrupt time of the frames kept by the queue, in order
+  uint64_t *arrival_ns;
+  size_t accepted;
+  size_t dropped;
+  size_t ignored;
+  uint64_t isr_total_ns;
+  uint64_t isr_max_ns;
+  int done;
+} _can_mgr_replay_state_t;
+
+static uint64_t _can_mgr_replay_now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void _can_mgr_replay_sleep_ns(uint64_t ns) {
+  struct timespec ts = {.tv_sec = ns / 1000000000ULL, .tv_nsec = ns % 1000000000ULL};
+  nanosleep(&ts, NULL);
+}
+
+static void _can_mgr_replay_wait_until(uint64_t target_ns) {
+  uint64_t now;
+  while ((now = _can_mgr_replay_now_ns()) < target_ns) {
+    if (target_ns - now > CAN_MGR_REPLAY_SPIN_NS)
+      _can_mgr_replay_sleep_ns(target_ns - now - CAN_MGR_REPLAY_SPIN_NS / 2);
+  }
+}
+
+// Host time to log time
+static uint64_t _can_mgr_replay_log_ns(float speed, uint64_t ns) {
+  return speed > 0.0f ? (uint64_t)(ns * speed) : ns;
+}
+
+static int _can_mgr_replay_hex(char c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+int can_mgr_replay_parse_line(const char *line, can_mgr_replay_frame_t *frame, char *iface, uint64_t *time_us) {
+  uint64_t sec, usec;
+  char name[16], body[CAN_MGR_REPLAY_LINE_SIZE];
+  if (sscanf(line, " (%" SCNu64 ".%" SCNu64 ") %15s %511s", &sec, &usec, name, body) != 4)
+    return -1;
+  char *sep = strchr(body, '#');
+  if (sep == NULL)
+    return -1;
+  size_t id_len = sep - body;
+  if (id_len != 3 && id_len != 8)
+    return -1;
+
+  memset(frame, 0, sizeof(*frame));
+  for (size_t i = 0; i < id_len; ++i) {
+    int digit = _can_mgr_replay_hex(body[i]);
+    if (digit < 0)
+      return -1;
+    frame->id = (frame->id << 4) | digit;
+  }
+  if (id_len == 8)
+    frame->flags |= CAN_MGR_MSG_EXT_ID;
+  else if (frame->id > 0x7FFU)
+    return -1;
+
+  const char *data = sep + 1;
+  size_t max_size = 8U;
+  if (*data == 'R') {
+    // Remote frames are not handled by the CAN manager
+    return -1;
+  } else if (*data == '#') {
+    // CAN FD frame, the flags nibble is not used
+    if (_can_mgr_replay_hex(data[1]) < 0)
+      return -1;
+    frame->flags |= CAN_MGR_MSG_FD;
+    max_size = CAN_MGR_FD_MAX_SIZE;
+    data += 2;
+  }
+  while (*data != '\0') {
+    if (*data == '.') {
+      ++data;
+      continue;
+    }
+    int high = _can_mgr_replay_hex(data[0]);
+    int low = high < 0 ? -1 : _can_mgr_replay_hex(data[1]);
+    if (low < 0 || frame->size == max_size)
+      return -1;
+    frame->data[frame->size++] = (high << 4) | low;
+    data += 2;
+  }
+  if (can_mgr_dlc_to_size(can_mgr_size_to_dlc(frame->size)) != frame->size)
+    return -1;
+
+  if (iface != NULL)
+    strcpy(iface, name);
+  if (time_us != NULL)
+    *time_us = sec * 1000000ULL + usec;
+  return 0;
+}
+
+int can_mgr_replay_load(const char *path, const char *iface, can_mgr_replay_frame_t *frames, size_t max_frames) {
+  FILE *file = fopen(path, "r");
+  if (file == NULL)
+    return -1;
+  char line[CAN_MGR_REPLAY_LINE_SIZE];
+  char name[16];
+  uint64_t time_us, first_us = 0;
+  size_t count = 0;
+  while (count < max_frames && fgets(line, sizeof(line), file) != NULL) {
+    if (can_mgr_replay_parse_line(line, &frames[count], name, &time_us) < 0)
+      continue;
+    if (iface != NULL && strcmp(iface, name) != 0)
+      continue;
+    if (count == 0)
+      first_us = time_us;
+    frames[count++].time_us = time_us - first_us;
+  }
+  fclose(file);
+  return count;
+}
+
+size_t can_mgr_replay_burst(const can_mgr_replay_burst_t *burst, can_mgr_replay_frame_t *frames, size_t max_frames) {
+  // Standard data frame with the worst case number of stuff bits
+  uint64_t bits = 47U + 8U * burst->size + (34U + 8U * burst->size - 1U) / 4U;
+  uint64_t frame_ns = bits * 1000000000ULL / burst->bitrate;
+  size_t count = 0;
+  for (uint32_t b = 0; b < burst->bursts; ++b) {
+    for (uint32_t i = 0; i < burst->burst_length && count < max_frames; ++i) {
+      can_mgr_replay_frame_t *frame = &frames[count];
+      memset(frame, 0, sizeof(*frame));
+      frame->time_us = (uint64_t)b * burst->burst_period_us + (i * frame_ns) / 1000U;
+      frame->id = burst->ids[count % burst->ids_size];
+      frame->size = burst->size;
+      for (uint8_t d = 0; d < burst->size; ++d)
+        frame->data[d] = count + d;
+      ++count;
+    }
+  }
+  return count;
+}
+
+// Simulated interrupt: the frames are put in the receive FIFO at their time
+static void *_can_mgr_replay_isr(void *arg) {
+  _can_mgr_replay_state_t *state = arg;
+  const can_mgr_replay_config_t *config = state->config;
+  CAN_HandleTypeDef *hcan = config->hcan;
+  for (size_t i = 0; i < state->count; ++i) {
+    const can_mgr_replay_frame_t *frame = &state->frames[i];
+    if (config->speed > 0.0f)
+      _can_mgr_replay_wait_until(state->start_ns + (uint64_t)(frame->time_us * 1000.0 / config->speed));
+
+    uint8_t ext = (frame->flags & CAN_MGR_MSG_EXT_ID) != 0;
+    hcan->rx_header = (CAN_RxHeaderTypeDef){.StdId = ext ? 0 : frame->id,
+                                            .ExtId = ext ? frame->id : 0,
+                                            .IDE = ext ? CAN_ID_EXT : CAN_ID_STD,
+                                            .RTR = CAN_RTR_DATA,
+                                            .DLC = can_mgr_size_to_dlc(frame->size),
+                                            .FDFormat = (frame->flags & CAN_MGR_MSG_FD) != 0};
+    memcpy(hcan->rx_data, frame->data, frame->size);
+    int dropped = can_mgr_rx_dropped(config->can_id);
+
+    // Written before the interrupt so that it is visible with the message
+    uint64_t start = _can_mgr_replay_now_ns();
+    state->arrival_ns[state->accepted] = start;
+    can_mgr_it_callback(hcan, config->rx_fifo, NULL);
+    uint64_t elapsed = _can_mgr_replay_now_ns() - start;
+
+    state->isr_total_ns += elapsed;
+    if (elapsed > state->isr_max_ns)
+      state->isr_max_ns = elapsed;
+    if (frame->flags & (CAN_MGR_MSG_EXT_ID | CAN_MGR_MSG_FD))
+      ++state->ignored;
+    else if (can_mgr_rx_dropped(config->can_id) != dropped)
+      ++state->dropped;
+    else
+      __atomic_store_n(&state->accepted, state->accepted + 1, __ATOMIC_RELEASE);
+  }
+  __atomic_store_n(&state->done, 1, __ATOMIC_RELEASE);
+  return NULL;
+}
+
+static int _can_mgr_replay_compare(const void *a, const void *b) {
+  uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+  return (x > y) - (x < y);
+}
+
+int can_mgr_replay_run(const can_mgr_replay_config_t *config, const can_mgr_replay_frame_t *frames, size_t count, can_mgr_replay_report_t *report) {
+  if (config == NULL || config->hcan == NULL || report == NULL || config->drain_batch == 0)
+    return -1;
+  _can_mgr_replay_state_t state = {.config = config, .frames = frames, .count = count};
+  state.arrival_ns = malloc((count + 1) * sizeof(*state.arrival_ns));
+  uint32_t *latencies = malloc((count + 1) * sizeof(*latencies));
+  can_mgr_msg_t *batch = malloc(config->drain_batch * sizeof(*batch));
+  if (state.arrival_ns == NULL || latencies == NULL || batch == NULL) {
+    free(state.arrival_ns);
+    free(latencies);
+    free(batch);
+    return -1;
+  }
+  memset(report, 0, sizeof(*report));
+
+  pthread_t isr;
+  state.start_ns = _can_mgr_replay_now_ns();
+  if (pthread_create(&isr, NULL, _can_mgr_replay_isr, &state) != 0) {
+    free(state.arrival_ns);
+    free(latencies);
+    free(batch);
+    return -1;
+  }
+
+  // Main loop
+  uint64_t period_ns = (uint64_t)config->consumer_period_us * 1000U;
+  if (config->speed > 0.0f)
+    period_ns = period_ns / config->speed;
+  size_t drained = 0;
+  for (;;) {
+    int done = __atomic_load_n(&state.done, __ATOMIC_ACQUIRE);
+    size_t level = __atomic_load_n(&state.accepted, __ATOMIC_ACQUIRE) - drained;
+    if (level > report->max_queue_level)
+      report->max_queue_level = level;
+    int n;
+    while ((n = can_mgr_rx_drain(config->can_id, batch, config->drain_batch)) > 0) {
+      uint64_t now = _can_mgr_replay_now_ns();
+      for (int i = 0; i < n; ++i, ++drained)
+        latencies[drained] = _can_mgr_replay_log_ns(config->speed, now - state.arrival_ns[drained]) / 1000U;
+    }
+    if (done)
+      break;
+    _can_mgr_replay_sleep_ns(period_ns);
+  }
+  pthread_join(isr, NULL);
+
+  report->frames = count;
+  report->delivered = drained;
+  report->dropped = state.dropped;
+  report->ignored = state.ignored;
+  report->drop_rate = drained + state.dropped > 0 ? (float)state.dropped / (drained + state.dropped) : 0.0f;
+  if (drained > 0) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < drained; ++i)
+      sum += latencies[i];
+    qsort(latencies, drained, sizeof(*latencies), _can_mgr_replay_compare);
+    report->latency_min_us = latencies[0];
+    report->latency_avg_us = sum / drained;
+    report->latency_p99_us = latencies[(drained * 99U) / 100U];
+    report->latency_max_us = latencies[drained - 1];
+  }
+  if (count > 0) {
+    report->isr_avg_ns = state.isr_total_ns / count;
+    report->isr_max_ns = state.isr_max_ns;
+  }
+  free(state.arrival_ns);
+  free(latencies);
+  free(batch);
+  return 0;
+}
+
+void can_mgr_replay_print(FILE *out, const char *name, const can_mgr_replay_report_t *report) {
+  fprintf(out, "[BENCH] %s: %zu frames, delivered %zu, dropped %zu (%.2f%%), ignored %zu, max queue level %zu\n", name,
+          report->frames, report->delivered, report->dropped, report->drop_rate * 100.0f, report->ignored,
+          report->max_queue_level);
+  fprintf(out, "[BENCH] %s: latency us min %" PRIu32 " avg %" PRIu32 " p99 %" PRIu32 " max %" PRIu32 ", isr ns avg %" PRIu32 " max %" PRIu32 "\n",
+          name, report->latency_min_us, report->latency_avg_us, report->latency_p99_us, report->latency_max_us,
+          report->isr_avg_ns, report->isr_max_ns);
+}
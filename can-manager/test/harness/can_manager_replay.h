@@ -0,0 +1,101 @@
+/**
+ * @file can_manager_replay.h
+ * @brief Host side harness that replays CAN traffic (candump log files or
+ * synthetic bursts) through the receive interrupt path of the CAN manager and
+ * measures the latency and the drop rate of the receive queue
+ *
+ * @date 18 Oct 2026
+ * @author Giacomo Mazzucchi [giacomo.mazzucchi@protonmail.com]
+ */
+
+#ifndef CAN_MANAGER_REPLAY_H
+#define CAN_MANAGER_REPLAY_H
+
+#include "can_manager.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+/** @brief Frame of the traffic to replay */
+typedef struct {
+  uint64_t time_us; // Time from the start of the replay
+  uint32_t id;
+  uint8_t flags; // CAN_MGR_MSG_EXT_ID and CAN_MGR_MSG_FD
+  uint8_t size;
+  uint8_t data[CAN_MGR_FD_MAX_SIZE];
+} can_mgr_replay_frame_t;
+
+/** @brief Synthetic traffic made of bursts of back-to-back frames */
+typedef struct {
+  const uint32_t *ids;      // IDs of the frames, used in turn
+  size_t ids_size;
+  uint8_t size;             // Payload size of every frame
+  uint32_t bursts;          // Number of bursts
+  uint32_t burst_length;    // Frames in each burst
+  uint32_t burst_period_us; // Time between the start of two bursts
+  uint32_t bitrate;         // Bus bitrate, gives the spacing of the frames
+} can_mgr_replay_burst_t;
+
+/** @brief Simulated peripheral and main loop */
+typedef struct {
+  CAN_HandleTypeDef *hcan;
+  int can_id;
+  uint32_t rx_fifo;
+  float speed;                 // 1 for real time, 10 for ten times faster, 0 as fast as possible
+  uint32_t consumer_period_us; // Period of the main loop that drains the receive queue (log time)
+  size_t drain_batch;          // Messages drained by each call of can_mgr_rx_drain
+} can_mgr_replay_config_t;
+
+/**
+ * @brief Result of a replay, the latencies go from the interrupt to the drain
+ * of the message by the main loop and are in log time (host time multiplied
+ * by the speed)
+ */
+typedef struct {
+  size_t frames;
+  size_t delivered; // Drained by the main loop
+  size_t dropped;   // Lost because the receive queue was full
+  size_t ignored;   // Extended IDs and CAN FD frames, not kept by the queue
+  float drop_rate;  // dropped / (delivered + dropped)
+  size_t max_queue_level;
+  uint32_t latency_min_us;
+  uint32_t latency_avg_us;
+  uint32_t latency_p99_us;
+  uint32_t latency_max_us;
+  uint32_t isr_avg_ns; // Host time spent in can_mgr_it_callback
+  uint32_t isr_max_ns;
+} can_mgr_replay_report_t;
+
+/**
+ * @brief Parse a line of a candump log file (candump -l), e.g.
+ * "(1697040000.123456) can0 123#DEADBEEF", "18FF50E5#00" for extended IDs and
+ * "123##1001122" for CAN FD frames
+ * @param iface The interface name the frame was received on, at least 16 bytes
+ * (can be NULL)
+ * @param time_us Absolute timestamp of the frame
+ * @return 0 on success, -1 if the line is not a data frame
+ */
+int can_mgr_replay_parse_line(const char *line, can_mgr_replay_frame_t *frame, char *iface, uint64_t *time_us);
+/**
+ * @brief Load the data frames of a candump log file, the timestamps are made
+ * relative to the first frame
+ * @param iface Only the frames of this interface are loaded (NULL for all)
+ * @return The number of frames loaded or -1 if the file cannot be opened
+ */
+int can_mgr_replay_load(const char *path, const char *iface, can_mgr_replay_frame_t *frames, size_t max_frames);
+/**
+ * @brief Generate synthetic bursts of frames
+ * @return The number of frames generated
+ */
+size_t can_mgr_replay_burst(const can_mgr_replay_burst_t *burst, can_mgr_replay_frame_t *frames, size_t max_frames);
+/**
+ * @brief Replay the frames from a simulated interrupt thread while the calling
+ * thread acts as the main loop and drains the receive queue
+ * @attention The receive queue of the peripheral must be enabled
+ * @return 0 on success or -1 on error
+ */
+int can_mgr_replay_run(const can_mgr_replay_config_t *config, const can_mgr_replay_frame_t *frames, size_t count, can_mgr_replay_report_t *report);
+/** @brief Print the report of a replay */
+void can_mgr_replay_print(FILE *out, const char *name, const can_mgr_replay_report_t *report);
+
+#endif // CAN_MANAGER_REPLAY_H
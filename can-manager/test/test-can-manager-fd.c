@@ -0,0 +1,228 @@
+/**
+ * @file test-can-manager-fd.c
+ * @brief Unit test for the variable length messages (extended IDs and CAN FD
+ * payloads) of the CAN manager
+ *
+ * @date 18 Oct 2026
+ * @author Giacomo Mazzucchi [giacomo.mazzucchi@protonmail.com]
+ */
+
+#include "can_manager.h"
+#include "unity.h"
+
+#define TEST_STATES_SIZE 4
+#define TEST_EXT_ID 0x18FF50E5U
+
+CAN_HandleTypeDef hcan;
+int can_id;
+
+// Buffers owned by the application, each state has its own capacity
+uint8_t bms_cells[64];
+uint8_t inverter[8];
+uint8_t ecu_status[12];
+uint8_t std_twin[8];
+can_mgr_fd_msg_t states[TEST_STATES_SIZE];
+uint8_t is_new[TEST_STATES_SIZE];
+uint32_t seq[TEST_STATES_SIZE];
+
+CAN_TxHeaderTypeDef sent_header;
+uint8_t *sent_data;
+size_t sent_count;
+
+int can_mgr_from_id_to_index(int can_id, int msg_id) {
+  switch (msg_id) {
+  case 0x100:
+    return 0;
+  case 0x200:
+    return 1;
+  case TEST_EXT_ID | CAN_MGR_EXT_ID_FLAG:
+    return 2;
+  // Same value of a standard ID, different message
+  case 0x100 | CAN_MGR_EXT_ID_FLAG:
+    return 3;
+  case 0x300:
+    return TEST_STATES_SIZE;
+  default:
+    return -1;
+  }
+}
+
+static void tx_callback(CAN_HandleTypeDef *hcan, CAN_TxHeaderTypeDef *header, uint8_t *data) {
+  sent_header = *header;
+  sent_data = data;
+  ++sent_count;
+}
+
+// Put a message at the head of the simulated receive FIFO and raise the interrupt
+static void receive(uint32_t id, uint8_t ext, uint8_t fd, uint8_t size, uint8_t first) {
+  hcan.rx_header = (CAN_RxHeaderTypeDef){.StdId = ext ? 0 : id,
+                                         .ExtId = ext ? id : 0,
+                                         .IDE = ext ? CAN_ID_EXT : CAN_ID_STD,
+                                         .DLC = can_mgr_size_to_dlc(size),
+                                         .FDFormat = fd};
+  for (size_t i = 0; i < sizeof(hcan.rx_data); ++i)
+    hcan.rx_data[i] = first + i;
+  can_mgr_it_callback(&hcan, CAN_RX_FIFO0, NULL);
+}
+
+void setUp(void) {
+  states[0] = (can_mgr_fd_msg_t){.capacity = sizeof(ecu_status), .data = ecu_status};
+  states[1] = (can_mgr_fd_msg_t){.capacity = sizeof(inverter), .data = inverter};
+  states[2] = (can_mgr_fd_msg_t){.capacity = sizeof(bms_cells), .data = bms_cells};
+  states[3] = (can_mgr_fd_msg_t){.capacity = sizeof(std_twin), .data = std_twin};
+  memset(is_new, 0, sizeof(is_new));
+  hcan.rx_reads = 0;
+  hcan.tx_free_level = UINT32_MAX;
+  hcan.tx_callback = tx_callback;
+  sent_count = 0;
+  can_mgr_error_code = 0;
+  can_mgr_config(can_id, NULL, 0, CAN_RX_FIFO0, NULL, NULL, 0);
+  can_mgr_config_fd(can_id, states, is_new, TEST_STATES_SIZE);
+}
+
+void tearDown(void) {}
+
+void test_fd_dlc_mapping(void) {
+  static const uint8_t sizes[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64};
+  for (uint8_t dlc = 0; dlc < 16; ++dlc) {
+    TEST_ASSERT_EQUAL_UINT8(sizes[dlc], can_mgr_dlc_to_size(dlc));
+    TEST_ASSERT_EQUAL_UINT8(dlc, can_mgr_size_to_dlc(sizes[dlc]));
+  }
+  // Sizes between the FD lengths are rounded up
+  TEST_ASSERT_EQUAL_UINT8(9, can_mgr_size_to_dlc(9));
+  TEST_ASSERT_EQUAL_UINT8(13, can_mgr_size_to_dlc(25));
+  TEST_ASSERT_EQUAL_UINT8(15, can_mgr_size_to_dlc(49));
+}
+
+void test_fd_receive_extended_fd_frame(void) {
+  receive(TEST_EXT_ID, 1, 1, 64, 10);
+  TEST_ASSERT_EQUAL_UINT8(1, is_new[2]);
+  TEST_ASSERT_EQUAL_HEX32(TEST_EXT_ID, states[2].id);
+  TEST_ASSERT_EQUAL_UINT8(CAN_MGR_MSG_EXT_ID | CAN_MGR_MSG_FD, states[2].flags);
+  TEST_ASSERT_EQUAL_UINT8(64, states[2].size);
+  // The payload is in the buffer of the application, read once from the FIFO
+  TEST_ASSERT_EQUAL_PTR(bms_cells, states[2].data);
+  TEST_ASSERT_EQUAL_UINT8(10, bms_cells[0]);
+  TEST_ASSERT_EQUAL_UINT8(73, bms_cells[63]);
+  TEST_ASSERT_EQUAL_UINT32(1, hcan.rx_reads);
+}
+
+void test_fd_standard_and_extended_same_value(void) {
+  receive(0x100, 0, 0, 8, 1);
+  receive(0x100, 1, 0, 4, 2);
+  TEST_ASSERT_EQUAL_UINT8(1, is_new[0]);
+  TEST_ASSERT_EQUAL_UINT8(1, is_new[3]);
+  TEST_ASSERT_EQUAL_UINT8(0, states[0].flags);
+  TEST_ASSERT_EQUAL_UINT8(1, ecu_status[0]);
+  TEST_ASSERT_EQUAL_UINT8(CAN_MGR_MSG_EXT_ID, states[3].flags);
+  TEST_ASSERT_EQUAL_UINT8(2, std_twin[0]);
+}
+
+void test_fd_frame_larger_than_buffer(void) {
+  receive(0x200, 0, 1, 12, 5);
+  TEST_ASSERT_EQUAL_UINT8(0, is_new[1]);
+  TEST_ASSERT_EQUAL_UINT8(0, inverter[0]);
+  TEST_ASSERT_NOT_EQUAL(0, can_mgr_error_code);
+  // The FIFO is released anyway
+  TEST_ASSERT_EQUAL_UINT32(1, hcan.rx_reads);
+}
+
+void test_fd_ignored_and_out_of_bound(void) {
+  receive(0x555, 0, 0, 8, 0);
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_error_code);
+  receive(0x300, 0, 0, 8, 0);
+  TEST_ASSERT_NOT_EQUAL(0, can_mgr_error_code);
+  TEST_ASSERT_EQUAL_UINT32(2, hcan.rx_reads);
+}
+
+void test_fd_read_snapshot(void) {
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_config_seq(can_id, seq));
+  receive(0x100, 0, 1, 12, 20);
+  uint8_t buf[16];
+  can_mgr_fd_msg_t out = {.capacity = sizeof(buf), .data = buf};
+  TEST_ASSERT_EQUAL_INT(1, can_mgr_read_fd(can_id, 0, &out));
+  TEST_ASSERT_EQUAL_UINT32(2, seq[0]);
+  TEST_ASSERT_EQUAL_UINT8(12, out.size);
+  TEST_ASSERT_EQUAL_UINT8(31, buf[11]);
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_read_fd(can_id, 0, &out));
+
+  uint8_t small[8];
+  can_mgr_fd_msg_t small_out = {.capacity = sizeof(small), .data = small};
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_read_fd(can_id, 0, &small_out));
+
+  // A failed read leaves the message new
+  receive(0x100, 0, 1, 12, 40);
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_read_fd(can_id, 0, &small_out));
+  TEST_ASSERT_EQUAL_INT(1, can_mgr_read_fd(can_id, 0, &out));
+  TEST_ASSERT_EQUAL_UINT8(51, buf[11]);
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_read_fd(can_id, 0, &out));
+
+  // The fixed size states are replaced by the variable length ones
+  can_mgr_msg_t classic_out;
+  can_mgr_error_code = 0;
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_read(can_id, 0, &classic_out));
+  TEST_ASSERT_NOT_EQUAL(0, can_mgr_error_code);
+}
+
+void test_fd_send(void) {
+  uint8_t payload[64];
+  can_mgr_fd_msg_t msg = {.id = TEST_EXT_ID, .flags = CAN_MGR_MSG_EXT_ID | CAN_MGR_MSG_FD, .size = 48, .capacity = 64, .data = payload};
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_send_fd(can_id, &msg));
+  TEST_ASSERT_EQUAL_size_t(1, sent_count);
+  TEST_ASSERT_EQUAL_UINT32(CAN_ID_EXT, sent_header.IDE);
+  TEST_ASSERT_EQUAL_HEX32(TEST_EXT_ID, sent_header.ExtId);
+  TEST_ASSERT_EQUAL_UINT32(14, sent_header.DLC);
+  TEST_ASSERT_EQUAL_UINT32(1, sent_header.FDFormat);
+  // No intermediate copy of the payload
+  TEST_ASSERT_EQUAL_PTR(payload, sent_data);
+
+  can_mgr_fd_msg_t classic = {.id = 0x123, .size = 8, .capacity = 8, .data = payload};
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_send_fd(can_id, &classic));
+  TEST_ASSERT_EQUAL_UINT32(CAN_ID_STD, sent_header.IDE);
+  TEST_ASSERT_EQUAL_UINT32(0x123, sent_header.StdId);
+  TEST_ASSERT_EQUAL_UINT32(0, sent_header.FDFormat);
+}
+
+void test_fd_send_invalid(void) {
+  uint8_t payload[64];
+  // Not a CAN FD length
+  can_mgr_fd_msg_t msg = {.id = 0x100, .flags = CAN_MGR_MSG_FD, .size = 10, .capacity = 64, .data = payload};
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_send_fd(can_id, &msg));
+  // Classic frame longer than 8 bytes
+  msg = (can_mgr_fd_msg_t){.id = 0x100, .size = 12, .capacity = 64, .data = payload};
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_send_fd(can_id, &msg));
+  // Standard ID out of range
+  msg = (can_mgr_fd_msg_t){.id = 0x800, .size = 8, .capacity = 64, .data = payload};
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_send_fd(can_id, &msg));
+  // Payload larger than the buffer
+  msg = (can_mgr_fd_msg_t){.id = 0x100, .flags = CAN_MGR_MSG_FD, .size = 16, .capacity = 12, .data = payload};
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_send_fd(can_id, &msg));
+  TEST_ASSERT_EQUAL_size_t(0, sent_count);
+}
+
+void test_fd_config_invalid(void) {
+  states[1].capacity = 4;
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_config_fd(can_id, states, is_new, TEST_STATES_SIZE));
+  states[1].capacity = 8;
+  states[1].data = NULL;
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_config_fd(can_id, states, is_new, TEST_STATES_SIZE));
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_config_fd(CAN_MGR_N_CAN, states, is_new, TEST_STATES_SIZE));
+}
+
+int main() {
+  can_id = can_mgr_init(&hcan);
+
+  UNITY_BEGIN();
+
+  RUN_TEST(test_fd_dlc_mapping);
+  RUN_TEST(test_fd_receive_extended_fd_frame);
+  RUN_TEST(test_fd_standard_and_extended_same_value);
+  RUN_TEST(test_fd_frame_larger_than_buffer);
+  RUN_TEST(test_fd_ignored_and_out_of_bound);
+  RUN_TEST(test_fd_read_snapshot);
+  RUN_TEST(test_fd_send);
+  RUN_TEST(test_fd_send_invalid);
+  RUN_TEST(test_fd_config_invalid);
+
+  return UNITY_END();
+}
@@ -0,0 +1,214 @@
+/**
+ * @file test-can-manager-filter.c
+ * @brief Unit test and false accept report of the filter bank optimizer of the
+ * CAN manager
+ *
+ * @date 18 Oct 2026
+ * @author Giacomo Mazzucchi [giacomo.mazzucchi@protonmail.com]
+ */
+
+#include "can_manager.h"
+#include "unity.h"
+
+#include <stdio.h>
+
+#define TEST_MAX_BANKS 28
+#define TEST_STD_IDS 0x800
+
+CAN_HandleTypeDef hcan;
+int can_id;
+
+CAN_FilterTypeDef filters[TEST_MAX_BANKS];
+can_mgr_filter_report_t report;
+can_mgr_filter_scratch_t scratch;
+
+int can_mgr_from_id_to_index(int can_id, int msg_id) { return -1; }
+
+// Check a standard data frame against the 16-bit filter banks as bxCAN does
+static int bxcan_accepts(CAN_FilterTypeDef *filters, int banks, uint16_t id) {
+  uint32_t frame = (uint32_t)id << 5;
+  for (int i = 0; i < banks; ++i) {
+    CAN_FilterTypeDef *f = &filters[i];
+    TEST_ASSERT_EQUAL_UINT32(CAN_FILTERSCALE_16BIT, f->FilterScale);
+    TEST_ASSERT_EQUAL_UINT32(ENABLE, f->FilterActivation);
+    if (f->FilterMode == CAN_FILTERMODE_IDLIST) {
+      if (frame == f->FilterIdLow || frame == f->FilterMaskIdLow ||
+          frame == f->FilterIdHigh || frame == f->FilterMaskIdHigh)
+        return 1;
+    } else {
+      if ((frame & f->FilterMaskIdLow) == (f->FilterIdLow & f->FilterMaskIdLow) ||
+          (frame & f->FilterMaskIdHigh) == (f->FilterIdHigh & f->FilterMaskIdHigh))
+        return 1;
+    }
+  }
+  return 0;
+}
+
+// Check that every wanted ID is accepted and that the report is consistent
+static void check_filters(const uint16_t *ids, size_t size, int banks) {
+  uint8_t wanted[TEST_STD_IDS] = {0};
+  size_t wanted_count = 0;
+  for (size_t i = 0; i < size; ++i) {
+    wanted_count += !wanted[ids[i]];
+    wanted[ids[i]] = 1;
+  }
+  size_t accepted = 0;
+  for (uint16_t id = 0; id < TEST_STD_IDS; ++id) {
+    int ok = bxcan_accepts(filters, banks, id);
+    if (wanted[id])
+      TEST_ASSERT_TRUE(ok);
+    accepted += ok;
+  }
+  TEST_ASSERT_EQUAL_size_t(banks, report.banks);
+  TEST_ASSERT_EQUAL_size_t(accepted, report.accepted);
+  TEST_ASSERT_EQUAL_size_t(accepted - wanted_count, report.false_accepts);
+  for (int i = 0; i < banks; ++i)
+    TEST_ASSERT_EQUAL_UINT32(i, filters[i].FilterBank);
+}
+
+// Pseudo-random IDs spread over the whole standard range
+static size_t random_ids(uint16_t *ids, size_t count, uint32_t seed) {
+  uint8_t used[TEST_STD_IDS] = {0};
+  size_t size = 0;
+  while (size < count) {
+    seed = seed * 1103515245U + 12345U;
+    uint16_t id = (seed >> 16) % TEST_STD_IDS;
+    if (!used[id]) {
+      used[id] = 1;
+      ids[size++] = id;
+    }
+  }
+  return size;
+}
+
+void setUp(void) { memset(&report, 0, sizeof(report)); }
+
+void tearDown(void) {}
+
+void test_filter_list_mode(void) {
+  uint16_t ids[] = {0x100, 0x205, 0x3A0, 0x010, 0x7FF, 0x000};
+  int banks = can_mgr_filter_optimize(ids, 6, filters, 14, 0, CAN_RX_FIFO0, &report, &scratch);
+  TEST_ASSERT_EQUAL_INT(2, banks);
+  TEST_ASSERT_EQUAL_UINT32(CAN_FILTERMODE_IDLIST, filters[0].FilterMode);
+  TEST_ASSERT_EQUAL_size_t(6, report.list_entries);
+  TEST_ASSERT_EQUAL_size_t(0, report.false_accepts);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, report.false_accept_ratio);
+  check_filters(ids, 6, banks);
+}
+
+void test_filter_duplicated_ids(void) {
+  uint16_t ids[] = {0x100, 0x100, 0x101, 0x100};
+  int banks = can_mgr_filter_optimize(ids, 4, filters, 14, 0, CAN_RX_FIFO0, &report, &scratch);
+  TEST_ASSERT_EQUAL_INT(1, banks);
+  TEST_ASSERT_EQUAL_size_t(2, report.accepted);
+  check_filters(ids, 4, banks);
+}
+
+void test_filter_full_list_banks(void) {
+  uint16_t ids[56];
+  random_ids(ids, 56, 7);
+  int banks = can_mgr_filter_optimize(ids, 56, filters, 14, 0, CAN_RX_FIFO1, &report, &scratch);
+  TEST_ASSERT_EQUAL_INT(14, banks);
+  TEST_ASSERT_EQUAL_size_t(0, report.false_accepts);
+  TEST_ASSERT_EQUAL_UINT32(CAN_RX_FIFO1, filters[13].FilterFIFOAssignment);
+  check_filters(ids, 56, banks);
+}
+
+void test_filter_aligned_block(void) {
+  // 64 consecutive IDs are a single mask entry
+  uint16_t ids[64];
+  for (size_t i = 0; i < 64; ++i)
+    ids[i] = 0x240 + i;
+  int banks = can_mgr_filter_optimize(ids, 64, filters, 1, 0, CAN_RX_FIFO0, &report, &scratch);
+  TEST_ASSERT_EQUAL_INT(1, banks);
+  TEST_ASSERT_EQUAL_UINT32(CAN_FILTERMODE_IDMASK, filters[0].FilterMode);
+  TEST_ASSERT_EQUAL_size_t(1, report.mask_entries);
+  TEST_ASSERT_EQUAL_size_t(0, report.false_accepts);
+  check_filters(ids, 64, banks);
+}
+
+void test_filter_mask_and_list_in_same_bank(void) {
+  uint16_t ids[] = {0x100, 0x101, 0x102, 0x103, 0x500};
+  int banks = can_mgr_filter_optimize(ids, 5, filters, 1, 0, CAN_RX_FIFO0, &report, &scratch);
+  TEST_ASSERT_EQUAL_INT(1, banks);
+  TEST_ASSERT_EQUAL_size_t(0, report.false_accepts);
+  check_filters(ids, 5, banks);
+}
+
+void test_filter_too_many_ids_for_banks(void) {
+  uint16_t ids[120];
+  random_ids(ids, 120, 3);
+  int banks = can_mgr_filter_optimize(ids, 120, filters, 14, 0, CAN_RX_FIFO0, &report, &scratch);
+  TEST_ASSERT_LESS_OR_EQUAL_INT(14, banks);
+  TEST_ASSERT_GREATER_THAN_size_t(0, report.false_accepts);
+  check_filters(ids, 120, banks);
+}
+
+void test_filter_first_bank(void) {
+  uint16_t ids[] = {0x100, 0x200};
+  int banks = can_mgr_filter_optimize(ids, 2, filters, 14, 14, CAN_RX_FIFO1, &report, &scratch);
+  TEST_ASSERT_EQUAL_INT(1, banks);
+  TEST_ASSERT_EQUAL_UINT32(14, filters[0].FilterBank);
+}
+
+void test_filter_invalid(void) {
+  uint16_t ids[] = {0x800};
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_filter_optimize(ids, 1, filters, 14, 0, CAN_RX_FIFO0, NULL, &scratch));
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_filter_optimize(ids, 0, filters, 0, 0, CAN_RX_FIFO0, NULL, &scratch));
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_filter_optimize(ids, 0, NULL, 14, 0, CAN_RX_FIFO0, NULL, &scratch));
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_filter_optimize(NULL, 0, filters, 14, 0, CAN_RX_FIFO0, NULL, &scratch));
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_filter_optimize(NULL, 0, filters, 14, 0, CAN_RX_FIFO0, NULL, NULL));
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_config_filters(CAN_MGR_N_CAN, filters, 1));
+}
+
+/**
+ * @brief Report the false accepts of a vehicle-like set of IDs (groups of
+ * nearby IDs of the same board plus scattered ones) with the banks of a single
+ * peripheral (14), of both peripherals (28) and with fewer banks, compared with
+ * accepting every message
+ */
+void test_filter_report(void) {
+  uint16_t ids[96];
+  size_t size = 0;
+  // Boards that use consecutive IDs
+  for (uint16_t base = 0x100; base < 0x700; base += 0x100)
+    for (uint16_t i = 0; i < 10; ++i)
+      ids[size++] = base + 3 * i;
+  // Scattered IDs
+  size += random_ids(&ids[size], 36, 11);
+  for (size_t i = 60; i < size; ++i)
+    ids[i] |= 0x400;
+
+  printf("[BENCH] %zu IDs, accept all: false accept ratio %.3f\n", size, (float)(TEST_STD_IDS - size) / TEST_STD_IDS);
+  size_t bank_counts[] = {4, 7, 14, 28};
+  float previous_ratio = 1.0f;
+  for (size_t i = 0; i < sizeof(bank_counts) / sizeof(bank_counts[0]); ++i) {
+    int banks = can_mgr_filter_optimize(ids, size, filters, bank_counts[i], 0, CAN_RX_FIFO0, &report, &scratch);
+    printf("[BENCH] %2zu banks: used %2d, %2zu list + %2zu mask entries, accepted %4zu, false accepts %4zu, ratio %.3f\n",
+           bank_counts[i], banks, report.list_entries, report.mask_entries, report.accepted,
+           report.false_accepts, report.false_accept_ratio);
+    check_filters(ids, size, banks);
+    TEST_ASSERT_LESS_OR_EQUAL_INT(bank_counts[i], banks);
+    TEST_ASSERT_LESS_OR_EQUAL_FLOAT(previous_ratio, report.false_accept_ratio);
+    previous_ratio = report.false_accept_ratio;
+  }
+  TEST_ASSERT_EQUAL_size_t(0, report.false_accepts);
+}
+
+int main() {
+  can_id = can_mgr_init(&hcan);
+
+  UNITY_BEGIN();
+
+  RUN_TEST(test_filter_list_mode);
+  RUN_TEST(test_filter_duplicated_ids);
+  RUN_TEST(test_filter_full_list_banks);
+  RUN_TEST(test_filter_aligned_block);
+  RUN_TEST(test_filter_mask_and_list_in_same_bank);
+  RUN_TEST(test_filter_too_many_ids_for_banks);
+  RUN_TEST(test_filter_first_bank);
+  RUN_TEST(test_filter_invalid);
+  RUN_TEST(test_filter_report);
+
+  return UNITY_END();
+}
@@ -0,0 +1,188 @@
+/**
+ * @file test-can-manager-replay.c
+ * @brief Unit test of the replay harness and load test of the receive queue of
+ * the CAN manager with a candump log and synthetic bursts
+ * @details Run with the path of a candump log (and the speed) to replay it:
+ * ./build/test-can-manager-replay candump.log 10
+ *
+ * @date 18 Oct 2026
+ * @author Giacomo Mazzucchi [giacomo.mazzucchi@protonmail.com]
+ */
+
+#include "can_manager.h"
+#include "can_manager_replay.h"
+#include "unity.h"
+
+#include <stdlib.h>
+
+#define TEST_MAX_FRAMES 4096
+#define TEST_SAMPLE_LOG "harness/candump-sample.log"
+#define TEST_BITRATE 1000000U
+
+CAN_HandleTypeDef hcan;
+int can_id;
+
+can_mgr_replay_frame_t frames[TEST_MAX_FRAMES];
+can_mgr_replay_report_t report;
+
+int can_mgr_from_id_to_index(int can_id, int msg_id) { return -1; }
+
+static void check_counts(size_t frames_count) {
+  TEST_ASSERT_EQUAL_size_t(frames_count, report.frames);
+  TEST_ASSERT_EQUAL_size_t(frames_count, report.delivered + report.dropped + report.ignored);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(report.latency_max_us, report.latency_min_us);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(report.latency_max_us, report.latency_p99_us);
+}
+
+void setUp(void) {
+  can_mgr_msg_t out[CAN_MGR_RX_QUEUE_SIZE];
+  can_mgr_config(can_id, NULL, 0, CAN_RX_FIFO0, NULL, NULL, 0);
+  can_mgr_rx_queue_enable(can_id, 1);
+  while (can_mgr_rx_drain(can_id, out, CAN_MGR_RX_QUEUE_SIZE) > 0)
+    ;
+  memset(&report, 0, sizeof(report));
+}
+
+void tearDown(void) {}
+
+void test_replay_parse_line(void) {
+  can_mgr_replay_frame_t frame;
+  char iface[16];
+  uint64_t time_us;
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_replay_parse_line("(1760781600.002150) can1 1A5#00FF\n", &frame, iface, &time_us));
+  TEST_ASSERT_EQUAL_STRING("can1", iface);
+  TEST_ASSERT_EQUAL_UINT64(1760781600002150ULL, time_us);
+  TEST_ASSERT_EQUAL_HEX32(0x1A5, frame.id);
+  TEST_ASSERT_EQUAL_UINT8(0, frame.flags);
+  TEST_ASSERT_EQUAL_UINT8(2, frame.size);
+  TEST_ASSERT_EQUAL_HEX8(0xFF, frame.data[1]);
+
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_replay_parse_line("(0.000001) can0 18FF50E5#11.22.33", &frame, NULL, NULL));
+  TEST_ASSERT_EQUAL_HEX32(0x18FF50E5, frame.id);
+  TEST_ASSERT_EQUAL_UINT8(CAN_MGR_MSG_EXT_ID, frame.flags);
+  TEST_ASSERT_EQUAL_UINT8(3, frame.size);
+
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_replay_parse_line("(0.000001) can0 300##1000102030405060708090A0B", &frame, NULL, NULL));
+  TEST_ASSERT_EQUAL_UINT8(CAN_MGR_MSG_FD, frame.flags);
+  TEST_ASSERT_EQUAL_UINT8(12, frame.size);
+  TEST_ASSERT_EQUAL_HEX8(0x0B, frame.data[11]);
+}
+
+void test_replay_parse_invalid_line(void) {
+  can_mgr_replay_frame_t frame;
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_replay_parse_line("(0.000001) can0 1A5#R", &frame, NULL, NULL));
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_replay_parse_line("# comment", &frame, NULL, NULL));
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_replay_parse_line("(0.000001) can0 800#00", &frame, NULL, NULL));
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_replay_parse_line("(0.000001) can0 100#001", &frame, NULL, NULL));
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_replay_parse_line("(0.000001) can0 100#000102030405060708", &frame, NULL, NULL));
+  // Not a CAN FD length
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_replay_parse_line("(0.000001) can0 100##100010203040506070809", &frame, NULL, NULL));
+}
+
+void test_replay_load(void) {
+  TEST_ASSERT_EQUAL_INT(190, can_mgr_replay_load(TEST_SAMPLE_LOG, NULL, frames, TEST_MAX_FRAMES));
+  TEST_ASSERT_EQUAL_UINT64(0, frames[0].time_us);
+  TEST_ASSERT_EQUAL_INT(180, can_mgr_replay_load(TEST_SAMPLE_LOG, "can0", frames, TEST_MAX_FRAMES));
+  TEST_ASSERT_EQUAL_INT(10, can_mgr_replay_load(TEST_SAMPLE_LOG, "can1", frames, TEST_MAX_FRAMES));
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_replay_load("harness/missing.log", NULL, frames, TEST_MAX_FRAMES));
+}
+
+void test_replay_burst_generation(void) {
+  static const uint32_t ids[] = {0x100, 0x101};
+  can_mgr_replay_burst_t burst = {.ids = ids, .ids_size = 2, .size = 8, .bursts = 2, .burst_length = 3, .burst_period_us = 1000, .bitrate = TEST_BITRATE};
+  TEST_ASSERT_EQUAL_size_t(6, can_mgr_replay_burst(&burst, frames, TEST_MAX_FRAMES));
+  // 135 bits frames at 1 Mbit/s
+  TEST_ASSERT_EQUAL_UINT64(135, frames[1].time_us);
+  TEST_ASSERT_EQUAL_UINT64(1270, frames[5].time_us);
+  TEST_ASSERT_EQUAL_HEX32(0x101, frames[3].id);
+  TEST_ASSERT_EQUAL_size_t(4, can_mgr_replay_burst(&burst, frames, 4));
+}
+
+void test_replay_sample_log(void) {
+  int count = can_mgr_replay_load(TEST_SAMPLE_LOG, NULL, frames, TEST_MAX_FRAMES);
+  can_mgr_replay_config_t config = {.hcan = &hcan, .can_id = can_id, .rx_fifo = CAN_RX_FIFO0, .speed = 5.0f, .consumer_period_us = 1000, .drain_batch = 4};
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_replay_run(&config, frames, count, &report));
+  can_mgr_replay_print(stdout, "sample log x5", &report);
+  check_counts(count);
+  // Extended IDs and CAN FD frames are not kept by the receive queue
+  TEST_ASSERT_EQUAL_size_t(30, report.ignored);
+  TEST_ASSERT_EQUAL_size_t(0, report.dropped);
+}
+
+void test_replay_burst_overflows_queue(void) {
+  static const uint32_t ids[] = {0x100, 0x200, 0x300};
+  can_mgr_replay_burst_t burst = {.ids = ids, .ids_size = 3, .size = 8, .bursts = 4, .burst_length = 64, .burst_period_us = 10000, .bitrate = TEST_BITRATE};
+  size_t count = can_mgr_replay_burst(&burst, frames, TEST_MAX_FRAMES);
+  // All the frames arrive at once, the main loop runs every 5 ms
+  can_mgr_replay_config_t config = {.hcan = &hcan, .can_id = can_id, .rx_fifo = CAN_RX_FIFO0, .speed = 0.0f, .consumer_period_us = 5000, .drain_batch = 8};
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_replay_run(&config, frames, count, &report));
+  check_counts(count);
+  TEST_ASSERT_GREATER_THAN_size_t(0, report.dropped);
+  TEST_ASSERT_GREATER_OR_EQUAL_size_t(CAN_MGR_RX_QUEUE_SIZE, report.delivered);
+  TEST_ASSERT_GREATER_THAN_FLOAT(0.0f, report.drop_rate);
+}
+
+/**
+ * @brief Report the drop rate and the latency of bursts of 64 back-to-back
+ * frames (8.6 ms at 1 Mbit/s) with a main loop that drains the queue every 1,
+ * 2 and 5 ms, to size CAN_MGR_RX_QUEUE_SIZE
+ */
+void test_replay_burst_report(void) {
+  static const uint32_t ids[] = {0x010, 0x0A0, 0x1A5, 0x2B0};
+  can_mgr_replay_burst_t burst = {.ids = ids, .ids_size = 4, .size = 8, .bursts = 3, .burst_length = 64, .burst_period_us = 20000, .bitrate = TEST_BITRATE};
+  size_t count = can_mgr_replay_burst(&burst, frames, TEST_MAX_FRAMES);
+  static const uint32_t periods[] = {1000, 2000, 5000};
+  printf("[BENCH] receive queue of %d messages, %zu frames in %u bursts\n", CAN_MGR_RX_QUEUE_SIZE, count, burst.bursts);
+  for (size_t i = 0; i < sizeof(periods) / sizeof(periods[0]); ++i) {
+    can_mgr_replay_config_t config = {.hcan = &hcan, .can_id = can_id, .rx_fifo = CAN_RX_FIFO0, .speed = 1.0f, .consumer_period_us = periods[i], .drain_batch = CAN_MGR_RX_QUEUE_SIZE};
+    TEST_ASSERT_EQUAL_INT(0, can_mgr_replay_run(&config, frames, count, &report));
+    char name[32];
+    snprintf(name, sizeof(name), "main loop %4u us", periods[i]);
+    can_mgr_replay_print(stdout, name, &report);
+    check_counts(count);
+    TEST_ASSERT_LESS_OR_EQUAL_size_t(CAN_MGR_RX_QUEUE_SIZE, report.max_queue_level);
+  }
+}
+
+void test_replay_invalid(void) {
+  can_mgr_replay_config_t config = {.hcan = NULL, .can_id = can_id, .drain_batch = 1};
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_replay_run(&config, frames, 0, &report));
+  config.hcan = &hcan;
+  config.drain_batch = 0;
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_replay_run(&config, frames, 0, &report));
+}
+
+int main(int argc, char **argv) {
+  can_id = can_mgr_init(&hcan);
+
+  if (argc > 1) {
+    int count = can_mgr_replay_load(argv[1], NULL, frames, TEST_MAX_FRAMES);
+    if (count < 0) {
+      fprintf(stderr, "cannot open %s\n", argv[1]);
+      return 1;
+    }
+    setUp();
+    can_mgr_replay_config_t config = {.hcan = &hcan,
+                                      .can_id = can_id,
+                                      .rx_fifo = CAN_RX_FIFO0,
+                                      .speed = argc > 2 ? atof(argv[2]) : 1.0f,
+                                      .consumer_period_us = 1000,
+                                      .drain_batch = CAN_MGR_RX_QUEUE_SIZE};
+    can_mgr_replay_run(&config, frames, count, &report);
+    can_mgr_replay_print(stdout, argv[1], &report);
+    return 0;
+  }
+
+  UNITY_BEGIN();
+
+  RUN_TEST(test_replay_parse_line);
+  RUN_TEST(test_replay_parse_invalid_line);
+  RUN_TEST(test_replay_load);
+  RUN_TEST(test_replay_burst_generation);
+  RUN_TEST(test_replay_sample_log);
+  RUN_TEST(test_replay_burst_overflows_queue);
+  RUN_TEST(test_replay_burst_report);
+  RUN_TEST(test_replay_invalid);
+
+  return UNITY_END();
+}
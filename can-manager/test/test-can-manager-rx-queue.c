@@ -0,0 +1,184 @@
+/**
+ * @file test-can-manager-rx-queue.c
+ * @brief Unit test for the receive queue mode of the CAN manager
+ *
+ * @date 18 Oct 2026
+ * @author Giacomo Mazzucchi [giacomo.mazzucchi@protonmail.com]
+ */
+
+#include "can_manager.h"
+#include "unity.h"
+
+#define TEST_STATES_SIZE 4
+
+CAN_HandleTypeDef hcan0, hcan1;
+int can_id0, can_id1;
+
+can_mgr_msg_t states[TEST_STATES_SIZE];
+uint8_t is_new[TEST_STATES_SIZE];
+
+int can_mgr_from_id_to_index(int can_id, int msg_id) {
+  return msg_id < TEST_STATES_SIZE ? msg_id : -1;
+}
+
+static void receive(uint32_t fifo, uint16_t id, uint8_t value) {
+  can_mgr_msg_t msg = {.id = id, .size = 2, .data = {value, (uint8_t)~value}};
+  can_mgr_it_callback(NULL, fifo, &msg);
+}
+
+// Put a classic frame in the simulated receive FIFO of can_id0 and raise the interrupt
+static void receive_from_fifo(uint16_t id, uint8_t dlc) {
+  hcan0.rx_header = (CAN_RxHeaderTypeDef){.StdId = id, .IDE = CAN_ID_STD, .DLC = dlc};
+  for (size_t i = 0; i < sizeof(hcan0.rx_data); ++i)
+    hcan0.rx_data[i] = i + 1;
+  can_mgr_it_callback(&hcan0, CAN_RX_FIFO0, NULL);
+}
+
+static void drain_all(int can_id) {
+  can_mgr_msg_t out[CAN_MGR_RX_QUEUE_SIZE];
+  while (can_mgr_rx_drain(can_id, out, CAN_MGR_RX_QUEUE_SIZE) > 0)
+    ;
+}
+
+void setUp(void) {
+  memset(states, 0, sizeof(states));
+  memset(is_new, 0, sizeof(is_new));
+  can_mgr_error_code = 0;
+  can_mgr_config(can_id0, NULL, 0, CAN_RX_FIFO0, states, is_new, TEST_STATES_SIZE);
+  can_mgr_config(can_id1, NULL, 0, CAN_RX_FIFO1, NULL, NULL, 0);
+  can_mgr_rx_queue_enable(can_id0, 1);
+  can_mgr_rx_queue_enable(can_id1, 0);
+  drain_all(can_id0);
+  drain_all(can_id1);
+}
+
+void tearDown(void) {}
+
+void test_rx_queue_keeps_every_frame(void) {
+  // Same ID received twice before the main loop runs
+  receive(CAN_RX_FIFO0, 1, 10);
+  receive(CAN_RX_FIFO0, 1, 11);
+
+  can_mgr_msg_t out[4];
+  TEST_ASSERT_EQUAL_INT(2, can_mgr_rx_drain(can_id0, out, 4));
+  TEST_ASSERT_EQUAL_UINT16(1, out[0].id);
+  TEST_ASSERT_EQUAL_UINT8(10, out[0].data[0]);
+  TEST_ASSERT_EQUAL_UINT8(11, out[1].data[0]);
+  TEST_ASSERT_EQUAL_UINT8((uint8_t)~11, out[1].data[1]);
+  TEST_ASSERT_EQUAL_UINT8(2, out[1].size);
+}
+
+void test_rx_queue_does_not_touch_states(void) {
+  receive(CAN_RX_FIFO0, 1, 10);
+  TEST_ASSERT_EQUAL_UINT8(0, is_new[1]);
+}
+
+void test_rx_queue_disabled_uses_states(void) {
+  can_mgr_rx_queue_enable(can_id0, 0);
+  receive(CAN_RX_FIFO0, 2, 7);
+  TEST_ASSERT_EQUAL_UINT8(1, is_new[2]);
+  TEST_ASSERT_EQUAL_UINT8(7, states[2].data[0]);
+  can_mgr_msg_t out[1];
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_rx_drain(can_id0, out, 1));
+}
+
+void test_rx_queue_batch_drain(void) {
+  for (uint8_t i = 0; i < 10; ++i)
+    receive(CAN_RX_FIFO0, 3, i);
+
+  can_mgr_msg_t out[4];
+  uint8_t expected = 0;
+  int n;
+  while ((n = can_mgr_rx_drain(can_id0, out, 4)) > 0) {
+    TEST_ASSERT_LESS_OR_EQUAL_INT(4, n);
+    for (int i = 0; i < n; ++i)
+      TEST_ASSERT_EQUAL_UINT8(expected++, out[i].data[0]);
+  }
+  TEST_ASSERT_EQUAL_UINT8(10, expected);
+}
+
+void test_rx_queue_full_drops(void) {
+  int dropped = can_mgr_rx_dropped(can_id0);
+  for (uint8_t i = 0; i < CAN_MGR_RX_QUEUE_SIZE + 3; ++i)
+    receive(CAN_RX_FIFO0, 0, i);
+  TEST_ASSERT_EQUAL_INT(dropped + 3, can_mgr_rx_dropped(can_id0));
+  TEST_ASSERT_NOT_EQUAL(0, can_mgr_error_code);
+
+  // The oldest messages are kept
+  can_mgr_msg_t out[1];
+  can_mgr_rx_drain(can_id0, out, 1);
+  TEST_ASSERT_EQUAL_UINT8(0, out[0].data[0]);
+}
+
+void test_rx_classic_dlc_above_8(void) {
+  // A classic frame with DLC 15 is valid and carries 8 bytes
+  int dropped = can_mgr_rx_dropped(can_id0);
+  receive_from_fifo(3, 15);
+  can_mgr_msg_t out[2];
+  TEST_ASSERT_EQUAL_INT(1, can_mgr_rx_drain(can_id0, out, 2));
+  TEST_ASSERT_EQUAL_UINT16(3, out[0].id);
+  TEST_ASSERT_EQUAL_UINT8(8, out[0].size);
+  TEST_ASSERT_EQUAL_UINT8(8, out[0].data[7]);
+  TEST_ASSERT_EQUAL_INT(dropped, can_mgr_rx_dropped(can_id0));
+
+  can_mgr_rx_queue_enable(can_id0, 0);
+  receive_from_fifo(2, 15);
+  TEST_ASSERT_EQUAL_UINT8(1, is_new[2]);
+  TEST_ASSERT_EQUAL_UINT8(8, states[2].size);
+  TEST_ASSERT_EQUAL_UINT8(8, states[2].data[7]);
+}
+
+void test_rx_queue_per_peripheral(void) {
+  can_mgr_rx_queue_enable(can_id1, 1);
+  receive(CAN_RX_FIFO0, 1, 1);
+  receive(CAN_RX_FIFO1, 1, 2);
+  receive(CAN_RX_FIFO1, 1, 3);
+  can_mgr_msg_t out[4];
+  TEST_ASSERT_EQUAL_INT(1, can_mgr_rx_drain(can_id0, out, 4));
+  TEST_ASSERT_EQUAL_INT(2, can_mgr_rx_drain(can_id1, out, 4));
+  TEST_ASSERT_EQUAL_UINT8(2, out[0].data[0]);
+}
+
+void test_rx_queue_invalid_can_id(void) {
+  can_mgr_msg_t out[1];
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_rx_drain(CAN_MGR_N_CAN, out, 1));
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_rx_queue_enable(-1, 1));
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_rx_dropped(CAN_MGR_N_CAN));
+}
+
+/**
+ * @brief Interleave bursts of received frames with partial drains of the main
+ * loop and check that no frame is lost or reordered while the queue has room
+ */
+void test_rx_queue_interleaved_bursts(void) {
+  uint8_t next_rx = 0, next_read = 0;
+  can_mgr_msg_t out[8];
+  for (int round = 0; round < 500; ++round) {
+    int burst = (round * 5) % 7;
+    for (int i = 0; i < burst; ++i)
+      receive(CAN_RX_FIFO0, 1, next_rx++);
+    int n = can_mgr_rx_drain(can_id0, out, 8);
+    for (int i = 0; i < n; ++i)
+      TEST_ASSERT_EQUAL_UINT8(next_read++, out[i].data[0]);
+  }
+  TEST_ASSERT_EQUAL_UINT8(next_rx, next_read);
+}
+
+int main() {
+  can_id0 = can_mgr_init(&hcan0);
+  can_id1 = can_mgr_init(&hcan1);
+
+  UNITY_BEGIN();
+
+  RUN_TEST(test_rx_queue_keeps_every_frame);
+  RUN_TEST(test_rx_queue_does_not_touch_states);
+  RUN_TEST(test_rx_queue_disabled_uses_states);
+  RUN_TEST(test_rx_queue_batch_drain);
+  RUN_TEST(test_rx_queue_full_drops);
+  RUN_TEST(test_rx_classic_dlc_above_8);
+  RUN_TEST(test_rx_queue_per_peripheral);
+  RUN_TEST(test_rx_queue_invalid_can_id);
+  RUN_TEST(test_rx_queue_interleaved_bursts);
+
+  return UNITY_END();
+}
@@ -0,0 +1,241 @@
+/**
+ * @file test-can-manager-schedule.c
+ * @brief Unit test and load report for the periodic message scheduler of the
+ * CAN manager
+ *
+ * @date 18 Oct 2026
+ * @author Giacomo Mazzucchi [giacomo.mazzucchi@protonmail.com]
+ */
+
+#include "can_manager.h"
+#include "unity.h"
+
+#include <stdio.h>
+
+#define TEST_MAX_SENT 4096
+// 1 ms tick on a 1 Mbit/s bus
+#define TEST_TICK_US 1000U
+#define TEST_BITRATE 1000000U
+
+CAN_HandleTypeDef hcan;
+int can_id;
+
+uint32_t current_tick;
+uint16_t sent_ids[TEST_MAX_SENT];
+uint32_t sent_ticks[TEST_MAX_SENT];
+uint8_t sent_data[TEST_MAX_SENT];
+size_t sent_count;
+
+int fill_calls;
+
+int can_mgr_from_id_to_index(int can_id, int msg_id) { return -1; }
+
+static void tx_callback(CAN_HandleTypeDef *hcan, CAN_TxHeaderTypeDef *header, uint8_t *data) {
+  if (sent_count < TEST_MAX_SENT) {
+    sent_ids[sent_count] = header->StdId;
+    sent_ticks[sent_count] = current_tick;
+    sent_data[sent_count] = data[0];
+    ++sent_count;
+  }
+}
+
+static void run_ticks(uint32_t from, uint32_t count) {
+  for (uint32_t i = 0; i < count; ++i) {
+    current_tick = from + i;
+    can_mgr_schedule_tick(can_id, current_tick);
+  }
+}
+
+// Write an increasing counter and skip every other transmission
+static int fill_skip_odd(can_mgr_msg_t *msg) {
+  msg->data[0] = fill_calls;
+  return fill_calls++ % 2;
+}
+
+void setUp(void) {
+  sent_count = 0;
+  fill_calls = 0;
+  // Every message goes directly into a mailbox
+  hcan.tx_free_level = UINT32_MAX;
+  hcan.tx_callback = tx_callback;
+  can_mgr_error_code = 0;
+}
+
+void tearDown(void) { can_mgr_schedule_config(can_id, NULL, 0, 0); }
+
+void test_schedule_invalid_entry(void) {
+  static can_mgr_schedule_entry_t table[] = {{.id = 0x100, .size = 8, .period = 0}};
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_schedule_config(can_id, table, 1, 0));
+  table[0].period = 10;
+  table[0].size = 9;
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_schedule_config(can_id, table, 1, 0));
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_schedule_config(CAN_MGR_N_CAN, table, 1, 0));
+  TEST_ASSERT_NOT_EQUAL(0, can_mgr_error_code);
+}
+
+void test_schedule_period_and_offset(void) {
+  static can_mgr_schedule_entry_t table[] = {{.id = 0x100, .size = 8, .period = 10, .offset = 3}};
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_schedule_config(can_id, table, 1, 1000));
+  run_ticks(1000, 40);
+  TEST_ASSERT_EQUAL_size_t(4, sent_count);
+  for (size_t i = 0; i < sent_count; ++i) {
+    TEST_ASSERT_EQUAL_UINT16(0x100, sent_ids[i]);
+    TEST_ASSERT_EQUAL_UINT32(1003 + 10 * i, sent_ticks[i]);
+  }
+}
+
+void test_schedule_first_tick(void) {
+  static can_mgr_schedule_entry_t table[] = {{.id = 0x100, .size = 1, .period = 5}};
+  can_mgr_schedule_config(can_id, table, 1, 7);
+  TEST_ASSERT_EQUAL_INT(1, can_mgr_schedule_tick(can_id, 7));
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_schedule_tick(can_id, 7));
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_schedule_tick(can_id, 8));
+}
+
+void test_schedule_fill_and_skip(void) {
+  static can_mgr_schedule_entry_t table[] = {{.id = 0x200, .size = 2, .period = 1, .fill = fill_skip_odd}};
+  can_mgr_schedule_config(can_id, table, 1, 0);
+  run_ticks(0, 6);
+  TEST_ASSERT_EQUAL_INT(6, fill_calls);
+  TEST_ASSERT_EQUAL_size_t(3, sent_count);
+  TEST_ASSERT_EQUAL_UINT8(0, sent_data[0]);
+  TEST_ASSERT_EQUAL_UINT8(2, sent_data[1]);
+  TEST_ASSERT_EQUAL_UINT8(4, sent_data[2]);
+}
+
+void test_schedule_missed_ticks(void) {
+  static can_mgr_schedule_entry_t table[] = {{.id = 0x300, .size = 8, .period = 5}};
+  can_mgr_schedule_config(can_id, table, 1, 0);
+  TEST_ASSERT_EQUAL_INT(1, can_mgr_schedule_tick(can_id, 0));
+  // Four periods missed, the message is sent only once
+  TEST_ASSERT_EQUAL_INT(1, can_mgr_schedule_tick(can_id, 23));
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_schedule_tick(can_id, 24));
+  TEST_ASSERT_EQUAL_INT(1, can_mgr_schedule_tick(can_id, 25));
+  // More than a turn of the wheel missed
+  TEST_ASSERT_EQUAL_INT(1, can_mgr_schedule_tick(can_id, 25 + 3 * CAN_MGR_SCHEDULE_WHEEL_SIZE));
+}
+
+void test_schedule_period_longer_than_wheel(void) {
+  static can_mgr_schedule_entry_t table[] = {{.id = 0x400, .size = 8, .period = 3 * CAN_MGR_SCHEDULE_WHEEL_SIZE + 5, .offset = 7}};
+  can_mgr_schedule_config(can_id, table, 1, 0);
+  run_ticks(0, 2 * table[0].period + 10);
+  TEST_ASSERT_EQUAL_size_t(3, sent_count);
+  TEST_ASSERT_EQUAL_UINT32(7, sent_ticks[0]);
+  TEST_ASSERT_EQUAL_UINT32(7 + table[0].period, sent_ticks[1]);
+  TEST_ASSERT_EQUAL_UINT32(7 + 2 * table[0].period, sent_ticks[2]);
+}
+
+void test_schedule_tick_overflow(void) {
+  static can_mgr_schedule_entry_t table[] = {{.id = 0x500, .size = 8, .period = 4}};
+  can_mgr_schedule_config(can_id, table, 1, UINT32_MAX - 5);
+  run_ticks(UINT32_MAX - 5, 16);
+  TEST_ASSERT_EQUAL_size_t(4, sent_count);
+  for (size_t i = 1; i < sent_count; ++i)
+    TEST_ASSERT_EQUAL_UINT32(4, sent_ticks[i] - sent_ticks[i - 1]);
+}
+
+void test_schedule_stats_utilization(void) {
+  // 8 bytes frame: 135 bits every ms at 1 Mbit/s
+  static can_mgr_schedule_entry_t table[] = {{.id = 0x100, .size = 8, .period = 1}, {.id = 0x101, .size = 0, .period = 2}};
+  can_mgr_schedule_stats_t stats;
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_schedule_stats(table, 2, TEST_TICK_US, TEST_BITRATE, &stats));
+  TEST_ASSERT_EQUAL_UINT32(2, stats.window);
+  TEST_ASSERT_EQUAL_UINT32(2, stats.max_burst);
+  TEST_ASSERT_EQUAL_UINT32(135 + 55, stats.max_burst_time_us);
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.135f + 0.0275f, stats.utilization);
+}
+
+void test_schedule_balance_same_period(void) {
+  static can_mgr_schedule_entry_t table[8];
+  for (size_t i = 0; i < 8; ++i)
+    table[i] = (can_mgr_schedule_entry_t){.id = 0x100 + i, .size = 8, .period = 16};
+  can_mgr_schedule_stats_t stats;
+  can_mgr_schedule_stats(table, 8, TEST_TICK_US, TEST_BITRATE, &stats);
+  TEST_ASSERT_EQUAL_UINT32(8, stats.max_burst);
+
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_schedule_balance(table, 8));
+  can_mgr_schedule_stats(table, 8, TEST_TICK_US, TEST_BITRATE, &stats);
+  TEST_ASSERT_EQUAL_UINT32(1, stats.max_burst);
+}
+
+void test_schedule_balance_configured_table(void) {
+  static can_mgr_schedule_entry_t table[4];
+  for (size_t i = 0; i < 4; ++i)
+    table[i] = (can_mgr_schedule_entry_t){.id = 0x100 + i, .size = 8, .period = 4};
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_schedule_config(can_id, table, 4, 0));
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_schedule_balance(table, 4));
+
+  // The wheel is left untouched, all the messages are still sent
+  TEST_ASSERT_EQUAL_INT(4, can_mgr_schedule_tick(can_id, 0));
+  TEST_ASSERT_EQUAL_INT(4, can_mgr_schedule_tick(can_id, 4));
+}
+
+/**
+ * @brief Report the worst case burst and the bus utilization of a schedule
+ * table similar to the one of a vehicle board, before and after the offsets
+ * are balanced, then run it for one hyperperiod
+ */
+void test_schedule_vehicle_table_report(void) {
+  static const struct {
+    uint32_t period;
+    size_t count;
+    uint8_t size;
+  } groups[] = {{10, 6, 8}, {20, 4, 8}, {50, 6, 6}, {100, 8, 8}, {200, 4, 4}, {1000, 4, 2}};
+  static can_mgr_schedule_entry_t table[32];
+  size_t size = 0;
+  uint32_t expected_frames = 0;
+  for (size_t g = 0; g < sizeof(groups) / sizeof(groups[0]); ++g) {
+    for (size_t i = 0; i < groups[g].count; ++i) {
+      table[size] = (can_mgr_schedule_entry_t){.id = 0x100 + size, .size = groups[g].size, .period = groups[g].period};
+      ++size;
+    }
+    expected_frames += groups[g].count * (1000 / groups[g].period);
+  }
+
+  can_mgr_schedule_stats_t before, after;
+  can_mgr_schedule_stats(table, size, TEST_TICK_US, TEST_BITRATE, &before);
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_schedule_balance(table, size));
+  can_mgr_schedule_stats(table, size, TEST_TICK_US, TEST_BITRATE, &after);
+
+  printf("[BENCH] %zu messages, utilization %.1f%%, window %u ticks\n", size, before.utilization * 100.0f, before.window);
+  printf("[BENCH] no offsets:       worst burst %2u frames %4u us\n", before.max_burst, before.max_burst_time_us);
+  printf("[BENCH] balanced offsets: worst burst %2u frames %4u us\n", after.max_burst, after.max_burst_time_us);
+
+  TEST_ASSERT_EQUAL_UINT32(1000, after.window);
+  TEST_ASSERT_EQUAL_FLOAT(before.utilization, after.utilization);
+  TEST_ASSERT_LESS_THAN_UINT32(before.max_burst, after.max_burst);
+  // The largest burst fits in a tick
+  TEST_ASSERT_LESS_THAN_UINT32(TEST_TICK_US, after.max_burst_time_us);
+
+  // Each tick sends at most the worst case burst
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_schedule_config(can_id, table, size, 0));
+  uint32_t max_sent = 0;
+  for (uint32_t tick = 0; tick < after.window; ++tick) {
+    current_tick = tick;
+    int sent = can_mgr_schedule_tick(can_id, tick);
+    if ((uint32_t)sent > max_sent)
+      max_sent = sent;
+  }
+  TEST_ASSERT_EQUAL_size_t(expected_frames, sent_count);
+  TEST_ASSERT_EQUAL_UINT32(after.max_burst, max_sent);
+}
+
+int main() {
+  can_id = can_mgr_init(&hcan);
+
+  UNITY_BEGIN();
+
+  RUN_TEST(test_schedule_invalid_entry);
+  RUN_TEST(test_schedule_period_and_offset);
+  RUN_TEST(test_schedule_first_tick);
+  RUN_TEST(test_schedule_fill_and_skip);
+  RUN_TEST(test_schedule_missed_ticks);
+  RUN_TEST(test_schedule_period_longer_than_wheel);
+  RUN_TEST(test_schedule_tick_overflow);
+  RUN_TEST(test_schedule_stats_utilization);
+  RUN_TEST(test_schedule_balance_same_period);
+  RUN_TEST(test_schedule_balance_configured_table);
+  RUN_TEST(test_schedule_vehicle_table_report);
+
+  return UNITY_END();
+}
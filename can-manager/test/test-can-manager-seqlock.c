@@ -0,0 +1,149 @@
+/**
+ * @file test-can-manager-seqlock.c
+ * @brief Unit test for the consistent reads of the CAN manager message states
+ *
+ * @date 18 Oct 2026
+ * @author Giacomo Mazzucchi [giacomo.mazzucchi@protonmail.com]
+ */
+
+#include "can_manager.h"
+#include "unity.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+
+#define TEST_STATES_SIZE 4
+#define TEST_WRITES 2000000
+
+CAN_HandleTypeDef hcan;
+int can_id;
+
+can_mgr_msg_t states[TEST_STATES_SIZE];
+uint8_t is_new[TEST_STATES_SIZE];
+uint32_t seq[TEST_STATES_SIZE];
+
+atomic_int writer_done;
+
+int can_mgr_from_id_to_index(int can_id, int msg_id) {
+  return msg_id < TEST_STATES_SIZE ? msg_id : -1;
+}
+
+static void receive(uint16_t id, uint8_t value) {
+  can_mgr_msg_t msg = {.id = id, .size = 8};
+  memset(msg.data, value, sizeof(msg.data));
+  can_mgr_it_callback(&hcan, CAN_RX_FIFO0, &msg);
+}
+
+static int is_consistent(can_mgr_msg_t *msg) {
+  for (size_t i = 1; i < sizeof(msg->data); ++i)
+    if (msg->data[i] != msg->data[0])
+      return 0;
+  return 1;
+}
+
+// Simulate the interrupt that keeps writing the same message state
+static void *writer(void *arg) {
+  for (uint32_t i = 0; i < TEST_WRITES; ++i)
+    receive(1, (uint8_t)i);
+  atomic_store(&writer_done, 1);
+  return NULL;
+}
+
+void setUp(void) {
+  memset(states, 0, sizeof(states));
+  memset(is_new, 0, sizeof(is_new));
+  can_mgr_error_code = 0;
+  can_mgr_config(can_id, NULL, 0, CAN_RX_FIFO0, states, is_new, TEST_STATES_SIZE);
+  can_mgr_config_seq(can_id, seq);
+}
+
+void tearDown(void) {}
+
+void test_read_new_flag(void) {
+  can_mgr_msg_t out;
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_read(can_id, 2, &out));
+  receive(2, 0x5A);
+  TEST_ASSERT_EQUAL_INT(1, can_mgr_read(can_id, 2, &out));
+  TEST_ASSERT_EQUAL_UINT16(2, out.id);
+  TEST_ASSERT_EQUAL_UINT8(8, out.size);
+  TEST_ASSERT_EQUAL_UINT8(0x5A, out.data[7]);
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_read(can_id, 2, &out));
+}
+
+void test_read_sequence_even_after_write(void) {
+  receive(3, 1);
+  receive(3, 2);
+  TEST_ASSERT_EQUAL_UINT32(4, seq[3]);
+  TEST_ASSERT_EQUAL_UINT32(0, seq[2]);
+}
+
+void test_read_index_out_of_bound(void) {
+  can_mgr_msg_t out;
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_read(can_id, TEST_STATES_SIZE, &out));
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_read(can_id, -1, &out));
+}
+
+void test_read_without_seq(void) {
+  can_mgr_config_seq(can_id, NULL);
+  can_mgr_msg_t out;
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_read(can_id, 0, &out));
+  TEST_ASSERT_NOT_EQUAL(0, can_mgr_error_code);
+}
+
+void test_read_write_in_progress(void) {
+  // A write that never completes makes every attempt fail
+  seq[1] = 1;
+  can_mgr_msg_t out;
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_read(can_id, 1, &out));
+  TEST_ASSERT_NOT_EQUAL(0, can_mgr_error_code);
+}
+
+/**
+ * @brief Read the message state while another thread keeps writing it, the
+ * snapshots given by can_mgr_read must always be consistent, the torn plain
+ * copies of the state are reported for comparison (on the host the 8 data bytes
+ * are usually written with a single store, on the MCU they are not)
+ */
+void test_read_concurrent_writer(void) {
+  pthread_t thread;
+  atomic_store(&writer_done, 0);
+  TEST_ASSERT_EQUAL_INT(0, pthread_create(&thread, NULL, writer, NULL));
+
+  unsigned long reads = 0, torn = 0, failed = 0;
+  unsigned long plain_reads = 0, plain_torn = 0;
+  while (!atomic_load(&writer_done)) {
+    can_mgr_msg_t out;
+    if (can_mgr_read(can_id, 1, &out) < 0) {
+      ++failed;
+    } else {
+      ++reads;
+      torn += !is_consistent(&out);
+    }
+
+    memcpy(&out, (void *)&states[1], sizeof(out));
+    ++plain_reads;
+    plain_torn += !is_consistent(&out);
+  }
+  pthread_join(thread, NULL);
+
+  printf("[BENCH] concurrent writer: seqlock %lu reads %lu torn %lu retries exhausted, plain copy %lu reads %lu torn\n",
+         reads, torn, failed, plain_reads, plain_torn);
+  TEST_ASSERT_EQUAL_UINT32(0, torn);
+  TEST_ASSERT_EQUAL_UINT32(2 * TEST_WRITES, seq[1]);
+}
+
+int main() {
+  can_id = can_mgr_init(&hcan);
+
+  UNITY_BEGIN();
+
+  RUN_TEST(test_read_new_flag);
+  RUN_TEST(test_read_sequence_even_after_write);
+  RUN_TEST(test_read_index_out_of_bound);
+  RUN_TEST(test_read_without_seq);
+  RUN_TEST(test_read_write_in_progress);
+  RUN_TEST(test_read_concurrent_writer);
+
+  return UNITY_END();
+}
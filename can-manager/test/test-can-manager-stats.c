@@ -0,0 +1,217 @@
+/**
+ * @file test-can-manager-stats.c
+ * @brief Unit test for the reception and transmission statistics of the CAN
+ * manager
+ *
+ * @date 18 Oct 2026
+ * @author Giacomo Mazzucchi [giacomo.mazzucchi@protonmail.com]
+ */
+
+#include "can_manager.h"
+#include "unity.h"
+
+#define TEST_STATES_SIZE 4
+#define TEST_BITRATE 1000000U
+
+CAN_HandleTypeDef hcan;
+int can_id;
+
+can_mgr_msg_t states[TEST_STATES_SIZE];
+uint8_t is_new[TEST_STATES_SIZE];
+can_mgr_id_stats_t id_stats[TEST_STATES_SIZE];
+
+uint32_t now_us;
+
+// IDs from 0 to 7 are known, only the first TEST_STATES_SIZE have a state
+int can_mgr_from_id_to_index(int can_id, int msg_id) {
+  return msg_id < 8 ? msg_id : -1;
+}
+
+uint32_t can_mgr_stats_get_time_us(void) { return now_us; }
+
+static void receive(uint16_t id, uint8_t size) {
+  can_mgr_msg_t msg = {.id = id, .size = size};
+  can_mgr_it_callback(&hcan, CAN_RX_FIFO0, &msg);
+}
+
+void setUp(void) {
+  now_us = 0;
+  memset(is_new, 0, sizeof(is_new));
+  hcan.tx_free_level = UINT32_MAX;
+  hcan.tx_callback = NULL;
+  can_mgr_error_code = 0;
+  can_mgr_config(can_id, NULL, 0, CAN_RX_FIFO0, states, is_new, TEST_STATES_SIZE);
+  can_mgr_config_stats(can_id, id_stats, TEST_BITRATE);
+}
+
+void tearDown(void) {}
+
+void test_stats_inter_arrival(void) {
+  uint32_t arrivals[] = {1000, 11000, 21500, 31000};
+  for (size_t i = 0; i < 4; ++i) {
+    now_us = arrivals[i];
+    receive(1, 8);
+  }
+  TEST_ASSERT_EQUAL_UINT16(1, id_stats[1].id);
+  TEST_ASSERT_EQUAL_UINT32(4, id_stats[1].count);
+  TEST_ASSERT_EQUAL_UINT32(9500, id_stats[1].min_period_us);
+  TEST_ASSERT_EQUAL_UINT32(10500, id_stats[1].max_period_us);
+  TEST_ASSERT_EQUAL_UINT64(30000, id_stats[1].sum_period_us);
+  TEST_ASSERT_EQUAL_UINT32(0, id_stats[2].count);
+
+  char line[96];
+  TEST_ASSERT_GREATER_THAN_INT(0, can_mgr_stats_format_id(can_id, 1, line, sizeof(line)));
+  TEST_ASSERT_EQUAL_STRING("0x001 n 4 period us min 9500 avg 10000 max 10500 jitter 1000\r\n", line);
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_stats_format_id(can_id, 2, line, sizeof(line)));
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_stats_format_id(can_id, TEST_STATES_SIZE, line, sizeof(line)));
+}
+
+void test_stats_unknown_and_out_of_bound(void) {
+  receive(20, 1);
+  receive(21, 1);
+  receive(TEST_STATES_SIZE + 1, 1);
+  can_mgr_stats_t stats;
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_stats_get(can_id, &stats));
+  TEST_ASSERT_EQUAL_UINT32(3, stats.rx_frames);
+  TEST_ASSERT_EQUAL_UINT32(2, stats.unknown_ids);
+  TEST_ASSERT_EQUAL_UINT32(1, stats.out_of_bound);
+}
+
+void test_stats_overwritten(void) {
+  receive(2, 1);
+  receive(2, 1);
+  is_new[2] = 0;
+  receive(2, 1);
+  can_mgr_stats_t stats;
+  can_mgr_stats_get(can_id, &stats);
+  TEST_ASSERT_EQUAL_UINT32(1, stats.overwritten);
+}
+
+void test_stats_fifo_overruns(void) {
+  can_mgr_stats_error_callback(&hcan, HAL_CAN_ERROR_RX_FOV0);
+  can_mgr_stats_error_callback(&hcan, HAL_CAN_ERROR_RX_FOV0 | HAL_CAN_ERROR_RX_FOV1);
+  can_mgr_stats_error_callback(NULL, HAL_CAN_ERROR_RX_FOV0);
+  can_mgr_stats_t stats;
+  can_mgr_stats_get(can_id, &stats);
+  TEST_ASSERT_EQUAL_UINT32(3, stats.fifo_overruns);
+}
+
+void test_stats_bus_load(void) {
+  // 100 frames of 135 bits and 100 frames of 55 bits in 100 ms at 1 Mbit/s
+  for (int i = 0; i < 100; ++i) {
+    now_us = i * 1000;
+    receive(3, 8);
+    can_mgr_msg_t msg = {.id = 0x100, .size = 0};
+    can_mgr_send(can_id, &msg);
+  }
+  now_us = CAN_MGR_STATS_WINDOW_US;
+  can_mgr_stats_t stats;
+  can_mgr_stats_get(can_id, &stats);
+  TEST_ASSERT_EQUAL_UINT32(100, stats.tx_frames);
+  TEST_ASSERT_EQUAL_UINT16(190, stats.bus_load);
+
+  // Silent bus in the next window
+  now_us = 3 * CAN_MGR_STATS_WINDOW_US;
+  can_mgr_stats_get(can_id, &stats);
+  TEST_ASSERT_EQUAL_UINT16(0, stats.bus_load);
+  TEST_ASSERT_EQUAL_UINT16(190, stats.max_bus_load);
+}
+
+void test_stats_send_n(void) {
+  can_mgr_msg_t msgs[3] = {{.id = 1}, {.id = 2}, {.id = 3}};
+  TEST_ASSERT_EQUAL_INT(3, can_mgr_send_n(can_id, msgs, 3));
+  can_mgr_stats_t stats;
+  can_mgr_stats_get(can_id, &stats);
+  TEST_ASSERT_EQUAL_UINT32(3, stats.tx_frames);
+}
+
+void test_stats_tx_queue(void) {
+  // The queued messages are counted when they are moved into a mailbox
+  hcan.tx_free_level = 0;
+  can_mgr_msg_t msgs[3] = {{.id = 1, .size = 8}, {.id = 2, .size = 8}, {.id = 3, .size = 8}};
+  TEST_ASSERT_EQUAL_INT(3, can_mgr_send_n(can_id, msgs, 3));
+  can_mgr_stats_t stats;
+  can_mgr_stats_get(can_id, &stats);
+  TEST_ASSERT_EQUAL_UINT32(0, stats.tx_frames);
+
+  hcan.tx_free_level = 2;
+  can_mgr_tx_it_callback(&hcan);
+  can_mgr_stats_get(can_id, &stats);
+  TEST_ASSERT_EQUAL_UINT32(2, stats.tx_frames);
+
+  hcan.tx_free_level = UINT32_MAX;
+  can_mgr_tx_it_callback(&hcan);
+  now_us = CAN_MGR_STATS_WINDOW_US;
+  can_mgr_stats_get(can_id, &stats);
+  TEST_ASSERT_EQUAL_UINT32(3, stats.tx_frames);
+  TEST_ASSERT_EQUAL_UINT16(4, stats.bus_load);
+}
+
+void test_stats_rx_queue_full(void) {
+  // The frames dropped by the full receive queue have used the bus too
+  can_mgr_rx_queue_enable(can_id, 1);
+  for (int i = 0; i < CAN_MGR_RX_QUEUE_SIZE + 4; ++i)
+    receive(3, 8);
+  now_us = CAN_MGR_STATS_WINDOW_US;
+  can_mgr_stats_t stats;
+  can_mgr_stats_get(can_id, &stats);
+  TEST_ASSERT_EQUAL_INT(4, can_mgr_rx_dropped(can_id));
+  TEST_ASSERT_EQUAL_UINT32(CAN_MGR_RX_QUEUE_SIZE + 4, stats.rx_frames);
+  TEST_ASSERT_EQUAL_UINT16(27, stats.bus_load);
+
+  can_mgr_msg_t out[CAN_MGR_RX_QUEUE_SIZE];
+  can_mgr_rx_drain(can_id, out, CAN_MGR_RX_QUEUE_SIZE);
+  can_mgr_rx_queue_enable(can_id, 0);
+}
+
+void test_stats_format(void) {
+  receive(1, 8);
+  receive(20, 8);
+  char line[128];
+  can_mgr_stats_format(can_id, line, sizeof(line));
+  TEST_ASSERT_EQUAL_STRING("can0 rx 2 tx 0 unknown 1 oob 0 overwritten 0 overrun 0 load 0.0% max 0.0%\r\n", line);
+}
+
+void test_stats_config_resets(void) {
+  receive(1, 8);
+  can_mgr_config_stats(can_id, id_stats, TEST_BITRATE);
+  can_mgr_stats_t stats;
+  can_mgr_stats_get(can_id, &stats);
+  TEST_ASSERT_EQUAL_UINT32(0, stats.rx_frames);
+  TEST_ASSERT_EQUAL_UINT32(0, id_stats[1].count);
+
+  // Without per message statistics only the counters are updated
+  can_mgr_config_stats(can_id, NULL, TEST_BITRATE);
+  receive(1, 8);
+  can_mgr_stats_get(can_id, &stats);
+  TEST_ASSERT_EQUAL_UINT32(1, stats.rx_frames);
+  TEST_ASSERT_EQUAL_UINT32(0, id_stats[1].count);
+}
+
+void test_stats_invalid_can_id(void) {
+  can_mgr_stats_t stats;
+  char line[8];
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_stats_get(CAN_MGR_N_CAN, &stats));
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_config_stats(-1, NULL, TEST_BITRATE));
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_stats_format(CAN_MGR_N_CAN, line, sizeof(line)));
+}
+
+int main() {
+  can_id = can_mgr_init(&hcan);
+
+  UNITY_BEGIN();
+
+  RUN_TEST(test_stats_inter_arrival);
+  RUN_TEST(test_stats_unknown_and_out_of_bound);
+  RUN_TEST(test_stats_overwritten);
+  RUN_TEST(test_stats_fifo_overruns);
+  RUN_TEST(test_stats_bus_load);
+  RUN_TEST(test_stats_send_n);
+  RUN_TEST(test_stats_tx_queue);
+  RUN_TEST(test_stats_rx_queue_full);
+  RUN_TEST(test_stats_format);
+  RUN_TEST(test_stats_config_resets);
+  RUN_TEST(test_stats_invalid_can_id);
+
+  return UNITY_END();
+}
@@ -0,0 +1,231 @@
+/**
+ * @file test-can-manager-timeout.c
+ * @brief Unit test for the timeouts of the CAN manager message states, with
+ * simulated senders that stop transmitting
+ *
+ * @date 18 Oct 2026
+ * @author Giacomo Mazzucchi [giacomo.mazzucchi@protonmail.com]
+ */
+
+#include "can_manager.h"
+#include "errorlib.h"
+#include "unity.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#define TEST_STATES_SIZE 512
+#define TEST_BENCH_TICKS 20000
+#define TEST_LOG_SIZE 16
+
+CAN_HandleTypeDef hcan;
+int can_id;
+
+can_mgr_msg_t states[TEST_STATES_SIZE];
+uint8_t is_new[TEST_STATES_SIZE];
+can_mgr_timeout_t timeouts[TEST_STATES_SIZE];
+
+uint32_t now;
+
+// Errors raised by the timeout callback
+#define TEST_ERROR_GROUPS 1
+int32_t timeout_instances[4];
+int32_t *errors[TEST_ERROR_GROUPS] = {timeout_instances};
+const size_t instances_count[TEST_ERROR_GROUPS] = {4};
+const size_t thresholds[TEST_ERROR_GROUPS] = {1};
+ErrorLibHandler error_handler;
+
+struct {
+  int index;
+  uint8_t stale;
+  uint32_t tick;
+} callback_log[TEST_LOG_SIZE];
+size_t callback_count;
+
+int can_mgr_from_id_to_index(int can_id, int msg_id) {
+  return msg_id < TEST_STATES_SIZE ? msg_id : -1;
+}
+
+uint32_t can_mgr_get_tick(void) { return now; }
+
+static void on_timeout(int can_id, int index, uint8_t stale) {
+  if (callback_count < TEST_LOG_SIZE) {
+    callback_log[callback_count].index = index;
+    callback_log[callback_count].stale = stale;
+    callback_log[callback_count].tick = now;
+    ++callback_count;
+  }
+  if (stale)
+    errorlib_error_set(&error_handler, 0, index);
+  else
+    errorlib_error_reset(&error_handler, 0, index);
+}
+
+static void receive(uint16_t id) {
+  can_mgr_msg_t msg = {.id = id, .size = 1};
+  can_mgr_it_callback(&hcan, CAN_RX_FIFO0, &msg);
+}
+
+/**
+ * @brief Run the senders of the first four message states (periods of 10, 20
+ * and 100 ticks, the last one is not monitored), the sender of the message
+ * dropped_index is silent between dropped_from and dropped_to
+ */
+static void run_senders(uint32_t from, uint32_t to, int dropped_index, uint32_t dropped_from, uint32_t dropped_to) {
+  static const uint32_t periods[] = {10, 20, 100, 50};
+  for (now = from; now < to; ++now) {
+    for (int i = 0; i < 4; ++i) {
+      int dropped = i == dropped_index && now >= dropped_from && now < dropped_to;
+      if (now % periods[i] == 0 && !dropped)
+        receive(i);
+    }
+    can_mgr_check_timeouts(can_id, now);
+  }
+}
+
+void setUp(void) {
+  now = 0;
+  callback_count = 0;
+  can_mgr_error_code = 0;
+  memset(timeouts, 0, sizeof(timeouts));
+  timeouts[0].period = 10;
+  timeouts[1].period = 20;
+  timeouts[2].period = 100;
+  errorlib_init(&error_handler, errors, instances_count, thresholds, TEST_ERROR_GROUPS);
+  memset(timeout_instances, 0, sizeof(timeout_instances));
+  can_mgr_config(can_id, NULL, 0, CAN_RX_FIFO0, states, is_new, TEST_STATES_SIZE);
+  can_mgr_config_timeouts(can_id, timeouts, on_timeout, 0);
+}
+
+void tearDown(void) {}
+
+void test_timeout_all_senders_alive(void) {
+  run_senders(0, 1000, -1, 0, 0);
+  TEST_ASSERT_EQUAL_size_t(0, callback_count);
+  TEST_ASSERT_EQUAL_size_t(0, errorlib_get_expired(&error_handler));
+  TEST_ASSERT_EQUAL_UINT32(980, timeouts[1].last_rx);
+}
+
+void test_timeout_dropped_sender(void) {
+  run_senders(0, 500, 1, 300, UINT32_MAX);
+  TEST_ASSERT_EQUAL_size_t(1, callback_count);
+  TEST_ASSERT_EQUAL_INT(1, callback_log[0].index);
+  TEST_ASSERT_EQUAL_UINT8(1, callback_log[0].stale);
+  // Last message at 280, stale after three periods
+  TEST_ASSERT_EQUAL_UINT32(280 + 3 * 20, callback_log[0].tick);
+  TEST_ASSERT_EQUAL_INT(1, can_mgr_is_stale(can_id, 1));
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_is_stale(can_id, 0));
+
+  TEST_ASSERT_EQUAL_size_t(1, errorlib_get_expired(&error_handler));
+  ErrorInfo info = errorlib_get_expired_info(&error_handler);
+  TEST_ASSERT_EQUAL_UINT32(0, info.group);
+  TEST_ASSERT_EQUAL_UINT16(1, info.instance);
+}
+
+void test_timeout_sender_comes_back(void) {
+  run_senders(0, 1000, 2, 200, 700);
+  TEST_ASSERT_EQUAL_size_t(2, callback_count);
+  TEST_ASSERT_EQUAL_INT(2, callback_log[0].index);
+  TEST_ASSERT_EQUAL_UINT32(100 + 3 * 100, callback_log[0].tick);
+  TEST_ASSERT_EQUAL_UINT8(0, callback_log[1].stale);
+  // Detected within a period from the first message received again
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(700, callback_log[1].tick);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(700 + 100, callback_log[1].tick);
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_is_stale(can_id, 2));
+}
+
+void test_timeout_all_senders_dropped(void) {
+  // The bus is disconnected, the unmonitored message is never reported
+  now = 1000;
+  TEST_ASSERT_EQUAL_INT(3, can_mgr_check_timeouts(can_id, now));
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_check_timeouts(can_id, now + 1));
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_is_stale(can_id, 3));
+}
+
+void test_timeout_tick_overflow(void) {
+  can_mgr_config_timeouts(can_id, timeouts, on_timeout, UINT32_MAX - 100);
+  run_senders(UINT32_MAX - 100, UINT32_MAX, -1, 0, 0);
+  now = 0;
+  receive(0);
+  receive(1);
+  receive(2);
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_check_timeouts(can_id, 0));
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_check_timeouts(can_id, 25));
+  TEST_ASSERT_EQUAL_INT(1, can_mgr_check_timeouts(can_id, 30));
+}
+
+void test_timeout_disabled(void) {
+  can_mgr_config_timeouts(can_id, NULL, NULL, 0);
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_check_timeouts(can_id, 10000));
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_is_stale(can_id, 0));
+}
+
+void test_timeout_invalid(void) {
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_check_timeouts(CAN_MGR_N_CAN, 0));
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_is_stale(can_id, TEST_STATES_SIZE));
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_config_timeouts(-1, timeouts, NULL, 0));
+}
+
+static double elapsed_ns(struct timespec *start, struct timespec *end) {
+  return (end->tv_sec - start->tv_sec) * 1e9 + (end->tv_nsec - start->tv_nsec);
+}
+
+// Scan of every message state, done at each tick by the boards
+static int scan_timeouts(uint32_t now) {
+  int expired = 0;
+  for (size_t i = 0; i < TEST_STATES_SIZE; ++i)
+    if (timeouts[i].period > 0 && now - timeouts[i].last_rx >= timeouts[i].period * CAN_MGR_TIMEOUT_PERIODS)
+      ++expired;
+  return expired;
+}
+
+/**
+ * @brief Compare the deadline heap with a scan of every message state with 512
+ * monitored messages (periods from 10 to 80 ticks) and one dropped sender
+ */
+void test_timeout_bench(void) {
+  for (size_t i = 0; i < TEST_STATES_SIZE; ++i)
+    timeouts[i].period = 10 * (1 + i % 8);
+  can_mgr_config_timeouts(can_id, timeouts, NULL, 0);
+
+  double heap_ns = 0, scan_ns = 0;
+  int heap_expired = 0, scan_expired = 0;
+  struct timespec start, end;
+  for (now = 0; now < TEST_BENCH_TICKS; ++now) {
+    for (size_t i = 1; i < TEST_STATES_SIZE; ++i)
+      if ((now + i) % timeouts[i].period == 0)
+        receive(i);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    heap_expired += can_mgr_check_timeouts(can_id, now);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    heap_ns += elapsed_ns(&start, &end);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    scan_expired += scan_timeouts(now) > 0;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    scan_ns += elapsed_ns(&start, &end);
+  }
+  printf("[BENCH] %d messages: deadline heap %.1f ns/tick, scan %.1f ns/tick\n",
+         TEST_STATES_SIZE, heap_ns / TEST_BENCH_TICKS, scan_ns / TEST_BENCH_TICKS);
+  TEST_ASSERT_EQUAL_INT(1, heap_expired);
+  TEST_ASSERT_EQUAL_INT(1, can_mgr_is_stale(can_id, 0));
+  TEST_ASSERT_GREATER_THAN_INT(0, scan_expired);
+}
+
+int main() {
+  can_id = can_mgr_init(&hcan);
+
+  UNITY_BEGIN();
+
+  RUN_TEST(test_timeout_all_senders_alive);
+  RUN_TEST(test_timeout_dropped_sender);
+  RUN_TEST(test_timeout_sender_comes_back);
+  RUN_TEST(test_timeout_all_senders_dropped);
+  RUN_TEST(test_timeout_tick_overflow);
+  RUN_TEST(test_timeout_disabled);
+  RUN_TEST(test_timeout_invalid);
+  RUN_TEST(test_timeout_bench);
+
+  return UNITY_END();
+}
@@ -0,0 +1,330 @@
+/**
+ * @file test-can-manager-tx-queue.c
+ * @brief Unit test and bus simulation for the transmit queue of the CAN manager
+ *
+ * @date 18 Oct 2026
+ * @author Giacomo Mazzucchi [giacomo.mazzucchi@protonmail.com]
+ */
+
+#include "can_manager.h"
+#include "unity.h"
+
+#include <stdio.h>
+
+// Duration of a frame with 8 bytes of data at 1Mbit/s (stuff bits included)
+#define FRAME_TIME_US 125U
+#define SIM_TIME_US 1000000U
+#define SIM_MSG_COUNT 8
+
+CAN_HandleTypeDef hcan;
+int can_id;
+
+int can_mgr_from_id_to_index(int can_id, int msg_id) { return -1; }
+
+/** @brief Simulated transmit mailbox */
+typedef struct {
+  uint8_t used;
+  uint16_t id;
+  uint32_t enqueued;
+} mailbox_t;
+
+mailbox_t mailboxes[CAN_MOCK_TX_MAILBOXES];
+uint16_t sent_ids[64];
+uint32_t sent_ext_ids[64];
+size_t sent_count;
+
+static void tx_callback(CAN_HandleTypeDef *hcan, CAN_TxHeaderTypeDef *header, uint8_t *data) {
+  for (size_t i = 0; i < CAN_MOCK_TX_MAILBOXES; ++i) {
+    if (!mailboxes[i].used) {
+      mailboxes[i].used = 1;
+      mailboxes[i].id = header->StdId;
+      memcpy(&mailboxes[i].enqueued, data, sizeof(uint32_t));
+      break;
+    }
+  }
+  if (sent_count < 64) {
+    sent_ext_ids[sent_count] = header->IDE == CAN_ID_EXT ? header->ExtId : 0;
+    sent_ids[sent_count++] = header->StdId;
+  }
+}
+
+// The mailbox with the lowest ID wins the arbitration
+static int bus_arbitration(void) {
+  int winner = -1;
+  for (int i = 0; i < (int)CAN_MOCK_TX_MAILBOXES; ++i)
+    if (mailboxes[i].used && (winner < 0 || mailboxes[i].id < mailboxes[winner].id))
+      winner = i;
+  return winner;
+}
+
+static int send(uint16_t id, uint32_t now) {
+  can_mgr_msg_t msg = {.id = id, .size = 8};
+  memcpy(msg.data, &now, sizeof(now));
+  return can_mgr_send(can_id, &msg);
+}
+
+// Transmit the winning mailbox and give the mailbox back to the manager
+static void complete_transmission(void) {
+  int mb = bus_arbitration();
+  if (mb >= 0) {
+    mailboxes[mb].used = 0;
+    ++hcan.tx_free_level;
+  }
+  can_mgr_tx_it_callback(&hcan);
+}
+
+void setUp(void) {
+  memset(mailboxes, 0, sizeof(mailboxes));
+  sent_count = 0;
+  hcan.tx_free_level = CAN_MOCK_TX_MAILBOXES;
+  hcan.tx_callback = tx_callback;
+  can_mgr_error_code = 0;
+}
+
+void tearDown(void) {
+  // Empty the queue
+  while (can_mgr_tx_queue_size(can_id) > 0 || bus_arbitration() >= 0)
+    complete_transmission();
+}
+
+void test_tx_queue_direct_when_mailbox_free(void) {
+  TEST_ASSERT_EQUAL_INT(0, send(0x100, 0));
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_tx_queue_size(can_id));
+  TEST_ASSERT_EQUAL_size_t(1, sent_count);
+  TEST_ASSERT_EQUAL_UINT32(CAN_MOCK_TX_MAILBOXES - 1, hcan.tx_free_level);
+}
+
+void test_tx_queue_never_blocks_when_full(void) {
+  for (uint16_t i = 0; i < CAN_MOCK_TX_MAILBOXES + 5; ++i)
+    TEST_ASSERT_EQUAL_INT(0, send(0x100 + i, 0));
+  TEST_ASSERT_EQUAL_INT(5, can_mgr_tx_queue_size(can_id));
+  TEST_ASSERT_EQUAL_size_t(CAN_MOCK_TX_MAILBOXES, sent_count);
+}
+
+void test_tx_queue_priority_order(void) {
+  hcan.tx_free_level = 0;
+  send(0x300, 0);
+  send(0x010, 0);
+  send(0x200, 0);
+  send(0x020, 0);
+  TEST_ASSERT_EQUAL_size_t(0, sent_count);
+
+  hcan.tx_free_level = 1;
+  can_mgr_tx_it_callback(&hcan);
+  hcan.tx_free_level = 1;
+  can_mgr_tx_it_callback(&hcan);
+  hcan.tx_free_level = 2;
+  can_mgr_tx_it_callback(&hcan);
+
+  uint16_t expected[] = {0x010, 0x020, 0x200, 0x300};
+  TEST_ASSERT_EQUAL_size_t(4, sent_count);
+  TEST_ASSERT_EQUAL_UINT16_ARRAY(expected, sent_ids, 4);
+}
+
+void test_tx_queue_fifo_for_same_id(void) {
+  hcan.tx_free_level = 0;
+  for (uint32_t i = 0; i < 5; ++i)
+    send(0x123, i);
+  hcan.tx_free_level = 5;
+  can_mgr_tx_it_callback(&hcan);
+  TEST_ASSERT_EQUAL_size_t(5, sent_count);
+  hcan.tx_free_level = 0;
+  for (size_t i = 0; i < CAN_MOCK_TX_MAILBOXES; ++i)
+    TEST_ASSERT_EQUAL_UINT32(i, mailboxes[i].enqueued);
+  memset(mailboxes, 0, sizeof(mailboxes));
+}
+
+void test_tx_queue_extended_ids(void) {
+  // Extended frames wait in the queue too, in order of arbitration
+  uint8_t payload[8] = {0};
+  can_mgr_fd_msg_t ext_low = {.id = (0x040U << 18) | 0x3FFFFU, .flags = CAN_MGR_MSG_EXT_ID, .size = 8, .capacity = 8, .data = payload};
+  can_mgr_fd_msg_t ext_same = {.id = 0x100U << 18, .flags = CAN_MGR_MSG_EXT_ID, .size = 8, .capacity = 8, .data = payload};
+  hcan.tx_free_level = 0;
+  send(0x100, 0);
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_send_fd(can_id, &ext_same));
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_send_fd(can_id, &ext_low));
+  send(0x050, 0);
+  TEST_ASSERT_EQUAL_INT(4, can_mgr_tx_queue_size(can_id));
+  TEST_ASSERT_EQUAL_size_t(0, sent_count);
+
+  for (int i = 0; i < 4; ++i) {
+    hcan.tx_free_level = 1;
+    can_mgr_tx_it_callback(&hcan);
+  }
+  // The standard frame wins over the extended one with the same base ID
+  uint32_t expected_ext[] = {ext_low.id, 0, 0, ext_same.id};
+  uint16_t expected_std[] = {0, 0x050, 0x100, 0};
+  TEST_ASSERT_EQUAL_size_t(4, sent_count);
+  TEST_ASSERT_EQUAL_UINT32_ARRAY(expected_ext, sent_ext_ids, 4);
+  TEST_ASSERT_EQUAL_UINT16_ARRAY(expected_std, sent_ids, 4);
+  hcan.tx_free_level = 0;
+  memset(mailboxes, 0, sizeof(mailboxes));
+}
+
+void test_tx_queue_full(void) {
+  hcan.tx_free_level = 0;
+  for (int i = 0; i < CAN_MGR_TX_QUEUE_SIZE; ++i)
+    TEST_ASSERT_EQUAL_INT(0, send(0x100, 0));
+  TEST_ASSERT_EQUAL_INT(-1, send(0x100, 0));
+  TEST_ASSERT_NOT_EQUAL(0, can_mgr_error_code);
+  hcan.tx_free_level = CAN_MOCK_TX_MAILBOXES;
+}
+
+void test_tx_queue_invalid_can_id(void) {
+  can_mgr_msg_t msg = {.id = 1};
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_send(CAN_MGR_N_CAN, &msg));
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_tx_queue_size(-1));
+}
+
+/** @brief Periodic message of the simulation and its latency statistics */
+typedef struct {
+  uint16_t id;
+  uint32_t period;
+  uint32_t sent;
+  uint32_t dropped;
+  uint64_t latency_sum;
+  uint32_t latency_max;
+} sim_msg_t;
+
+typedef enum { SIM_DIRECT, SIM_FIFO, SIM_PRIORITY } sim_mode_t;
+
+// About 112% of the bus bandwidth
+sim_msg_t sim_msgs[SIM_MSG_COUNT] = {
+    {0x010, 1000}, {0x080, 2000}, {0x100, 1000}, {0x200, 500},
+    {0x300, 1000}, {0x400, 500},  {0x500, 1000}, {0x700, 2000}};
+
+// Software FIFO used as a baseline without priorities
+struct {
+  uint16_t id[CAN_MGR_TX_QUEUE_SIZE];
+  uint32_t enqueued[CAN_MGR_TX_QUEUE_SIZE];
+  size_t start, size;
+} fifo;
+
+static void fifo_refill(void) {
+  while (hcan.tx_free_level > 0 && fifo.size > 0) {
+    can_mgr_msg_t msg = {.id = fifo.id[fifo.start], .size = 8};
+    memcpy(msg.data, &fifo.enqueued[fifo.start], sizeof(uint32_t));
+    can_mgr_send(can_id, &msg);
+    fifo.start = (fifo.start + 1) % CAN_MGR_TX_QUEUE_SIZE;
+    --fifo.size;
+  }
+}
+
+static sim_msg_t *sim_find(uint16_t id) {
+  for (size_t i = 0; i < SIM_MSG_COUNT; ++i)
+    if (sim_msgs[i].id == id)
+      return &sim_msgs[i];
+  return NULL;
+}
+
+static void simulate(sim_mode_t mode) {
+  for (size_t i = 0; i < SIM_MSG_COUNT; ++i) {
+    sim_msgs[i].sent = sim_msgs[i].dropped = 0;
+    sim_msgs[i].latency_sum = sim_msgs[i].latency_max = 0;
+  }
+  memset(&fifo, 0, sizeof(fifo));
+
+  uint32_t bus_end = 0;
+  int bus_mb = -1;
+  for (uint32_t now = 0; now < SIM_TIME_US; ++now) {
+    // End of the current transmission
+    if (bus_mb >= 0 && now >= bus_end) {
+      sim_msg_t *m = sim_find(mailboxes[bus_mb].id);
+      uint32_t latency = now - mailboxes[bus_mb].enqueued;
+      ++m->sent;
+      m->latency_sum += latency;
+      if (latency > m->latency_max)
+        m->latency_max = latency;
+      mailboxes[bus_mb].used = 0;
+      ++hcan.tx_free_level;
+      bus_mb = -1;
+      if (mode == SIM_FIFO)
+        fifo_refill();
+      else
+        can_mgr_tx_it_callback(&hcan);
+    }
+
+    // Main loop sending the periodic messages
+    for (size_t i = 0; i < SIM_MSG_COUNT; ++i) {
+      if (now % sim_msgs[i].period != 0)
+        continue;
+      if (mode == SIM_FIFO) {
+        if (fifo.size == CAN_MGR_TX_QUEUE_SIZE) {
+          ++sim_msgs[i].dropped;
+        } else {
+          size_t idx = (fifo.start + fifo.size) % CAN_MGR_TX_QUEUE_SIZE;
+          fifo.id[idx] = sim_msgs[i].id;
+          fifo.enqueued[idx] = now;
+          ++fifo.size;
+        }
+      } else if (mode == SIM_DIRECT && hcan.tx_free_level == 0) {
+        // The old behaviour without waiting: the message is lost
+        ++sim_msgs[i].dropped;
+      } else if (send(sim_msgs[i].id, now) < 0) {
+        ++sim_msgs[i].dropped;
+      }
+    }
+    if (mode == SIM_FIFO)
+      fifo_refill();
+
+    // Start of a new transmission
+    if (bus_mb < 0 && (bus_mb = bus_arbitration()) >= 0)
+      bus_end = now + FRAME_TIME_US;
+  }
+  memset(mailboxes, 0, sizeof(mailboxes));
+  hcan.tx_free_level = CAN_MOCK_TX_MAILBOXES;
+  while (can_mgr_tx_queue_size(can_id) > 0)
+    complete_transmission();
+  memset(mailboxes, 0, sizeof(mailboxes));
+  hcan.tx_free_level = CAN_MOCK_TX_MAILBOXES;
+}
+
+static void print_results(const char *name) {
+  for (size_t i = 0; i < SIM_MSG_COUNT; ++i) {
+    sim_msg_t *m = &sim_msgs[i];
+    printf("[BENCH] %-8s id 0x%03X: sent %5u dropped %5u latency avg %7.1f us max %6u us\n",
+           name, m->id, (unsigned)m->sent, (unsigned)m->dropped,
+           m->sent ? (double)m->latency_sum / m->sent : 0.0,
+           (unsigned)m->latency_max);
+  }
+}
+
+/**
+ * @brief Simulate one second of a saturated bus (about 112% of the bandwidth)
+ * comparing the direct send without a queue, a FIFO queue and the priority
+ * queue, measuring the queue latency of each message
+ */
+void test_tx_queue_bus_saturation(void) {
+  simulate(SIM_DIRECT);
+  print_results("direct");
+
+  simulate(SIM_FIFO);
+  print_results("fifo");
+  uint32_t fifo_high_max = sim_msgs[0].latency_max;
+
+  simulate(SIM_PRIORITY);
+  print_results("priority");
+
+  // The highest priority message waits at most for the mailboxes to free up
+  TEST_ASSERT_EQUAL_UINT32(0, sim_msgs[0].dropped);
+  TEST_ASSERT_EQUAL_UINT32(SIM_TIME_US / sim_msgs[0].period, sim_msgs[0].sent);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(2 * FRAME_TIME_US, sim_msgs[0].latency_max);
+  TEST_ASSERT_LESS_THAN_UINT32(fifo_high_max, sim_msgs[0].latency_max);
+}
+
+int main() {
+  can_id = can_mgr_init(&hcan);
+
+  UNITY_BEGIN();
+
+  RUN_TEST(test_tx_queue_direct_when_mailbox_free);
+  RUN_TEST(test_tx_queue_never_blocks_when_full);
+  RUN_TEST(test_tx_queue_priority_order);
+  RUN_TEST(test_tx_queue_fifo_for_same_id);
+  RUN_TEST(test_tx_queue_extended_ids);
+  RUN_TEST(test_tx_queue_full);
+  RUN_TEST(test_tx_queue_invalid_can_id);
+  RUN_TEST(test_tx_queue_bus_saturation);
+
+  return UNITY_END();
+}
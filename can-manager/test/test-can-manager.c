@@ -9,18 +9,169 @@
 #include "can_manager.h"
 #include "unity.h"
 
-int can_manager_from_id_to_index(int can_id, int msg_id) { return 1; }
+#include <stdio.h>
+#include <time.h>
 
-void setUp(void) {}
+#define TEST_MAX_IDS 1100
+#define TEST_STATES_SIZE 600
+#define TEST_BENCH_IDS 500
+#define TEST_BENCH_FRAMES 200000
+
+CAN_HandleTypeDef hcan;
+int can_id;
+
+uint16_t test_ids[TEST_MAX_IDS];
+size_t test_ids_size;
+
+can_mgr_msg_t states[TEST_STATES_SIZE];
+uint8_t is_new[TEST_STATES_SIZE];
+
+// Linear search, as usually done by the boards
+int can_mgr_from_id_to_index(int can_id, int msg_id) {
+  for (size_t i = 0; i < test_ids_size; ++i)
+    if (test_ids[i] == msg_id)
+      return i;
+  return -1;
+}
+
+// Spread the IDs over the whole standard range
+static void set_ids(size_t count) {
+  for (size_t i = 0; i < count; ++i)
+    test_ids[i] = (i * 0x1F3) % 0x800;
+  test_ids_size = count;
+}
+
+static double elapsed_ns(struct timespec *start, struct timespec *end) {
+  return (end->tv_sec - start->tv_sec) * 1e9 + (end->tv_nsec - start->tv_nsec);
+}
+
+void setUp(void) {
+  set_ids(16);
+  memset(states, 0, sizeof(states));
+  memset(is_new, 0, sizeof(is_new));
+  can_mgr_error_code = 0;
+  can_mgr_config(can_id, NULL, 0, CAN_RX_FIFO0, states, is_new, TEST_STATES_SIZE);
+}
 
 void tearDown(void) {}
 
-void test_unity(void) { TEST_ASSERT(1); }
+void test_id_to_index_known(void) {
+  for (size_t i = 0; i < test_ids_size; ++i)
+    TEST_ASSERT_EQUAL_INT(i, can_mgr_id_to_index(can_id, test_ids[i]));
+}
+
+void test_id_to_index_unknown(void) {
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_id_to_index(can_id, 0x7FF));
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_id_to_index(can_id, 0x800));
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_id_to_index(can_id, -1));
+}
+
+void test_id_to_index_invalid_can_id(void) {
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_id_to_index(CAN_MGR_N_CAN, test_ids[0]));
+}
+
+void test_it_callback_stores_message(void) {
+  can_mgr_msg_t msg = {.id = test_ids[5], .size = 3, .data = {1, 2, 3}};
+  can_mgr_it_callback(&hcan, CAN_RX_FIFO0, &msg);
+  TEST_ASSERT_EQUAL_UINT8(1, is_new[5]);
+  TEST_ASSERT_EQUAL_UINT16(test_ids[5], states[5].id);
+  TEST_ASSERT_EQUAL_UINT8(3, states[5].size);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(msg.data, states[5].data, 3);
+}
+
+void test_it_callback_ignores_unknown(void) {
+  can_mgr_msg_t msg = {.id = 0x7FF, .size = 1, .data = {1}};
+  can_mgr_it_callback(&hcan, CAN_RX_FIFO0, &msg);
+  for (size_t i = 0; i < TEST_STATES_SIZE; ++i)
+    TEST_ASSERT_EQUAL_UINT8(0, is_new[i]);
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_error_code);
+}
+
+void test_it_callback_index_out_of_bound(void) {
+  can_mgr_config(can_id, NULL, 0, CAN_RX_FIFO0, states, is_new, 4);
+  can_mgr_msg_t msg = {.id = test_ids[4], .size = 1, .data = {1}};
+  can_mgr_it_callback(&hcan, CAN_RX_FIFO0, &msg);
+  TEST_ASSERT_NOT_EQUAL(0, can_mgr_error_code);
+  TEST_ASSERT_EQUAL_UINT8(0, is_new[4]);
+}
+
+void test_config_id_table_full(void) {
+  set_ids(TEST_MAX_IDS);
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_config(can_id, NULL, 0, CAN_RX_FIFO0, states, is_new, TEST_STATES_SIZE));
+  TEST_ASSERT_NOT_EQUAL(0, can_mgr_error_code);
+}
+
+void test_config_rebuilds_table(void) {
+  set_ids(32);
+  can_mgr_config(can_id, NULL, 0, CAN_RX_FIFO0, states, is_new, TEST_STATES_SIZE);
+  TEST_ASSERT_EQUAL_INT(31, can_mgr_id_to_index(can_id, test_ids[31]));
+  set_ids(8);
+  can_mgr_config(can_id, NULL, 0, CAN_RX_FIFO0, states, is_new, TEST_STATES_SIZE);
+  TEST_ASSERT_EQUAL_INT(-1, can_mgr_id_to_index(can_id, test_ids[31]));
+}
+
+/**
+ * @brief Compare the lookup table with the linear search of the user-defined
+ * function with 500 distinct IDs, the received IDs are uniformly distributed
+ */
+void test_bench_id_to_index(void) {
+  set_ids(TEST_BENCH_IDS);
+  TEST_ASSERT_EQUAL_INT(0, can_mgr_config(can_id, NULL, 0, CAN_RX_FIFO0, states, is_new, TEST_STATES_SIZE));
+
+  for (size_t i = 0; i < TEST_BENCH_IDS; ++i)
+    TEST_ASSERT_EQUAL_INT(i, can_mgr_id_to_index(can_id, test_ids[i]));
+
+  struct timespec start, end;
+  volatile int sink = 0;
+  uint32_t seed = 1;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (size_t i = 0; i < TEST_BENCH_FRAMES; ++i) {
+    seed = seed * 1103515245U + 12345U;
+    sink += can_mgr_from_id_to_index(can_id, test_ids[(seed >> 16) % TEST_BENCH_IDS]);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double linear_ns = elapsed_ns(&start, &end) / TEST_BENCH_FRAMES;
+
+  seed = 1;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (size_t i = 0; i < TEST_BENCH_FRAMES; ++i) {
+    seed = seed * 1103515245U + 12345U;
+    sink += can_mgr_id_to_index(can_id, test_ids[(seed >> 16) % TEST_BENCH_IDS]);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double table_ns = elapsed_ns(&start, &end) / TEST_BENCH_FRAMES;
+
+  can_mgr_msg_t msg = {.size = 8};
+  seed = 1;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (size_t i = 0; i < TEST_BENCH_FRAMES; ++i) {
+    seed = seed * 1103515245U + 12345U;
+    msg.id = test_ids[(seed >> 16) % TEST_BENCH_IDS];
+    can_mgr_it_callback(&hcan, CAN_RX_FIFO0, &msg);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double callback_ns = elapsed_ns(&start, &end) / TEST_BENCH_FRAMES;
+
+  printf("[BENCH] %d IDs: linear search %.1f ns/frame, lookup table %.1f ns/frame, it callback %.1f ns/frame\n",
+         TEST_BENCH_IDS, linear_ns, table_ns, callback_ns);
+  (void)sink;
+}
 
 int main() {
+  can_id = can_mgr_init(&hcan);
+
   UNITY_BEGIN();
 
-  RUN_TEST(test_unity);
+  RUN_TEST(test_id_to_index_known);
+  RUN_TEST(test_id_to_index_unknown);
+  RUN_TEST(test_id_to_index_invalid_can_id);
+  RUN_TEST(test_it_callback_stores_message);
+  RUN_TEST(test_it_callback_ignores_unknown);
+  RUN_TEST(test_it_callback_index_out_of_bound);
+  RUN_TEST(test_config_id_table_full);
+  RUN_TEST(test_config_rebuilds_table);
+  RUN_TEST(test_bench_id_to_index);
 
-  UNITY_END();
+  return UNITY_END();
 }
@@ -1,5 +1,12 @@
 #include "generic_queue.h"
 
+/*
+    In power of two mode the producer writes only tail and the consumer only
+    head, the element is copied before the index that publishes it
+*/
+#define _GENQ_LOAD(x) __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define _GENQ_STORE(x, v) __atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+
 void GENQ_init(generic_queue_t *q, size_t size, size_t elem_size, uint8_t *queue)
 {
     q->size = size;
@@ -7,17 +14,45 @@ void GENQ_init(generic_queue_t *q, size_t size, size_t elem_size, uint8_t *queue
     q->tail = q->head = q->cnt_elems = 0;
     q->max_elems = q->size/q->queue_elem_size;
     q->queue = queue;
+    q->spsc = false;
+    q->mask = 0;
+}
+bool GENQ_init_pow2(generic_queue_t *q, size_t size, size_t elem_size, uint8_t *queue)
+{
+    size_t max_elems = size/elem_size;
+    if(max_elems == 0 || (max_elems & (max_elems-1)) != 0) return 0;
+
+    GENQ_init(q, size, elem_size, queue);
+    q->spsc = true;
+    q->mask = max_elems-1;
+    return 1;
+}
+size_t GENQ_count(generic_queue_t *q)
+{
+    if(q->spsc) return _GENQ_LOAD(q->tail) - _GENQ_LOAD(q->head);
+    return q->cnt_elems;
 }
 bool GENQ_is_empty(generic_queue_t *q)
 {
+    if(q->spsc) return GENQ_count(q) == 0;
     return q->cnt_elems == 0;
 }
 bool GENQ_is_full(generic_queue_t *q)
 {
+    if(q->spsc) return GENQ_count(q) >= q->max_elems;
     return q->cnt_elems >= q->max_elems;
 }
 bool GENQ_pop(generic_queue_t *q, uint8_t *e)
 {
+    if(q->spsc)
+    {
+        size_t head = q->head;
+        if(head == _GENQ_LOAD(q->tail)) return 0;
+
+        memcpy(e, q->queue+(head & q->mask)*q->queue_elem_size, q->queue_elem_size);
+        _GENQ_STORE(q->head, head+1);
+        return 1;
+    }
     if(GENQ_is_empty(q)) return 0;
     q->cnt_elems--;
 
@@ -28,6 +63,15 @@ bool GENQ_pop(generic_queue_t *q, uint8_t *e)
 }
 bool GENQ_push(generic_queue_t *q, uint8_t *e)
 {
+    if(q->spsc)
+    {
+        size_t tail = q->tail;
+        if(tail - _GENQ_LOAD(q->head) >= q->max_elems) return 0;
+
+        memcpy(q->queue+(tail & q->mask)*q->queue_elem_size, e, q->queue_elem_size);
+        _GENQ_STORE(q->tail, tail+1);
+        return 1;
+    }
     if(GENQ_is_full(q)) return 0;
     q->cnt_elems++;
 
@@ -35,4 +79,144 @@ bool GENQ_push(generic_queue_t *q, uint8_t *e)
     q->tail++;
     q->tail %= q->max_elems;
     return 1;
-}
\ No newline at end of file
+}
+
+size_t GENQ_push_n(generic_queue_t *q, const uint8_t *e, size_t n)
+{
+    size_t tail = q->tail, free_elems, index;
+    if(q->spsc)
+    {
+        free_elems = q->max_elems - (tail - _GENQ_LOAD(q->head));
+        index = tail & q->mask;
+    }
+    else
+    {
+        free_elems = q->max_elems - q->cnt_elems;
+        index = tail;
+    }
+    if(n > free_elems) n = free_elems;
+    if(n == 0) return 0;
+
+    /* Up to the end of the memory, then from the start */
+    size_t first = q->max_elems - index;
+    if(first > n) first = n;
+    memcpy(q->queue+index*q->queue_elem_size, e, first*q->queue_elem_size);
+    memcpy(q->queue, e+first*q->queue_elem_size, (n-first)*q->queue_elem_size);
+
+    if(q->spsc)
+        _GENQ_STORE(q->tail, tail+n);
+    else
+    {
+        q->cnt_elems += n;
+        q->tail = (index+n) % q->max_elems;
+    }
+    return n;
+}
+size_t GENQ_pop_n(generic_queue_t *q, uint8_t *e, size_t n)
+{
+    size_t head = q->head, elems, index;
+    if(q->spsc)
+    {
+        elems = _GENQ_LOAD(q->tail) - head;
+        index = head & q->mask;
+    }
+    else
+    {
+        elems = q->cnt_elems;
+        index = head;
+    }
+    if(n > elems) n = elems;
+    if(n == 0) return 0;
+
+    /* Up to the end of the memory, then from the start */
+    size_t first = q->max_elems - index;
+    if(first > n) first = n;
+    memcpy(e, q->queue+index*q->queue_elem_size, first*q->queue_elem_size);
+    memcpy(e+first*q->queue_elem_size, q->queue, (n-first)*q->queue_elem_size);
+
+    if(q->spsc)
+        _GENQ_STORE(q->head, head+n);
+    else
+    {
+        q->cnt_elems -= n;
+        q->head = (index+n) % q->max_elems;
+    }
+    return n;
+}
+
+/*
+    Records: the length is stored in 2 bytes before the record, a length of
+    _GENQ_RECORD_WRAP (or less than 2 bytes left) means the next record is at
+    the start of the memory
+*/
+#define _GENQ_RECORD_HEADER 2
+#define _GENQ_RECORD_WRAP 0xFFFF
+
+void GENQ_init_records(generic_queue_t *q, size_t size, uint8_t *queue)
+{
+    GENQ_init(q, size, 1, queue);
+}
+bool GENQ_push_record(generic_queue_t *q, const uint8_t *e, uint16_t len)
+{
+    if(len > GENQ_RECORD_MAX_LEN) return 0;
+    size_t need = _GENQ_RECORD_HEADER+len;
+
+    if(q->cnt_elems == 0)
+        q->head = q->tail = 0;
+    if(q->cnt_elems == 0 || q->tail > q->head)
+    {
+        /* Free bytes from tail to the end, then before head */
+        if(q->size-q->tail < need)
+        {
+            if(q->head < need) return 0;
+            if(q->size-q->tail >= _GENQ_RECORD_HEADER)
+            {
+                uint16_t wrap = _GENQ_RECORD_WRAP;
+                memcpy(q->queue+q->tail, &wrap, _GENQ_RECORD_HEADER);
+            }
+            q->tail = 0;
+        }
+    }
+    else if(q->head-q->tail < need) return 0;     //free bytes from tail to head
+
+    memcpy(q->queue+q->tail, &len, _GENQ_RECORD_HEADER);
+    memcpy(q->queue+q->tail+_GENQ_RECORD_HEADER, e, len);
+    q->tail += need;
+    q->cnt_elems++;
+    return 1;
+}
+bool GENQ_peek_record(generic_queue_t *q, uint8_t **e, uint16_t *len)
+{
+    if(GENQ_is_empty(q)) return 0;
+
+    uint16_t l = _GENQ_RECORD_WRAP;
+    if(q->size-q->head >= _GENQ_RECORD_HEADER)
+        memcpy(&l, q->queue+q->head, _GENQ_RECORD_HEADER);
+    if(l == _GENQ_RECORD_WRAP)
+    {
+        q->head = 0;
+        memcpy(&l, q->queue, _GENQ_RECORD_HEADER);
+    }
+
+    *e = q->queue+q->head+_GENQ_RECORD_HEADER;
+    *len = l;
+    return 1;
+}
+void GENQ_release_record(generic_queue_t *q)
+{
+    uint8_t *e;
+    uint16_t len;
+    if(!GENQ_peek_record(q, &e, &len)) return;
+
+    q->head += _GENQ_RECORD_HEADER+len;
+    q->cnt_elems--;
+}
+bool GENQ_pop_record(generic_queue_t *q, uint8_t *e, size_t max_len, uint16_t *len)
+{
+    uint8_t *record;
+    if(!GENQ_peek_record(q, &record, len) || *len > max_len) return 0;
+
+    memcpy(e, record, *len);
+    GENQ_release_record(q);
+    return 1;
+}
@@ -13,19 +13,115 @@ typedef struct{
     size_t max_elems;
     int cnt_elems;
     uint8_t *queue;
+    bool spsc;      // power of two mode: head and tail are free running, the index is masked
+    size_t mask;
 } generic_queue_t;
 
+#define GENQ_RECORD_MAX_LEN 0xFFFE
+
 /**
- * 
+ *
  * @param q pointer to the queue
  * @param size size of the allocated memory in bytes
  * @param elem_size max size of the single element of the queue
  * @param queue pointer to the allocated memory for the queue
 */
 void GENQ_init(generic_queue_t *q, size_t size, size_t elem_size, uint8_t *queue);
+
+/**
+ *
+ * @brief initialize a queue with a power of two capacity: the index is masked
+ *        instead of divided and, with one producer and one consumer (e.g. an
+ *        ISR and the main loop), push and pop need no critical section
+ *
+ * @param q pointer to the queue
+ * @param size size of the allocated memory in bytes
+ * @param elem_size max size of the single element of the queue
+ * @param queue pointer to the allocated memory for the queue
+ *
+ * @returns false if size/elem_size is not a power of two
+*/
+bool GENQ_init_pow2(generic_queue_t *q, size_t size, size_t elem_size, uint8_t *queue);
+
 bool GENQ_is_empty(generic_queue_t *q);
 bool GENQ_is_full(generic_queue_t *q);
+size_t GENQ_count(generic_queue_t *q);
 bool GENQ_pop(generic_queue_t *q, uint8_t *e);
 bool GENQ_push(generic_queue_t*, uint8_t *e);
 
-#endif
\ No newline at end of file
+/**
+ *
+ * @brief initialize a queue of variable length records: each record takes a
+ *        2 bytes length and its bytes, and is never split at the end of the
+ *        memory (the unused bytes at the end are skipped), so it can be read
+ *        in place with GENQ_peek_record
+ *
+ * @param q pointer to the queue
+ * @param size size of the allocated memory in bytes
+ * @param queue pointer to the allocated memory for the queue
+ *
+ * @attention only the record functions, GENQ_is_empty and GENQ_count can be used
+*/
+void GENQ_init_records(generic_queue_t *q, size_t size, uint8_t *queue);
+
+/**
+ *
+ * @param q pointer to the queue
+ * @param e pointer to the record
+ * @param len length of the record in bytes, up to GENQ_RECORD_MAX_LEN
+ *
+ * @returns false if there is no contiguous space for the record
+*/
+bool GENQ_push_record(generic_queue_t *q, const uint8_t *e, uint16_t len);
+
+/**
+ *
+ * @brief get the oldest record without copying it, GENQ_release_record removes it
+ *
+ * @param q pointer to the queue
+ * @param e destination for the pointer to the record inside the queue memory
+ * @param len destination for the length of the record
+ *
+ * @returns false if the queue is empty
+*/
+bool GENQ_peek_record(generic_queue_t *q, uint8_t **e, uint16_t *len);
+void GENQ_release_record(generic_queue_t *q);
+
+/**
+ *
+ * @brief copy the oldest record in e and remove it
+ *
+ * @param q pointer to the queue
+ * @param e pointer to the memory for the record
+ * @param max_len size of the memory pointed by e
+ * @param len destination for the length of the record
+ *
+ * @returns false if the queue is empty or the record is longer than max_len
+*/
+bool GENQ_pop_record(generic_queue_t *q, uint8_t *e, size_t max_len, uint16_t *len);
+
+/**
+ *
+ * @brief push up to n contiguous elements, with at most two copies
+ *
+ * @param q pointer to the queue
+ * @param e pointer to the elements
+ * @param n number of elements
+ *
+ * @returns the number of elements pushed, less than n if the queue is full
+*/
+size_t GENQ_push_n(generic_queue_t *q, const uint8_t *e, size_t n);
+
+/**
+ *
+ * @brief pop up to n elements in e, with at most two copies
+ *
+ * @param q pointer to the queue
+ * @param e pointer to the memory for n elements
+ * @param n number of elements
+ *
+ * @returns the number of elements popped, less than n if the queue is empty
+*/
+size_t GENQ_pop_n(generic_queue_t *q, uint8_t *e, size_t n);
+
+#endif
@@ -0,0 +1,140 @@
+#define _POSIX_C_SOURCE 199309L
+#include "stdio.h"
+#include "time.h"
+#include "../generic_queue.h"
+
+/*
+    Throughput of the queue initialized with GENQ_init (index divided by the
+    number of elements) and GENQ_init_pow2 (index masked), with single and
+    bulk operations, then memory efficiency and throughput of variable length
+    records against slots of the maximum record length
+
+    gcc -O2 -std=c99 bench.c ../generic_queue.c -o bench && ./bench
+*/
+
+#define capacity 64
+#define burst 16
+#define n_elems 20000000
+
+typedef struct{
+    uint16_t id;
+    uint8_t size;
+    uint8_t data[8];
+} can_msg;
+
+uint8_t mem[sizeof(can_msg)*capacity];
+
+double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec*1e9 + ts.tv_nsec;
+}
+
+void bench(const char *name, generic_queue_t *q, bool bulk)
+{
+    can_msg in[burst], out[burst];
+    for(int i=0;i<burst;i++) in[i].id = i;
+    long int sum = 0;
+
+    /* Push a burst of messages then pop them, as from an ISR to the main loop */
+    double start = now_ns();
+    for(int i=0;i<n_elems/burst;i++)
+    {
+        if(bulk)
+        {
+            GENQ_push_n(q, (uint8_t*)in, burst);
+            GENQ_pop_n(q, (uint8_t*)out, burst);
+        }
+        else
+        {
+            for(int j=0;j<burst;j++) GENQ_push(q, (uint8_t*)(in+j));
+            for(int j=0;j<burst;j++) GENQ_pop(q, (uint8_t*)(out+j));
+        }
+        sum += out[burst-1].id;
+    }
+    double elapsed = now_ns() - start;
+
+    printf("[BENCH] %-14s %-6s %6.2f ns/msg %7.1f Mmsg/s (%ld)\n", name, bulk ? "bulk" : "single",
+           elapsed/n_elems, n_elems/elapsed*1e3, sum);
+}
+
+/* Mixed records: CAN frames of 1-8 bytes and log lines of 16-120 bytes */
+#define record_mem 4096
+#define max_record 120
+uint8_t records[record_mem];
+
+uint16_t record_len(void)
+{
+    return rand()%10 < 7 ? rand()%8+1 : rand()%(max_record-15)+16;
+}
+
+void bench_records(bool fixed)
+{
+    generic_queue_t q;
+    uint8_t in[max_record] = {0}, out[max_record];
+    if(fixed) GENQ_init(&q, record_mem, max_record, records);
+    else GENQ_init_records(&q, record_mem, records);
+    srand(42);
+
+    /* Fill with random records until one doesn't fit */
+    size_t stored = 0, payload = 0;
+    while(1)
+    {
+        uint16_t len = record_len();
+        if(fixed ? !GENQ_push(&q, in) : !GENQ_push_record(&q, in, len)) break;
+        stored++;
+        payload += len;
+    }
+
+    /* Keep the queue full, popping the oldest record for each new one */
+    long int sum = 0;
+    double start = now_ns();
+    for(int i=0;i<n_elems/10;i++)
+    {
+        uint16_t len = record_len();
+        if(fixed)
+        {
+            GENQ_pop(&q, out);
+            GENQ_push(&q, in);
+            sum += out[0];
+        }
+        else
+        {
+            uint8_t *view;
+            uint16_t view_len;
+            while(!GENQ_push_record(&q, in, len))
+            {
+                GENQ_peek_record(&q, &view, &view_len);
+                sum += view[0];
+                GENQ_release_record(&q);
+            }
+        }
+    }
+    double elapsed = now_ns() - start;
+
+    printf("[BENCH] %-14s %4zu records in %d bytes, payload %4.1f%% of the memory, %5.1f ns/record (%ld)\n",
+           fixed ? "120 B slots" : "records", stored, record_mem, 100.0*payload/record_mem,
+           elapsed/(n_elems/10), sum);
+}
+
+int main()
+{
+    generic_queue_t q;
+
+    GENQ_init(&q, sizeof(can_msg)*(capacity-4), sizeof(can_msg), mem);
+    bench("GENQ_init 60", &q, false);
+    bench("GENQ_init 60", &q, true);
+
+    GENQ_init(&q, sizeof(can_msg)*capacity, sizeof(can_msg), mem);
+    bench("GENQ_init 64", &q, false);
+    bench("GENQ_init 64", &q, true);
+
+    GENQ_init_pow2(&q, sizeof(can_msg)*capacity, sizeof(can_msg), mem);
+    bench("GENQ_init_pow2", &q, false);
+    bench("GENQ_init_pow2", &q, true);
+
+    bench_records(true);
+    bench_records(false);
+    return 0;
+}
@@ -0,0 +1,120 @@
+#define _POSIX_C_SOURCE 200112L
+#include "stdio.h"
+#include "pthread.h"
+#include "sched.h"
+#include "../generic_queue.h"
+
+/*
+    gcc -std=c99 -pthread test_pow2.c ../generic_queue.c -o test_pow2 && ./test_pow2
+*/
+
+#define tot 32
+#define n_spsc 200000
+
+typedef struct{
+    long int v;
+    char prova[5];
+}  test;
+
+uint8_t mem[sizeof(test)*tot];
+
+int check_fifo(generic_queue_t *q)
+{
+    /* Single and bulk operations across the end of the memory */
+    test v[3*tot], out[3*tot];
+    for(int i=0;i<3*tot;i++)
+    {
+        v[i].v = i%tot;
+        memcpy(v[i].prova, "asdaa", 5);
+    }
+    int pushed = 0, popped = 0;
+    for(int round=0;round<20;round++)
+    {
+        size_t n = (round*7)%tot+1;
+        if(round%2)
+            for(size_t i=0;i<n && GENQ_push(q, (uint8_t*)(v+(pushed%tot))); i++) pushed++;
+        else
+            pushed += GENQ_push_n(q, (uint8_t*)(v+(pushed%tot)), n);
+        if((int)GENQ_count(q) != pushed-popped || pushed-popped > tot) return 1;
+
+        n = (round*5)%tot+1;
+        size_t got = 0;
+        if(round%3)
+            got = GENQ_pop_n(q, (uint8_t*)out, n);
+        else
+            while(got < n && GENQ_pop(q, (uint8_t*)(out+got))) got++;
+        for(size_t i=0;i<got;i++)
+            if(out[i].v != (long int)((popped+i)%tot) || memcmp(out[i].prova, "asdaa", 5)) return 1;
+        popped += got;
+    }
+
+    /* Bulk push stops when full, bulk pop when empty */
+    popped += GENQ_pop_n(q, (uint8_t*)out, 3*tot);
+    if(!GENQ_is_empty(q) || GENQ_push_n(q, (uint8_t*)v, 3*tot) != tot || !GENQ_is_full(q)) return 1;
+    if(GENQ_push(q, (uint8_t*)v) || GENQ_pop_n(q, (uint8_t*)out, 3*tot) != tot) return 1;
+    for(int i=0;i<tot;i++)
+        if(out[i].v != i) return 1;
+    return 0;
+}
+
+generic_queue_t spsc;
+
+void *producer(void *arg)
+{
+    (void)arg;
+    long int next = 0;
+    test batch[8];
+    while(next < n_spsc)
+    {
+        if(next%3)
+        {
+            test t = {next, "asdaa"};
+            if(GENQ_push(&spsc, (uint8_t*)&t)) next++;
+            else sched_yield();
+        }
+        else
+        {
+            size_t n = n_spsc-next < 8 ? n_spsc-next : 8;
+            for(size_t i=0;i<n;i++) batch[i].v = next+i;
+            size_t pushed = GENQ_push_n(&spsc, (uint8_t*)batch, n);
+            if(pushed == 0) sched_yield();
+            next += pushed;
+        }
+    }
+    return NULL;
+}
+
+int main()
+{
+    generic_queue_t q;
+    int errors = 0;
+
+    if(GENQ_init_pow2(&q, sizeof(test)*30, sizeof(test), mem)) errors++;
+    if(!GENQ_init_pow2(&q, sizeof(test)*tot, sizeof(test), mem)) errors++;
+    errors += check_fifo(&q);
+
+    GENQ_init(&q, sizeof(test)*tot, sizeof(test), mem);
+    errors += check_fifo(&q);
+
+    /* One thread pushes, this one pops: the sequence must arrive in order */
+    GENQ_init_pow2(&spsc, sizeof(test)*tot, sizeof(test), mem);
+    pthread_t t;
+    pthread_create(&t, NULL, producer, NULL);
+    long int expected = 0;
+    test batch[8];
+    while(expected < n_spsc)
+    {
+        size_t got = GENQ_pop_n(&spsc, (uint8_t*)batch, 8);
+        if(got == 0) sched_yield();
+        for(size_t i=0;i<got;i++)
+        {
+            if(batch[i].v != expected) errors++;
+            expected = batch[i].v+1;
+        }
+    }
+    pthread_join(t, NULL);
+
+    if(errors == 0) printf("test passed\n");
+    else printf("test not passed\n");
+    return errors != 0;
+}
@@ -0,0 +1,94 @@
+#include "stdio.h"
+#include "../generic_queue.h"
+
+/*
+    gcc -std=c99 test_records.c ../generic_queue.c -o test_records && ./test_records
+*/
+
+#define size 512
+#define max_record 100
+#define n_records 100000
+
+uint8_t mem[size];
+
+/* Reference FIFO of the lengths and first bytes of the queued records */
+uint16_t ref_len[size];
+uint8_t ref_seed[size];
+int ref_head = 0, ref_cnt = 0;
+
+void fill(uint8_t *record, uint16_t len, uint8_t seed)
+{
+    for(uint16_t i=0;i<len;i++) record[i] = seed+i;
+}
+
+int check(uint8_t *record, uint16_t len)
+{
+    uint16_t expected_len = ref_len[ref_head];
+    uint8_t seed = ref_seed[ref_head];
+    ref_head = (ref_head+1)%size;
+    ref_cnt--;
+    if(len != expected_len) return 1;
+    for(uint16_t i=0;i<len;i++)
+        if(record[i] != (uint8_t)(seed+i)) return 1;
+    return 0;
+}
+
+int main()
+{
+    generic_queue_t q;
+    GENQ_init_records(&q, size, mem);
+    int errors = 0;
+    uint8_t record[max_record];
+
+    /* Random lengths, views and copies: every record is read back in place */
+    srand(42);
+    for(int i=0;i<n_records;i++)
+    {
+        if(rand()%2)
+        {
+            uint16_t len = rand()%(max_record+1);
+            uint8_t seed = rand();
+            fill(record, len, seed);
+            if(GENQ_push_record(&q, record, len))
+            {
+                int tail = (ref_head+ref_cnt)%size;
+                ref_len[tail] = len;
+                ref_seed[tail] = seed;
+                ref_cnt++;
+            }
+            else if(ref_cnt == 0) errors++;
+        }
+        else if(rand()%2)
+        {
+            uint8_t *view;
+            uint16_t len;
+            if(GENQ_peek_record(&q, &view, &len))
+            {
+                if(view < mem || view+len > mem+size) errors++;
+                errors += check(view, len);
+                GENQ_release_record(&q);
+            }
+            else if(ref_cnt != 0) errors++;
+        }
+        else
+        {
+            uint16_t len;
+            if(GENQ_pop_record(&q, record, sizeof(record), &len))
+                errors += check(record, len);
+            else if(ref_cnt != 0) errors++;
+        }
+        if((int)GENQ_count(&q) != ref_cnt) errors++;
+    }
+
+    /* A record of the whole memory, then nothing else fits */
+    while(GENQ_pop_record(&q, record, sizeof(record), &(uint16_t){0}));
+    static uint8_t big[size];
+    if(!GENQ_push_record(&q, big, size-2) || GENQ_push_record(&q, big, 0)) errors++;
+    if(GENQ_pop_record(&q, record, sizeof(record), &(uint16_t){0})) errors++;   //longer than max_len
+    GENQ_release_record(&q);
+    if(!GENQ_is_empty(&q) || GENQ_push_record(&q, big, size-1)) errors++;
+
+    if(errors == 0) printf("test passed\n");
+    else printf("test not passed\n");
+    return errors != 0;
+}
@@ -5,21 +5,61 @@
 #include "stdlib.h"
 #include "string.h"
 
+/* End of a list of nodes */
+#define _PQ_NIL UINT16_MAX
+
+/* Round a block size up to the alignment of the nodes */
+#define _PQ_ALIGN(size) (((size) + sizeof(uint32_t) - 1) / sizeof(uint32_t) * sizeof(uint32_t))
+
+/* Payload stored in the slot i */
+#define _PQ_PAYLOAD(queue, i) ((queue)->payloads + (size_t)(i) * (queue)->payload_size)
+
+/* Node of the list engine, its payload is in the slot with the same index */
 typedef struct PQ_NodeTypeDef {
     PQ_PriorityTypeDef priority;
-    void *payload;
-    struct PQ_NodeTypeDef *next;
+    uint16_t next;
 } PQ_NodeTypeDef;
 
+/* Node of the heap engine, the payload stays in its slot while the node moves */
+typedef struct PQ_HeapNodeTypeDef {
+    uint32_t seq;
+    uint32_t key; /* With lazy aging: priority * pops per level + pops before the insert */
+    PQ_PriorityTypeDef priority;
+    uint16_t slot;
+} PQ_HeapNodeTypeDef;
+
+/*
+ * Both engines use a single block: this struct (padded to PQ_ARENA_HEADER_SIZE),
+ * the payloads and then the nodes of the engine
+ */
 typedef struct _PQ_QueueTypeDef {
-    PQ_NodeTypeDef *head;
-    PQ_NodeTypeDef *free_nodes;
+    PQ_EngineTypeDef engine;
+    bool owns_memory;
     size_t payload_size;
+    uint8_t *payloads;
+    size_t count;
+    size_t length;
+
+    /* List engine */
+    PQ_NodeTypeDef *nodes;
+    uint16_t head;
+    uint16_t free_nodes;
+
+    /* Heap engine */
+    PQ_HeapNodeTypeDef *heap;
+    uint16_t *free_slots;
+    uint32_t seq;
+    uint16_t aging; /* Pops per priority level, 0 if lazy aging is disabled */
+    uint32_t pops;
 
     PQ_cmp_priorities_fn prio_cmp_fn;
     PQ_after_pop_fn prio_op_fn;
 } _PQ_QueueTypeDef;
 
+/* PQ_ARENA_SIZE relies on these sizes */
+typedef char _PQ_check_header_size[sizeof(_PQ_QueueTypeDef) <= PQ_ARENA_HEADER_SIZE ? 1 : -1];
+typedef char _PQ_check_node_size[sizeof(PQ_NodeTypeDef) == 4 ? 1 : -1];
+
 
 /* Default compare function in case the user provides NULL */
 int16_t _PQ_cmp_int_impl(PQ_PriorityTypeDef a, PQ_PriorityTypeDef b) {
@@ -27,22 +67,121 @@ int16_t _PQ_cmp_int_impl(PQ_PriorityTypeDef a, PQ_PriorityTypeDef b) {
 }
 PQ_cmp_priorities_fn _PQ_cmp_int = _PQ_cmp_int_impl;
 
-PQ_NodeTypeDef *_PQ_get_free_node(_PQ_QueueTypeDef *queue) {
-    if (queue->free_nodes == NULL)
-        return NULL;
+uint16_t _PQ_get_free_node(_PQ_QueueTypeDef *queue) {
+    if (queue->free_nodes == _PQ_NIL)
+        return _PQ_NIL;
 
     /* Pop a node from the free list and return it */
-    PQ_NodeTypeDef *n = queue->free_nodes;
-    queue->free_nodes = n->next;
-    n->next           = NULL;
+    uint16_t n           = queue->free_nodes;
+    queue->free_nodes    = queue->nodes[n].next;
+    queue->nodes[n].next = _PQ_NIL;
 
     return n;
 }
 
-void _PQ_free_node(_PQ_QueueTypeDef *queue, PQ_NodeTypeDef *node) {
+void _PQ_free_node(_PQ_QueueTypeDef *queue, uint16_t node) {
     /* Add the node to the free list */
-    node->next        = queue->free_nodes;
-    queue->free_nodes = node;
+    queue->nodes[node].next = queue->free_nodes;
+    queue->free_nodes       = node;
+}
+
+/* Initialize the fields shared by the engines, the payloads follow the header */
+void _PQ_setup(_PQ_QueueTypeDef *queue,
+               PQ_EngineTypeDef engine,
+               size_t queue_length,
+               size_t payload_size,
+               PQ_cmp_priorities_fn cmp,
+               PQ_after_pop_fn op) {
+    queue->engine       = engine;
+    queue->payload_size = payload_size;
+    queue->payloads     = (uint8_t *)queue + PQ_ARENA_HEADER_SIZE;
+    queue->count        = 0;
+    queue->length       = queue_length;
+    queue->head = queue->free_nodes = _PQ_NIL;
+    queue->seq          = 0;
+    queue->aging        = 0;
+    queue->pops         = 0;
+
+    queue->prio_cmp_fn = cmp != NULL ? cmp : _PQ_cmp_int;
+    queue->prio_op_fn  = op;
+}
+
+/* True if node a has to be popped before node b, ties are broken by insertion order */
+bool _PQ_heap_before(_PQ_QueueTypeDef *queue, PQ_HeapNodeTypeDef *a, PQ_HeapNodeTypeDef *b) {
+    int32_t cmp;
+    if (queue->aging > 0)
+        cmp = (int32_t)(b->key - a->key);
+    else
+        cmp = queue->prio_cmp_fn(a->priority, b->priority);
+    return cmp > 0 || (cmp == 0 && (int32_t)(a->seq - b->seq) < 0);
+}
+
+/* Move the hole at index i up until node can be placed in it */
+void _PQ_heap_sift_up(_PQ_QueueTypeDef *queue, size_t i, PQ_HeapNodeTypeDef node) {
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!_PQ_heap_before(queue, &node, &queue->heap[parent]))
+            break;
+        queue->heap[i] = queue->heap[parent];
+        i              = parent;
+    }
+    queue->heap[i] = node;
+}
+
+/* Move the hole at index i down until node can be placed in it */
+void _PQ_heap_sift_down(_PQ_QueueTypeDef *queue, size_t i, PQ_HeapNodeTypeDef node) {
+    size_t child;
+    while ((child = 2 * i + 1) < queue->count) {
+        if (child + 1 < queue->count && _PQ_heap_before(queue, &queue->heap[child + 1], &queue->heap[child]))
+            child++;
+        if (!_PQ_heap_before(queue, &queue->heap[child], &node))
+            break;
+        queue->heap[i] = queue->heap[child];
+        i              = child;
+    }
+    queue->heap[i] = node;
+}
+
+bool _PQ_heap_insert(_PQ_QueueTypeDef *queue, PQ_PriorityTypeDef priority, void *payload) {
+    if (queue->count == queue->length)
+        return false;
+
+    /* Take a free slot for the payload from the top of the stack */
+    uint16_t slot = queue->free_slots[queue->length - queue->count - 1];
+    memcpy(_PQ_PAYLOAD(queue, slot), payload, queue->payload_size);
+
+    PQ_HeapNodeTypeDef node = {.seq = queue->seq++, .priority = priority, .slot = slot};
+    if (queue->aging > 0)
+        node.key = (uint32_t)priority * queue->aging + queue->pops;
+    _PQ_heap_sift_up(queue, queue->count++, node);
+    return true;
+}
+
+void _PQ_heap_pop(_PQ_QueueTypeDef *queue, void *payload) {
+    uint16_t slot = queue->heap[0].slot;
+    if (payload != NULL)
+        memcpy(payload, _PQ_PAYLOAD(queue, slot), queue->payload_size);
+
+    /* Give the slot back and fill the root with the last node */
+    queue->count--;
+    queue->free_slots[queue->length - queue->count - 1] = slot;
+    if (queue->count > 0)
+        _PQ_heap_sift_down(queue, 0, queue->heap[queue->count]);
+
+    /* With lazy aging the keys keep their order, only the count of pops advances */
+    if (queue->aging > 0) {
+        queue->pops++;
+        return;
+    }
+
+    /* Apply the post-pop operation to all nodes and rebuild the heap, since
+     * the operation is not required to keep the order */
+    if (queue->prio_op_fn != NULL) {
+        for (size_t i = 0; i < queue->count; i++)
+            queue->prio_op_fn(&queue->heap[i].priority);
+        for (size_t i = queue->count / 2; i-- > 0;)
+            _PQ_heap_sift_down(queue, i, queue->heap[i]);
+    }
 }
 
 /**
@@ -57,23 +196,100 @@ void _PQ_free_node(_PQ_QueueTypeDef *queue, PQ_NodeTypeDef *node) {
  * */
 void PQ_init(
     _PQ_QueueTypeDef **queue, size_t queue_length, size_t payload_size, PQ_cmp_priorities_fn cmp, PQ_after_pop_fn op) {
-    //assert(cmp != NULL); //commented because nullish values are handled at line 66
-    /* Initialize pointers to NULL */
-    (*queue)       = malloc(sizeof(_PQ_QueueTypeDef));
-    (*queue)->head = (*queue)->free_nodes = NULL;
-
-    (*queue)->payload_size = payload_size;
-    (*queue)->prio_cmp_fn  = cmp != NULL ? cmp : _PQ_cmp_int;
-    (*queue)->prio_op_fn   = op;
-
-    /* Pre-allocate all nodes */
-    PQ_NodeTypeDef *cursor;
-    for (size_t i = 0; i < queue_length; i++) {
-        cursor               = (PQ_NodeTypeDef *)malloc(sizeof(PQ_NodeTypeDef));
-        cursor->payload      = malloc((*queue)->payload_size);
-        cursor->next         = (*queue)->free_nodes;
-        (*queue)->free_nodes = cursor;
-    }
+    PQ_init_arena(queue, NULL, queue_length, payload_size, cmp, op);
+}
+
+/**
+ * @brief Initializes a new priority queue in a single block of memory that
+ *        holds the queue, every node and every payload
+ * @param queue The queue to initialize
+ * @param arena Block of at least PQ_ARENA_SIZE(queue_length, payload_size)
+ *              bytes aligned as a pointer, or NULL to allocate it with a
+ *              single malloc. A caller-provided block is not freed by PQ_destroy
+ * @param queue_length The maximun number of elements in the queue (less than 65535)
+ * @param payload_size The size of one element
+ * @param cmp Function to compare priorities. It should return >0 if the 
+ *            priority of the first element is higher than the second
+ * @param op  Function to apply to every element's priority after each pop 
+ *            (ex: decrement to prevent starvation)
+ * */
+void PQ_init_arena(_PQ_QueueTypeDef **queue,
+                   void *arena,
+                   size_t queue_length,
+                   size_t payload_size,
+                   PQ_cmp_priorities_fn cmp,
+                   PQ_after_pop_fn op) {
+    assert(queue_length < _PQ_NIL);
+
+    bool owns_memory = arena == NULL;
+    if (owns_memory)
+        arena = malloc(PQ_ARENA_SIZE(queue_length, payload_size));
+
+    (*queue) = arena;
+    _PQ_setup(*queue, PQ_ENGINE_LIST, queue_length, payload_size, cmp, op);
+    (*queue)->owns_memory = owns_memory;
+    (*queue)->nodes       = (PQ_NodeTypeDef *)((*queue)->payloads + _PQ_ALIGN(queue_length * payload_size));
+
+    /* Chain all nodes in the free list */
+    for (size_t i = 0; i < queue_length; i++)
+        (*queue)->nodes[i].next = i + 1 < queue_length ? i + 1 : _PQ_NIL;
+    (*queue)->free_nodes = queue_length > 0 ? 0 : _PQ_NIL;
+}
+
+/**
+ * @brief Initializes a new priority queue backed by a binary heap. Payloads,
+ *        heap nodes and free slots are allocated in a single block; payloads
+ *        never move, only the small heap nodes are swapped
+ * @param queue The queue to initialize
+ * @param queue_length The maximun number of elements in the queue (at most 65536)
+ * @param payload_size The size of one element
+ * @param cmp Function to compare priorities. It should return >0 if the 
+ *            priority of the first element is higher than the second
+ * @param op  Function to apply to every element's priority after each pop 
+ *            (ex: decrement to prevent starvation)
+ * */
+void PQ_init_heap(
+    _PQ_QueueTypeDef **queue, size_t queue_length, size_t payload_size, PQ_cmp_priorities_fn cmp, PQ_after_pop_fn op) {
+    assert(queue_length <= (size_t)UINT16_MAX + 1);
+
+    size_t payloads_size = _PQ_ALIGN(queue_length * payload_size);
+    size_t heap_size     = queue_length * sizeof(PQ_HeapNodeTypeDef);
+    (*queue)             = malloc(PQ_ARENA_HEADER_SIZE + payloads_size + heap_size + queue_length * sizeof(uint16_t));
+
+    _PQ_setup(*queue, PQ_ENGINE_HEAP, queue_length, payload_size, cmp, op);
+    (*queue)->owns_memory = true;
+    (*queue)->heap        = (PQ_HeapNodeTypeDef *)((*queue)->payloads + payloads_size);
+    (*queue)->free_slots  = (uint16_t *)((*queue)->heap + queue_length);
+
+    /* The top of the stack of free slots is at the end */
+    for (size_t i = 0; i < queue_length; i++)
+        (*queue)->free_slots[i] = queue_length - 1 - i;
+}
+
+/**
+ * @brief Enable lazy aging on an empty queue of the heap engine: the priority of
+ *        every element improves by one level every pops_per_level pops, as if
+ *        the post-pop function decremented it, without touching the queued
+ *        elements. Each element is ordered by priority * pops_per_level plus
+ *        the number of pops before its insert, so the heap stays valid and
+ *        pop is O(log n)
+ * @attention With lazy aging the lowest priority value is the highest priority
+ *            (as for CAN IDs) and the compare and post-pop functions are not
+ *            used. Priority * pops_per_level plus the number of pops an element
+ *            waits must stay below 2^31
+ * @param queue The queue
+ * @param pops_per_level Pops that make an element gain one priority level,
+ *                       0 to disable lazy aging
+ *
+ * @return True if the aging was set, false if the queue is not an empty heap
+ * */
+bool PQ_set_aging(_PQ_QueueTypeDef *queue, uint16_t pops_per_level) {
+    if (queue->engine != PQ_ENGINE_HEAP || !PQ_is_empty(queue))
+        return false;
+
+    queue->aging = pops_per_level;
+    queue->pops  = 0;
+    return true;
 }
 
 /**
@@ -81,27 +297,10 @@ void PQ_init(
  * @param q The queue to free
  * */
 void PQ_destroy(_PQ_QueueTypeDef **q) {
-    _PQ_QueueTypeDef *queue = *q;
-    PQ_NodeTypeDef *cursor;
-
-    /* De-allocate all used nodes */
-    while (queue->head != NULL) {
-        cursor      = queue->head;
-        queue->head = queue->head->next;
-        //free(cursor->payload);
-        free(cursor);
-    }
-
-    /* De-allocate all nodes in the free list */
-    while (queue->free_nodes != NULL) {
-        cursor            = queue->free_nodes;
-        queue->free_nodes = queue->free_nodes->next;
-        //free(cursor->payload);
-        free(cursor);
-    }
-
-    /* Free the main struct */
-    free(*q);
+    /* Nodes and payloads are in the same block of the queue */
+    if ((*q)->owns_memory)
+        free(*q);
+    *q = NULL;
 }
 
 /**
@@ -110,7 +309,7 @@ void PQ_destroy(_PQ_QueueTypeDef **q) {
  * @retval True if empty, false otherwise
  * */
 bool PQ_is_empty(_PQ_QueueTypeDef *queue) {
-    return queue->head == NULL;
+    return queue->count == 0;
 }
 
 /**
@@ -124,30 +323,35 @@ bool PQ_is_empty(_PQ_QueueTypeDef *queue) {
  *         out of MEM)
  * */
 bool PQ_insert(_PQ_QueueTypeDef *queue, PQ_PriorityTypeDef priority, void *payload) {
-    PQ_NodeTypeDef *new_node = _PQ_get_free_node(queue);
+    if (queue->engine == PQ_ENGINE_HEAP)
+        return _PQ_heap_insert(queue, priority, payload);
+
+    uint16_t new_node = _PQ_get_free_node(queue);
 
     // No free nodes available, exit with error
-    if (new_node == NULL)
+    if (new_node == _PQ_NIL)
         return false;
 
     /* Populate the new node */
-    new_node->priority = priority;
-    memcpy(&(new_node->payload), payload, queue->payload_size);
+    PQ_NodeTypeDef *nodes    = queue->nodes;
+    nodes[new_node].priority = priority;
+    memcpy(_PQ_PAYLOAD(queue, new_node), payload, queue->payload_size);
 
-    if (queue->head == NULL || queue->prio_cmp_fn(new_node->priority, queue->head->priority) > 0) {
+    if (queue->head == _PQ_NIL || queue->prio_cmp_fn(priority, nodes[queue->head].priority) > 0) {
         /* Insert the new node in front of the list */
-        new_node->next = queue->head;
-        queue->head    = new_node;
+        nodes[new_node].next = queue->head;
+        queue->head          = new_node;
     } else {
         /* Find the proper position */
-        PQ_NodeTypeDef *cursor = queue->head;
-        while (cursor->next != NULL && queue->prio_cmp_fn(cursor->next->priority, new_node->priority) >= 0)
-            cursor = cursor->next;
+        uint16_t cursor = queue->head;
+        while (nodes[cursor].next != _PQ_NIL && queue->prio_cmp_fn(nodes[nodes[cursor].next].priority, priority) >= 0)
+            cursor = nodes[cursor].next;
 
         /* Insert the element after the cursor */
-        new_node->next = cursor->next;
-        cursor->next   = new_node;
+        nodes[new_node].next = nodes[cursor].next;
+        nodes[cursor].next   = new_node;
     }
+    queue->count++;
     return true;
 }
 
@@ -158,7 +362,11 @@ bool PQ_insert(_PQ_QueueTypeDef *queue, PQ_PriorityTypeDef priority, void *paylo
  * @retval The item with the highest priority
  * */
 void *PQ_peek_highest(_PQ_QueueTypeDef *queue) {
-    return PQ_is_empty(queue) ? NULL : &(queue->head->payload);
+    if (PQ_is_empty(queue))
+        return NULL;
+    if (queue->engine == PQ_ENGINE_HEAP)
+        return _PQ_PAYLOAD(queue, queue->heap[0].slot);
+    return _PQ_PAYLOAD(queue, queue->head);
 }
 
 /**
@@ -171,21 +379,27 @@ void *PQ_peek_highest(_PQ_QueueTypeDef *queue) {
 void PQ_pop_highest(_PQ_QueueTypeDef *queue, void *payload) {
     if (PQ_is_empty(queue))
         return;
-    
+
+    if (queue->engine == PQ_ENGINE_HEAP) {
+        _PQ_heap_pop(queue, payload);
+        return;
+    }
+
     if (payload != NULL)
-        memcpy(payload, &queue->head->payload, queue->payload_size);
+        memcpy(payload, _PQ_PAYLOAD(queue, queue->head), queue->payload_size);
 
     /* Pop and free the head */
-    PQ_NodeTypeDef *to_free = queue->head;
-    queue->head             = queue->head->next;
+    uint16_t to_free = queue->head;
+    queue->head      = queue->nodes[to_free].next;
     _PQ_free_node(queue, to_free);
+    queue->count--;
 
     /* Apply the post-pop operation to all nodes */
     if (queue->prio_op_fn != NULL) {
-        PQ_NodeTypeDef *cursor = queue->head;
-        while (cursor != NULL) {
-            queue->prio_op_fn(&cursor->priority);
-            cursor = cursor->next;
+        uint16_t cursor = queue->head;
+        while (cursor != _PQ_NIL) {
+            queue->prio_op_fn(&queue->nodes[cursor].priority);
+            cursor = queue->nodes[cursor].next;
         }
     }
 }
@@ -11,6 +11,14 @@
  * function are needed: the former is used to determine which element has higher
  * priority among two, while the latter can be used to, for instance, decrement each
  * element's priority by one unit at each pop operation to avoid starvation effects.
+ *
+ * Two engines are available behind the same API: PQ_init creates a sorted linked
+ * list (O(n) insert, O(1) pop), PQ_init_heap a binary heap (O(log n) insert and
+ * pop). Both keep the queue, the nodes and the payloads in a single block of
+ * memory, PQ_init_arena places the list in a block provided by the caller.
+ * Both pop elements with the same priority in insertion order. PQ_set_aging
+ * replaces the post-pop function of the heap with lazy aging, so that pops stay
+ * O(log n).
  * */
 
 #ifndef PRIO_Q_H
@@ -21,12 +29,23 @@
 #include "stdint.h"
 
 typedef uint16_t PQ_PriorityTypeDef;
+typedef enum { PQ_ENGINE_LIST, PQ_ENGINE_HEAP } PQ_EngineTypeDef;
+
+/* Bytes taken by the queue at the start of its block */
+#define PQ_ARENA_HEADER_SIZE 128
+/* Bytes of the block needed by PQ_init_arena */
+#define PQ_ARENA_SIZE(queue_length, payload_size) \
+    (PQ_ARENA_HEADER_SIZE + ((queue_length) * (payload_size) + 3) / 4 * 4 + (queue_length) * 4)
+
 typedef struct _PQ_QueueTypeDef *PQ_QueueTypeDef;
 
 typedef int16_t (*PQ_cmp_priorities_fn)(PQ_PriorityTypeDef, PQ_PriorityTypeDef);
 typedef void (*PQ_after_pop_fn)(PQ_PriorityTypeDef *);
 
 void PQ_init(PQ_QueueTypeDef *, size_t, size_t, PQ_cmp_priorities_fn, PQ_after_pop_fn);
+void PQ_init_arena(PQ_QueueTypeDef *, void *, size_t, size_t, PQ_cmp_priorities_fn, PQ_after_pop_fn);
+void PQ_init_heap(PQ_QueueTypeDef *, size_t, size_t, PQ_cmp_priorities_fn, PQ_after_pop_fn);
+bool PQ_set_aging(PQ_QueueTypeDef, uint16_t);
 void PQ_destroy(PQ_QueueTypeDef *);
 bool PQ_is_empty(PQ_QueueTypeDef);
 bool PQ_insert(PQ_QueueTypeDef queue, PQ_PriorityTypeDef priority, void *payload);
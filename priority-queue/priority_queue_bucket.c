@@ -0,0 +1,141 @@
+/**
+ * @file      priority_queue_bucket.c
+ * @author    Giacomo Mazzucchi [giacomo.mazzucchi@protonmail.com]
+ * @date      2026-10-18
+ * @updated
+ * @ingroup
+ * @prefix    PQB
+ *
+ * @brief     Priority queue with one FIFO per priority level and a bitmap of
+ *            the non-empty levels
+ *
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "priority_queue_bucket.h"
+
+#include "string.h"
+
+/* Private define ------------------------------------------------------------*/
+
+/* End of a list of slots */
+#define _PQB_NIL UINT16_MAX
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Count leading zeros of a non-zero word, a single instruction on Cortex-M3 and above */
+#ifndef PQB_CLZ
+#define PQB_CLZ(x) ((uint32_t)__builtin_clz(x))
+#endif
+
+#define _PQB_BIT(i) (0x80000000U >> ((i) % 32))
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Highest non-empty priority level
+ * @attention The queue must not be empty
+ */
+static uint16_t _PQB_highest(PQB *pq) {
+    uint32_t word = PQB_CLZ(pq->summary);
+    return word * 32 + PQB_CLZ(pq->bitmap[word]);
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+bool PQB_init(PQB *pq, uint16_t levels, uint16_t max_elem, size_t elem_size, void *mem) {
+    if (pq == NULL || mem == NULL || levels == 0 || levels > PQB_MAX_LEVELS || max_elem == _PQB_NIL)
+        return false;
+
+    pq->levels    = levels;
+    pq->max_elem  = max_elem;
+    pq->elem_size = elem_size;
+    pq->elem_cnt  = 0;
+    pq->summary   = 0;
+
+    /* Elements, bitmap, next slots, heads and tails in the same block */
+    uint16_t words = (levels + 31) / 32;
+    pq->queue      = mem;
+    pq->bitmap     = (uint32_t *)(pq->queue + ((size_t)max_elem * elem_size + 3) / 4 * 4);
+    pq->next       = (uint16_t *)(pq->bitmap + words);
+    pq->head       = pq->next + max_elem;
+    pq->tail       = pq->head + levels;
+
+    memset(pq->bitmap, 0, words * sizeof(uint32_t));
+
+    /* Chain all slots in the free list */
+    for (uint16_t i = 0; i < max_elem; i++)
+        pq->next[i] = i + 1 < max_elem ? i + 1 : _PQB_NIL;
+    pq->free_slot = max_elem > 0 ? 0 : _PQB_NIL;
+
+    return true;
+}
+
+bool PQB_is_full(PQB *pq) { return pq->elem_cnt == pq->max_elem; }
+bool PQB_is_empty(PQB *pq) { return pq->elem_cnt == 0; }
+
+bool PQB_insert(PQB *pq, PQB_PriorityTypeDef priority, const void *element) {
+    if (priority >= pq->levels || pq->free_slot == _PQB_NIL)
+        return false;
+
+    /* Take a free slot */
+    uint16_t slot  = pq->free_slot;
+    pq->free_slot  = pq->next[slot];
+    pq->next[slot] = _PQB_NIL;
+    memcpy(pq->queue + slot * pq->elem_size, element, pq->elem_size);
+
+    /* Append it to the FIFO of the level */
+    uint16_t word = priority / 32;
+    if (pq->bitmap[word] & _PQB_BIT(priority)) {
+        pq->next[pq->tail[priority]] = slot;
+    } else {
+        pq->head[priority] = slot;
+        pq->bitmap[word] |= _PQB_BIT(priority);
+        pq->summary |= _PQB_BIT(word);
+    }
+    pq->tail[priority] = slot;
+    pq->elem_cnt++;
+
+    return true;
+}
+
+bool PQB_top(PQB *pq, PQB_PriorityTypeDef *priority, void *element) {
+    if (PQB_is_empty(pq))
+        return false;
+
+    uint16_t level = _PQB_highest(pq);
+    if (priority != NULL)
+        *priority = level;
+    if (element != NULL)
+        memcpy(element, pq->queue + pq->head[level] * pq->elem_size, pq->elem_size);
+
+    return true;
+}
+
+bool PQB_pop(PQB *pq, PQB_PriorityTypeDef *priority, void *element) {
+    if (PQB_is_empty(pq))
+        return false;
+
+    uint16_t level = _PQB_highest(pq);
+    uint16_t slot  = pq->head[level];
+    if (priority != NULL)
+        *priority = level;
+    if (element != NULL)
+        memcpy(element, pq->queue + slot * pq->elem_size, pq->elem_size);
+
+    /* Remove the slot from the FIFO, clear the bits of the level if it is empty */
+    pq->head[level] = pq->next[slot];
+    if (pq->head[level] == _PQB_NIL) {
+        uint16_t word = level / 32;
+        pq->bitmap[word] &= ~_PQB_BIT(level);
+        if (pq->bitmap[word] == 0)
+            pq->summary &= ~_PQB_BIT(word);
+    }
+
+    /* Give the slot back */
+    pq->next[slot] = pq->free_slot;
+    pq->free_slot  = slot;
+    pq->elem_cnt--;
+
+    return true;
+}
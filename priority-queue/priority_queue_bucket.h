@@ -0,0 +1,127 @@
+/**
+ * @file      priority_queue_bucket.h
+ * @author    Giacomo Mazzucchi [giacomo.mazzucchi@protonmail.com]
+ * @date      2026-10-18
+ * @updated
+ * @ingroup
+ * @prefix    PQB
+ *
+ * @brief     Priority queue for small ranges of priorities: one FIFO per
+ *            priority level and a bitmap of the non-empty levels
+ *
+ * @details   Insert and pop are O(1): the highest non-empty level is found
+ *            with two count-leading-zeros instructions (one on the summary
+ *            word, one on the bitmap word). Elements with the same priority
+ *            are popped in insertion order. Level 0 is the highest priority,
+ *            as for CAN IDs. All the memory is provided by the caller.
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef PRIORITY_QUEUE_BUCKET_H
+#define PRIORITY_QUEUE_BUCKET_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "stdbool.h"
+#include "stddef.h"
+#include "stdint.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Maximum number of priority levels (32 bitmap words of 32 levels) */
+#define PQB_MAX_LEVELS 1024
+
+/* Exported macros -----------------------------------------------------------*/
+
+/**
+ * @brief Bytes of the memory needed by a queue
+ *
+ * @param levels    Number of priority levels
+ * @param max_elem  Maximum number of elements in the queue
+ * @param elem_size Size of one element
+ */
+#define PQB_MEM_SIZE(levels, max_elem, elem_size)                            \
+    (((max_elem) * (elem_size) + 3) / 4 * 4 + ((levels) + 31) / 32 * 4 + \
+     ((max_elem) + 2 * (levels)) * sizeof(uint16_t))
+
+/* Exported types ------------------------------------------------------------*/
+typedef uint16_t PQB_PriorityTypeDef;
+
+typedef struct {
+    uint16_t levels;    /*!< Number of priority levels */
+    uint16_t max_elem;  /*!< Maximum number of elements */
+    uint16_t elem_cnt;  /*!< Number of elements in the queue */
+    uint16_t free_slot; /*!< First slot of the list of free slots */
+    size_t elem_size;   /*!< Size of one element */
+    uint32_t summary;   /*!< Bit 31-w set if the bitmap word w is not zero */
+    uint32_t *bitmap;   /*!< Bit 31-(l%32) of word l/32 set if the level l is not empty */
+    uint8_t *queue;     /*!< Elements, by slot */
+    uint16_t *next;     /*!< Next slot in the same level or in the free list */
+    uint16_t *head;     /*!< First slot of each level */
+    uint16_t *tail;     /*!< Last slot of each level */
+} PQB;
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+ * @brief Initialize a queue
+ *
+ * @param pq        Pointer to the queue to initialize
+ * @param levels    Number of priority levels (1 to PQB_MAX_LEVELS)
+ * @param max_elem  Maximum number of elements (less than 65535)
+ * @param elem_size Size of one element
+ * @param mem       Memory of at least PQB_MEM_SIZE(levels, max_elem, elem_size)
+ *                  bytes, aligned to 4 bytes
+ *
+ * @returns true if initialized successfully, false if the parameters are not valid
+ */
+bool PQB_init(PQB *pq, uint16_t levels, uint16_t max_elem, size_t elem_size, void *mem);
+
+/**
+ * @brief Insert an element at the end of the FIFO of its priority, O(1)
+ *
+ * @param pq       Pointer to the queue
+ * @param priority Priority level of the element, 0 is the highest
+ * @param element  Pointer to the element to insert (it will be copied)
+ *
+ * @returns true if inserted successfully, false if the queue is full or the
+ *          priority is out of range
+ */
+bool PQB_insert(PQB *pq, PQB_PriorityTypeDef priority, const void *element);
+
+/**
+ * @brief Get the oldest element with the highest priority without removing it, O(1)
+ *
+ * @param pq       Pointer to the queue
+ * @param priority Destination pointer for the priority (can be NULL)
+ * @param element  Destination pointer for the element (can be NULL)
+ *
+ * @returns true if the queue is not empty, false otherwise
+ */
+bool PQB_top(PQB *pq, PQB_PriorityTypeDef *priority, void *element);
+
+/**
+ * @brief Get the oldest element with the highest priority and remove it, O(1)
+ *
+ * @param pq       Pointer to the queue
+ * @param priority Destination pointer for the priority (can be NULL)
+ * @param element  Destination pointer for the element (can be NULL)
+ *
+ * @returns true if popped successfully, false if the queue is empty
+ */
+bool PQB_pop(PQB *pq, PQB_PriorityTypeDef *priority, void *element);
+
+/**
+ * @param pq pointer to the queue
+ *
+ * @returns true if the queue is full, false otherwise
+ */
+bool PQB_is_full(PQB *pq);
+
+/**
+ * @param pq pointer to the queue
+ *
+ * @returns true if the queue is empty, false otherwise
+ */
+bool PQB_is_empty(PQB *pq);
+
+#endif
@@ -26,6 +26,12 @@ typedef struct ypeDef {
     void *payload;                 /*!< Node payload, this value is a memcopy */
 } _PQFI_NodeTypeDef;
 
+typedef struct {
+    PQFI_PriorityTypeDef priority; /*!< Node priority */
+    uint16_t order;                /*!< Position in the run, keeps the insertion order of equal priorities */
+    void *payload;                 /*!< Node payload */
+} _PQFI_RunNodeTypeDef;
+
 typedef struct _PQFI_HandleTypeDef {
     _PQFI_NodeTypeDef *buffer;           /*!< Circular buffer used as priority queue list */
     uint16_t pq_length;                  /*!< Priority queue length */
@@ -37,6 +43,9 @@ typedef struct _PQFI_HandleTypeDef {
     size_t payload_size;                 /*!< Size of a payload, used for allocation purposes */
     PQFI_CmpPrtyFnTypeDef cmp_prty_fn;   /*!< Priority compare function, provided by the user */
     PQFI_AntiStrvFnTypeDef anti_strv_fn; /*!< Priority queue anti starvation function, at each pop */
+    PQFI_SortModeTypeDef sort_mode;      /*!< How pop orders the nodes inserted since the last pop */
+    _PQFI_RunNodeTypeDef *run;           /*!< Merge mode: copy of the nodes inserted since the last pop */
+    uint16_t sorted_cnt;                 /*!< Merge mode: number of ordered nodes from head */
 
 } _PQFI_HandleTypeDef;
 
@@ -64,6 +73,17 @@ static void _advance_cursor(_PQFI_HandleTypeDef *hpqfi, uint16_t *cursor);
  */
 static void _pq_sort(_PQFI_HandleTypeDef *hpqfi, uint16_t head, uint16_t tail);
 
+/**
+ * @brief   Sort the run of nodes inserted since the last pop and merge it with
+ *          the ordered nodes from head, O(k log k + n) for k new nodes
+ * @details Like _pq_sort it works on a snapshot of the queue from head to tail
+ *
+ * @param   hpqfi _PQFI_HandleTypeDef pointer
+ * @param   head  Head index at the time of sorting
+ * @param   tail  Tail index at the time of sorting
+ */
+static void _pq_merge(_PQFI_HandleTypeDef *hpqfi, uint16_t head, uint16_t tail);
+
 /**
  * @brief Apply anti starvation to nodes in the priority queue
  * 
@@ -106,6 +126,10 @@ PQFI_HandleTypeDef PQFI_init(
     hpqfi->cmp_prty_fn  = cmp_fn;
     hpqfi->anti_strv_fn = astrv_fn;
 
+    hpqfi->sort_mode  = PQFI_SORT_INSERTION;
+    hpqfi->run        = NULL;
+    hpqfi->sorted_cnt = 0;
+
     /* Pre-allocate all nodes */
     for (size_t i = 0; i < queue_length; i++) {
         hpqfi->buffer[i].payload = calloc(1, hpqfi->payload_size);
@@ -121,11 +145,30 @@ void PQFI_destroy(_PQFI_HandleTypeDef *hpqfi) {
 
     /* Deallocate priority queue/buffer */
     free(hpqfi->buffer);
+    free(hpqfi->run);
 
     /* Free the main struct */
     free(hpqfi);
 }
 
+bool PQFI_set_sort_mode(_PQFI_HandleTypeDef *hpqfi, PQFI_SortModeTypeDef sort_mode) {
+    assert(hpqfi != NULL);
+
+    if (!PQFI_is_empty(hpqfi))
+        return false;
+
+    if (sort_mode == PQFI_SORT_MERGE && hpqfi->run == NULL) {
+        hpqfi->run = (_PQFI_RunNodeTypeDef *)malloc(hpqfi->pq_length * sizeof(_PQFI_RunNodeTypeDef));
+        if (hpqfi->run == NULL)
+            return false;
+    }
+    hpqfi->sort_mode  = sort_mode;
+    hpqfi->sort_pivot = hpqfi->head;
+    hpqfi->sorted_cnt = 0;
+
+    return true;
+}
+
 bool PQFI_is_empty(_PQFI_HandleTypeDef *hpqfi) {
     assert(hpqfi != NULL);
 
@@ -169,7 +212,12 @@ bool PQFI_pop(_PQFI_HandleTypeDef *hpqfi, void *payload) {
     _apply_anti_starvation(hpqfi, head_cpy, tail_cpy);
 
     /* Redorder hpqfi before pop */
-    _pq_sort(hpqfi, head_cpy, tail_cpy);
+    if (hpqfi->sort_mode == PQFI_SORT_MERGE) {
+        _pq_merge(hpqfi, head_cpy, tail_cpy);
+        hpqfi->sorted_cnt--;
+    } else {
+        _pq_sort(hpqfi, head_cpy, tail_cpy);
+    }
 
     memcpy(payload, hpqfi->buffer[hpqfi->head].payload, hpqfi->payload_size);
     _advance_cursor(hpqfi, &(hpqfi->head));
@@ -179,19 +227,26 @@ bool PQFI_pop(_PQFI_HandleTypeDef *hpqfi, void *payload) {
 
 /* Private functions ---------------------------------------------------------*/
 
+/* Number of nodes from head to tail, the queue is full if they are the same index */
+static uint16_t _pq_count(_PQFI_HandleTypeDef *hpqfi, uint16_t head, uint16_t tail) {
+    return head == tail ? hpqfi->pq_length : (tail + hpqfi->pq_length - head) % hpqfi->pq_length;
+}
+
 static void _pq_sort(_PQFI_HandleTypeDef *hpqfi, uint16_t head, uint16_t tail) {
-    while (hpqfi->sort_pivot != tail) {
+    /* The sort pivot is the last ordered node, count them instead of comparing
+     * the pivot with the tail that is also the head when the queue is full */
+    uint16_t count  = _pq_count(hpqfi, head, tail);
+    uint16_t sorted = (hpqfi->sort_pivot + hpqfi->pq_length - head) % hpqfi->pq_length + 1;
+
+    for (; sorted < count; sorted++) {
         /* First non in order element */
         uint16_t node_not_sorted = hpqfi->sort_pivot;
         _advance_cursor(hpqfi, &node_not_sorted);
 
-        /* If all nodes are sorted return */
-        if (node_not_sorted == tail)
-            return;
-
         uint16_t cursor = head;
         /* cmp_prty_fn(a,b) = 1 if a.prio > b.prio , cmp_prty_fn(a,b) = 0 if a.prio <= b.prio */
-        while (hpqfi->cmp_prty_fn(hpqfi->buffer[node_not_sorted].priority, hpqfi->buffer[cursor].priority) == 0) {
+        while (cursor != node_not_sorted &&
+               hpqfi->cmp_prty_fn(hpqfi->buffer[node_not_sorted].priority, hpqfi->buffer[cursor].priority) == 0) {
             _advance_cursor(hpqfi, &cursor);
         }
         while (cursor != node_not_sorted) {
@@ -210,6 +265,71 @@ static void _pq_sort(_PQFI_HandleTypeDef *hpqfi, uint16_t head, uint16_t tail) {
     }
 }
 
+/* True if the run node a goes before b: higher priority or same priority and inserted first */
+static bool _run_before(_PQFI_HandleTypeDef *hpqfi, _PQFI_RunNodeTypeDef *a, _PQFI_RunNodeTypeDef *b) {
+    if (hpqfi->cmp_prty_fn(a->priority, b->priority))
+        return true;
+    return !hpqfi->cmp_prty_fn(b->priority, a->priority) && a->order < b->order;
+}
+
+/* Sift down for the heap sort of the run, the root is the node that goes last */
+static void _run_sift_down(_PQFI_HandleTypeDef *hpqfi, uint16_t i, uint16_t size) {
+    _PQFI_RunNodeTypeDef *run = hpqfi->run;
+    _PQFI_RunNodeTypeDef node = run[i];
+    uint16_t child;
+    while ((child = 2 * i + 1) < size) {
+        if (child + 1 < size && _run_before(hpqfi, &run[child], &run[child + 1]))
+            child++;
+        if (!_run_before(hpqfi, &node, &run[child]))
+            break;
+        run[i] = run[child];
+        i      = child;
+    }
+    run[i] = node;
+}
+
+static void _pq_merge(_PQFI_HandleTypeDef *hpqfi, uint16_t head, uint16_t tail) {
+    uint16_t len    = hpqfi->pq_length;
+    uint16_t count  = _pq_count(hpqfi, head, tail);
+    uint16_t sorted = hpqfi->sorted_cnt;
+    uint16_t size   = count - sorted;
+    if (size == 0)
+        return;
+
+    /* Copy the new run out of the buffer and heap sort it, O(k log k) */
+    _PQFI_RunNodeTypeDef *run = hpqfi->run;
+    for (uint16_t j = 0; j < size; j++) {
+        _PQFI_NodeTypeDef *node = &hpqfi->buffer[(head + sorted + j) % len];
+        run[j].priority         = node->priority;
+        run[j].order            = j;
+        run[j].payload          = node->payload;
+    }
+    for (uint16_t j = size / 2; j-- > 0;)
+        _run_sift_down(hpqfi, j, size);
+    for (uint16_t end = size - 1; end > 0; end--) {
+        _PQFI_RunNodeTypeDef tmp = run[0];
+        run[0]                   = run[end];
+        run[end]                 = tmp;
+        _run_sift_down(hpqfi, 0, end);
+    }
+
+    /* Merge from the back: only the ordered nodes that go after some new node are moved */
+    int32_t i = (int32_t)sorted - 1;
+    int32_t j = (int32_t)size - 1;
+    for (uint16_t w = count; j >= 0;) {
+        _PQFI_NodeTypeDef *dst = &hpqfi->buffer[(head + --w) % len];
+        if (i >= 0 && hpqfi->cmp_prty_fn(run[j].priority, hpqfi->buffer[(head + i) % len].priority)) {
+            *dst = hpqfi->buffer[(head + i) % len];
+            i--;
+        } else {
+            dst->priority = run[j].priority;
+            dst->payload  = run[j].payload;
+            j--;
+        }
+    }
+    hpqfi->sorted_cnt = count;
+}
+
 static void _advance_cursor(_PQFI_HandleTypeDef *hpqfi, uint16_t *cursor) {
     if (cursor == &hpqfi->head) {
         hpqfi->buf_full = false;
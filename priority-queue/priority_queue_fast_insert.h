@@ -28,6 +28,14 @@ typedef struct _PQFI_HandleTypeDef *PQFI_HandleTypeDef;
 typedef bool (*PQFI_CmpPrtyFnTypeDef)(PQFI_PriorityTypeDef, PQFI_PriorityTypeDef);
 typedef PQFI_PriorityTypeDef (*PQFI_AntiStrvFnTypeDef)(PQFI_PriorityTypeDef);
 
+/**
+ * @brief How pop orders the nodes inserted since the last pop
+ */
+typedef enum {
+    PQFI_SORT_INSERTION, /*!< Insert each new node in the ordered nodes, O(k n) for k new nodes */
+    PQFI_SORT_MERGE      /*!< Sort the new nodes and merge them with the ordered nodes, O(k log k + n) */
+} PQFI_SortModeTypeDef;
+
 /* Exported constants --------------------------------------------------------*/
 /* Exported macros -----------------------------------------------------------*/
 /* Exported functions --------------------------------------------------------*/
@@ -56,6 +64,19 @@ PQFI_HandleTypeDef PQFI_init(
  * */
 void PQFI_destroy(PQFI_HandleTypeDef hpqfi);
 
+/**
+ * @brief Select how pop orders the nodes inserted since the last pop.
+ *        The merge mode bounds the latency of the first pop after a burst of
+ *        inserts and pops nodes with the same priority in insertion order
+ *        (cmp_fn must be strict). It allocates a buffer of queue_length nodes
+ * 
+ * @param hpqfi     PQFI_HandleTypeDef instance
+ * @param sort_mode PQFI_SORT_INSERTION (default) or PQFI_SORT_MERGE
+ * 
+ * @return true if the mode was set, false if the queue is not empty or out of MEM
+ */
+bool PQFI_set_sort_mode(PQFI_HandleTypeDef hpqfi, PQFI_SortModeTypeDef sort_mode);
+
 /**
  * @brief Check if the queue is empty
  * 
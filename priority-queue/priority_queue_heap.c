@@ -1,5 +1,14 @@
 #include "priority_queue_heap.h"
 
+/* The compare function chosen at build time can be inlined */
+#ifdef PQH_COMPARE
+#define _PQH_COMPARE(pq, a, b) PQH_COMPARE(a, b)
+#else
+#define _PQH_COMPARE(pq, a, b) (pq)->compare(a, b)
+#endif
+
+#define _PQH_ELEM(pq, i) ((pq)->queue + (i) * (pq)->elem_size)
+
 int _PQH_parent(int i) { return (i-1)/2; }
 int _PQH_left(int i)   { return 2*i+1;   }
 int _PQH_right(int i)  { return 2*i+2;   }
@@ -30,6 +39,40 @@ void PQH_init(PQH *pq, int pq_size, int elem_size, uint8_t *queue, int *priority
     pq->priority = priority;
 }
 
+/**
+ * @brief Put an element in the hole i and move it down: the compare loop only
+ *        reads the priority array, the payloads on the path are moved once
+ *        the final slot is known
+ *
+ * @param priority priority of the element
+ * @param src index of the payload of the element, not on the path
+ */
+static void _PQH_sift_down(PQH *pq, int i, int priority, int src)
+{
+    int hole = i, child, depth = 0;
+    while((child = _PQH_left(hole)) < pq->elem_cnt)
+    {
+        if(child + 1 < pq->elem_cnt && _PQH_COMPARE(pq, pq->priority[child], pq->priority[child + 1]))
+            child++;
+        if(!_PQH_COMPARE(pq, priority, pq->priority[child]))
+            break;
+        pq->priority[hole] = pq->priority[child];
+        hole = child;
+        depth++;
+    }
+    pq->priority[hole] = priority;
+
+    /* Each payload on the path from i moves up one level, top-down */
+    for(int j = i; depth > 0; depth--)
+    {
+        int next = ((hole + 1) >> (depth - 1)) - 1;   //ancestor of hole, child of j
+        memcpy(_PQH_ELEM(pq, j), _PQH_ELEM(pq, next), pq->elem_size);
+        j = next;
+    }
+    if(hole != src)
+        memcpy(_PQH_ELEM(pq, hole), _PQH_ELEM(pq, src), pq->elem_size);
+}
+
 bool PQH_is_full(PQH *pq)  { return pq->elem_cnt == pq->max_elem; }
 bool PQH_is_empty(PQH *pq) { return pq->elem_cnt == 0; }
 
@@ -37,48 +80,47 @@ bool PQH_insert(PQH *pq, int priority, uint8_t *element)
 {
     if(PQH_is_full(pq)) return 0;
 
-    memcpy(pq->priority+pq->tail, &priority, 4);
-    memcpy(pq->queue+pq->tail*pq->elem_size, element, pq->elem_size);
+    /* Move the parent priorities down until the hole is the place of the new one */
     int i = pq->tail;
-    pq->tail++;
-    pq->elem_cnt++;
-    while(i > 0 && pq->compare(pq->priority[_PQH_parent(i)], pq->priority[i]))
+    while(i > 0 && _PQH_COMPARE(pq, pq->priority[_PQH_parent(i)], priority))
     {
-        _PQH_swap(pq, _PQH_parent(i), i);
+        pq->priority[i] = pq->priority[_PQH_parent(i)];
         i = _PQH_parent(i);
     }
+    pq->priority[i] = priority;
+
+    /* Then the payloads on the same path, one copy each */
+    for(int j = pq->tail; j != i; j = _PQH_parent(j))
+        memcpy(_PQH_ELEM(pq, j), _PQH_ELEM(pq, _PQH_parent(j)), pq->elem_size);
+    memcpy(_PQH_ELEM(pq, i), element, pq->elem_size);
+
+    pq->tail++;
+    pq->elem_cnt++;
 
     return 1;
 }
 void PQH_top(PQH *pq, int *priority, uint8_t *element)
 {
     memcpy(element, pq->queue, pq->elem_size);
-    memcpy(priority, pq->priority, 4);
+    *priority = pq->priority[0];
 }
 bool PQH_pop(PQH *pq, int *priority, uint8_t *element)
 {
     if(PQH_is_empty(pq)) return 0;
 
     PQH_top(pq, priority, element);
-    _PQH_swap(pq, 0, pq->tail-1);
     pq->elem_cnt--;
     pq->tail--;
-    _PQH_heap_restore(pq, 0);
+
+    /* The last element fills the hole left by the top */
+    _PQH_sift_down(pq, 0, pq->priority[pq->tail], pq->tail);
 
     return 1;
 }
 
 void _PQH_heap_restore(PQH *pq, int i)
 {
-    int l = _PQH_left(i), r = _PQH_right(i);
-    int best = i;
-    if(l < pq->elem_cnt && pq->compare(pq->priority[i], pq->priority[l]))
-        best = l;
-    if(r < pq->elem_cnt && pq->compare(pq->priority[best], pq->priority[r]))
-        best = r;
-    if(best != i)
-    {
-        _PQH_swap(pq, i, best);
-        _PQH_heap_restore(pq, best);
-    }
-}
\ No newline at end of file
+    /* The last member is free for the element to move */
+    memcpy(_PQH_ELEM(pq, pq->max_elem), _PQH_ELEM(pq, i), pq->elem_size);
+    _PQH_sift_down(pq, i, pq->priority[i], pq->max_elem);
+}
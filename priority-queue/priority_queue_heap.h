@@ -18,6 +18,12 @@ typedef struct{
 
 /*
     DEFAULT COMPARE FUNCTIONS
+
+    compare(parent, child) is true if the child must go above the parent:
+    PQH_GT and PQH_GE pop the lowest priority first, PQH_LT and PQH_LE the
+    highest. Building priority_queue_heap.c with -DPQH_COMPARE=PQH_GT (or
+    another of them) uses that function for every queue instead of the one
+    passed to PQH_init, so it can be inlined.
 */
 
 /* greater or equal */
@@ -38,7 +44,7 @@ bool PQH_LT(int a, int b);
  * @param priority pointer to the allocated memory for the priority
  * @param compare pointer to the compare function, you can use the default compare functions (PQ_GE, PQ_GT,)
  * 
- * @warning the last member is used for swapping, if you need n elements remember to allocate n+1 elements
+ * @warning the last member is used for moving elements, if you need n elements remember to allocate n+1 elements
  */
 void PQH_init(PQH *pq, int pq_size, int elem_size, uint8_t *queue, int *priority, bool (*compare)(int, int));
 
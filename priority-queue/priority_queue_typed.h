@@ -0,0 +1,348 @@
+/**
+ * @file      priority_queue_typed.h
+ * @author    Giacomo Mazzucchi [giacomo.mazzucchi@protonmail.com]
+ * @date      2026-10-18
+ * @updated
+ * @ingroup
+ * @prefix    PQT
+ *
+ * @brief     Typed priority queues generated by macros, with the compare
+ *            function known at compile time and static storage
+ *
+ * @details   Each PQT_DEFINE_* macro generates a queue type NAME and the same
+ *            static inline functions for every backend, so firmware can switch
+ *            backend by changing only the line of the definition:
+ *
+ *                #define CAN_BEFORE(a, b) ((a) < (b))
+ *                PQT_DEFINE_HEAP(can_queue, can_msg, uint16_t, 64, CAN_BEFORE)
+ *
+ *                static can_queue q;
+ *                can_queue_init(&q);
+ *                can_queue_insert(&q, msg.id, &msg);
+ *                can_queue_pop(&q, &id, &msg);
+ *
+ *            Generated functions (NAME_ prefix):
+ *            - void NAME_init(NAME *q)
+ *            - bool NAME_insert(NAME *q, PRIORITY priority, const TYPE *element)
+ *            - bool NAME_peek(const NAME *q, PRIORITY *priority, TYPE *element)
+ *            - bool NAME_pop(NAME *q, PRIORITY *priority, TYPE *element)
+ *            - uint16_t NAME_count(const NAME *q)
+ *            - bool NAME_is_empty(const NAME *q), bool NAME_is_full(const NAME *q)
+ *
+ *            insert returns false if the queue is full (or the priority is out
+ *            of range for the bucket backend), peek and pop return false if the
+ *            queue is empty; their priority and element pointers can be NULL.
+ *            With every backend, elements with the same priority are popped in
+ *            insertion order. Run `make bench && ./bench` in test/ to compare
+ *            the backends.
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef PRIORITY_QUEUE_TYPED_H
+#define PRIORITY_QUEUE_TYPED_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "stdbool.h"
+#include "stddef.h"
+#include "stdint.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Maximum number of priority levels of the bucket backend (32 bitmap words of 32 levels) */
+#define PQT_MAX_LEVELS 1024
+
+/* Exported macros -----------------------------------------------------------*/
+
+/* Count leading zeros of a non-zero word, a single instruction on Cortex-M3 and above */
+#ifndef PQT_CLZ
+#define PQT_CLZ(x) ((uint32_t)__builtin_clz(x))
+#endif
+
+/* End of a list of slots */
+#define _PQT_NIL UINT16_MAX
+
+#define _PQT_BIT(i) (0x80000000U >> ((i) % 32))
+
+/* Fail the build if the condition is false */
+#define _PQT_CHECK(NAME, what, cond) typedef char _##NAME##_##what[(cond) ? 1 : -1]
+
+/**
+ * @brief Binary heap backend: insert and pop O(log n)
+ * @details The heap holds {priority, insertion number, slot} nodes, the
+ *          elements never move from their slot. Best for wide ranges of
+ *          priorities and queues longer than a few tens of elements.
+ *
+ * @param NAME     Name of the queue type and prefix of its functions
+ * @param TYPE     Type of the elements
+ * @param PRIORITY Type of the priorities
+ * @param CAPACITY Maximum number of elements (less than 65535)
+ * @param BEFORE   Function or macro BEFORE(a, b), true if priority a is popped
+ *                 before priority b, it must be strict (false if a == b)
+ */
+#define PQT_DEFINE_HEAP(NAME, TYPE, PRIORITY, CAPACITY, BEFORE)                                 \
+    _PQT_CHECK(NAME, capacity, (CAPACITY) > 0 && (CAPACITY) < _PQT_NIL);                        \
+                                                                                                \
+    typedef struct {                                                                            \
+        PRIORITY priority;                                                                      \
+        uint16_t slot;                                                                          \
+        uint32_t seq;                                                                           \
+    } NAME##_node;                                                                              \
+                                                                                                \
+    typedef struct {                                                                            \
+        uint16_t count;                  /*!< Number of elements in the queue */                \
+        uint32_t seq;                    /*!< Insertion number of the next element */           \
+        NAME##_node heap[CAPACITY];      /*!< Binary heap, the first node is popped first */    \
+        uint16_t free_slots[CAPACITY];   /*!< Stack of free slots, CAPACITY - count of them */  \
+        TYPE elements[CAPACITY];         /*!< Elements, by slot */                              \
+    } NAME;                                                                                     \
+                                                                                                \
+    /* Wrap-safe insertion number compare keeps equal priorities in FIFO order */               \
+    static inline bool _##NAME##_before(const NAME##_node *a, const NAME##_node *b) {           \
+        if (BEFORE(a->priority, b->priority))                                                   \
+            return true;                                                                        \
+        return !BEFORE(b->priority, a->priority) && (int32_t)(a->seq - b->seq) < 0;             \
+    }                                                                                           \
+                                                                                                \
+    static inline void NAME##_init(NAME *q) {                                                   \
+        q->count = 0;                                                                           \
+        q->seq   = 0;                                                                           \
+        for (uint16_t i = 0; i < (CAPACITY); i++)                                               \
+            q->free_slots[i] = i;                                                               \
+    }                                                                                           \
+                                                                                                \
+    static inline uint16_t NAME##_count(const NAME *q) { return q->count; }                     \
+    static inline bool NAME##_is_empty(const NAME *q) { return q->count == 0; }                 \
+    static inline bool NAME##_is_full(const NAME *q) { return q->count == (CAPACITY); }         \
+                                                                                                \
+    static inline bool NAME##_insert(NAME *q, PRIORITY priority, const TYPE *element) {         \
+        if (NAME##_is_full(q))                                                                  \
+            return false;                                                                       \
+                                                                                                \
+        NAME##_node node = {priority, q->free_slots[(CAPACITY) - 1 - q->count], q->seq++};      \
+        q->elements[node.slot] = *element;                                                      \
+                                                                                                \
+        /* Move the parents down until the hole is the place of the node */                     \
+        uint16_t i = q->count++;                                                                \
+        while (i > 0 && _##NAME##_before(&node, &q->heap[(i - 1) / 2])) {                       \
+            q->heap[i] = q->heap[(i - 1) / 2];                                                  \
+            i          = (i - 1) / 2;                                                           \
+        }                                                                                       \
+        q->heap[i] = node;                                                                      \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    static inline bool NAME##_peek(const NAME *q, PRIORITY *priority, TYPE *element) {          \
+        if (NAME##_is_empty(q))                                                                 \
+            return false;                                                                       \
+        if (priority != NULL)                                                                   \
+            *priority = q->heap[0].priority;                                                    \
+        if (element != NULL)                                                                    \
+            *element = q->elements[q->heap[0].slot];                                            \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    static inline bool NAME##_pop(NAME *q, PRIORITY *priority, TYPE *element) {                 \
+        if (!NAME##_peek(q, priority, element))                                                 \
+            return false;                                                                       \
+                                                                                                \
+        q->count--;                                                                             \
+        q->free_slots[(CAPACITY) - 1 - q->count] = q->heap[0].slot;                             \
+                                                                                                \
+        /* Move the children up until the hole is the place of the last node */                 \
+        NAME##_node node = q->heap[q->count];                                                   \
+        uint16_t i = 0, child;                                                                  \
+        while ((child = 2 * i + 1) < q->count) {                                                \
+            if (child + 1 < q->count && _##NAME##_before(&q->heap[child + 1], &q->heap[child])) \
+                child++;                                                                        \
+            if (!_##NAME##_before(&q->heap[child], &node))                                      \
+                break;                                                                          \
+            q->heap[i] = q->heap[child];                                                        \
+            i          = child;                                                                 \
+        }                                                                                       \
+        q->heap[i] = node;                                                                      \
+        return true;                                                                            \
+    }
+
+/**
+ * @brief Bucket backend: one FIFO per priority level, insert and pop O(1)
+ * @details The highest non-empty level is found with two count-leading-zeros
+ *          instructions, as in PQB. Level 0 is popped first, as for CAN IDs.
+ *          Best for small ranges of priorities.
+ *
+ * @param NAME     Name of the queue type and prefix of its functions
+ * @param TYPE     Type of the elements
+ * @param LEVELS   Number of priority levels (1 to PQT_MAX_LEVELS), the
+ *                 priorities are uint16_t
+ * @param CAPACITY Maximum number of elements (less than 65535)
+ */
+#define PQT_DEFINE_BUCKET(NAME, TYPE, LEVELS, CAPACITY)                                         \
+    _PQT_CHECK(NAME, capacity, (CAPACITY) > 0 && (CAPACITY) < _PQT_NIL);                        \
+    _PQT_CHECK(NAME, levels, (LEVELS) > 0 && (LEVELS) <= PQT_MAX_LEVELS);                       \
+                                                                                                \
+    typedef struct {                                                                            \
+        uint16_t count;                        /*!< Number of elements in the queue */          \
+        uint16_t free_slot;                    /*!< First slot of the list of free slots */     \
+        uint32_t summary;                      /*!< Bit 31-w set if bitmap word w is not 0 */   \
+        uint32_t bitmap[((LEVELS) + 31) / 32]; /*!< Bit 31-(l%32) of word l/32: l not empty */  \
+        uint16_t head[LEVELS];                 /*!< First slot of each level */                 \
+        uint16_t tail[LEVELS];                 /*!< Last slot of each level */                  \
+        uint16_t next[CAPACITY];               /*!< Next slot in the level or the free list */  \
+        TYPE elements[CAPACITY];               /*!< Elements, by slot */                        \
+    } NAME;                                                                                     \
+                                                                                                \
+    /* Highest non-empty level, the queue must not be empty */                                  \
+    static inline uint16_t _##NAME##_highest(const NAME *q) {                                   \
+        uint32_t word = PQT_CLZ(q->summary);                                                    \
+        return word * 32 + PQT_CLZ(q->bitmap[word]);                                            \
+    }                                                                                           \
+                                                                                                \
+    static inline void NAME##_init(NAME *q) {                                                   \
+        q->count   = 0;                                                                         \
+        q->summary = 0;                                                                         \
+        for (uint16_t i = 0; i < ((LEVELS) + 31) / 32; i++)                                     \
+            q->bitmap[i] = 0;                                                                   \
+        for (uint16_t i = 0; i < (CAPACITY); i++)                                               \
+            q->next[i] = i + 1 < (CAPACITY) ? i + 1 : _PQT_NIL;                                 \
+        q->free_slot = 0;                                                                       \
+    }                                                                                           \
+                                                                                                \
+    static inline uint16_t NAME##_count(const NAME *q) { return q->count; }                     \
+    static inline bool NAME##_is_empty(const NAME *q) { return q->count == 0; }                 \
+    static inline bool NAME##_is_full(const NAME *q) { return q->count == (CAPACITY); }         \
+                                                                                                \
+    static inline bool NAME##_insert(NAME *q, uint16_t priority, const TYPE *element) {         \
+        if (priority >= (LEVELS) || NAME##_is_full(q))                                          \
+            return false;                                                                       \
+                                                                                                \
+        uint16_t slot     = q->free_slot;                                                       \
+        q->free_slot      = q->next[slot];                                                      \
+        q->next[slot]     = _PQT_NIL;                                                           \
+        q->elements[slot] = *element;                                                           \
+                                                                                                \
+        uint16_t word = priority / 32;                                                          \
+        if (q->bitmap[word] & _PQT_BIT(priority)) {                                             \
+            q->next[q->tail[priority]] = slot;                                                  \
+        } else {                                                                                \
+            q->head[priority] = slot;                                                           \
+            q->bitmap[word] |= _PQT_BIT(priority);                                              \
+            q->summary |= _PQT_BIT(word);                                                       \
+        }                                                                                       \
+        q->tail[priority] = slot;                                                               \
+        q->count++;                                                                             \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    static inline bool NAME##_peek(const NAME *q, uint16_t *priority, TYPE *element) {          \
+        if (NAME##_is_empty(q))                                                                 \
+            return false;                                                                       \
+                                                                                                \
+        uint16_t level = _##NAME##_highest(q);                                                  \
+        if (priority != NULL)                                                                   \
+            *priority = level;                                                                  \
+        if (element != NULL)                                                                    \
+            *element = q->elements[q->head[level]];                                             \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    static inline bool NAME##_pop(NAME *q, uint16_t *priority, TYPE *element) {                 \
+        if (NAME##_is_empty(q))                                                                 \
+            return false;                                                                       \
+                                                                                                \
+        uint16_t level = _##NAME##_highest(q);                                                  \
+        uint16_t slot  = q->head[level];                                                        \
+        if (priority != NULL)                                                                   \
+            *priority = level;                                                                  \
+        if (element != NULL)                                                                    \
+            *element = q->elements[slot];                                                       \
+                                                                                                \
+        q->head[level] = q->next[slot];                                                         \
+        if (q->head[level] == _PQT_NIL) {                                                       \
+            uint16_t word = level / 32;                                                         \
+            q->bitmap[word] &= ~_PQT_BIT(level);                                                \
+            if (q->bitmap[word] == 0)                                                           \
+                q->summary &= ~_PQT_BIT(word);                                                  \
+        }                                                                                       \
+                                                                                                \
+        q->next[slot] = q->free_slot;                                                           \
+        q->free_slot  = slot;                                                                   \
+        q->count--;                                                                             \
+        return true;                                                                            \
+    }
+
+/**
+ * @brief Sorted ring backend: insert O(n) moving the elements that go after
+ *        the new one, pop O(1)
+ * @details The insert starts from the tail, so it is O(1) when the new element
+ *          goes last (e.g. same or lower priority than the queued ones). Best
+ *          for short queues and small elements, or when pops must be fast.
+ *
+ * @param NAME     Name of the queue type and prefix of its functions
+ * @param TYPE     Type of the elements
+ * @param PRIORITY Type of the priorities
+ * @param CAPACITY Maximum number of elements (less than 65535), a power of 2
+ *                 makes the ring index a mask
+ * @param BEFORE   Function or macro BEFORE(a, b), true if priority a is popped
+ *                 before priority b, it must be strict (false if a == b)
+ */
+#define PQT_DEFINE_RING(NAME, TYPE, PRIORITY, CAPACITY, BEFORE)                                 \
+    _PQT_CHECK(NAME, capacity, (CAPACITY) > 0 && (CAPACITY) < _PQT_NIL);                        \
+                                                                                                \
+    typedef struct {                                                                            \
+        uint16_t head;                  /*!< Index of the element popped first */               \
+        uint16_t count;                 /*!< Number of elements in the queue */                 \
+        PRIORITY priorities[CAPACITY];  /*!< Priorities, sorted from head */                    \
+        TYPE elements[CAPACITY];        /*!< Elements, sorted from head */                      \
+    } NAME;                                                                                     \
+                                                                                                \
+    static inline void NAME##_init(NAME *q) {                                                   \
+        q->head  = 0;                                                                           \
+        q->count = 0;                                                                           \
+    }                                                                                           \
+                                                                                                \
+    static inline uint16_t NAME##_count(const NAME *q) { return q->count; }                     \
+    static inline bool NAME##_is_empty(const NAME *q) { return q->count == 0; }                 \
+    static inline bool NAME##_is_full(const NAME *q) { return q->count == (CAPACITY); }         \
+                                                                                                \
+    static inline bool NAME##_insert(NAME *q, PRIORITY priority, const TYPE *element) {         \
+        if (NAME##_is_full(q))                                                                  \
+            return false;                                                                       \
+                                                                                                \
+        /* Move one place back the elements that go after the new one */                        \
+        uint16_t i   = q->count++;                                                              \
+        uint16_t dst = (q->head + i) % (CAPACITY);                                              \
+        while (i > 0) {                                                                         \
+            uint16_t src = (q->head + i - 1) % (CAPACITY);                                      \
+            if (!BEFORE(priority, q->priorities[src]))                                          \
+                break;                                                                          \
+            q->priorities[dst] = q->priorities[src];                                            \
+            q->elements[dst]   = q->elements[src];                                              \
+            dst                = src;                                                           \
+            i--;                                                                                \
+        }                                                                                       \
+        q->priorities[dst] = priority;                                                          \
+        q->elements[dst]   = *element;                                                          \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    static inline bool NAME##_peek(const NAME *q, PRIORITY *priority, TYPE *element) {          \
+        if (NAME##_is_empty(q))                                                                 \
+            return false;                                                                       \
+        if (priority != NULL)                                                                   \
+            *priority = q->priorities[q->head];                                                 \
+        if (element != NULL)                                                                    \
+            *element = q->elements[q->head];                                                    \
+        return true;                                                                            \
+    }                                                                                           \
+                                                                                                \
+    static inline bool NAME##_pop(NAME *q, PRIORITY *priority, TYPE *element) {                 \
+        if (!NAME##_peek(q, priority, element))                                                 \
+            return false;                                                                       \
+        q->head = (q->head + 1) % (CAPACITY);                                                   \
+        q->count--;                                                                             \
+        return true;                                                                            \
+    }
+
+/* Exported types ------------------------------------------------------------*/
+/* Exported functions --------------------------------------------------------*/
+
+#endif
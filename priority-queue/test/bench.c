@@ -0,0 +1,320 @@
+/**
+ * @file bench.c
+ * @brief Compare the list and the heap engines of the priority queue with
+ *        queues of 32, 256 and 2048 CAN messages, then all the queues (bucket,
+ *        PQH, PQFI and the typed backends) on a small and a wide range of
+ *        priorities, and the pop latency of the two sort modes of PQFI after
+ *        bursts of inserts
+ *
+ * Run with `make bench && ./bench`
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../priority_queue.h"
+#include "../priority_queue_bucket.h"
+#include "../priority_queue_fast_insert.h"
+#include "../priority_queue_heap.h"
+#include "../priority_queue_typed.h"
+
+#define BENCH_STEADY_OPS 20000
+#define BENCH_MAX_SIZE 2048
+#define BENCH_LEVELS 8
+#define BENCH_WIDE_LEVELS PQB_MAX_LEVELS
+
+typedef struct can_msg {
+    uint16_t id;
+    uint8_t size;
+    uint8_t data[8];
+} can_msg;
+
+typedef void (*init_fn)(PQ_QueueTypeDef *, size_t, size_t, PQ_cmp_priorities_fn, PQ_after_pop_fn);
+
+int16_t _cmp_op(PQ_PriorityTypeDef a, PQ_PriorityTypeDef b) {
+    return b - a;
+}
+
+void _pop_op(PQ_PriorityTypeDef *p) {
+    if (*p > 0)
+        (*p)--;
+}
+
+double _now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+uint16_t _random_id(void) {
+    return rand() % 0x800;
+}
+
+/*
+ * Fill a queue with n messages, keep it at n with insert/pop pairs, then drain
+ * it. The aging is done by the post-pop function op or lazily if aging > 0
+ */
+void bench(const char *name, init_fn init, size_t n, PQ_after_pop_fn op, uint16_t aging) {
+    PQ_QueueTypeDef q;
+    can_msg m = {0, 8, {0}};
+    init(&q, n + 1, sizeof(can_msg), _cmp_op, op);
+    if (aging > 0)
+        PQ_set_aging(q, aging);
+    srand(42);
+
+    double start = _now_ns();
+    for (size_t i = 0; i < n; i++) {
+        m.id = _random_id();
+        PQ_insert(q, m.id, &m);
+    }
+    double fill = (_now_ns() - start) / n;
+
+    size_t steady_ops = BENCH_STEADY_OPS / (op != NULL ? n / 32 : 1);
+    start             = _now_ns();
+    for (size_t i = 0; i < steady_ops; i++) {
+        m.id = _random_id();
+        PQ_insert(q, m.id, &m);
+        PQ_pop_highest(q, &m);
+    }
+    double steady = (_now_ns() - start) / steady_ops;
+
+    start = _now_ns();
+    while (!PQ_is_empty(q))
+        PQ_pop_highest(q, &m);
+    double drain = (_now_ns() - start) / n;
+
+    printf("[BENCH] %-4s %-10s n=%5zu  insert %9.1f ns  insert+pop %9.1f ns  pop %9.1f ns\n",
+           name, aging > 0 ? "lazy aging" : (op != NULL ? "aging" : "no aging"), n, fill, steady, drain);
+    PQ_destroy(&q);
+}
+
+/* Common interface of the queues compared on a range of priorities */
+typedef struct {
+    const char *name;
+    void (*init)(size_t n);
+    void (*insert)(uint16_t priority, can_msg *m);
+    void (*pop)(can_msg *m);
+    void (*destroy)(void);
+} bench_queue;
+
+/* Number of priority levels of the current run */
+uint16_t bench_levels;
+
+PQB pqb;
+uint32_t pqb_mem[PQB_MEM_SIZE(BENCH_WIDE_LEVELS, BENCH_MAX_SIZE, sizeof(can_msg)) / 4 + 1];
+
+void _pqb_init(size_t n) {
+    PQB_init(&pqb, bench_levels, n, sizeof(can_msg), pqb_mem);
+}
+void _pqb_insert(uint16_t priority, can_msg *m) {
+    PQB_insert(&pqb, priority, m);
+}
+void _pqb_pop(can_msg *m) {
+    PQB_pop(&pqb, NULL, m);
+}
+
+PQH pqh;
+uint8_t pqh_queue[(BENCH_MAX_SIZE + 1) * sizeof(can_msg)];
+int pqh_priority[BENCH_MAX_SIZE + 1];
+
+void _pqh_init(size_t n) {
+    PQH_init(&pqh, (n + 1) * sizeof(can_msg), sizeof(can_msg), pqh_queue, pqh_priority, PQH_GT);
+}
+void _pqh_insert(uint16_t priority, can_msg *m) {
+    PQH_insert(&pqh, priority, (uint8_t *)m);
+}
+void _pqh_pop(can_msg *m) {
+    int priority;
+    PQH_pop(&pqh, &priority, (uint8_t *)m);
+}
+
+PQFI_HandleTypeDef pqfi;
+
+bool _pqfi_cmp(PQFI_PriorityTypeDef a, PQFI_PriorityTypeDef b) {
+    return a < b;
+}
+void _pqfi_init(size_t n) {
+    pqfi = PQFI_init(n, sizeof(can_msg), _pqfi_cmp, NULL);
+}
+void _pqfi_merge_init(size_t n) {
+    _pqfi_init(n);
+    PQFI_set_sort_mode(pqfi, PQFI_SORT_MERGE);
+}
+void _pqfi_insert(uint16_t priority, can_msg *m) {
+    PQFI_insert(pqfi, priority, m);
+}
+void _pqfi_pop(can_msg *m) {
+    PQFI_pop(pqfi, m);
+}
+void _pqfi_destroy(void) {
+    PQFI_destroy(pqfi);
+}
+
+/* The typed queues have the capacity of the longest run */
+#define _BEFORE(a, b) ((a) < (b))
+PQT_DEFINE_HEAP(t_heap, can_msg, uint16_t, BENCH_MAX_SIZE, _BEFORE)
+PQT_DEFINE_BUCKET(t_bucket, can_msg, BENCH_WIDE_LEVELS, BENCH_MAX_SIZE)
+PQT_DEFINE_RING(t_ring, can_msg, uint16_t, BENCH_MAX_SIZE, _BEFORE)
+
+t_heap t_heap_q;
+t_bucket t_bucket_q;
+t_ring t_ring_q;
+
+void _t_heap_init(size_t n) {
+    t_heap_init(&t_heap_q);
+}
+void _t_heap_insert(uint16_t priority, can_msg *m) {
+    t_heap_insert(&t_heap_q, priority, m);
+}
+void _t_heap_pop(can_msg *m) {
+    t_heap_pop(&t_heap_q, NULL, m);
+}
+void _t_bucket_init(size_t n) {
+    t_bucket_init(&t_bucket_q);
+}
+void _t_bucket_insert(uint16_t priority, can_msg *m) {
+    t_bucket_insert(&t_bucket_q, priority, m);
+}
+void _t_bucket_pop(can_msg *m) {
+    t_bucket_pop(&t_bucket_q, NULL, m);
+}
+void _t_ring_init(size_t n) {
+    t_ring_init(&t_ring_q);
+}
+void _t_ring_insert(uint16_t priority, can_msg *m) {
+    t_ring_insert(&t_ring_q, priority, m);
+}
+void _t_ring_pop(can_msg *m) {
+    t_ring_pop(&t_ring_q, NULL, m);
+}
+
+/*
+ * Same scenario of bench() with bench_levels priorities, the pops of the drain
+ * are timed one by one to report the slowest (the first pop after a burst of
+ * inserts for PQFI), their average includes the time to read the clock
+ */
+void bench_range(bench_queue *q, size_t n) {
+    can_msg m = {0, 8, {0}};
+    q->init(n);
+    srand(42);
+
+    double start = _now_ns();
+    for (size_t i = 0; i < n; i++) {
+        m.id = _random_id();
+        q->insert(m.id % bench_levels, &m);
+    }
+    double fill = (_now_ns() - start) / n;
+
+    start = _now_ns();
+    for (size_t i = 0; i < BENCH_STEADY_OPS; i++) {
+        m.id = _random_id();
+        q->insert(m.id % bench_levels, &m);
+        q->pop(&m);
+    }
+    double steady = (_now_ns() - start) / BENCH_STEADY_OPS;
+
+    /* Pop half of the queue, then refill it with a burst of inserts */
+    for (size_t i = 0; i < n / 2; i++)
+        q->pop(&m);
+    for (size_t i = 0; i < n / 2; i++) {
+        m.id = _random_id();
+        q->insert(m.id % bench_levels, &m);
+    }
+
+    double max_pop = 0;
+    start          = _now_ns();
+    for (size_t i = 0; i < n; i++) {
+        double pop_start = _now_ns();
+        q->pop(&m);
+        double pop = _now_ns() - pop_start;
+        max_pop    = pop > max_pop ? pop : max_pop;
+    }
+    double drain = (_now_ns() - start) / n;
+
+    printf("[BENCH] %-8s %4u levels n=%4zu  insert %7.1f ns  insert+pop %9.1f ns  pop %7.1f ns  max pop %9.1f ns\n",
+           q->name, bench_levels, n, fill, steady, drain, max_pop);
+    if (q->destroy != NULL)
+        q->destroy();
+}
+
+/*
+ * Keep a PQFI queue half full, then repeatedly insert a burst of messages (as
+ * from the CAN receive interrupt) and pop as many: the first pop after each
+ * burst sorts it
+ */
+void bench_burst(PQFI_SortModeTypeDef mode, size_t burst) {
+    can_msg m = {0, 8, {0}};
+    pqfi      = PQFI_init(BENCH_MAX_SIZE, sizeof(can_msg), _pqfi_cmp, NULL);
+    PQFI_set_sort_mode(pqfi, mode);
+    srand(42);
+
+    for (size_t i = 0; i < BENCH_MAX_SIZE / 2; i++) {
+        m.id = _random_id();
+        PQFI_insert(pqfi, m.id, &m);
+    }
+
+    size_t rounds  = BENCH_STEADY_OPS / burst;
+    double total   = 0;
+    double max_pop = 0;
+    for (size_t r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < burst; i++) {
+            m.id = _random_id();
+            PQFI_insert(pqfi, m.id, &m);
+        }
+        for (size_t i = 0; i < burst; i++) {
+            double pop_start = _now_ns();
+            PQFI_pop(pqfi, &m);
+            double pop = _now_ns() - pop_start;
+            total += pop;
+            max_pop = pop > max_pop ? pop : max_pop;
+        }
+    }
+
+    printf("[BENCH] PQFI %-9s n=%4d burst=%4zu  pop %7.1f ns  max pop %9.1f ns\n",
+           mode == PQFI_SORT_MERGE ? "merge" : "insertion", BENCH_MAX_SIZE, burst, total / (rounds * burst),
+           max_pop);
+    PQFI_destroy(pqfi);
+}
+
+int main(void) {
+    size_t sizes[] = {32, 256, 2048};
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        bench("list", PQ_init, sizes[i], NULL, 0);
+        bench("heap", PQ_init_heap, sizes[i], NULL, 0);
+    }
+
+    /* Aging applied to every element after each pop or lazily */
+    size_t aging_sizes[] = {32, 256, 2048, 16384};
+    for (size_t i = 0; i < sizeof(aging_sizes) / sizeof(aging_sizes[0]); i++) {
+        bench("list", PQ_init, aging_sizes[i], _pop_op, 0);
+        bench("heap", PQ_init_heap, aging_sizes[i], _pop_op, 0);
+        bench("heap", PQ_init_heap, aging_sizes[i], NULL, 1);
+    }
+
+    /* Matrix of queues, sizes and ranges of priorities */
+    bench_queue queues[] = {
+        {"bucket", _pqb_init, _pqb_insert, _pqb_pop, NULL},
+        {"PQH", _pqh_init, _pqh_insert, _pqh_pop, NULL},
+        {"PQFI", _pqfi_init, _pqfi_insert, _pqfi_pop, _pqfi_destroy},
+        {"PQFI-M", _pqfi_merge_init, _pqfi_insert, _pqfi_pop, _pqfi_destroy},
+        {"T-heap", _t_heap_init, _t_heap_insert, _t_heap_pop, NULL},
+        {"T-bucket", _t_bucket_init, _t_bucket_insert, _t_bucket_pop, NULL},
+        {"T-ring", _t_ring_init, _t_ring_insert, _t_ring_pop, NULL},
+    };
+    uint16_t levels[] = {BENCH_LEVELS, BENCH_WIDE_LEVELS};
+    for (size_t l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+        bench_levels = levels[l];
+        for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+            for (size_t j = 0; j < sizeof(queues) / sizeof(queues[0]); j++)
+                bench_range(&queues[j], sizes[i]);
+    }
+
+    size_t bursts[] = {16, 128, 1024};
+    for (size_t i = 0; i < sizeof(bursts) / sizeof(bursts[0]); i++) {
+        bench_burst(PQFI_SORT_INSERTION, bursts[i]);
+        bench_burst(PQFI_SORT_MERGE, bursts[i]);
+    }
+    return 0;
+}
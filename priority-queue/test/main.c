@@ -2,8 +2,23 @@
 #include "../../munit/munit.h"
 #include "tests.h"
 
+/* Every test runs on every engine */
+static char *engines[]             = {"list", "arena", "heap", NULL};
+static MunitParameterEnum params[] = {{"engine", engines}, {NULL, NULL}};
+
+/* Fast insert tests run on both sort modes */
+static char *sort_modes[]               = {"insertion", "merge", NULL};
+static MunitParameterEnum pqfi_params[] = {{"sort", sort_modes}, {NULL, NULL}};
+
+/* Heap queue tests run with every default compare function */
+static char *compares[]                = {"GT", "GE", "LT", "LE", NULL};
+static MunitParameterEnum pqh_params[] = {{"compare", compares}, {NULL, NULL}};
+
+/* Typed queue tests run on every backend */
+static char *backends[]                  = {"heap", "bucket", "ring", NULL};
+static MunitParameterEnum typed_params[] = {{"backend", backends}, {NULL, NULL}};
+
 /* Define the test cases */
-//TODO test for maximum space used for insert (-> PQ_insert() = false)
 MunitTest tests[] = {
     {
         "/test-is-empty",       /* name         */
@@ -11,14 +26,45 @@ MunitTest tests[] = {
         NULL,                   /* setup        */
         NULL,                   /* tear_down    */
         MUNIT_TEST_OPTION_NONE, /* options      */
-        NULL                    /* parameters   */
+        params                  /* parameters   */
     },
-    {"/test-ordered-insert", test_ordered_insert, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
-    {"/test-reverse-insert", test_reverse_insert, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
-    {"/test-random-insert", test_random_insert, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
-    {"/test-no-starvation", test_no_starvation, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
-    {"/test-null-cmp-fn", test_null_cmp_fn, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
-    {"/test-pop-out-param", test_pop_out_param, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/test-ordered-insert", test_ordered_insert, NULL, NULL, MUNIT_TEST_OPTION_NONE, params},
+    {"/test-reverse-insert", test_reverse_insert, NULL, NULL, MUNIT_TEST_OPTION_NONE, params},
+    {"/test-random-insert", test_random_insert, NULL, NULL, MUNIT_TEST_OPTION_NONE, params},
+    {"/test-no-starvation", test_no_starvation, NULL, NULL, MUNIT_TEST_OPTION_NONE, params},
+    {"/test-null-cmp-fn", test_null_cmp_fn, NULL, NULL, MUNIT_TEST_OPTION_NONE, params},
+    {"/test-pop-out-param", test_pop_out_param, NULL, NULL, MUNIT_TEST_OPTION_NONE, params},
+    {"/test-full-queue", test_full_queue, NULL, NULL, MUNIT_TEST_OPTION_NONE, params},
+    {"/test-same-priority-fifo", test_same_priority_fifo, NULL, NULL, MUNIT_TEST_OPTION_NONE, params},
+    {"/test-large-payload", test_large_payload, NULL, NULL, MUNIT_TEST_OPTION_NONE, params},
+    {"/test-aging-matches-eager", test_aging_matches_eager, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/test-aging-starvation-bound", test_aging_starvation_bound, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/test-aging-invalid", test_aging_invalid, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+
+    /* Bucket queue */
+    {"/test-bucket-levels", test_bucket_levels, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/test-bucket-fifo", test_bucket_fifo, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/test-bucket-full-and-range", test_bucket_full_and_range, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/test-bucket-many-levels", test_bucket_many_levels, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/test-bucket-random", test_bucket_random, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/test-bucket-invalid-init", test_bucket_invalid_init, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+
+    /* Fast insert queue */
+    {"/test-fast-insert-full-queue", test_fast_insert_full_queue, NULL, NULL, MUNIT_TEST_OPTION_NONE, pqfi_params},
+    {"/test-fast-insert-same-priority-fifo", test_fast_insert_same_priority_fifo, NULL, NULL, MUNIT_TEST_OPTION_NONE, pqfi_params},
+    {"/test-fast-insert-bursts", test_fast_insert_bursts, NULL, NULL, MUNIT_TEST_OPTION_NONE, pqfi_params},
+    {"/test-fast-insert-sort-mode", test_fast_insert_sort_mode, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+
+    /* Heap queue */
+    {"/test-heap-order", test_heap_order, NULL, NULL, MUNIT_TEST_OPTION_NONE, pqh_params},
+    {"/test-heap-full", test_heap_full, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+
+    /* Typed queue */
+    {"/test-typed-full", test_typed_full, NULL, NULL, MUNIT_TEST_OPTION_NONE, typed_params},
+    {"/test-typed-random", test_typed_random, NULL, NULL, MUNIT_TEST_OPTION_NONE, typed_params},
+    {"/test-typed-null-out", test_typed_null_out, NULL, NULL, MUNIT_TEST_OPTION_NONE, typed_params},
+    {"/test-typed-bucket-range", test_typed_bucket_range, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/test-typed-compare", test_typed_compare, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
 
     /* Mark the end of the array with a NULL test function */
     {NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}};
@@ -1,6 +1,7 @@
 #include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 #define MUNIT_ENABLE_ASSERT_ALIASES
@@ -15,6 +16,15 @@ typedef struct msg {
     char c[8];
 } msg;
 
+/* Larger than the pointers of the nodes, to check that payloads are stored inline */
+typedef struct big_msg {
+    uint32_t n;
+    uint8_t data[60];
+} big_msg;
+
+/* Block provided by the caller for the arena engine */
+static uint64_t arena[(PQ_ARENA_SIZE(PQ_SIZE, sizeof(big_msg)) + 7) / 8];
+
 int _cmp_int(const void *a, const void *b) {
     return *(uint16_t *)a - *(uint16_t *)b;
 }
@@ -27,9 +37,25 @@ void _pop_op(PQ_PriorityTypeDef *p) {
     (*p)--;
 }
 
+/* Initialize the queue with the engine given by the "engine" parameter */
+void _init_queue_size(
+    PQ_QueueTypeDef *q, const MunitParameter *params, size_t payload_size, PQ_cmp_priorities_fn cmp, PQ_after_pop_fn op) {
+    const char *engine = munit_parameters_get(params, "engine");
+    if (engine != NULL && strcmp(engine, "heap") == 0)
+        PQ_init_heap(q, PQ_SIZE, payload_size, cmp, op);
+    else if (engine != NULL && strcmp(engine, "arena") == 0)
+        PQ_init_arena(q, arena, PQ_SIZE, payload_size, cmp, op);
+    else
+        PQ_init(q, PQ_SIZE, payload_size, cmp, op);
+}
+
+void _init_queue(PQ_QueueTypeDef *q, const MunitParameter *params, PQ_cmp_priorities_fn cmp, PQ_after_pop_fn op) {
+    _init_queue_size(q, params, sizeof(msg), cmp, op);
+}
+
 MunitResult test_is_empty(const MunitParameter *params, void *data) {
     PQ_QueueTypeDef q;
-    PQ_init(&q, PQ_SIZE, sizeof(msg), _cmp_op, _pop_op);
+    _init_queue(&q, params, _cmp_op, _pop_op);
 
     assert_true(PQ_is_empty(q));
 
@@ -45,7 +71,7 @@ MunitResult test_is_empty(const MunitParameter *params, void *data) {
 MunitResult test_ordered_insert(const MunitParameter *params, void *data) {
     PQ_QueueTypeDef q;
 
-    PQ_init(&q, PQ_SIZE, sizeof(msg), _cmp_op, _pop_op);
+    _init_queue(&q, params, _cmp_op, _pop_op);
 
     for (int i = 0; i < PQ_SIZE; i++) {
         msg m = {i, "abc"};
@@ -64,7 +90,7 @@ MunitResult test_ordered_insert(const MunitParameter *params, void *data) {
 
 MunitResult test_reverse_insert(const MunitParameter *params, void *data) {
     PQ_QueueTypeDef q;
-    PQ_init(&q, PQ_SIZE, sizeof(msg), _cmp_op, _pop_op);
+    _init_queue(&q, params, _cmp_op, _pop_op);
 
     for (int i = PQ_SIZE - 1; i >= 0; i--) {
         msg m = {i, "abc"};
@@ -89,7 +115,7 @@ MunitResult test_random_insert(const MunitParameter *params, void *data) {
         IDs[i] = rand() % UINT8_MAX;
 
     PQ_QueueTypeDef q;
-    PQ_init(&q, PQ_SIZE, sizeof(msg), _cmp_op, _pop_op);
+    _init_queue(&q, params, _cmp_op, _pop_op);
 
     for (int i = 0; i < PQ_SIZE; i++) {
         msg m = {IDs[i], "abc"};
@@ -110,7 +136,7 @@ MunitResult test_random_insert(const MunitParameter *params, void *data) {
 
 MunitResult test_no_starvation(const MunitParameter *params, void *data) {
     PQ_QueueTypeDef q;
-    PQ_init(&q, PQ_SIZE, sizeof(msg), _cmp_op, _pop_op);
+    _init_queue(&q, params, _cmp_op, _pop_op);
 
     msg m1 = {50, "A"};
     PQ_insert(q, 50, &m1);
@@ -135,7 +161,7 @@ MunitResult test_no_starvation(const MunitParameter *params, void *data) {
 
 MunitResult test_null_cmp_fn(const MunitParameter *params, void *data) {
     PQ_QueueTypeDef q;
-    PQ_init(&q, PQ_SIZE, sizeof(msg), NULL, _pop_op);
+    _init_queue(&q, params, NULL, _pop_op);
 
     for (int i = 0; i < PQ_SIZE; i++) {
         msg m = {i, "abc"};
@@ -154,7 +180,7 @@ MunitResult test_null_cmp_fn(const MunitParameter *params, void *data) {
 
 MunitResult test_pop_out_param(const MunitParameter *params, void *data) {
     PQ_QueueTypeDef q;
-    PQ_init(&q, PQ_SIZE, sizeof(msg), _cmp_op, _pop_op);
+    _init_queue(&q, params, _cmp_op, _pop_op);
 
     for (int i = 0; i < PQ_SIZE; i++) {
         msg m = {i, "abc"};
@@ -170,3 +196,170 @@ MunitResult test_pop_out_param(const MunitParameter *params, void *data) {
     PQ_destroy(&q);
     return MUNIT_OK;
 }
+
+MunitResult test_full_queue(const MunitParameter *params, void *data) {
+    PQ_QueueTypeDef q;
+    _init_queue(&q, params, _cmp_op, NULL);
+
+    for (int i = 0; i < PQ_SIZE; i++) {
+        msg m = {i, "abc"};
+        assert_true(PQ_insert(q, PQ_SIZE - i, &m));
+    }
+    msg m = {0, "abc"};
+    assert_false(PQ_insert(q, 0, &m));
+
+    /* A pop frees a node for the next insert */
+    PQ_pop_highest(q, &m);
+    assert_uint8(m.n, ==, PQ_SIZE - 1);
+    m.n = 200;
+    assert_true(PQ_insert(q, 0, &m));
+    assert_uint8(((msg *)PQ_peek_highest(q))->n, ==, 200);
+
+    PQ_destroy(&q);
+    return MUNIT_OK;
+}
+
+MunitResult test_same_priority_fifo(const MunitParameter *params, void *data) {
+    PQ_QueueTypeDef q;
+    _init_queue(&q, params, _cmp_op, NULL);
+
+    /* Three priority levels, interleaved */
+    for (int i = 0; i < PQ_SIZE; i++) {
+        msg m = {i, "abc"};
+        PQ_insert(q, i % 3, &m);
+    }
+
+    for (int i = 0; !PQ_is_empty(q); i++) {
+        msg m;
+        PQ_pop_highest(q, &m);
+        int level = i < 34 ? 0 : (i < 67 ? 1 : 2);
+        int index = i < 34 ? i : (i < 67 ? i - 34 : i - 67);
+        assert_uint8(m.n, ==, level + 3 * index);
+    }
+    assert_null(PQ_peek_highest(q));
+
+    PQ_destroy(&q);
+    return MUNIT_OK;
+}
+
+MunitResult test_large_payload(const MunitParameter *params, void *data) {
+    PQ_QueueTypeDef q;
+    _init_queue_size(&q, params, sizeof(big_msg), _cmp_op, NULL);
+
+    for (int i = 0; i < PQ_SIZE; i++) {
+        big_msg m;
+        m.n = i;
+        memset(m.data, i, sizeof(m.data));
+        assert_true(PQ_insert(q, PQ_SIZE - i, &m));
+    }
+
+    for (int i = PQ_SIZE - 1; !PQ_is_empty(q); i--) {
+        big_msg *peek = PQ_peek_highest(q);
+        assert_uint32(peek->n, ==, i);
+        big_msg m;
+        PQ_pop_highest(q, &m);
+        assert_uint32(m.n, ==, i);
+        assert_uint8(m.data[0], ==, i);
+        assert_uint8(m.data[sizeof(m.data) - 1], ==, i);
+    }
+
+    PQ_destroy(&q);
+    assert_null(q);
+    return MUNIT_OK;
+}
+
+MunitResult test_aging_matches_eager(const MunitParameter *params, void *data) {
+    PQ_QueueTypeDef eager_list, eager_heap, lazy_heap;
+    PQ_init(&eager_list, PQ_SIZE, sizeof(uint32_t), _cmp_op, _pop_op);
+    PQ_init_heap(&eager_heap, PQ_SIZE, sizeof(uint32_t), _cmp_op, _pop_op);
+    PQ_init_heap(&lazy_heap, PQ_SIZE, sizeof(uint32_t), NULL, NULL);
+    assert_true(PQ_set_aging(lazy_heap, 1));
+
+    /* Base priorities high enough for the decrements not to wrap */
+    srand(42);
+    uint32_t id = 0, queued = 0;
+    for (int step = 0; step < 2000; step++) {
+        if (queued == PQ_SIZE || id == 1000 || (queued > 0 && rand() % 2 == 0)) {
+            if (queued == 0)
+                break;
+            uint32_t a, b, c;
+            PQ_pop_highest(eager_list, &a);
+            PQ_pop_highest(eager_heap, &b);
+            PQ_pop_highest(lazy_heap, &c);
+            assert_uint32(a, ==, c);
+            assert_uint32(b, ==, c);
+            queued--;
+        } else {
+            PQ_PriorityTypeDef priority = 2000 + rand() % 32;
+            assert_true(PQ_insert(eager_list, priority, &id));
+            assert_true(PQ_insert(eager_heap, priority, &id));
+            assert_true(PQ_insert(lazy_heap, priority, &id));
+            id++;
+            queued++;
+        }
+    }
+
+    PQ_destroy(&eager_list);
+    PQ_destroy(&eager_heap);
+    PQ_destroy(&lazy_heap);
+    return MUNIT_OK;
+}
+
+MunitResult test_aging_starvation_bound(const MunitParameter *params, void *data) {
+    PQ_QueueTypeDef q;
+    PQ_init_heap(&q, PQ_SIZE, sizeof(msg), NULL, NULL);
+    assert_true(PQ_set_aging(q, 4));
+
+    /* Under a stream of highest priority messages, a message with priority p
+     * waits p * pops_per_level pops */
+    msg low = {100, "low"};
+    PQ_insert(q, 100, &low);
+    int step;
+    for (step = 0; step < 1000; step++) {
+        msg m = {0, "high"};
+        PQ_insert(q, 0, &m);
+        PQ_pop_highest(q, &m);
+        if (m.n == 100)
+            break;
+    }
+    assert_int(step, ==, 100 * 4);
+
+    /* It also waits for the messages queued ahead of it: the 50 old ones and
+     * the new ones inserted in the first 10 * 4 pops */
+    while (!PQ_is_empty(q))
+        PQ_pop_highest(q, NULL);
+    for (int i = 0; i < 50; i++) {
+        msg m = {0, "old"};
+        PQ_insert(q, 0, &m);
+    }
+    PQ_insert(q, 10, &low);
+    for (step = 0; step < 1000; step++) {
+        msg m = {0, "new"};
+        PQ_insert(q, 0, &m);
+        PQ_pop_highest(q, &m);
+        if (m.n == 100)
+            break;
+    }
+    assert_int(step, ==, 50 + 10 * 4);
+
+    PQ_destroy(&q);
+    return MUNIT_OK;
+}
+
+MunitResult test_aging_invalid(const MunitParameter *params, void *data) {
+    PQ_QueueTypeDef list, heap;
+    PQ_init(&list, PQ_SIZE, sizeof(msg), NULL, NULL);
+    PQ_init_heap(&heap, PQ_SIZE, sizeof(msg), NULL, NULL);
+
+    assert_false(PQ_set_aging(list, 1));
+    msg m = {0, "abc"};
+    PQ_insert(heap, 0, &m);
+    assert_false(PQ_set_aging(heap, 1));
+    PQ_pop_highest(heap, NULL);
+    assert_true(PQ_set_aging(heap, 1));
+    assert_true(PQ_set_aging(heap, 0));
+
+    PQ_destroy(&list);
+    PQ_destroy(&heap);
+    return MUNIT_OK;
+}
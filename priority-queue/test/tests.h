@@ -11,5 +11,32 @@ MunitResult test_random_insert(const MunitParameter *, void *);
 MunitResult test_no_starvation(const MunitParameter *, void *);
 MunitResult test_null_cmp_fn(const MunitParameter *, void *);
 MunitResult test_pop_out_param(const MunitParameter *, void *);
+MunitResult test_full_queue(const MunitParameter *, void *);
+MunitResult test_same_priority_fifo(const MunitParameter *, void *);
+MunitResult test_large_payload(const MunitParameter *, void *);
+MunitResult test_aging_matches_eager(const MunitParameter *, void *);
+MunitResult test_aging_starvation_bound(const MunitParameter *, void *);
+MunitResult test_aging_invalid(const MunitParameter *, void *);
+
+MunitResult test_bucket_levels(const MunitParameter *, void *);
+MunitResult test_bucket_fifo(const MunitParameter *, void *);
+MunitResult test_bucket_full_and_range(const MunitParameter *, void *);
+MunitResult test_bucket_many_levels(const MunitParameter *, void *);
+MunitResult test_bucket_random(const MunitParameter *, void *);
+MunitResult test_bucket_invalid_init(const MunitParameter *, void *);
+
+MunitResult test_fast_insert_full_queue(const MunitParameter *, void *);
+MunitResult test_fast_insert_same_priority_fifo(const MunitParameter *, void *);
+MunitResult test_fast_insert_bursts(const MunitParameter *, void *);
+MunitResult test_fast_insert_sort_mode(const MunitParameter *, void *);
+
+MunitResult test_heap_order(const MunitParameter *, void *);
+MunitResult test_heap_full(const MunitParameter *, void *);
+
+MunitResult test_typed_full(const MunitParameter *, void *);
+MunitResult test_typed_random(const MunitParameter *, void *);
+MunitResult test_typed_null_out(const MunitParameter *, void *);
+MunitResult test_typed_bucket_range(const MunitParameter *, void *);
+MunitResult test_typed_compare(const MunitParameter *, void *);
 
 #endif
\ No newline at end of file
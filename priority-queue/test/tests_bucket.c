@@ -0,0 +1,142 @@
+#include <stdlib.h>
+#include <string.h>
+
+#define MUNIT_ENABLE_ASSERT_ALIASES
+#include "../../munit/munit.h"
+#include "../priority_queue_bucket.h"
+#include "tests.h"
+
+#define PQB_SIZE 100
+#define PQB_LEVELS 8
+
+typedef struct msg {
+    uint16_t n;
+    char c[6];
+} msg;
+
+static uint32_t mem[PQB_MEM_SIZE(PQB_MAX_LEVELS, PQB_SIZE, sizeof(msg)) / 4 + 1];
+
+MunitResult test_bucket_levels(const MunitParameter *params, void *data) {
+    PQB pq;
+    assert_true(PQB_init(&pq, PQB_LEVELS, PQB_SIZE, sizeof(msg), mem));
+    assert_true(PQB_is_empty(&pq));
+
+    for (int i = 0; i < PQB_LEVELS; i++) {
+        msg m = {PQB_LEVELS - 1 - i, "abc"};
+        assert_true(PQB_insert(&pq, PQB_LEVELS - 1 - i, &m));
+    }
+    assert_false(PQB_is_empty(&pq));
+
+    for (int i = 0; i < PQB_LEVELS; i++) {
+        msg m;
+        PQB_PriorityTypeDef priority;
+        assert_true(PQB_pop(&pq, &priority, &m));
+        assert_uint16(priority, ==, i);
+        assert_uint16(m.n, ==, i);
+    }
+    assert_true(PQB_is_empty(&pq));
+    assert_false(PQB_pop(&pq, NULL, NULL));
+    return MUNIT_OK;
+}
+
+MunitResult test_bucket_fifo(const MunitParameter *params, void *data) {
+    PQB pq;
+    PQB_init(&pq, PQB_LEVELS, PQB_SIZE, sizeof(msg), mem);
+
+    for (int i = 0; i < PQB_SIZE; i++) {
+        msg m = {i, "abc"};
+        PQB_insert(&pq, i % 3, &m);
+    }
+
+    /* Same order of a stable sort by priority */
+    for (int level = 0; level < 3; level++) {
+        for (int i = level; i < PQB_SIZE; i += 3) {
+            msg m;
+            PQB_PriorityTypeDef priority;
+            assert_true(PQB_top(&pq, &priority, &m));
+            assert_uint16(m.n, ==, i);
+            assert_true(PQB_pop(&pq, &priority, &m));
+            assert_uint16(priority, ==, level);
+            assert_uint16(m.n, ==, i);
+        }
+    }
+    assert_true(PQB_is_empty(&pq));
+    return MUNIT_OK;
+}
+
+MunitResult test_bucket_full_and_range(const MunitParameter *params, void *data) {
+    PQB pq;
+    PQB_init(&pq, PQB_LEVELS, PQB_SIZE, sizeof(msg), mem);
+
+    msg m = {0, "abc"};
+    assert_false(PQB_insert(&pq, PQB_LEVELS, &m));
+    for (int i = 0; i < PQB_SIZE; i++)
+        assert_true(PQB_insert(&pq, PQB_LEVELS - 1, &m));
+    assert_true(PQB_is_full(&pq));
+    assert_false(PQB_insert(&pq, 0, &m));
+
+    /* A pop frees a slot for the next insert */
+    assert_true(PQB_pop(&pq, NULL, NULL));
+    m.n = 42;
+    assert_true(PQB_insert(&pq, 0, &m));
+    assert_true(PQB_top(&pq, NULL, &m));
+    assert_uint16(m.n, ==, 42);
+    return MUNIT_OK;
+}
+
+MunitResult test_bucket_many_levels(const MunitParameter *params, void *data) {
+    PQB pq;
+    assert_true(PQB_init(&pq, PQB_MAX_LEVELS, PQB_SIZE, sizeof(msg), mem));
+
+    /* Levels in different bitmap words */
+    PQB_PriorityTypeDef levels[] = {1023, 31, 32, 0, 700, 63, 64, 1000};
+    PQB_PriorityTypeDef sorted[] = {0, 31, 32, 63, 64, 700, 1000, 1023};
+    for (size_t i = 0; i < sizeof(levels) / sizeof(levels[0]); i++) {
+        msg m = {levels[i], "abc"};
+        assert_true(PQB_insert(&pq, levels[i], &m));
+    }
+    for (size_t i = 0; i < sizeof(sorted) / sizeof(sorted[0]); i++) {
+        msg m;
+        PQB_PriorityTypeDef priority;
+        assert_true(PQB_pop(&pq, &priority, &m));
+        assert_uint16(priority, ==, sorted[i]);
+        assert_uint16(m.n, ==, sorted[i]);
+    }
+    assert_true(PQB_is_empty(&pq));
+    return MUNIT_OK;
+}
+
+MunitResult test_bucket_random(const MunitParameter *params, void *data) {
+    PQB pq;
+    PQB_init(&pq, PQB_MAX_LEVELS, PQB_SIZE, sizeof(msg), mem);
+
+    /* Interleave inserts and pops, the popped priorities never decrease between inserts */
+    srand(42);
+    int inserted = 0, popped = 0;
+    while (popped < 10 * PQB_SIZE) {
+        if (!PQB_is_full(&pq) && (PQB_is_empty(&pq) || rand() % 2)) {
+            msg m = {rand() % PQB_MAX_LEVELS, "abc"};
+            assert_true(PQB_insert(&pq, m.n, &m));
+            inserted++;
+        } else {
+            msg m;
+            PQB_PriorityTypeDef priority, next;
+            assert_true(PQB_pop(&pq, &priority, &m));
+            assert_uint16(priority, ==, m.n);
+            if (PQB_top(&pq, &next, NULL))
+                assert_uint16(next, >=, priority);
+            popped++;
+        }
+    }
+    assert_int(inserted - popped, ==, pq.elem_cnt);
+    return MUNIT_OK;
+}
+
+MunitResult test_bucket_invalid_init(const MunitParameter *params, void *data) {
+    PQB pq;
+    assert_false(PQB_init(&pq, 0, PQB_SIZE, sizeof(msg), mem));
+    assert_false(PQB_init(&pq, PQB_MAX_LEVELS + 1, PQB_SIZE, sizeof(msg), mem));
+    assert_false(PQB_init(&pq, PQB_LEVELS, PQB_SIZE, sizeof(msg), NULL));
+    assert_false(PQB_init(NULL, PQB_LEVELS, PQB_SIZE, sizeof(msg), mem));
+    return MUNIT_OK;
+}
@@ -0,0 +1,130 @@
+#include <stdlib.h>
+#include <string.h>
+
+#define MUNIT_ENABLE_ASSERT_ALIASES
+#include "../../munit/munit.h"
+#include "../priority_queue_fast_insert.h"
+#include "tests.h"
+
+#define PQFI_SIZE 64
+
+typedef struct msg {
+    uint16_t priority;
+    uint16_t seq;
+} msg;
+
+/* Lower value, higher priority (as CAN IDs) */
+bool _pqfi_cmp(PQFI_PriorityTypeDef a, PQFI_PriorityTypeDef b) {
+    return a < b;
+}
+
+/* Initialize the queue with the sort mode given by the "sort" parameter */
+PQFI_HandleTypeDef _init_pqfi(const MunitParameter *params) {
+    PQFI_HandleTypeDef q = PQFI_init(PQFI_SIZE, sizeof(msg), _pqfi_cmp, NULL);
+    const char *sort     = munit_parameters_get(params, "sort");
+    if (sort != NULL && strcmp(sort, "merge") == 0)
+        assert_true(PQFI_set_sort_mode(q, PQFI_SORT_MERGE));
+    return q;
+}
+
+/* Check that a popped message is the first of the queued ones by priority, then insertion */
+static void _check_popped(msg *queued, size_t *queued_cnt, msg *popped) {
+    size_t best = 0;
+    for (size_t i = 1; i < *queued_cnt; i++) {
+        if (queued[i].priority < queued[best].priority ||
+            (queued[i].priority == queued[best].priority && queued[i].seq < queued[best].seq))
+            best = i;
+    }
+    assert_uint16(popped->priority, ==, queued[best].priority);
+    assert_uint16(popped->seq, ==, queued[best].seq);
+    queued[best] = queued[--(*queued_cnt)];
+}
+
+MunitResult test_fast_insert_full_queue(const MunitParameter *params, void *data) {
+    PQFI_HandleTypeDef q = _init_pqfi(params);
+
+    /* With a full queue the head is also the tail */
+    for (int i = 0; i < PQFI_SIZE; i++) {
+        msg m = {PQFI_SIZE - 1 - i, i};
+        assert_true(PQFI_insert(q, m.priority, &m));
+    }
+    assert_true(PQFI_is_full(q));
+    assert_false(PQFI_insert(q, 0, &(msg){0, 0}));
+
+    for (int i = 0; i < PQFI_SIZE; i++) {
+        msg m;
+        assert_true(PQFI_pop(q, &m));
+        assert_uint16(m.priority, ==, i);
+    }
+    assert_true(PQFI_is_empty(q));
+
+    PQFI_destroy(q);
+    return MUNIT_OK;
+}
+
+MunitResult test_fast_insert_same_priority_fifo(const MunitParameter *params, void *data) {
+    PQFI_HandleTypeDef q = _init_pqfi(params);
+
+    for (int i = 0; i < PQFI_SIZE; i++) {
+        msg m = {i % 4, i};
+        PQFI_insert(q, m.priority, &m);
+    }
+    for (int level = 0; level < 4; level++) {
+        for (int i = level; i < PQFI_SIZE; i += 4) {
+            msg m;
+            PQFI_pop(q, &m);
+            assert_uint16(m.priority, ==, level);
+            assert_uint16(m.seq, ==, i);
+        }
+    }
+
+    PQFI_destroy(q);
+    return MUNIT_OK;
+}
+
+MunitResult test_fast_insert_bursts(const MunitParameter *params, void *data) {
+    PQFI_HandleTypeDef q = _init_pqfi(params);
+    msg queued[PQFI_SIZE];
+    size_t queued_cnt = 0;
+    uint16_t seq      = 0;
+
+    /* Bursts of inserts (as from an interrupt) between a few pops, the buffer wraps around */
+    srand(42);
+    for (int round = 0; round < 200; round++) {
+        int burst = rand() % (PQFI_SIZE / 2);
+        for (int i = 0; i < burst && queued_cnt < PQFI_SIZE; i++) {
+            msg m = {rand() % 16, seq++};
+            assert_true(PQFI_insert(q, m.priority, &m));
+            queued[queued_cnt++] = m;
+        }
+        int pops = rand() % (PQFI_SIZE / 2);
+        for (int i = 0; i < pops && queued_cnt > 0; i++) {
+            msg m;
+            assert_true(PQFI_pop(q, &m));
+            _check_popped(queued, &queued_cnt, &m);
+        }
+    }
+    while (queued_cnt > 0) {
+        msg m;
+        assert_true(PQFI_pop(q, &m));
+        _check_popped(queued, &queued_cnt, &m);
+    }
+    assert_true(PQFI_is_empty(q));
+
+    PQFI_destroy(q);
+    return MUNIT_OK;
+}
+
+MunitResult test_fast_insert_sort_mode(const MunitParameter *params, void *data) {
+    PQFI_HandleTypeDef q = PQFI_init(PQFI_SIZE, sizeof(msg), _pqfi_cmp, NULL);
+
+    msg m = {1, 0};
+    PQFI_insert(q, m.priority, &m);
+    assert_false(PQFI_set_sort_mode(q, PQFI_SORT_MERGE));
+    PQFI_pop(q, &m);
+    assert_true(PQFI_set_sort_mode(q, PQFI_SORT_MERGE));
+    assert_true(PQFI_set_sort_mode(q, PQFI_SORT_INSERTION));
+
+    PQFI_destroy(q);
+    return MUNIT_OK;
+}
@@ -0,0 +1,98 @@
+#include <stdlib.h>
+#include <string.h>
+
+#define MUNIT_ENABLE_ASSERT_ALIASES
+#include "../../munit/munit.h"
+#include "../priority_queue_heap.h"
+#include "tests.h"
+
+#define PQH_SIZE 100
+
+/* Payload larger than a word, every byte is checked after the moves */
+typedef struct msg {
+    int priority;
+    uint8_t fill[36];
+} msg;
+
+/* One more member than the elements for the moves */
+static uint8_t queue[(PQH_SIZE + 1) * sizeof(msg)];
+static int priorities[PQH_SIZE + 1];
+
+/* Compare function given by the "compare" parameter */
+static bool (*_compare(const MunitParameter *params))(int, int) {
+    const char *compare = munit_parameters_get(params, "compare");
+    if (compare != NULL && strcmp(compare, "GE") == 0)
+        return PQH_GE;
+    if (compare != NULL && strcmp(compare, "LT") == 0)
+        return PQH_LT;
+    if (compare != NULL && strcmp(compare, "LE") == 0)
+        return PQH_LE;
+    return PQH_GT;
+}
+
+static msg _msg(int priority) {
+    msg m = {priority, {0}};
+    memset(m.fill, priority & 0xFF, sizeof(m.fill));
+    return m;
+}
+
+static void _check_msg(msg *m, int priority) {
+    assert_int(m->priority, ==, priority);
+    for (size_t i = 0; i < sizeof(m->fill); i++)
+        assert_uint8(m->fill[i], ==, priority & 0xFF);
+}
+
+MunitResult test_heap_order(const MunitParameter *params, void *data) {
+    PQH pq;
+    bool (*compare)(int, int) = _compare(params);
+    PQH_init(&pq, sizeof(queue), sizeof(msg), queue, priorities, compare);
+
+    /* Interleave inserts and pops, each pop is the first of the queued priorities */
+    int queued[PQH_SIZE];
+    int queued_cnt = 0;
+    srand(42);
+    for (int i = 0; i < 20 * PQH_SIZE; i++) {
+        if (!PQH_is_full(&pq) && (PQH_is_empty(&pq) || rand() % 2)) {
+            msg m = _msg(rand() % 1000 - 500);
+            assert_true(PQH_insert(&pq, m.priority, (uint8_t *)&m));
+            queued[queued_cnt++] = m.priority;
+        } else {
+            int best = 0;
+            for (int j = 1; j < queued_cnt; j++)
+                if (compare(queued[best], queued[j]))
+                    best = j;
+
+            msg m;
+            int priority;
+            assert_true(PQH_pop(&pq, &priority, (uint8_t *)&m));
+            assert_int(priority, ==, queued[best]);
+            _check_msg(&m, priority);
+            queued[best] = queued[--queued_cnt];
+        }
+        assert_int(pq.elem_cnt, ==, queued_cnt);
+    }
+    return MUNIT_OK;
+}
+
+MunitResult test_heap_full(const MunitParameter *params, void *data) {
+    PQH pq;
+    PQH_init(&pq, sizeof(queue), sizeof(msg), queue, priorities, PQH_GT);
+
+    for (int i = 0; i < PQH_SIZE; i++) {
+        msg m = _msg(PQH_SIZE - 1 - i);
+        assert_true(PQH_insert(&pq, m.priority, (uint8_t *)&m));
+    }
+    assert_true(PQH_is_full(&pq));
+    msg m = _msg(0);
+    assert_false(PQH_insert(&pq, 0, (uint8_t *)&m));
+
+    for (int i = 0; i < PQH_SIZE; i++) {
+        int priority;
+        assert_true(PQH_pop(&pq, &priority, (uint8_t *)&m));
+        assert_int(priority, ==, i);
+        _check_msg(&m, i);
+    }
+    assert_true(PQH_is_empty(&pq));
+    assert_false(PQH_pop(&pq, NULL, NULL));
+    return MUNIT_OK;
+}
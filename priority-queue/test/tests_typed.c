@@ -0,0 +1,180 @@
+#include <stdlib.h>
+#include <string.h>
+
+#define MUNIT_ENABLE_ASSERT_ALIASES
+#include "../../munit/munit.h"
+#include "../priority_queue_typed.h"
+#include "tests.h"
+
+#define PQT_SIZE 64
+#define PQT_LEVELS 8
+
+typedef struct msg {
+    uint16_t priority;
+    uint16_t seq;
+} msg;
+
+/* Lower value, higher priority (as CAN IDs) */
+#define LOWER_FIRST(a, b) ((a) < (b))
+#define GREATER_FIRST(a, b) ((a) > (b))
+
+PQT_DEFINE_HEAP(heap_queue, msg, uint16_t, PQT_SIZE, LOWER_FIRST)
+PQT_DEFINE_BUCKET(bucket_queue, msg, PQT_LEVELS, PQT_SIZE)
+PQT_DEFINE_RING(ring_queue, msg, uint16_t, PQT_SIZE, LOWER_FIRST)
+
+PQT_DEFINE_HEAP(int_heap_queue, msg, int, PQT_SIZE, GREATER_FIRST)
+PQT_DEFINE_RING(int_ring_queue, msg, int, PQT_SIZE, GREATER_FIRST)
+
+/* Same tests on every backend, selected by the "backend" parameter */
+typedef struct {
+    const char *name;
+    void (*init)(void);
+    bool (*insert)(uint16_t, const msg *);
+    bool (*peek)(uint16_t *, msg *);
+    bool (*pop)(uint16_t *, msg *);
+    bool (*is_full)(void);
+    bool (*is_empty)(void);
+    uint16_t (*count)(void);
+} typed_queue;
+
+#define TYPED_QUEUE(NAME)                                                                            \
+    static NAME NAME##_q;                                                                            \
+    static void NAME##_t_init(void) { NAME##_init(&NAME##_q); }                                      \
+    static bool NAME##_t_insert(uint16_t p, const msg *m) { return NAME##_insert(&NAME##_q, p, m); } \
+    static bool NAME##_t_peek(uint16_t *p, msg *m) { return NAME##_peek(&NAME##_q, p, m); }          \
+    static bool NAME##_t_pop(uint16_t *p, msg *m) { return NAME##_pop(&NAME##_q, p, m); }            \
+    static bool NAME##_t_is_full(void) { return NAME##_is_full(&NAME##_q); }                         \
+    static bool NAME##_t_is_empty(void) { return NAME##_is_empty(&NAME##_q); }                       \
+    static uint16_t NAME##_t_count(void) { return NAME##_count(&NAME##_q); }                         \
+    static typed_queue NAME##_t = {#NAME,          NAME##_t_init,    NAME##_t_insert,  NAME##_t_peek, \
+                                   NAME##_t_pop,   NAME##_t_is_full, NAME##_t_is_empty, NAME##_t_count};
+
+TYPED_QUEUE(heap_queue)
+TYPED_QUEUE(bucket_queue)
+TYPED_QUEUE(ring_queue)
+
+static typed_queue *_backend(const MunitParameter *params) {
+    const char *backend = munit_parameters_get(params, "backend");
+    typed_queue *q      = &heap_queue_t;
+    if (backend != NULL && strcmp(backend, "bucket") == 0)
+        q = &bucket_queue_t;
+    else if (backend != NULL && strcmp(backend, "ring") == 0)
+        q = &ring_queue_t;
+    q->init();
+    return q;
+}
+
+/* Check that a popped message is the first of the queued ones by priority, then insertion */
+static void _check_popped(msg *queued, size_t *queued_cnt, uint16_t priority, msg *popped) {
+    size_t best = 0;
+    for (size_t i = 1; i < *queued_cnt; i++) {
+        if (queued[i].priority < queued[best].priority ||
+            (queued[i].priority == queued[best].priority && queued[i].seq < queued[best].seq))
+            best = i;
+    }
+    assert_uint16(priority, ==, queued[best].priority);
+    assert_uint16(popped->priority, ==, queued[best].priority);
+    assert_uint16(popped->seq, ==, queued[best].seq);
+    queued[best] = queued[--(*queued_cnt)];
+}
+
+MunitResult test_typed_full(const MunitParameter *params, void *data) {
+    typed_queue *q = _backend(params);
+    assert_true(q->is_empty());
+
+    for (int i = 0; i < PQT_SIZE; i++) {
+        msg m = {(PQT_SIZE - 1 - i) % PQT_LEVELS, i};
+        assert_true(q->insert(m.priority, &m));
+    }
+    assert_true(q->is_full());
+    assert_uint16(q->count(), ==, PQT_SIZE);
+    assert_false(q->insert(0, &(msg){0, 0}));
+
+    /* Same order of a stable sort by priority */
+    for (int level = 0; level < PQT_LEVELS; level++) {
+        for (int i = PQT_LEVELS - 1 - level; i < PQT_SIZE; i += PQT_LEVELS) {
+            msg m;
+            uint16_t priority;
+            assert_true(q->pop(&priority, &m));
+            assert_uint16(priority, ==, level);
+            assert_uint16(m.seq, ==, i);
+        }
+    }
+    assert_true(q->is_empty());
+    return MUNIT_OK;
+}
+
+MunitResult test_typed_random(const MunitParameter *params, void *data) {
+    typed_queue *q = _backend(params);
+    msg queued[PQT_SIZE];
+    size_t queued_cnt = 0;
+    uint16_t seq      = 0;
+
+    srand(42);
+    for (int i = 0; i < 20 * PQT_SIZE; i++) {
+        if (queued_cnt < PQT_SIZE && (queued_cnt == 0 || rand() % 2)) {
+            msg m = {rand() % PQT_LEVELS, seq++};
+            assert_true(q->insert(m.priority, &m));
+            queued[queued_cnt++] = m;
+        } else {
+            msg top, m;
+            uint16_t top_priority, priority;
+            assert_true(q->peek(&top_priority, &top));
+            assert_true(q->pop(&priority, &m));
+            assert_uint16(top_priority, ==, priority);
+            assert_uint16(top.seq, ==, m.seq);
+            _check_popped(queued, &queued_cnt, priority, &m);
+        }
+        assert_uint16(q->count(), ==, queued_cnt);
+    }
+    return MUNIT_OK;
+}
+
+MunitResult test_typed_null_out(const MunitParameter *params, void *data) {
+    typed_queue *q = _backend(params);
+    assert_false(q->peek(NULL, NULL));
+    assert_false(q->pop(NULL, NULL));
+
+    msg m = {3, 0};
+    q->insert(m.priority, &m);
+    assert_true(q->peek(NULL, NULL));
+    assert_true(q->pop(NULL, NULL));
+    assert_true(q->is_empty());
+    return MUNIT_OK;
+}
+
+MunitResult test_typed_bucket_range(const MunitParameter *params, void *data) {
+    bucket_queue q;
+    bucket_queue_init(&q);
+
+    msg m = {PQT_LEVELS, 0};
+    assert_false(bucket_queue_insert(&q, PQT_LEVELS, &m));
+    assert_true(bucket_queue_insert(&q, PQT_LEVELS - 1, &m));
+    return MUNIT_OK;
+}
+
+MunitResult test_typed_compare(const MunitParameter *params, void *data) {
+    static int_heap_queue heap;
+    static int_ring_queue ring;
+    int_heap_queue_init(&heap);
+    int_ring_queue_init(&ring);
+
+    /* Greater first with negative priorities */
+    int priorities[] = {-5, 7, 0, -100, 7, 3};
+    int sorted[]     = {7, 7, 3, 0, -5, -100};
+    for (size_t i = 0; i < sizeof(priorities) / sizeof(priorities[0]); i++) {
+        msg m = {0, i};
+        int_heap_queue_insert(&heap, priorities[i], &m);
+        int_ring_queue_insert(&ring, priorities[i], &m);
+    }
+    for (size_t i = 0; i < sizeof(sorted) / sizeof(sorted[0]); i++) {
+        int heap_priority, ring_priority;
+        msg heap_m, ring_m;
+        assert_true(int_heap_queue_pop(&heap, &heap_priority, &heap_m));
+        assert_true(int_ring_queue_pop(&ring, &ring_priority, &ring_m));
+        assert_int(heap_priority, ==, sorted[i]);
+        assert_int(ring_priority, ==, sorted[i]);
+        assert_uint16(heap_m.seq, ==, ring_m.seq);
+    }
+    return MUNIT_OK;
+}
@@ -91,7 +91,8 @@ typedef enum {
     RING_BUFFER_OK,
     RING_BUFFER_NULL_POINTER,
     RING_BUFFER_EMPTY,
-    RING_BUFFER_FULL
+    RING_BUFFER_FULL,
+    RING_BUFFER_INVALID_CAPACITY
 } RingBufferReturnCode;
 
 
@@ -242,6 +243,151 @@ typedef enum {
  */
 #define ring_buffer_clear(buffer) _ring_buffer_clear((RingBufferInterface *)(buffer))
 
+/**
+ * @brief Type definition for the single producer single consumer ring buffer handler structure
+ * @details The buffer can be used without critical sections if only one context
+ * (e.g. an interrupt) pushes the items and only one context (e.g. the main loop) pops them
+ *
+ * As an example you can declare and initialize a new SPSC ring buffer structure
+ * that contains 16 integers as follows:
+ *      SpscRingBuffer(int, 16) buf = ring_buffer_spsc_new(int, 16);
+ *
+ * @attention The capacity must be a power of two
+ *
+ * @param TYPE The data type of the items
+ * @param CAPACITY The maximum number of elements of the buffer
+ *
+ * @param head The number of pushed items (modified only by the producer)
+ * @param tail The number of popped items (modified only by the consumer)
+ * @param data_size The size of a single element in bytes
+ * @param capacity The maximum number of elements that the buffer can contain
+ */
+#define SpscRingBuffer(TYPE, CAPACITY) \
+struct { \
+    size_t head; \
+    size_t tail; \
+    uint16_t data_size; \
+    size_t capacity; \
+    TYPE data[CAPACITY]; \
+}
+
+/**
+ * @brief SPSC ring buffer handler structure initialization
+ * @attention The TYPE and CAPACITY parameters must be the same as the ones
+ * used in the structure declaration above
+ *
+ * @details If the ring_buffer_spsc_init function is used this macro is not needed
+ *
+ * @param TYPE The data type of the items
+ * @param CAPACITY The maximum number of elements of the buffer (power of two)
+ */
+#define ring_buffer_spsc_new(TYPE, CAPACITY) \
+{ \
+    .head = 0, \
+    .tail = 0, \
+    .data_size = sizeof(TYPE), \
+    .capacity = CAPACITY \
+}
+
+/**
+ * @brief Structure definition used to pass the SPSC buffer handler as a function parameter
+ * @attention This function should not be used directly
+ */
+typedef struct {
+    size_t head;
+    size_t tail;
+    uint16_t data_size;
+    size_t capacity;
+    void * data;
+} SpscRingBufferInterface;
+
+/**
+ * @brief Initialize the SPSC buffer
+ * @attention The type and capacity parameters must be the same as the ones
+ * used in the structure declaration above
+ *
+ * @details If the ring_buffer_spsc_new macro is used this function is not needed
+ *
+ * @param buffer The buffer hanler structure
+ * @param type The type of the items
+ * @param capacity The maximum number of elements of the buffer (power of two)
+ * @return RingBufferReturnCode
+ *     - RING_BUFFER_NULL_POINTER if the buffer handler is NULL
+ *     - RING_BUFFER_INVALID_CAPACITY if the capacity is not a power of two
+ *     - RING_BUFFER_OK otherwise
+ */
+#define ring_buffer_spsc_init(buffer, type, capacity) _ring_buffer_spsc_init((SpscRingBufferInterface *)(buffer), sizeof(type), capacity)
+
+/**
+ * @brief Get the current number of elements in the SPSC buffer
+ *
+ * @param buffer The buffer handler structure
+ * @return size_t The buffer size
+ */
+#define ring_buffer_spsc_size(buffer) _ring_buffer_spsc_size((SpscRingBufferInterface *)(buffer))
+
+/**
+ * @brief Insert an element at the end of the SPSC buffer
+ * @attention This function must be called only by the producer
+ *
+ * @param buffer The buffer handler structure
+ * @param item A pointer to the item to insert
+ * @return RingBufferReturnCode
+ *     - RING_BUFFER_NULL_POINTER if the buffer handler or the item are NULL
+ *     - RING_BUFFER_FULL if the buffer is full
+ *     - RING_BUFFER_OK otherwise
+ */
+#define ring_buffer_spsc_push(buffer, item) _ring_buffer_spsc_push((SpscRingBufferInterface *)(buffer), (void *)(item))
+
+/**
+ * @brief Get a pointer to the free slot at the end of the SPSC buffer
+ * @details The item can be written directly inside the buffer, it is inserted
+ * only after ring_buffer_spsc_commit is called
+ * @attention This function must be called only by the producer
+ *
+ * @param buffer The buffer handler structure
+ * @return void * The free slot or NULL if the buffer is full
+ */
+#define ring_buffer_spsc_reserve(buffer) _ring_buffer_spsc_reserve((SpscRingBufferInterface *)(buffer))
+
+/**
+ * @brief Insert the item written in the slot given by ring_buffer_spsc_reserve
+ * @attention This function must be called only by the producer
+ *
+ * @param buffer The buffer handler structure
+ * @return RingBufferReturnCode
+ *     - RING_BUFFER_NULL_POINTER if the buffer handler is NULL
+ *     - RING_BUFFER_FULL if the buffer is full
+ *     - RING_BUFFER_OK otherwise
+ */
+#define ring_buffer_spsc_commit(buffer) _ring_buffer_spsc_commit((SpscRingBufferInterface *)(buffer))
+
+/**
+ * @brief Remove an element from the front of the SPSC buffer
+ * @details The 'out' parameter can be NULL
+ * @attention This function must be called only by the consumer
+ *
+ * @param buffer The buffer handler structure
+ * @param out A pointer to a variable where the removed item is copied into
+ * @return RingBufferReturnCode
+ *     - RING_BUFFER_NULL_POINTER if the buffer handler is NULL
+ *     - RING_BUFFER_EMPTY if the buffer is empty
+ *     - RING_BUFFER_OK otherwise
+ */
+#define ring_buffer_spsc_pop(buffer, out) _ring_buffer_spsc_pop((SpscRingBufferInterface *)(buffer), (void *)(out))
+
+/**
+ * @brief Remove multiple elements from the front of the SPSC buffer
+ * @details The items are copied with at most two memcpy calls
+ * @attention This function must be called only by the consumer
+ *
+ * @param buffer The buffer handler structure
+ * @param out An array where the removed items are copied into
+ * @param count The maximum number of items to remove
+ * @return size_t The number of removed items
+ */
+#define ring_buffer_spsc_pop_n(buffer, out, count) _ring_buffer_spsc_pop_n((SpscRingBufferInterface *)(buffer), (void *)(out), count)
+
 /******************************************/
 /*   DO NOT USE THE FOLLOWING FUNCTIONS   */
 /*         USE THE MACRO INSTEAD          */
@@ -267,6 +413,14 @@ void * _ring_buffer_peek_front(RingBufferInterface * buffer);
 void * _ring_buffer_peek_back(RingBufferInterface * buffer);
 RingBufferReturnCode _ring_buffer_clear(RingBufferInterface * buffer);
 
+RingBufferReturnCode _ring_buffer_spsc_init(SpscRingBufferInterface * buffer, size_t data_size, size_t capacity);
+size_t _ring_buffer_spsc_size(SpscRingBufferInterface * buffer);
+RingBufferReturnCode _ring_buffer_spsc_push(SpscRingBufferInterface * buffer, void * item);
+void * _ring_buffer_spsc_reserve(SpscRingBufferInterface * buffer);
+RingBufferReturnCode _ring_buffer_spsc_commit(SpscRingBufferInterface * buffer);
+RingBufferReturnCode _ring_buffer_spsc_pop(SpscRingBufferInterface * buffer, void * out);
+size_t _ring_buffer_spsc_pop_n(SpscRingBufferInterface * buffer, void * out, size_t count);
+
 // Function that substitute cs_enter and cs_exit if they are NULL
 void _ring_buffer_cs_dummy(void);
 
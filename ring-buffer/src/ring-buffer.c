@@ -247,3 +247,109 @@ RingBufferReturnCode _ring_buffer_clear(RingBufferInterface * buffer) {
     return RING_BUFFER_OK;
 }
 
+
+/*
+ * The head is written only by the producer and the tail only by the consumer,
+ * the acquire/release accesses make the item data visible before the index
+ * that publishes it, so no critical section is needed
+ */
+
+RingBufferReturnCode _ring_buffer_spsc_init(
+    SpscRingBufferInterface * buffer,
+    size_t data_size,
+    size_t capacity)
+{
+    if (buffer == NULL)
+        return RING_BUFFER_NULL_POINTER;
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0)
+        return RING_BUFFER_INVALID_CAPACITY;
+    buffer->head = 0;
+    buffer->tail = 0;
+    buffer->data_size = data_size;
+    buffer->capacity = capacity;
+    memset(&buffer->data, 0, capacity * data_size);
+    return RING_BUFFER_OK;
+}
+
+size_t _ring_buffer_spsc_size(SpscRingBufferInterface * buffer) {
+    if (buffer == NULL)
+        return 0U;
+    size_t head = __atomic_load_n(&buffer->head, __ATOMIC_ACQUIRE);
+    size_t tail = __atomic_load_n(&buffer->tail, __ATOMIC_ACQUIRE);
+    return head - tail;
+}
+
+void * _ring_buffer_spsc_reserve(SpscRingBufferInterface * buffer) {
+    if (buffer == NULL)
+        return NULL;
+    size_t head = __atomic_load_n(&buffer->head, __ATOMIC_RELAXED);
+    size_t tail = __atomic_load_n(&buffer->tail, __ATOMIC_ACQUIRE);
+    if (head - tail >= buffer->capacity)
+        return NULL;
+    uint8_t * base = (uint8_t *)&buffer->data;
+    return base + (head & (buffer->capacity - 1)) * buffer->data_size;
+}
+
+RingBufferReturnCode _ring_buffer_spsc_commit(SpscRingBufferInterface * buffer) {
+    if (buffer == NULL)
+        return RING_BUFFER_NULL_POINTER;
+    size_t head = __atomic_load_n(&buffer->head, __ATOMIC_RELAXED);
+    size_t tail = __atomic_load_n(&buffer->tail, __ATOMIC_ACQUIRE);
+    if (head - tail >= buffer->capacity)
+        return RING_BUFFER_FULL;
+    __atomic_store_n(&buffer->head, head + 1, __ATOMIC_RELEASE);
+    return RING_BUFFER_OK;
+}
+
+RingBufferReturnCode _ring_buffer_spsc_push(SpscRingBufferInterface * buffer, void * item) {
+    if (buffer == NULL || item == NULL)
+        return RING_BUFFER_NULL_POINTER;
+    void * slot = _ring_buffer_spsc_reserve(buffer);
+    if (slot == NULL)
+        return RING_BUFFER_FULL;
+    memcpy(slot, item, buffer->data_size);
+    return _ring_buffer_spsc_commit(buffer);
+}
+
+RingBufferReturnCode _ring_buffer_spsc_pop(SpscRingBufferInterface * buffer, void * out) {
+    if (buffer == NULL)
+        return RING_BUFFER_NULL_POINTER;
+    size_t tail = __atomic_load_n(&buffer->tail, __ATOMIC_RELAXED);
+    size_t head = __atomic_load_n(&buffer->head, __ATOMIC_ACQUIRE);
+    if (head == tail)
+        return RING_BUFFER_EMPTY;
+
+    if (out != NULL) {
+        const size_t data_size = buffer->data_size;
+        uint8_t * base = (uint8_t *)&buffer->data;
+        memcpy(out, base + (tail & (buffer->capacity - 1)) * data_size, data_size);
+    }
+    __atomic_store_n(&buffer->tail, tail + 1, __ATOMIC_RELEASE);
+    return RING_BUFFER_OK;
+}
+
+size_t _ring_buffer_spsc_pop_n(SpscRingBufferInterface * buffer, void * out, size_t count) {
+    if (buffer == NULL || out == NULL)
+        return 0U;
+    size_t tail = __atomic_load_n(&buffer->tail, __ATOMIC_RELAXED);
+    size_t head = __atomic_load_n(&buffer->head, __ATOMIC_ACQUIRE);
+    size_t available = head - tail;
+    if (count > available)
+        count = available;
+    if (count == 0)
+        return 0U;
+
+    // Copy the items until the end of the array and then from the start
+    const size_t data_size = buffer->data_size;
+    const size_t start = tail & (buffer->capacity - 1);
+    size_t first = buffer->capacity - start;
+    if (first > count)
+        first = count;
+    uint8_t * base = (uint8_t *)&buffer->data;
+    memcpy(out, base + start * data_size, first * data_size);
+    if (count > first)
+        memcpy((uint8_t *)out + first * data_size, base, (count - first) * data_size);
+
+    __atomic_store_n(&buffer->tail, tail + count, __ATOMIC_RELEASE);
+    return count;
+}
@@ -0,0 +1,194 @@
+/**
+ * @file test-ring-buffer-spsc.c
+ * @brief Unit test functions for the single producer single consumer circular buffer
+ *
+ * @date 18 Oct 2026
+ * @author Antonio Gelain [antonio.gelain2@gmail.com]
+ */
+
+#include "unity.h"
+#include "ring-buffer.h"
+
+#include <stdio.h>
+
+typedef struct {
+    float x, y;
+} Point;
+
+SpscRingBuffer(int, 8) int_buf = ring_buffer_spsc_new(int, 8);
+SpscRingBuffer(Point, 4) point_buf = ring_buffer_spsc_new(Point, 4);
+
+void setUp(void) {
+    ring_buffer_spsc_init(&int_buf, int, 8);
+    ring_buffer_spsc_init(&point_buf, Point, 4);
+}
+
+void tearDown(void) {
+
+}
+
+void check_ring_buffer_spsc_init_with_null(void) {
+    TEST_ASSERT_EQUAL_INT(RING_BUFFER_NULL_POINTER, ring_buffer_spsc_init(NULL, int, 8));
+}
+void check_ring_buffer_spsc_init_invalid_capacity(void) {
+    TEST_ASSERT_EQUAL_INT(RING_BUFFER_INVALID_CAPACITY, ring_buffer_spsc_init(&int_buf, int, 6));
+    TEST_ASSERT_EQUAL_INT(RING_BUFFER_INVALID_CAPACITY, ring_buffer_spsc_init(&int_buf, int, 0));
+}
+void check_ring_buffer_spsc_init_return_value(void) {
+    TEST_ASSERT_EQUAL_INT(RING_BUFFER_OK, ring_buffer_spsc_init(&int_buf, int, 8));
+}
+
+void check_ring_buffer_spsc_size_with_null(void) {
+    TEST_ASSERT_EQUAL_size_t(0U, ring_buffer_spsc_size(NULL));
+}
+void check_ring_buffer_spsc_size(void) {
+    int item = 1;
+    ring_buffer_spsc_push(&int_buf, &item);
+    ring_buffer_spsc_push(&int_buf, &item);
+    TEST_ASSERT_EQUAL_size_t(2U, ring_buffer_spsc_size(&int_buf));
+}
+
+void check_ring_buffer_spsc_push_with_null_item(void) {
+    TEST_ASSERT_EQUAL_INT(RING_BUFFER_NULL_POINTER, ring_buffer_spsc_push(&int_buf, NULL));
+}
+void check_ring_buffer_spsc_push_when_full(void) {
+    for (int i = 0; i < 8; ++i)
+        TEST_ASSERT_EQUAL_INT(RING_BUFFER_OK, ring_buffer_spsc_push(&int_buf, &i));
+    int item = 8;
+    TEST_ASSERT_EQUAL_INT(RING_BUFFER_FULL, ring_buffer_spsc_push(&int_buf, &item));
+    TEST_ASSERT_EQUAL_size_t(8U, ring_buffer_spsc_size(&int_buf));
+}
+
+void check_ring_buffer_spsc_pop_when_empty(void) {
+    int item;
+    TEST_ASSERT_EQUAL_INT(RING_BUFFER_EMPTY, ring_buffer_spsc_pop(&int_buf, &item));
+}
+void check_ring_buffer_spsc_pop_with_null_item(void) {
+    int item = 3;
+    ring_buffer_spsc_push(&int_buf, &item);
+    TEST_ASSERT_EQUAL_INT(RING_BUFFER_OK, ring_buffer_spsc_pop(&int_buf, NULL));
+    TEST_ASSERT_EQUAL_size_t(0U, ring_buffer_spsc_size(&int_buf));
+}
+void check_ring_buffer_spsc_pop_order_with_wrap(void) {
+    int item;
+    // Move the indices near the end of the array
+    for (int i = 0; i < 6; ++i) {
+        ring_buffer_spsc_push(&int_buf, &i);
+        ring_buffer_spsc_pop(&int_buf, &item);
+    }
+    for (int i = 0; i < 8; ++i)
+        ring_buffer_spsc_push(&int_buf, &i);
+    for (int i = 0; i < 8; ++i) {
+        TEST_ASSERT_EQUAL_INT(RING_BUFFER_OK, ring_buffer_spsc_pop(&int_buf, &item));
+        TEST_ASSERT_EQUAL_INT(i, item);
+    }
+}
+void check_ring_buffer_spsc_pop_struct(void) {
+    Point p = { 1.5f, -2.0f }, out;
+    ring_buffer_spsc_push(&point_buf, &p);
+    ring_buffer_spsc_pop(&point_buf, &out);
+    TEST_ASSERT_EQUAL_FLOAT(p.x, out.x);
+    TEST_ASSERT_EQUAL_FLOAT(p.y, out.y);
+}
+
+void check_ring_buffer_spsc_reserve_when_full(void) {
+    for (int i = 0; i < 8; ++i)
+        ring_buffer_spsc_push(&int_buf, &i);
+    TEST_ASSERT_NULL(ring_buffer_spsc_reserve(&int_buf));
+    TEST_ASSERT_EQUAL_INT(RING_BUFFER_FULL, ring_buffer_spsc_commit(&int_buf));
+}
+void check_ring_buffer_spsc_reserve_not_visible_before_commit(void) {
+    int * slot = ring_buffer_spsc_reserve(&int_buf);
+    TEST_ASSERT_NOT_NULL(slot);
+    *slot = 42;
+    TEST_ASSERT_EQUAL_size_t(0U, ring_buffer_spsc_size(&int_buf));
+    TEST_ASSERT_EQUAL_INT(RING_BUFFER_OK, ring_buffer_spsc_commit(&int_buf));
+
+    int item;
+    ring_buffer_spsc_pop(&int_buf, &item);
+    TEST_ASSERT_EQUAL_INT(42, item);
+}
+
+void check_ring_buffer_spsc_pop_n_with_null(void) {
+    int out[4];
+    TEST_ASSERT_EQUAL_size_t(0U, ring_buffer_spsc_pop_n(NULL, out, 4));
+    TEST_ASSERT_EQUAL_size_t(0U, ring_buffer_spsc_pop_n(&int_buf, NULL, 4));
+}
+void check_ring_buffer_spsc_pop_n_partial(void) {
+    for (int i = 0; i < 3; ++i)
+        ring_buffer_spsc_push(&int_buf, &i);
+    int out[8] = { 0 };
+    TEST_ASSERT_EQUAL_size_t(3U, ring_buffer_spsc_pop_n(&int_buf, out, 8));
+    int expected[] = { 0, 1, 2 };
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected, out, 3);
+    TEST_ASSERT_EQUAL_size_t(0U, ring_buffer_spsc_size(&int_buf));
+}
+void check_ring_buffer_spsc_pop_n_with_wrap(void) {
+    int item;
+    for (int i = 0; i < 5; ++i) {
+        ring_buffer_spsc_push(&int_buf, &i);
+        ring_buffer_spsc_pop(&int_buf, &item);
+    }
+    for (int i = 0; i < 7; ++i)
+        ring_buffer_spsc_push(&int_buf, &i);
+
+    int out[8] = { 0 };
+    TEST_ASSERT_EQUAL_size_t(6U, ring_buffer_spsc_pop_n(&int_buf, out, 6));
+    int expected[] = { 0, 1, 2, 3, 4, 5 };
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected, out, 6);
+    TEST_ASSERT_EQUAL_size_t(1U, ring_buffer_spsc_size(&int_buf));
+}
+
+/**
+ * @brief Interleave pushes and batch pops as an interrupt and the main loop would
+ * do, checking that every item is received once and in order
+ */
+void check_ring_buffer_spsc_interleaved(void) {
+    int next_push = 0, next_pop = 0;
+    int out[8];
+    for (int round = 0; round < 1000; ++round) {
+        int burst = (round * 7) % 9;
+        for (int i = 0; i < burst; ++i) {
+            if (ring_buffer_spsc_push(&int_buf, &next_push) == RING_BUFFER_OK)
+                ++next_push;
+        }
+        size_t n = ring_buffer_spsc_pop_n(&int_buf, out, (round % 5) + 1);
+        for (size_t i = 0; i < n; ++i)
+            TEST_ASSERT_EQUAL_INT(next_pop++, out[i]);
+    }
+    size_t n;
+    while ((n = ring_buffer_spsc_pop_n(&int_buf, out, 8)) > 0)
+        for (size_t i = 0; i < n; ++i)
+            TEST_ASSERT_EQUAL_INT(next_pop++, out[i]);
+    TEST_ASSERT_EQUAL_INT(next_push, next_pop);
+}
+
+int main() {
+    UNITY_BEGIN();
+
+    RUN_TEST(check_ring_buffer_spsc_init_with_null);
+    RUN_TEST(check_ring_buffer_spsc_init_invalid_capacity);
+    RUN_TEST(check_ring_buffer_spsc_init_return_value);
+
+    RUN_TEST(check_ring_buffer_spsc_size_with_null);
+    RUN_TEST(check_ring_buffer_spsc_size);
+
+    RUN_TEST(check_ring_buffer_spsc_push_with_null_item);
+    RUN_TEST(check_ring_buffer_spsc_push_when_full);
+
+    RUN_TEST(check_ring_buffer_spsc_pop_when_empty);
+    RUN_TEST(check_ring_buffer_spsc_pop_with_null_item);
+    RUN_TEST(check_ring_buffer_spsc_pop_order_with_wrap);
+    RUN_TEST(check_ring_buffer_spsc_pop_struct);
+
+    RUN_TEST(check_ring_buffer_spsc_reserve_when_full);
+    RUN_TEST(check_ring_buffer_spsc_reserve_not_visible_before_commit);
+
+    RUN_TEST(check_ring_buffer_spsc_pop_n_with_null);
+    RUN_TEST(check_ring_buffer_spsc_pop_n_partial);
+    RUN_TEST(check_ring_buffer_spsc_pop_n_with_wrap);
+
+    RUN_TEST(check_ring_buffer_spsc_interleaved);
+
+    return UNITY_END();
+}